@@ -12,9 +12,12 @@
 #include <sys/types.h>
 #include <signal.h>
 #include <sys/stat.h>
+#include <sys/socket.h>
+#include <fcntl.h>
 #include <sys/wait.h>
 #include <arpa/inet.h>
 #include <glib-unix.h>
+#include <gio/gunixsocketaddress.h>
 
 #include "nm-libnm-core-aux/nm-dispatcher-api.h"
 #include "nm-dispatcher-utils.h"
@@ -36,6 +39,29 @@ static struct {
     Request *current_request;
     GQueue * requests_waiting;
     int      num_requests_pending;
+
+    /* "no-wait" scripts that wait for a free slot, because already
+     * @max_parallel of them are running. */
+    GQueue *scripts_nowait_waiting;
+    int     num_scripts_nowait_running;
+    int     max_parallel;
+
+    /* long-running handler processes, connected via HANDLER_SOCKET_PATH. */
+    GSocketService *handler_service;
+    GSList *        handlers;
+    guint           handler_id_counter;
+    bool            handler_socket_activated;
+
+    /* set while handlers_shutdown() disconnects the handlers, after the
+     * main loop finished. */
+    bool handlers_shutting_down;
+
+    struct {
+        guint64 num_requests;
+        guint64 num_coalesced;
+        gint64  queue_latency_last_usec;
+        gint64  queue_latency_max_usec;
+    } stats;
 } gl;
 
 typedef struct {
@@ -47,10 +73,19 @@ typedef struct {
     char *         error;
     gboolean       wait;
     gboolean       dispatched;
+    gboolean       nowait_queued;
     guint          watch_id;
     guint          timeout_id;
 } ScriptInfo;
 
+typedef struct {
+    GSocketConnection *conn;
+    GSource *          in_source;
+    GSource *          out_source;
+    GString *          out_buf;
+    guint              handler_id;
+} Handler;
+
 struct Request {
     guint request_id;
 
@@ -64,6 +99,8 @@ struct Request {
     guint      idx;
     int        num_scripts_done;
     int        num_scripts_nowait;
+
+    gint64 ts_queued_usec;
 };
 
 /*****************************************************************************/
@@ -196,7 +233,8 @@ quit_timeout_cb(gpointer user_data)
 static void
 quit_timeout_reschedule(void)
 {
-    if (!gl.persist) {
+    /* connected handlers keep us running. */
+    if (!gl.persist && !gl.handlers) {
         nm_clear_g_source(&gl.quit_id);
         gl.quit_id = g_timeout_add_seconds(10, quit_timeout_cb, NULL);
     }
@@ -239,6 +277,10 @@ next_request(Request *request)
 
     gl.current_request = request;
 
+    gl.stats.queue_latency_last_usec = g_get_monotonic_time() - request->ts_queued_usec;
+    gl.stats.queue_latency_max_usec =
+        NM_MAX(gl.stats.queue_latency_max_usec, gl.stats.queue_latency_last_usec);
+
     return TRUE;
 }
 
@@ -356,11 +398,54 @@ complete_script(ScriptInfo *script)
     }
 }
 
+static gboolean script_dispatch(ScriptInfo *script);
+
+static void
+script_dispatch_nowait(ScriptInfo *script)
+{
+    nm_assert(!script->wait);
+
+    if (gl.max_parallel > 0 && gl.num_scripts_nowait_running >= gl.max_parallel) {
+        /* count the script as running for the request. That way, the request
+         * won't start its "wait" scripts or complete before this one ran. */
+        _LOG_S_T(script, "queue script (no-wait), %d running", gl.num_scripts_nowait_running);
+        script->request->num_scripts_nowait++;
+        script->nowait_queued = TRUE;
+        g_queue_push_tail(gl.scripts_nowait_waiting, script);
+        return;
+    }
+
+    script_dispatch(script);
+}
+
+static void
+script_nowait_done(void)
+{
+    ScriptInfo *script;
+
+    nm_assert(gl.num_scripts_nowait_running > 0);
+    gl.num_scripts_nowait_running--;
+
+    while (gl.max_parallel <= 0 || gl.num_scripts_nowait_running < gl.max_parallel) {
+        script = g_queue_pop_head(gl.scripts_nowait_waiting);
+        if (!script)
+            return;
+
+        script->nowait_queued = FALSE;
+        script->request->num_scripts_nowait--;
+        if (!script_dispatch(script)) {
+            /* Failed to execute the script. It counts as completed. */
+            complete_script(script);
+        }
+    }
+}
+
 static void
 script_watch_cb(GPid pid, int status, gpointer user_data)
 {
     ScriptInfo *script = user_data;
     guint       err;
+    gboolean    wait;
 
     g_assert(pid == script->pid);
 
@@ -398,13 +483,19 @@ script_watch_cb(GPid pid, int status, gpointer user_data)
 
     g_spawn_close_pid(script->pid);
 
+    wait = script->wait;
+
     complete_script(script);
+
+    if (!wait)
+        script_nowait_done();
 }
 
 static gboolean
 script_timeout_cb(gpointer user_data)
 {
     ScriptInfo *script = user_data;
+    gboolean    wait;
 
     script->timeout_id = 0;
     nm_clear_g_source(&script->watch_id);
@@ -426,8 +517,13 @@ again:
 
     g_spawn_close_pid(script->pid);
 
+    wait = script->wait;
+
     complete_script(script);
 
+    if (!wait)
+        script_nowait_done();
+
     return FALSE;
 }
 
@@ -488,6 +584,8 @@ check_filename(const char *file_name)
 
 #define SCRIPT_TIMEOUT 600 /* 10 minutes */
 
+#define MAX_PARALLEL_DEFAULT 32
+
 static gboolean
 script_dispatch(ScriptInfo *script)
 {
@@ -527,8 +625,10 @@ script_dispatch(ScriptInfo *script)
 
     script->watch_id   = g_child_watch_add(script->pid, (GChildWatchFunc) script_watch_cb, script);
     script->timeout_id = g_timeout_add_seconds(SCRIPT_TIMEOUT, script_timeout_cb, script);
-    if (!script->wait)
+    if (!script->wait) {
         request->num_scripts_nowait++;
+        gl.num_scripts_nowait_running++;
+    }
     return TRUE;
 }
 
@@ -676,6 +776,364 @@ script_must_wait(const char *path)
     return TRUE;
 }
 
+/*****************************************************************************/
+
+#define HANDLER_SOCKET_PATH NMRUNDIR "/dispatcher.sock"
+
+/* a handler that doesn't read its events gets disconnected, once
+ * that many bytes are queued for it. */
+#define HANDLER_OUT_BUF_MAX (1024 * 1024)
+
+static void handler_flush(Handler *handler);
+
+static void
+handler_free(Handler *handler)
+{
+    _LOG_X_D("handler:%u: disconnected", handler->handler_id);
+
+    gl.handlers = g_slist_remove(gl.handlers, handler);
+
+    nm_clear_g_source_inst(&handler->in_source);
+    nm_clear_g_source_inst(&handler->out_source);
+    g_io_stream_close(G_IO_STREAM(handler->conn), NULL, NULL);
+    g_object_unref(handler->conn);
+    g_string_free(handler->out_buf, TRUE);
+    g_slice_free(Handler, handler);
+
+    if (!gl.handlers_shutting_down && !gl.handlers && gl.num_requests_pending <= 0)
+        quit_timeout_reschedule();
+}
+
+static gboolean
+handler_out_cb(GObject *stream, gpointer user_data)
+{
+    Handler *handler = user_data;
+
+    nm_clear_g_source_inst(&handler->out_source);
+    handler_flush(handler);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+handler_flush(Handler *handler)
+{
+    gs_free_error GError *error = NULL;
+    GPollableOutputStream *out;
+    gssize                 n;
+
+    if (handler->out_source)
+        return;
+
+    out = G_POLLABLE_OUTPUT_STREAM(g_io_stream_get_output_stream(G_IO_STREAM(handler->conn)));
+
+    while (handler->out_buf->len > 0) {
+        n = g_pollable_output_stream_write_nonblocking(out,
+                                                       handler->out_buf->str,
+                                                       handler->out_buf->len,
+                                                       NULL,
+                                                       &error);
+        if (n < 0) {
+            if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK)) {
+                handler->out_source = g_pollable_output_stream_create_source(out, NULL);
+                g_source_set_callback(handler->out_source,
+                                      (GSourceFunc) handler_out_cb,
+                                      handler,
+                                      NULL);
+                g_source_attach(handler->out_source, NULL);
+                return;
+            }
+            _LOG_X_D("handler:%u: failure to write: %s", handler->handler_id, error->message);
+            handler_free(handler);
+            return;
+        }
+        g_string_erase(handler->out_buf, 0, n);
+    }
+}
+
+static gboolean
+handler_in_cb(GObject *stream, gpointer user_data)
+{
+    gs_free_error GError *error   = NULL;
+    Handler *             handler = user_data;
+    char                  buf[256];
+    gssize                n;
+
+    /* handlers are not supposed to send anything. We only read to notice
+     * when they disconnect. */
+    n = g_pollable_input_stream_read_nonblocking(G_POLLABLE_INPUT_STREAM(stream),
+                                                 buf,
+                                                 sizeof(buf),
+                                                 NULL,
+                                                 &error);
+    if (n > 0 || (n < 0 && g_error_matches(error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK)))
+        return G_SOURCE_CONTINUE;
+
+    handler_free(handler);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean
+handler_incoming_cb(GSocketService *   service,
+                    GSocketConnection *conn,
+                    GObject *          source_object,
+                    gpointer           user_data)
+{
+    gs_unref_object GCredentials *creds = NULL;
+    Handler *                     handler;
+    GInputStream *                in;
+
+    /* only root may get the events, just like only root owned scripts are run. */
+    creds = g_socket_get_credentials(g_socket_connection_get_socket(conn), NULL);
+    if (!creds || g_credentials_get_unix_user(creds, NULL) != 0) {
+        _LOG_X_W("handler: reject connection from non-root peer");
+        return TRUE;
+    }
+
+    handler  = g_slice_new(Handler);
+    *handler = (Handler){
+        .conn       = g_object_ref(conn),
+        .out_buf    = g_string_new(NULL),
+        .handler_id = ++gl.handler_id_counter,
+    };
+
+    in                 = g_io_stream_get_input_stream(G_IO_STREAM(conn));
+    handler->in_source = g_pollable_input_stream_create_source(G_POLLABLE_INPUT_STREAM(in), NULL);
+    g_source_set_callback(handler->in_source, (GSourceFunc) handler_in_cb, handler, NULL);
+    g_source_attach(handler->in_source, NULL);
+
+    gl.handlers = g_slist_prepend(gl.handlers, handler);
+    nm_clear_g_source(&gl.quit_id);
+
+    _LOG_X_D("handler:%u: connected", handler->handler_id);
+    return TRUE;
+}
+
+static gboolean
+handlers_fd_is_listening_unix_socket(int fd)
+{
+    struct sockaddr_storage addr;
+    socklen_t               len;
+    int                     val;
+
+    len = sizeof(val);
+    if (getsockopt(fd, SOL_SOCKET, SO_TYPE, &val, &len) < 0 || val != SOCK_STREAM)
+        return FALSE;
+
+    len = sizeof(val);
+    if (getsockopt(fd, SOL_SOCKET, SO_ACCEPTCONN, &val, &len) < 0 || !val)
+        return FALSE;
+
+    len = sizeof(addr);
+    if (getsockname(fd, (struct sockaddr *) &addr, &len) < 0 || addr.ss_family != AF_UNIX)
+        return FALSE;
+
+    return TRUE;
+}
+
+/* With the NetworkManager-dispatcher.socket unit, systemd owns the listening
+ * socket and passes it to us (see sd_listen_fds(3)). Then the socket exists
+ * while the dispatcher is not running, and connecting to it starts the
+ * dispatcher. */
+static int
+handlers_get_activated_fd(void)
+{
+    gint64 pid;
+    gint64 n_fds;
+
+    pid   = _nm_utils_ascii_str_to_int64(g_getenv("LISTEN_PID"), 10, 1, G_MAXINT32, -1);
+    n_fds = _nm_utils_ascii_str_to_int64(g_getenv("LISTEN_FDS"), 10, 1, G_MAXINT32, -1);
+
+    /* don't pass them on to scripts. */
+    g_unsetenv("LISTEN_PID");
+    g_unsetenv("LISTEN_FDS");
+    g_unsetenv("LISTEN_FDNAMES");
+
+    if (pid != getpid() || n_fds < 1)
+        return -1;
+
+    if (n_fds > 1)
+        _LOG_X_W("handler: got %d sockets from systemd, only use the first", (int) n_fds);
+
+    /* SD_LISTEN_FDS_START. Don't trust the environment alone, the fd must
+     * really be the listening unix stream socket of our socket unit. */
+    if (!handlers_fd_is_listening_unix_socket(3)) {
+        _LOG_X_W("handler: fd 3 passed by systemd is not a listening unix stream socket");
+        return -1;
+    }
+
+    fcntl(3, F_SETFD, FD_CLOEXEC);
+    return 3;
+}
+
+static gboolean
+handlers_add_socket(GError **error)
+{
+    gs_unref_object GSocketAddress *address = NULL;
+    gs_unref_object GSocket *socket         = NULL;
+    mode_t                   old_umask;
+    gboolean                 success;
+    int                      fd;
+
+    fd = handlers_get_activated_fd();
+    if (fd >= 0) {
+        gl.handler_socket_activated = TRUE;
+        socket                      = g_socket_new_from_fd(fd, error);
+        if (!socket)
+            return FALSE;
+        return g_socket_listener_add_socket(G_SOCKET_LISTENER(gl.handler_service),
+                                            socket,
+                                            NULL,
+                                            error);
+    }
+
+    unlink(HANDLER_SOCKET_PATH);
+
+    /* The events contain the same environment as scripts get. Create the
+     * socket accessible only by root, without a window where it isn't. */
+    address   = g_unix_socket_address_new(HANDLER_SOCKET_PATH);
+    old_umask = umask(0077);
+    success   = g_socket_listener_add_address(G_SOCKET_LISTENER(gl.handler_service),
+                                            address,
+                                            G_SOCKET_TYPE_STREAM,
+                                            G_SOCKET_PROTOCOL_DEFAULT,
+                                            NULL,
+                                            NULL,
+                                            error);
+    umask(old_umask);
+    return success;
+}
+
+static void
+handlers_setup(void)
+{
+    gs_free_error GError *error = NULL;
+
+    gl.handler_service = g_socket_service_new();
+    if (!handlers_add_socket(&error)) {
+        _LOG_X_W("handler: cannot listen on %s: %s", HANDLER_SOCKET_PATH, error->message);
+        g_clear_object(&gl.handler_service);
+        return;
+    }
+
+    g_signal_connect(gl.handler_service, "incoming", G_CALLBACK(handler_incoming_cb), NULL);
+    g_socket_service_start(gl.handler_service);
+}
+
+static void
+handlers_shutdown(void)
+{
+    gl.handlers_shutting_down = TRUE;
+    while (gl.handlers)
+        handler_free(gl.handlers->data);
+
+    if (gl.handler_service) {
+        g_socket_service_stop(gl.handler_service);
+        g_socket_listener_close(G_SOCKET_LISTENER(gl.handler_service));
+        g_clear_object(&gl.handler_service);
+        if (!gl.handler_socket_activated)
+            unlink(HANDLER_SOCKET_PATH);
+    }
+}
+
+/* Sends the event for @request to all connected handlers. An event is a
+ * sequence of NUL terminated strings: the action, the interface name
+ * (possibly empty) and the environment that scripts get, terminated
+ * by an empty string. */
+static void
+handlers_send_event(const Request *request)
+{
+    nm_auto_free_gstring GString *event = NULL;
+    GSList *                      iter;
+    GSList *                      iter_next;
+    char **                       p;
+
+    if (!gl.handlers)
+        return;
+
+    event = g_string_new(NULL);
+    g_string_append_len(event, request->action, strlen(request->action) + 1);
+    g_string_append_len(event, request->iface ?: "", strlen(request->iface ?: "") + 1);
+    for (p = request->envp; p && *p; p++)
+        g_string_append_len(event, *p, strlen(*p) + 1);
+    g_string_append_c(event, '\0');
+
+    for (iter = gl.handlers; iter; iter = iter_next) {
+        Handler *handler = iter->data;
+
+        iter_next = iter->next;
+
+        if (handler->out_buf->len + event->len > HANDLER_OUT_BUF_MAX) {
+            _LOG_X_W("handler:%u: too many unread events. Disconnect", handler->handler_id);
+            handler_free(handler);
+            continue;
+        }
+        g_string_append_len(handler->out_buf, event->str, event->len);
+        handler_flush(handler);
+    }
+}
+
+/*****************************************************************************/
+
+static gboolean
+request_can_coalesce(const Request *request)
+{
+    guint i;
+
+    /* The state-refresh actions only report the current DHCP lease. If a
+     * newer event for the same interface arrives before the old one started,
+     * the scripts only need to run for the newer one. */
+    if (!request->iface
+        || !NM_IN_STRSET(request->action, NMD_ACTION_DHCP4_CHANGE, NMD_ACTION_DHCP6_CHANGE))
+        return FALSE;
+
+    /* only requests where no script did start yet. Requests with "no-wait" scripts
+     * started them right away. */
+    if (request->idx > 0)
+        return FALSE;
+    for (i = 0; i < request->scripts->len; i++) {
+        const ScriptInfo *script = g_ptr_array_index(request->scripts, i);
+
+        if (!script->wait)
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static void
+requests_waiting_coalesce(Request *request)
+{
+    GList *iter;
+    GList *iter_next;
+
+    if (!request_can_coalesce(request))
+        return;
+
+    for (iter = g_queue_peek_head_link(gl.requests_waiting); iter; iter = iter_next) {
+        Request *r = iter->data;
+
+        iter_next = iter->next;
+
+        if (!request_can_coalesce(r) || !nm_streq(r->action, request->action)
+            || !nm_streq(r->iface, request->iface))
+            continue;
+
+        _LOG_R_D(r, "completed: superseded by req:%u", request->request_id);
+
+        g_queue_delete_link(gl.requests_waiting, iter);
+        gl.stats.num_coalesced++;
+
+        /* reply like for a request without scripts. */
+        g_dbus_method_invocation_return_value(
+            r->context,
+            g_variant_new("(@a(sus))", g_variant_new_array(G_VARIANT_TYPE("(sus)"), NULL, 0)));
+        r->num_scripts_done = r->scripts->len;
+        request_free(r);
+
+        g_assert_cmpint(gl.num_requests_pending, >, 1);
+        gl.num_requests_pending--;
+    }
+}
+
 static void
 _method_call_action(GDBusMethodInvocation *invocation, GVariant *parameters)
 {
@@ -735,11 +1193,14 @@ _method_call_action(GDBusMethodInvocation *invocation, GVariant *parameters)
                   &vpn_ip6_config,
                   &debug);
 
-    request             = g_slice_new0(Request);
-    request->request_id = ++gl.request_id_counter;
-    request->debug      = debug || gl.debug;
-    request->context    = invocation;
-    request->action     = g_strdup(action);
+    request                 = g_slice_new0(Request);
+    request->request_id     = ++gl.request_id_counter;
+    request->debug          = debug || gl.debug;
+    request->context        = invocation;
+    request->action         = g_strdup(action);
+    request->ts_queued_usec = g_get_monotonic_time();
+
+    gl.stats.num_requests++;
 
     request->envp = nm_dispatcher_utils_construct_envp(action,
                                                        connection,
@@ -778,6 +1239,9 @@ _method_call_action(GDBusMethodInvocation *invocation, GVariant *parameters)
             _LOG_R_T(request, "environment: %s", *p);
     }
 
+    if (!error_message)
+        handlers_send_event(request);
+
     if (error_message || request->scripts->len == 0) {
         GVariant *results;
 
@@ -801,12 +1265,15 @@ _method_call_action(GDBusMethodInvocation *invocation, GVariant *parameters)
         ScriptInfo *s = g_ptr_array_index(request->scripts, i);
 
         if (!s->wait) {
-            script_dispatch(s);
+            script_dispatch_nowait(s);
             num_nowait++;
         }
     }
 
     if (num_nowait < request->scripts->len) {
+        if (gl.current_request)
+            requests_waiting_coalesce(request);
+
         /* The request has at least one wait script.
          * Try next_request() to schedule the request for
          * execution. This either enqueues the request or
@@ -865,6 +1332,45 @@ on_name_lost(GDBusConnection *connection, const char *name, gpointer user_data)
     g_main_loop_quit(gl.loop);
 }
 
+static void
+_method_call_get_statistics(GDBusMethodInvocation *invocation)
+{
+    GVariantBuilder builder;
+
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sv}"));
+    g_variant_builder_add(&builder, "{sv}", "requests", g_variant_new_uint64(gl.stats.num_requests));
+    g_variant_builder_add(&builder,
+                          "{sv}",
+                          "requests-coalesced",
+                          g_variant_new_uint64(gl.stats.num_coalesced));
+    g_variant_builder_add(&builder,
+                          "{sv}",
+                          "requests-pending",
+                          g_variant_new_uint32(gl.num_requests_pending));
+    g_variant_builder_add(&builder,
+                          "{sv}",
+                          "requests-waiting",
+                          g_variant_new_uint32(g_queue_get_length(gl.requests_waiting)));
+    g_variant_builder_add(&builder,
+                          "{sv}",
+                          "scripts-nowait-running",
+                          g_variant_new_uint32(gl.num_scripts_nowait_running));
+    g_variant_builder_add(&builder,
+                          "{sv}",
+                          "scripts-nowait-waiting",
+                          g_variant_new_uint32(g_queue_get_length(gl.scripts_nowait_waiting)));
+    g_variant_builder_add(&builder,
+                          "{sv}",
+                          "queue-latency-last-usec",
+                          g_variant_new_int64(gl.stats.queue_latency_last_usec));
+    g_variant_builder_add(&builder,
+                          "{sv}",
+                          "queue-latency-max-usec",
+                          g_variant_new_int64(gl.stats.queue_latency_max_usec));
+
+    g_dbus_method_invocation_return_value(invocation, g_variant_new("(a{sv})", &builder));
+}
+
 static void
 _method_call(GDBusConnection *      connection,
              const char *           sender,
@@ -880,6 +1386,10 @@ _method_call(GDBusConnection *      connection,
             _method_call_action(invocation, parameters);
             return;
         }
+        if (nm_streq(method_name, "GetStatistics")) {
+            _method_call_get_statistics(invocation);
+            return;
+        }
     }
     g_dbus_method_invocation_return_error(invocation,
                                           G_DBUS_ERROR,
@@ -910,7 +1420,11 @@ static GDBusInterfaceInfo *const interface_info = NM_DEFINE_GDBUS_INTERFACE_INFO
                 NM_DEFINE_GDBUS_ARG_INFO("vpn_ip6_config", "a{sv}"),
                 NM_DEFINE_GDBUS_ARG_INFO("debug", "b"), ),
             .out_args =
-                NM_DEFINE_GDBUS_ARG_INFOS(NM_DEFINE_GDBUS_ARG_INFO("results", "a(sus)"), ), ), ), );
+                NM_DEFINE_GDBUS_ARG_INFOS(NM_DEFINE_GDBUS_ARG_INFO("results", "a(sus)"), ), ),
+        NM_DEFINE_GDBUS_METHOD_INFO(
+            "GetStatistics",
+            .out_args =
+                NM_DEFINE_GDBUS_ARG_INFOS(NM_DEFINE_GDBUS_ARG_INFO("statistics", "a{sv}"), ), ), ), );
 
 static const GDBusInterfaceVTable interface_vtable = {
     .method_call = _method_call,
@@ -982,6 +1496,13 @@ parse_command_line(int *p_argc, char ***p_argv, GError **error)
     GOptionEntry    entries[] = {
         {"debug", 0, 0, G_OPTION_ARG_NONE, &gl.debug, "Output to console rather than syslog", NULL},
         {"persist", 0, 0, G_OPTION_ARG_NONE, &gl.persist, "Don't quit after a short timeout", NULL},
+        {"max-parallel",
+         0,
+         0,
+         G_OPTION_ARG_INT,
+         &gl.max_parallel,
+         "Maximum number of no-wait scripts to run in parallel (0 for no limit)",
+         "N"},
         {NULL}};
     gboolean success;
 
@@ -1005,6 +1526,8 @@ main(int argc, char **argv)
     guint                 dbus_regist_id   = 0;
     guint                 dbus_own_name_id = 0;
 
+    gl.max_parallel = MAX_PARALLEL_DEFAULT;
+
     if (!parse_command_line(&argc, &argv, &error)) {
         _LOG_X_W("Error parsing command line arguments: %s", error->message);
         gl.exit_with_failure = TRUE;
@@ -1035,7 +1558,8 @@ main(int argc, char **argv)
         goto done;
     }
 
-    gl.requests_waiting = g_queue_new();
+    gl.requests_waiting       = g_queue_new();
+    gl.scripts_nowait_waiting = g_queue_new();
 
     dbus_regist_id =
         g_dbus_connection_register_object(gl.dbus_connection,
@@ -1059,6 +1583,8 @@ main(int argc, char **argv)
                                                     NULL,
                                                     NULL);
 
+    handlers_setup();
+
     quit_timeout_reschedule();
 
     g_main_loop_run(gl.loop);
@@ -1086,7 +1612,10 @@ done:
     if (dbus_regist_id != 0)
         g_dbus_connection_unregister_object(gl.dbus_connection, nm_steal_int(&dbus_regist_id));
 
+    handlers_shutdown();
+
     nm_clear_pointer(&gl.requests_waiting, g_queue_free);
+    nm_clear_pointer(&gl.scripts_nowait_waiting, g_queue_free);
 
     nm_clear_g_source(&signal_id_term);
     nm_clear_g_source(&signal_id_int);
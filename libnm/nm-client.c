@@ -1617,6 +1617,41 @@ _dbobjs_obj_watcher_unregister(NMClient *self, gpointer obj_watcher_base)
 
 /*****************************************************************************/
 
+static gboolean
+_dbus_path_is_skipped(NMClient *self, const char *object_path)
+{
+    static const struct {
+        const char *          path_prefix;
+        NMClientInstanceFlags flag;
+    } skip_list[] = {
+        {NM_DBUS_PATH "/IP4Config/", NM_CLIENT_INSTANCE_FLAGS_NO_IP_CONFIGS},
+        {NM_DBUS_PATH "/IP6Config/", NM_CLIENT_INSTANCE_FLAGS_NO_IP_CONFIGS},
+        {NM_DBUS_PATH "/DHCP4Config/", NM_CLIENT_INSTANCE_FLAGS_NO_IP_CONFIGS},
+        {NM_DBUS_PATH "/DHCP6Config/", NM_CLIENT_INSTANCE_FLAGS_NO_IP_CONFIGS},
+        {NM_DBUS_PATH_ACCESS_POINT "/", NM_CLIENT_INSTANCE_FLAGS_NO_ACCESS_POINTS},
+    };
+    NMClientInstanceFlags instance_flags = NM_CLIENT_GET_PRIVATE(self)->instance_flags;
+    int                   i;
+
+    /* Objects of skipped types are never tracked. References to them from
+     * other objects (like the "Ip4Config" property of a device) stay
+     * unresolved and the corresponding libnm getters return NULL. */
+
+    if (!NM_FLAGS_ANY(instance_flags,
+                      NM_CLIENT_INSTANCE_FLAGS_NO_IP_CONFIGS
+                          | NM_CLIENT_INSTANCE_FLAGS_NO_ACCESS_POINTS))
+        return FALSE;
+
+    for (i = 0; i < (int) G_N_ELEMENTS(skip_list); i++) {
+        if (NM_FLAGS_HAS(instance_flags, skip_list[i].flag)
+            && g_str_has_prefix(object_path, skip_list[i].path_prefix))
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/*****************************************************************************/
+
 typedef struct {
     NMLDBusObjWatcher parent;
     NMLDBusPropertyO *pr_o;
@@ -1675,7 +1710,7 @@ nml_dbus_property_o_notify_changed(NMLDBusPropertyO *pr_o, NMClient *self)
                 pr_o->owner_dbobj->dbus_path->str,
                 pr_o->meta_iface->dbus_properties[pr_o->dbus_property_idx].dbus_property_name,
                 pr_o->obj_watcher->dbobj->dbus_path->str);
-        } else {
+        } else if (!_dbus_path_is_skipped(self, pr_o->obj_watcher->dbobj->dbus_path->str)) {
             NML_NMCLIENT_LOG_E(
                 self,
                 "[%s]: property %s references %s but object is not present on D-Bus",
@@ -1988,7 +2023,8 @@ nml_dbus_property_ao_notify_changed(NMLDBusPropertyAO *pr_ao, NMClient *self)
                     pr_ao->owner_dbobj->dbus_path->str,
                     pr_ao->meta_iface->dbus_properties[pr_ao->dbus_property_idx].dbus_property_name,
                     pr_ao_data->obj_watcher.dbobj->dbus_path->str);
-            } else {
+            } else if (!_dbus_path_is_skipped(self,
+                                              pr_ao_data->obj_watcher.dbobj->dbus_path->str)) {
                 NML_NMCLIENT_LOG_E(
                     self,
                     "[%s]: property %s references %s but object is not present on D-Bus",
@@ -3038,6 +3074,11 @@ _dbus_handle_interface_added(NMClient *  self,
 
     nm_assert(g_variant_is_of_type(ifaces, G_VARIANT_TYPE("a{sa{sv}}")));
 
+    if (_dbus_path_is_skipped(self, object_path)) {
+        NML_NMCLIENT_LOG_T(self, "%s: [%s] skip object", log_context, object_path);
+        return FALSE;
+    }
+
     g_variant_iter_init(&iter_ifaces, ifaces);
     while (g_variant_iter_next(&iter_ifaces, "{&s@a{sv}}", &interface_name, &changed_properties)) {
         _nm_unused gs_unref_variant GVariant *changed_properties_free = changed_properties;
@@ -3156,6 +3197,9 @@ _dbus_managed_objects_changed_cb(GDBusConnection *connection,
 
         g_variant_get(parameters, "(&o^a&s)", &object_path, &interfaces);
 
+        if (_dbus_path_is_skipped(self, object_path))
+            return;
+
         log_context = "interfaces-removed";
         changed = _dbus_handle_interface_removed(self, log_context, object_path, NULL, interfaces);
         goto out;
@@ -3192,6 +3236,9 @@ _dbus_properties_changed_cb(GDBusConnection *connection,
     if (!g_variant_is_of_type(parameters, G_VARIANT_TYPE("(sa{sv}as)")))
         return;
 
+    if (_dbus_path_is_skipped(self, object_path))
+        return;
+
     g_variant_get(parameters,
                   "(&s@a{sv}^a&s)",
                   &interface_name,
@@ -8041,6 +8088,11 @@ nm_client_class_init(NMClientClass *client_class)
      * property to know whether permissions are ready. Note that permissions are only fetched
      * when NMClient has a D-Bus name owner.
      *
+     * The flags %NM_CLIENT_INSTANCE_FLAGS_NO_IP_CONFIGS and %NM_CLIENT_INSTANCE_FLAGS_NO_ACCESS_POINTS
+     * (since 1.30) can only be set during construction. They let clients that only care about
+     * devices and connections avoid creating objects for every IP configuration and Wi-Fi
+     * access point that NetworkManager exports.
+     *
      * Since: 1.24
      */
     obj_properties[PROP_INSTANCE_FLAGS] = g_param_spec_uint(
@@ -24,12 +24,23 @@ G_BEGIN_DECLS
  *   can be disabled. You can toggle this flag to enable and disable automatic
  *   fetching of the permissions. Watch also nm_client_get_permissions_state()
  *   to know whether the permissions are up to date.
+ * @NM_CLIENT_INSTANCE_FLAGS_NO_IP_CONFIGS: don't track IP4Config, IP6Config,
+ *   DHCP4Config and DHCP6Config objects. The corresponding properties of
+ *   devices and active connections will be %NULL. This reduces the memory
+ *   and the D-Bus traffic processed by clients that don't need this
+ *   information. This flag can only be set during construction. Since: 1.30.
+ * @NM_CLIENT_INSTANCE_FLAGS_NO_ACCESS_POINTS: don't track Wi-Fi access point
+ *   objects. nm_device_wifi_get_access_points() returns an empty list and
+ *   nm_device_wifi_get_active_access_point() returns %NULL. This flag can
+ *   only be set during construction. Since: 1.30.
  *
  * Since: 1.24
  */
 typedef enum { /*< flags >*/
                NM_CLIENT_INSTANCE_FLAGS_NONE                      = 0,
                NM_CLIENT_INSTANCE_FLAGS_NO_AUTO_FETCH_PERMISSIONS = 1,
+               NM_CLIENT_INSTANCE_FLAGS_NO_IP_CONFIGS             = 2,
+               NM_CLIENT_INSTANCE_FLAGS_NO_ACCESS_POINTS          = 4,
 } NMClientInstanceFlags;
 
 #define NM_TYPE_CLIENT            (nm_client_get_type())
@@ -1268,6 +1268,83 @@ test_connection_invalid(void)
 
 /*****************************************************************************/
 
+static void
+test_client_instance_flags(gconstpointer test_data)
+{
+    nmtstc_auto_service_cleanup NMTstcServiceInfo *sinfo = NULL;
+    gs_unref_object NMClient *client                     = NULL;
+    gs_unref_object NMClient *client2                    = NULL;
+    NMClientInstanceFlags     instance_flags;
+    NMDevice *                wlan0;
+    NMDevice *                wlan0_2;
+    GError *                  error = NULL;
+    GVariant *                ret;
+    gboolean                  no_ip_configs;
+    gboolean                  no_aps;
+
+    instance_flags = GPOINTER_TO_UINT(test_data);
+    no_ip_configs = NM_FLAGS_HAS(instance_flags, NM_CLIENT_INSTANCE_FLAGS_NO_IP_CONFIGS);
+    no_aps        = NM_FLAGS_HAS(instance_flags, NM_CLIENT_INSTANCE_FLAGS_NO_ACCESS_POINTS);
+
+    sinfo = nmtstc_service_init();
+    if (!nmtstc_service_available(sinfo))
+        return;
+
+    /* A client without flags, to know when the service is set up. */
+    client = nmtstc_client_new(TRUE);
+
+    wlan0 = nmtstc_service_add_device(sinfo, client, "AddWifiDevice", "wlan0");
+    g_assert(NM_IS_DEVICE_WIFI(wlan0));
+
+    ret = g_dbus_proxy_call_sync(sinfo->proxy,
+                                 "AddWifiAp",
+                                 g_variant_new("(sss)", "wlan0", "test-ap", expected_bssid),
+                                 G_DBUS_CALL_FLAGS_NO_AUTO_START,
+                                 3000,
+                                 NULL,
+                                 &error);
+    g_assert_no_error(error);
+    g_assert(ret);
+    g_variant_unref(ret);
+
+    nmtst_main_context_iterate_until_assert(
+        NULL,
+        5000,
+        nm_device_wifi_get_access_points(NM_DEVICE_WIFI(wlan0))->len == 1);
+    g_assert(nm_device_get_ip4_config(wlan0));
+    g_assert(nm_device_get_ip6_config(wlan0));
+    g_assert(nm_device_get_dhcp4_config(wlan0));
+    g_assert(nm_device_get_dhcp6_config(wlan0));
+
+    /* Now the client with flags. It must still initialize, only without the
+     * objects that it was told to ignore. */
+    client2 = nmtstc_context_object_new(NM_TYPE_CLIENT,
+                                        TRUE,
+                                        NM_CLIENT_INSTANCE_FLAGS,
+                                        (guint) instance_flags,
+                                        NULL);
+    g_assert(nm_client_get_nm_running(client2));
+    g_assert(NM_FLAGS_ALL(nm_client_get_instance_flags(client2), instance_flags));
+
+    g_assert_cmpint(nm_client_get_devices(client2)->len, ==, 1);
+    wlan0_2 = nm_client_get_device_by_iface(client2, "wlan0");
+    g_assert(NM_IS_DEVICE_WIFI(wlan0_2));
+    g_assert_cmpstr(nm_object_get_path(NM_OBJECT(wlan0_2)),
+                    ==,
+                    nm_object_get_path(NM_OBJECT(wlan0)));
+
+    g_assert_cmpint(!!nm_device_get_ip4_config(wlan0_2), ==, !no_ip_configs);
+    g_assert_cmpint(!!nm_device_get_ip6_config(wlan0_2), ==, !no_ip_configs);
+    g_assert_cmpint(!!nm_device_get_dhcp4_config(wlan0_2), ==, !no_ip_configs);
+    g_assert_cmpint(!!nm_device_get_dhcp6_config(wlan0_2), ==, !no_ip_configs);
+
+    g_assert_cmpint(nm_device_wifi_get_access_points(NM_DEVICE_WIFI(wlan0_2))->len,
+                    ==,
+                    no_aps ? 0 : 1);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -1288,6 +1365,12 @@ main(int argc, char **argv)
     g_test_add_func("/libnm/activate-virtual", test_activate_virtual);
     g_test_add_func("/libnm/device-connection-compatibility", test_device_connection_compatibility);
     g_test_add_func("/libnm/connection/invalid", test_connection_invalid);
+    g_test_add_data_func("/libnm/client-instance-flags/no-ip-configs",
+                         GUINT_TO_POINTER(NM_CLIENT_INSTANCE_FLAGS_NO_IP_CONFIGS),
+                         test_client_instance_flags);
+    g_test_add_data_func("/libnm/client-instance-flags/no-access-points",
+                         GUINT_TO_POINTER(NM_CLIENT_INSTANCE_FLAGS_NO_ACCESS_POINTS),
+                         test_client_instance_flags);
 
     return g_test_run();
 }
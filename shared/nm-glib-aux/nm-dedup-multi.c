@@ -44,6 +44,8 @@ ASSERT_idx_type(const NMDedupMultiIdxType *idx_type)
     nm_assert(idx_type->klass->idx_obj_id_equal);
     nm_assert(!!idx_type->klass->idx_obj_partition_hash_update
               == !!idx_type->klass->idx_obj_partition_equal);
+    nm_assert(!idx_type->klass->idx_obj_partition_hash
+              || idx_type->klass->idx_obj_partition_hash_update);
     nm_assert(idx_type->lst_idx_head.next);
 #endif
 }
@@ -168,6 +170,11 @@ _dict_idx_entries_hash(const NMDedupMultiEntry *entry)
 
     _entry_unpack(entry, &idx_type, &obj, &lookup_head);
 
+    if (lookup_head && idx_type->klass->idx_obj_partition_hash) {
+        nm_assert(obj);
+        return idx_type->klass->idx_obj_partition_hash(idx_type, obj);
+    }
+
     nm_hash_init(&h, 1914869417u);
     if (idx_type->klass->idx_obj_partition_hash_update) {
         nm_assert(obj);
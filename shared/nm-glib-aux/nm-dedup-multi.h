@@ -160,6 +160,14 @@ struct _NMDedupMultiIdxTypeClass {
     gboolean (*idx_obj_partition_equal)(const NMDedupMultiIdxType *idx_type,
                                         const NMDedupMultiObj *    obj_a,
                                         const NMDedupMultiObj *    obj_b);
+
+    /* optional. If set, the head entries are hashed with this function instead
+     * of idx_obj_partition_hash_update(). It must be consistent with
+     * idx_obj_partition_equal() and should mix in @idx_type. That allows an
+     * idx-type to use a cheaper hash (NMHashFastState) when its partition key
+     * cannot be chosen by an untrusted party. */
+    guint (*idx_obj_partition_hash)(const NMDedupMultiIdxType *idx_type,
+                                    const NMDedupMultiObj *    obj);
 };
 
 static inline gboolean
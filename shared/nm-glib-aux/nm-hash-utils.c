@@ -126,6 +126,22 @@ nm_hash_siphash42_init(CSipHash *h, guint static_seed)
     c_siphash_init(h, (const guint8 *) &seed);
 }
 
+void
+nm_hash_fast_init(NMHashFastState *state, guint static_seed)
+{
+    union {
+        guint64 u64[2];
+        guint   arr[HASH_KEY_SIZE_GUINT];
+    } seed;
+
+    nm_assert(state);
+
+    memcpy(&seed, _get_hash_key(), HASH_KEY_SIZE);
+    seed.arr[0] ^= static_seed;
+    state->_v = seed.u64[0];
+    state->_k = seed.u64[1];
+}
+
 guint
 nm_hash_str(const char *str)
 {
@@ -197,7 +213,7 @@ gboolean
 nm_pint_equals(gconstpointer a, gconstpointer b)
 {
     const int *s1 = a;
-    const int *s2 = a;
+    const int *s2 = b;
 
     return s1 == s2 || (s1 && s2 && *s1 == *s2);
 }
@@ -341,6 +341,90 @@ nm_hash_mem(guint static_seed, const void *ptr, gsize n)
 
 /*****************************************************************************/
 
+/* NMHashFastState is a cheaper hasher than NMHashState. It is also keyed with
+ * the random per-run seed, but it is not a cryptographic PRF and gives no
+ * protection against hash flooding. Only use it where the hashed data cannot
+ * be chosen by an untrusted party, like ifindexes or enum values of an internal
+ * index. NMPCache uses it for the head entries of some of its indexes.
+ *
+ * Also, contrary to NMHashState, the result depends on how the data is split
+ * across nm_hash_fast_update() calls. That is no problem as long as equal keys
+ * are always hashed by the same code. */
+typedef struct {
+    guint64 _v;
+    guint64 _k;
+} NMHashFastState;
+
+void nm_hash_fast_init(NMHashFastState *state, guint static_seed);
+
+#define _NM_HASH_FAST_P1 ((guint64) 0x9E3779B185EBCA87ull)
+#define _NM_HASH_FAST_P2 ((guint64) 0xC2B2AE3D27D4EB4Full)
+#define _NM_HASH_FAST_P3 ((guint64) 0x165667B19E3779F9ull)
+
+static inline guint64
+_nm_hash_fast_round(guint64 v, guint64 w)
+{
+    v += w * _NM_HASH_FAST_P2;
+    v = (v << 31) | (v >> 33);
+    return v * _NM_HASH_FAST_P1;
+}
+
+static inline void
+nm_hash_fast_update(NMHashFastState *state, const void *ptr, gsize n)
+{
+    const guint8 *p = ptr;
+    guint64       v;
+    guint64       w;
+
+    nm_assert(state);
+    nm_assert(n == 0 || ptr);
+
+    /* mix in the length first, so that zero padding of the tail below
+     * does not lead to collisions. */
+    v = _nm_hash_fast_round(state->_v, n);
+
+    for (; n >= sizeof(w); n -= sizeof(w), p += sizeof(w)) {
+        memcpy(&w, p, sizeof(w));
+        v = _nm_hash_fast_round(v, w);
+    }
+    if (n > 0) {
+        w = 0;
+        memcpy(&w, p, n);
+        v = _nm_hash_fast_round(v, w);
+    }
+
+    state->_v = v;
+}
+
+#define nm_hash_fast_update_val(state, val)                \
+    G_STMT_START                                           \
+    {                                                      \
+        typeof(val) _val = (val);                          \
+                                                           \
+        nm_hash_fast_update((state), &_val, sizeof(_val)); \
+    }                                                      \
+    G_STMT_END
+
+static inline guint
+nm_hash_fast_complete(const NMHashFastState *state)
+{
+    guint64 v;
+
+    nm_assert(state);
+
+    v = state->_v ^ state->_k;
+    v ^= v >> 33;
+    v *= _NM_HASH_FAST_P2;
+    v ^= v >> 29;
+    v *= _NM_HASH_FAST_P3;
+    v ^= v >> 32;
+
+    /* like nm_hash_complete(), never return zero. */
+    return (((guint)(v >> 32)) ^ ((guint) v)) ?: 1396707757u;
+}
+
+/*****************************************************************************/
+
 /* nm_pstr_*() are for hashing keys that are pointers to strings,
  * that is, "const char *const*" types, using strcmp(). */
 
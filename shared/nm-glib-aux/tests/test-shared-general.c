@@ -75,6 +75,27 @@ test_nmhash(void)
     g_assert(nm_hash_val(555, 4) != 0);
 }
 
+#define _hash_fast_val(static_seed, val)       \
+    ({                                         \
+        NMHashFastState _h;                    \
+                                               \
+        nm_hash_fast_init(&_h, (static_seed)); \
+        nm_hash_fast_update_val(&_h, (val));   \
+        nm_hash_fast_complete(&_h);            \
+    })
+
+static void
+test_nmhash_fast(void)
+{
+    int rnd;
+
+    nm_utils_random_bytes(&rnd, sizeof(rnd));
+
+    g_assert(_hash_fast_val(555, 4) != 0);
+    g_assert_cmpint(_hash_fast_val(555, rnd), ==, _hash_fast_val(555, rnd));
+    g_assert_cmpint(_hash_fast_val(555, (guint32) 0), !=, _hash_fast_val(555, (guint64) 0));
+}
+
 /*****************************************************************************/
 
 static const char *
@@ -1268,6 +1289,7 @@ main(int argc, char **argv)
     g_test_add_func("/general/test_gpid", test_gpid);
     g_test_add_func("/general/test_monotonic_timestamp", test_monotonic_timestamp);
     g_test_add_func("/general/test_nmhash", test_nmhash);
+    g_test_add_func("/general/test_nmhash_fast", test_nmhash_fast);
     g_test_add_func("/general/test_nm_make_strv", test_make_strv);
     g_test_add_func("/general/test_nm_strdup_int", test_nm_strdup_int);
     g_test_add_func("/general/test_nm_strndup_a", test_nm_strndup_a);
@@ -40,7 +40,10 @@
  * - functions that do the actual logging logging (nm_log(), nm_logging_enabled()) are
  *   thread-safe and may be used from multiple threads.
  *    - When called from the not-main-thread, @mt_require_locking must be set to %TRUE.
- *      In this case, a Mutex will be used for accessing the global state.
+ *      In this case, a Mutex will be used for accessing the global state. The exception
+ *      is nm_logging_enabled(), which only reads one word of the enabled state and does
+ *      so with an atomic load instead of the lock. That way, checking for a disabled
+ *      level is cheap also on call sites that must be thread-safe.
  *    - When called from the main-thread, they may optionally pass @mt_require_locking %FALSE.
  *      This avoids extra locking and is in particular interesting for nm_logging_enabled(),
  *      which is expected to be called frequently and from the main-thread.
@@ -94,6 +97,7 @@ typedef struct {
     bool        init_pre_done : 1;
     bool        init_done : 1;
     bool        debug_stderr : 1;
+    bool        journal_async : 1;
     const char *prefix;
     const char *syslog_identifier;
 
@@ -393,8 +397,10 @@ nm_logging_setup(const char *level, const char *domains, char **bad_domains, GEr
     G_LOCK(log);
 
     gl.mut.log_level = new_log_level;
+
+    /* _nm_logging_enabled_locking() reads these words without lock. */
     for (i = 0; i < G_N_ELEMENTS(new_log_state); i++)
-        _nm_logging_enabled_state[i] = new_log_state[i];
+        __atomic_store_n(&_nm_logging_enabled_state[i], new_log_state[i], __ATOMIC_RELAXED);
 
     G_UNLOCK(log);
 
@@ -566,12 +572,15 @@ nm_logging_get_level(NMLogDomain domain)
 gboolean
 _nm_logging_enabled_locking(NMLogLevel level, NMLogDomain domain)
 {
-    gboolean v;
+    nm_assert(((guint) level) < G_N_ELEMENTS(_nm_logging_enabled_state));
+    if (((guint) level) >= G_N_ELEMENTS(_nm_logging_enabled_state))
+        return FALSE;
 
-    G_LOCK(log);
-    v = _nm_logging_enabled_lockfree(level, domain);
-    G_UNLOCK(log);
-    return v;
+    /* This is called for every logging statement on call sites that must be
+     * thread-safe, regardless whether the level is enabled. The check only
+     * depends on one word, which nm_logging_setup() stores atomically. There
+     * is nothing else to keep consistent with it, so no lock is needed. */
+    return !!(__atomic_load_n(&_nm_logging_enabled_state[level], __ATOMIC_RELAXED) & domain);
 }
 
 gboolean
@@ -641,6 +650,209 @@ _nm_printf(3, 4) static void _iovec_set_format(struct iovec *iov,
         }                                                               \
         G_STMT_END
 
+/*****************************************************************************/
+
+/* With the "journal-async" backend, messages are copied into a bounded queue and
+ * a writer thread passes them on to journald. That way, the logging thread is
+ * not blocked when journald applies backpressure. When the queue is full, the
+ * message is dropped and accounted per logging domain. The writer thread
+ * reports the number of dropped messages after it caught up.
+ *
+ * All journal writes go through the writer thread while this backend is
+ * active, including the messages from the glib log handler, so that they
+ * keep their order. */
+
+    #define JOURNAL_ASYNC_QUEUE_SIZE 4096u
+
+typedef struct {
+    guint        n_iov;
+    struct iovec iov[];
+} JournalRecord;
+
+static struct {
+    GMutex         lock;
+    GCond          cond;
+    GCond          cond_drained;
+    GThread *      thread;
+    JournalRecord *queue[JOURNAL_ASYNC_QUEUE_SIZE];
+    guint          queue_head;
+    guint          queue_len;
+    /* One counter per entry of domain_desc[]. The last one (for the terminating
+     * entry) counts messages without logging domain, like those from glib. */
+    guint dropped[G_N_ELEMENTS(domain_desc)];
+    bool  has_dropped : 1;
+    bool           busy : 1;
+} gl_journal_async;
+
+static JournalRecord *
+_journal_record_new(const struct iovec *iov, guint n_iov)
+{
+    JournalRecord *rec;
+    gsize          len = 0;
+    char *         p;
+    guint          i;
+
+    for (i = 0; i < n_iov; i++)
+        len += iov[i].iov_len;
+
+    rec        = g_malloc(sizeof(JournalRecord) + (sizeof(struct iovec) * n_iov) + len);
+    rec->n_iov = n_iov;
+    p          = (char *) &rec->iov[n_iov];
+    for (i = 0; i < n_iov; i++) {
+        memcpy(p, iov[i].iov_base, iov[i].iov_len);
+        _iovec_set(&rec->iov[i], p, iov[i].iov_len);
+        p += iov[i].iov_len;
+    }
+    return rec;
+}
+
+static void
+_journal_async_sendv(NMLogDomain domain, const struct iovec *iov, guint n_iov)
+{
+    JournalRecord *rec;
+    guint          i;
+
+    rec = _journal_record_new(iov, n_iov);
+
+    g_mutex_lock(&gl_journal_async.lock);
+
+    if (gl_journal_async.queue_len >= JOURNAL_ASYNC_QUEUE_SIZE) {
+        if (domain == LOGD_NONE)
+            gl_journal_async.dropped[G_N_ELEMENTS(domain_desc) - 1]++;
+        for (i = 0; domain_desc[i].name; i++) {
+            if (NM_FLAGS_ANY(domain, domain_desc[i].num))
+                gl_journal_async.dropped[i]++;
+        }
+        gl_journal_async.has_dropped = TRUE;
+        g_mutex_unlock(&gl_journal_async.lock);
+        g_free(rec);
+        return;
+    }
+
+    gl_journal_async.queue[(gl_journal_async.queue_head + gl_journal_async.queue_len)
+                           % JOURNAL_ASYNC_QUEUE_SIZE] = rec;
+    if (gl_journal_async.queue_len++ == 0)
+        g_cond_signal(&gl_journal_async.cond);
+
+    g_mutex_unlock(&gl_journal_async.lock);
+}
+
+static JournalRecord *
+_journal_async_record_dropped(const guint *dropped)
+{
+    nm_auto_free_gstring GString *str = NULL;
+    struct iovec                  iov_data[6];
+    struct iovec *                iov = iov_data;
+    char *                        iov_free_data[1];
+    char **                       iov_free = iov_free_data;
+    JournalRecord *               rec;
+    guint                         n = 0;
+    guint                         i;
+
+    for (i = 0; i < G_N_ELEMENTS(domain_desc); i++) {
+        if (dropped[i] == 0)
+            continue;
+        if (!str)
+            str = g_string_new(NULL);
+        else
+            g_string_append(str, ", ");
+        g_string_append_printf(str, "%s=%u", domain_desc[i].name ?: "other", dropped[i]);
+        n += dropped[i];
+    }
+
+    _iovec_set_format_a(iov++, 30, "PRIORITY=%d", LOG_WARNING);
+    _iovec_set_format(iov++,
+                      iov_free++,
+                      "MESSAGE=%slogging: dropped log messages due to a full queue (%s)",
+                      gl.imm.prefix,
+                      str ? str->str : "");
+    _iovec_set_string(iov++, syslog_identifier_full(gl.imm.syslog_identifier));
+    _iovec_set_format_a(iov++, 30, "SYSLOG_PID=%ld", (long) getpid());
+    _iovec_set_string_literal(iov++, "SYSLOG_FACILITY=3");
+    _iovec_set_format_a(iov++, 30, "NM_LOG_DROPPED=%u", n);
+
+    nm_assert(iov == &iov_data[G_N_ELEMENTS(iov_data)]);
+
+    rec = _journal_record_new(iov_data, iov - iov_data);
+
+    for (; --iov_free >= iov_free_data;)
+        g_free(*iov_free);
+    return rec;
+}
+
+static gpointer
+_journal_async_thread(gpointer user_data)
+{
+    JournalRecord **batch;
+    guint           dropped[G_N_ELEMENTS(domain_desc)];
+    gboolean        has_dropped;
+    guint           n;
+    guint           i;
+
+    /* one extra slot for the report about dropped messages. */
+    batch = g_new(JournalRecord *, JOURNAL_ASYNC_QUEUE_SIZE + 1);
+
+    for (;;) {
+        g_mutex_lock(&gl_journal_async.lock);
+
+        while (gl_journal_async.queue_len == 0 && !gl_journal_async.has_dropped) {
+            gl_journal_async.busy = FALSE;
+            g_cond_broadcast(&gl_journal_async.cond_drained);
+            g_cond_wait(&gl_journal_async.cond, &gl_journal_async.lock);
+        }
+        gl_journal_async.busy = TRUE;
+
+        /* take all pending records at once and send them without holding the lock. */
+        n = gl_journal_async.queue_len;
+        for (i = 0; i < n; i++) {
+            batch[i] = gl_journal_async.queue[(gl_journal_async.queue_head + i)
+                                              % JOURNAL_ASYNC_QUEUE_SIZE];
+        }
+        gl_journal_async.queue_head = (gl_journal_async.queue_head + n) % JOURNAL_ASYNC_QUEUE_SIZE;
+        gl_journal_async.queue_len  = 0;
+
+        has_dropped = gl_journal_async.has_dropped;
+        if (has_dropped) {
+            memcpy(dropped, gl_journal_async.dropped, sizeof(dropped));
+            memset(gl_journal_async.dropped, 0, sizeof(gl_journal_async.dropped));
+            gl_journal_async.has_dropped = FALSE;
+        }
+
+        g_mutex_unlock(&gl_journal_async.lock);
+
+        /* The messages were dropped after the ones in the batch were queued. */
+        if (has_dropped)
+            batch[n++] = _journal_async_record_dropped(dropped);
+
+        for (i = 0; i < n; i++) {
+            sd_journal_sendv(batch[i]->iov, batch[i]->n_iov);
+            g_free(batch[i]);
+        }
+    }
+
+    return NULL;
+}
+
+static void
+_journal_async_flush(void)
+{
+    /* called at exit, to not lose the pending messages. */
+    g_mutex_lock(&gl_journal_async.lock);
+    while (gl_journal_async.queue_len > 0 || gl_journal_async.has_dropped
+           || gl_journal_async.busy)
+        g_cond_wait(&gl_journal_async.cond_drained, &gl_journal_async.lock);
+    g_mutex_unlock(&gl_journal_async.lock);
+}
+
+static void
+_journal_async_start(void)
+{
+    nm_assert(!gl_journal_async.thread);
+
+    gl_journal_async.thread = g_thread_new("nm-log-journal", _journal_async_thread, NULL);
+    atexit(_journal_async_flush);
+}
+
 #endif
 
 void
@@ -780,7 +992,10 @@ _nm_log_impl(const char *file,
         nm_assert(iov <= &iov_data[G_N_ELEMENTS(iov_data)]);
         nm_assert(iov_free <= &iov_free_data[G_N_ELEMENTS(iov_free_data)]);
 
-        sd_journal_sendv(iov_data, iov - iov_data);
+        if (g->journal_async)
+            _journal_async_sendv(domain, iov_data, iov - iov_data);
+        else
+            sd_journal_sendv(iov_data, iov - iov_data);
 
         for (; --iov_free >= iov_free_data;)
             g_free(*iov_free);
@@ -867,31 +1082,43 @@ nm_log_handler(const char *log_domain, GLogLevelFlags level, const char *message
 #if SYSTEMD_JOURNAL
     case LOG_BACKEND_JOURNAL:
     {
-        gint64 now, boottime;
+        gint64        now, boottime;
+        struct iovec  iov_data[9];
+        struct iovec *iov = iov_data;
+        char *        iov_free_data[2];
+        char **       iov_free = iov_free_data;
 
         now      = nm_utils_get_monotonic_timestamp_nsec();
         boottime = nm_utils_monotonic_timestamp_as_boottime(now, 1);
 
-        sd_journal_send("PRIORITY=%d",
-                        syslog_priority,
-                        "MESSAGE=%s%s",
-                        gl.imm.prefix,
-                        message ?: "",
-                        syslog_identifier_full(gl.imm.syslog_identifier),
-                        "SYSLOG_PID=%ld",
-                        (long) getpid(),
-                        "SYSLOG_FACILITY=3",
-                        "GLIB_DOMAIN=%s",
-                        log_domain ?: "",
-                        "GLIB_LEVEL=%d",
-                        (int) (level & G_LOG_LEVEL_MASK),
-                        "TIMESTAMP_MONOTONIC=%lld.%06lld",
-                        (long long) (now / NM_UTILS_NSEC_PER_SEC),
-                        (long long) ((now % NM_UTILS_NSEC_PER_SEC) / 1000),
-                        "TIMESTAMP_BOOTTIME=%lld.%06lld",
-                        (long long) (boottime / NM_UTILS_NSEC_PER_SEC),
-                        (long long) ((boottime % NM_UTILS_NSEC_PER_SEC) / 1000),
-                        NULL);
+        _iovec_set_format_a(iov++, 30, "PRIORITY=%d", syslog_priority);
+        _iovec_set_format(iov++, iov_free++, "MESSAGE=%s%s", gl.imm.prefix, message ?: "");
+        _iovec_set_string(iov++, syslog_identifier_full(gl.imm.syslog_identifier));
+        _iovec_set_format_a(iov++, 30, "SYSLOG_PID=%ld", (long) getpid());
+        _iovec_set_string_literal(iov++, "SYSLOG_FACILITY=3");
+        _iovec_set_format(iov++, iov_free++, "GLIB_DOMAIN=%s", log_domain ?: "");
+        _iovec_set_format_a(iov++, 30, "GLIB_LEVEL=%d", (int) (level & G_LOG_LEVEL_MASK));
+        _iovec_set_format_a(iov++,
+                            60,
+                            "TIMESTAMP_MONOTONIC=%lld.%06lld",
+                            (long long) (now / NM_UTILS_NSEC_PER_SEC),
+                            (long long) ((now % NM_UTILS_NSEC_PER_SEC) / 1000));
+        _iovec_set_format_a(iov++,
+                            60,
+                            "TIMESTAMP_BOOTTIME=%lld.%06lld",
+                            (long long) (boottime / NM_UTILS_NSEC_PER_SEC),
+                            (long long) ((boottime % NM_UTILS_NSEC_PER_SEC) / 1000));
+
+        nm_assert(iov == &iov_data[G_N_ELEMENTS(iov_data)]);
+        nm_assert(iov_free == &iov_free_data[G_N_ELEMENTS(iov_free_data)]);
+
+        if (gl.imm.journal_async)
+            _journal_async_sendv(LOGD_NONE, iov_data, iov - iov_data);
+        else
+            sd_journal_sendv(iov_data, iov - iov_data);
+
+        for (; --iov_free >= iov_free_data;)
+            g_free(*iov_free);
     } break;
 #endif
     default:
@@ -947,6 +1174,7 @@ nm_logging_init(const char *logging_backend, gboolean debug)
 {
     gboolean   fetch_monotonic_timestamp = FALSE;
     gboolean   obsolete_debug_backend    = FALSE;
+    gboolean   journal_async             = FALSE;
     LogBackend x_log_backend;
 
     /* this function may be called zero or one times, and only on the
@@ -956,6 +1184,7 @@ nm_logging_init(const char *logging_backend, gboolean debug)
 
     nm_assert(NM_IN_STRSET("" NM_CONFIG_DEFAULT_LOGGING_BACKEND,
                            NM_LOG_CONFIG_BACKEND_JOURNAL,
+                           NM_LOG_CONFIG_BACKEND_JOURNAL_ASYNC,
                            NM_LOG_CONFIG_BACKEND_SYSLOG));
 
     if (gl.imm.init_done)
@@ -980,6 +1209,9 @@ nm_logging_init(const char *logging_backend, gboolean debug)
 #if SYSTEMD_JOURNAL
     if (!nm_streq(logging_backend, NM_LOG_CONFIG_BACKEND_SYSLOG)) {
         x_log_backend = LOG_BACKEND_JOURNAL;
+        journal_async = nm_streq(logging_backend, NM_LOG_CONFIG_BACKEND_JOURNAL_ASYNC);
+        if (journal_async)
+            _journal_async_start();
 
         /* We only log the monotonic-timestamp with structured logging (journal).
          * Only in this case, fetch the timestamp. */
@@ -991,10 +1223,11 @@ nm_logging_init(const char *logging_backend, gboolean debug)
         openlog(syslog_identifier_domain(gl.imm.syslog_identifier), LOG_PID, LOG_DAEMON);
     }
 
-    gl.mut.init_done    = TRUE;
-    gl.mut.log_backend  = x_log_backend;
-    gl.mut.uses_syslog  = TRUE;
-    gl.mut.debug_stderr = debug;
+    gl.mut.init_done     = TRUE;
+    gl.mut.log_backend   = x_log_backend;
+    gl.mut.journal_async = journal_async;
+    gl.mut.uses_syslog   = TRUE;
+    gl.mut.debug_stderr  = debug;
 
     g_log_set_handler(syslog_identifier_domain(gl.imm.syslog_identifier),
                       G_LOG_LEVEL_MASK | G_LOG_FLAG_FATAL | G_LOG_FLAG_RECURSION,
@@ -1016,10 +1249,13 @@ nm_logging_init(const char *logging_backend, gboolean debug)
 
     if (nm_streq(logging_backend, NM_LOG_CONFIG_BACKEND_SYSLOG)) {
         /* good */
-    } else if (nm_streq(logging_backend, NM_LOG_CONFIG_BACKEND_JOURNAL)) {
+    } else if (NM_IN_STRSET(logging_backend,
+                            NM_LOG_CONFIG_BACKEND_JOURNAL,
+                            NM_LOG_CONFIG_BACKEND_JOURNAL_ASYNC)) {
 #if !SYSTEMD_JOURNAL
         nm_log_warn(LOGD_CORE,
-                    "config: logging backend 'journal' is not available, fallback to 'syslog'");
+                    "config: logging backend '%s' is not available, fallback to 'syslog'",
+                    logging_backend);
 #endif
     } else {
         nm_log_warn(LOGD_CORE,
@@ -144,6 +144,15 @@ nl_nlmsghdr_to_str(const struct nlmsghdr *hdr, char *buf, gsize len)
     case RTM_DELTFILTER:
         s = "RTM_DELTFILTER";
         break;
+    case RTM_GETNEIGH:
+        s = "RTM_GETNEIGH";
+        break;
+    case RTM_NEWNEIGH:
+        s = "RTM_NEWNEIGH";
+        break;
+    case RTM_DELNEIGH:
+        s = "RTM_DELNEIGH";
+        break;
     case NLMSG_NOOP:
         s = "NLMSG_NOOP";
         break;
@@ -204,6 +213,7 @@ nl_nlmsghdr_to_str(const struct nlmsghdr *hdr, char *buf, gsize len)
     case RTM_NEWROUTE:
     case RTM_NEWQDISC:
     case RTM_NEWTFILTER:
+    case RTM_NEWNEIGH:
         _F(NLM_F_REPLACE, "replace");
         _F(NLM_F_EXCL, "excl");
         _F(NLM_F_CREATE, "create");
@@ -212,6 +222,7 @@ nl_nlmsghdr_to_str(const struct nlmsghdr *hdr, char *buf, gsize len)
     case RTM_GETLINK:
     case RTM_GETADDR:
     case RTM_GETROUTE:
+    case RTM_GETNEIGH:
     case RTM_DELQDISC:
     case RTM_DELTFILTER:
         _F(NLM_F_DUMP, "dump");
@@ -1024,6 +1035,24 @@ nl_socket_add_memberships(struct nl_sock *sk, int group, ...)
     return 0;
 }
 
+int
+nl_socket_drop_membership(struct nl_sock *sk, int group)
+{
+    int err;
+
+    if (sk->s_fd == -1)
+        return -NME_NL_BAD_SOCK;
+
+    if (group <= 0)
+        g_return_val_if_reached(-NME_BUG);
+
+    err = setsockopt(sk->s_fd, SOL_NETLINK, NETLINK_DROP_MEMBERSHIP, &group, sizeof(group));
+    if (err < 0)
+        return -nm_errno_from_native(errno);
+
+    return 0;
+}
+
 int
 nl_socket_set_ext_ack(struct nl_sock *sk, gboolean enable)
 {
@@ -192,6 +192,15 @@ nla_get_u32(const struct nlattr *nla)
     return *((const uint32_t *) nla_data(nla));
 }
 
+static inline uint32_t
+nla_get_u32_cond(/*const*/ struct nlattr *const *tb, int attr, uint32_t default_val)
+{
+    nm_assert(tb);
+    nm_assert(attr >= 0);
+
+    return tb[attr] ? nla_get_u32(tb[attr]) : default_val;
+}
+
 static inline int32_t
 nla_get_s32(const struct nlattr *nla)
 {
@@ -523,6 +532,8 @@ uint32_t nl_socket_get_local_port(const struct nl_sock *sk);
 
 int nl_socket_add_memberships(struct nl_sock *sk, int group, ...);
 
+int nl_socket_drop_membership(struct nl_sock *sk, int group);
+
 int nl_connect(struct nl_sock *sk, int protocol);
 
 int nl_recv(struct nl_sock *    sk,
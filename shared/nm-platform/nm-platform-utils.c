@@ -23,6 +23,14 @@
 
 /*****************************************************************************/
 
+/* The ethtool helpers are also called from the worker threads of
+ * nm_platform_link_prefetch(). Hence, we require locking from nm-logging.
+ * Indicate that by setting NM_THREAD_SAFE_ON_MAIN_THREAD to zero. */
+#undef NM_THREAD_SAFE_ON_MAIN_THREAD
+#define NM_THREAD_SAFE_ON_MAIN_THREAD 0
+
+/*****************************************************************************/
+
 #define ONOFF(bool_val) ((bool_val) ? "on" : "off")
 
 /******************************************************************************
@@ -1638,7 +1638,29 @@ typedef struct {
 } ShareRule;
 
 struct _NMUtilsShareRules {
+    /* with iptables, the list of rules that we insert/delete one by one. */
     GArray *rules;
+
+    /* with nftables, all rules live in a table of our own. They are added
+     * with a single invocation of nft (and thus, a single netlink batch),
+     * and removed together by deleting the table. The iptables rules are
+     * prepared as well, to fall back to them if nft fails. */
+    char *nft_table;
+    char *nft_script;
+
+    /* nft runs asynchronously. While it runs, it holds a reference, so that
+     * the owner can free the rules right after unsharing. */
+    int ref_count;
+
+    bool use_nft : 1;
+
+    /* whether the rules are requested to be active, and whether the nft
+     * table is currently added. One nft process at a time is in flight to
+     * bring the latter in line with the former. */
+    bool nft_shared : 1;
+    bool nft_added : 1;
+    bool nft_busy : 1;
+    bool nft_busy_add : 1;
 };
 
 static void
@@ -1651,27 +1673,49 @@ _share_rule_clear(gpointer data)
 }
 
 NMUtilsShareRules *
-nm_utils_share_rules_new(void)
+nm_utils_share_rules_new(gboolean use_nft)
 {
     NMUtilsShareRules *self;
 
     self  = g_slice_new(NMUtilsShareRules);
     *self = (NMUtilsShareRules){
-        .rules = g_array_sized_new(FALSE, FALSE, sizeof(ShareRule), 10),
+        .rules     = g_array_sized_new(FALSE, FALSE, sizeof(ShareRule), 10),
+        .ref_count = 1,
+        .use_nft   = use_nft,
     };
 
     g_array_set_clear_func(self->rules, _share_rule_clear);
     return self;
 }
 
+static void
+_share_rules_unref(NMUtilsShareRules *self)
+{
+    nm_assert(self->ref_count > 0);
+
+    if (--self->ref_count > 0)
+        return;
+
+    g_array_unref(self->rules);
+    g_free(self->nft_table);
+    g_free(self->nft_script);
+    nm_g_slice_free(self);
+}
+
 void
 nm_utils_share_rules_free(NMUtilsShareRules *self)
 {
     if (!self)
         return;
 
-    g_array_unref(self->rules);
-    nm_g_slice_free(self);
+    /* an nft process in flight keeps the rules alive until it completes. */
+    _share_rules_unref(self);
+}
+
+gboolean
+_nmtst_utils_share_rules_is_busy(NMUtilsShareRules *self)
+{
+    return self->nft_busy;
 }
 
 void
@@ -1690,12 +1734,46 @@ nm_utils_share_rules_add_rule_take(NMUtilsShareRules *self, const char *table, c
     };
 }
 
-void
-nm_utils_share_rules_apply(NMUtilsShareRules *self, gboolean shared)
+static gboolean
+_share_rules_check_status(const char *cmd, int status)
 {
-    guint i;
+    if (WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS)
+        return TRUE;
 
-    g_return_if_fail(self);
+    if (WIFEXITED(status))
+        nm_log_warn(LOGD_SHARING, "** Command returned exit status %d.", WEXITSTATUS(status));
+    else
+        nm_log_warn(LOGD_SHARING, "** Command \"%s\" exited abnormally (%d).", cmd, status);
+    return FALSE;
+}
+
+static gboolean
+_share_rules_spawn(const char *const *argv, const char *cmd)
+{
+    gs_free_error GError *error = NULL;
+    int                   status;
+
+    nm_log_info(LOGD_SHARING, "Executing: %s", cmd);
+    if (!g_spawn_sync("/",
+                      (char **) argv,
+                      (char **) NM_PTRARRAY_EMPTY(const char *),
+                      G_SPAWN_STDOUT_TO_DEV_NULL | G_SPAWN_STDERR_TO_DEV_NULL,
+                      NULL,
+                      NULL,
+                      NULL,
+                      NULL,
+                      &status,
+                      &error)) {
+        nm_log_warn(LOGD_SHARING, "Error executing command: %s", error->message);
+        return FALSE;
+    }
+    return _share_rules_check_status(cmd, status);
+}
+
+static void
+_share_rules_apply_iptables(NMUtilsShareRules *self, gboolean shared)
+{
+    guint i;
 
     if (self->rules->len == 0)
         return;
@@ -1708,11 +1786,9 @@ nm_utils_share_rules_apply(NMUtilsShareRules *self, gboolean shared)
         i = 0;
 
     for (;;) {
-        gs_free_error GError *error = NULL;
         ShareRule *           rule;
         gs_free const char ** argv = NULL;
         gs_free char *        cmd  = NULL;
-        int                   status;
 
         rule = &g_array_index(self->rules, ShareRule, i);
 
@@ -1723,25 +1799,8 @@ nm_utils_share_rules_apply(NMUtilsShareRules *self, gboolean shared)
                               rule->rule);
         argv = nm_utils_strsplit_set(cmd, " ");
 
-        nm_log_info(LOGD_SHARING, "Executing: %s", cmd);
-        if (!g_spawn_sync("/",
-                          (char **) argv,
-                          (char **) NM_PTRARRAY_EMPTY(const char *),
-                          G_SPAWN_STDOUT_TO_DEV_NULL | G_SPAWN_STDERR_TO_DEV_NULL,
-                          NULL,
-                          NULL,
-                          NULL,
-                          NULL,
-                          &status,
-                          &error)) {
-            nm_log_warn(LOGD_SHARING, "Error executing command: %s", error->message);
-            goto next;
-        }
-        if (WEXITSTATUS(status)) {
-            nm_log_warn(LOGD_SHARING, "** Command returned exit status %d.", WEXITSTATUS(status));
-        }
+        _share_rules_spawn(argv, cmd);
 
-next:
         if (shared) {
             if (i == 0)
                 break;
@@ -1754,8 +1813,227 @@ next:
     }
 }
 
+static void _share_rules_nft_sync(NMUtilsShareRules *self);
+
+static void
+_share_rules_nft_watch_cb(GPid pid, int status, gpointer user_data)
+{
+    NMUtilsShareRules *self = user_data;
+    gs_free char *     cmd  = NULL;
+    gboolean           added;
+
+    g_spawn_close_pid(pid);
+
+    nm_assert(self->nft_busy);
+
+    added          = self->nft_busy_add;
+    self->nft_busy = FALSE;
+
+    cmd = g_strdup_printf("%s (%s table %s)", NFT_PATH, added ? "add" : "delete", self->nft_table);
+    if (_share_rules_check_status(cmd, status))
+        self->nft_added = added;
+    else if (added) {
+        /* The transaction failed as a whole, so nothing was added. Maybe the
+         * kernel lacks nf_tables support. Try iptables instead, and remember
+         * to remove the iptables rules later. */
+        nm_log_warn(LOGD_SHARING, "share: failed to add nftables rules, use iptables");
+        self->use_nft = FALSE;
+        if (self->nft_shared)
+            _share_rules_apply_iptables(self, TRUE);
+    }
+
+    /* meanwhile, the rules might have been requested to be removed. */
+    _share_rules_nft_sync(self);
+
+    _share_rules_unref(self);
+}
+
+static gboolean
+_share_rules_nft_spawn(NMUtilsShareRules *self, gboolean shared)
+{
+    gs_free_error GError *error  = NULL;
+    gs_free char *        script = NULL;
+    gs_free char *        cmd    = NULL;
+    const char *          argv[3];
+    GPid                  pid;
+
+    nm_assert(!self->nft_busy);
+
+    if (shared)
+        script = g_strdup(self->nft_script);
+    else
+        script = g_strdup_printf("delete table ip %s", self->nft_table);
+
+    /* nft parses all its arguments as one input, and submits the commands
+     * as one transaction to the kernel. */
+    argv[0] = NFT_PATH;
+    argv[1] = script;
+    argv[2] = NULL;
+
+    cmd = g_strdup_printf("%s '%s'", NFT_PATH, script);
+    nm_log_info(LOGD_SHARING, "Executing: %s", cmd);
+
+    /* Don't wait for nft on the main loop. The outcome is handled when it
+     * exits. */
+    if (!g_spawn_async("/",
+                       (char **) argv,
+                       (char **) NM_PTRARRAY_EMPTY(const char *),
+                       G_SPAWN_DO_NOT_REAP_CHILD | G_SPAWN_STDOUT_TO_DEV_NULL
+                           | G_SPAWN_STDERR_TO_DEV_NULL,
+                       NULL,
+                       NULL,
+                       &pid,
+                       &error)) {
+        nm_log_warn(LOGD_SHARING, "Error executing command: %s", error->message);
+        return FALSE;
+    }
+
+    self->nft_busy     = TRUE;
+    self->nft_busy_add = shared;
+    self->ref_count++;
+    g_child_watch_add(pid, _share_rules_nft_watch_cb, self);
+    return TRUE;
+}
+
+static void
+_share_rules_nft_sync(NMUtilsShareRules *self)
+{
+    if (!self->use_nft || self->nft_busy || self->nft_shared == self->nft_added)
+        return;
+
+    if (_share_rules_nft_spawn(self, self->nft_shared))
+        return;
+
+    if (self->nft_shared) {
+        nm_log_warn(LOGD_SHARING, "share: failed to add nftables rules, use iptables");
+        self->use_nft = FALSE;
+        _share_rules_apply_iptables(self, TRUE);
+    }
+}
+
+void
+nm_utils_share_rules_apply(NMUtilsShareRules *self, gboolean shared)
+{
+    g_return_if_fail(self);
+
+    if (self->use_nft) {
+        if (self->nft_script) {
+            self->nft_shared = shared;
+            _share_rules_nft_sync(self);
+        }
+        return;
+    }
+
+    _share_rules_apply_iptables(self, shared);
+}
+
+static gboolean
+_share_rules_add_all_nft(NMUtilsShareRules *self,
+                         int                ifindex,
+                         const char *       ip_iface,
+                         const char *       str_network,
+                         guint              plen)
+{
+    GString *   script;
+    const char *t;
+    char *      s;
+
+    nm_assert(!self->nft_table);
+
+    /* The interface name is passed to nft as quoted string. Don't bother
+     * escaping the odd interface name that needs it. */
+    if (strpbrk(ip_iface, "\"\\")) {
+        nm_log_warn(LOGD_SHARING,
+                    "share: cannot express interface name \"%s\" for nftables, use iptables",
+                    ip_iface);
+        return FALSE;
+    }
+
+    /* The table name contains the ifindex, so that it is unique even if an
+     * interface name gets reused, or two names map to the same identifier
+     * below. The interface name is only there to help a human reader, but nft
+     * is picky about identifiers. */
+    self->nft_table = g_strdup_printf("nm-shared-%d-%s", ifindex, ip_iface);
+    for (s = &self->nft_table[NM_STRLEN("nm-shared-")]; *s; s++) {
+        if (!g_ascii_isalnum(*s) && !NM_IN_SET(*s, '_', '-', '.'))
+            *s = '_';
+    }
+
+    t      = self->nft_table;
+    script = g_string_sized_new(1024);
+
+    /* Start from a clean table, in case it was left over earlier. */
+    g_string_append_printf(script, "add table ip %s\n", t);
+    g_string_append_printf(script, "flush table ip %s\n", t);
+
+    g_string_append_printf(
+        script,
+        "add chain ip %s nat_postrouting { type nat hook postrouting priority 100; policy "
+        "accept; }\n",
+        t);
+    g_string_append_printf(script,
+                           "add rule ip %s nat_postrouting ip saddr %s/%u ip daddr != %s/%u "
+                           "masquerade\n",
+                           t,
+                           str_network,
+                           plen,
+                           str_network,
+                           plen);
+
+    g_string_append_printf(
+        script,
+        "add chain ip %s filter_input { type filter hook input priority 0; policy accept; }\n",
+        t);
+    g_string_append_printf(script,
+                           "add rule ip %s filter_input iifname \"%s\" udp dport { 53, 67 } "
+                           "accept\n",
+                           t,
+                           ip_iface);
+    g_string_append_printf(script,
+                           "add rule ip %s filter_input iifname \"%s\" tcp dport { 53, 67 } "
+                           "accept\n",
+                           t,
+                           ip_iface);
+
+    g_string_append_printf(
+        script,
+        "add chain ip %s filter_forward { type filter hook forward priority 0; policy accept; "
+        "}\n",
+        t);
+    g_string_append_printf(script,
+                           "add rule ip %s filter_forward ip daddr %s/%u oifname \"%s\" ct state "
+                           "{ established, related } accept\n",
+                           t,
+                           str_network,
+                           plen,
+                           ip_iface);
+    g_string_append_printf(script,
+                           "add rule ip %s filter_forward ip saddr %s/%u iifname \"%s\" accept\n",
+                           t,
+                           str_network,
+                           plen,
+                           ip_iface);
+    g_string_append_printf(script,
+                           "add rule ip %s filter_forward iifname \"%s\" oifname \"%s\" accept\n",
+                           t,
+                           ip_iface,
+                           ip_iface);
+    g_string_append_printf(script,
+                           "add rule ip %s filter_forward oifname \"%s\" reject\n",
+                           t,
+                           ip_iface);
+    g_string_append_printf(script,
+                           "add rule ip %s filter_forward iifname \"%s\" reject",
+                           t,
+                           ip_iface);
+
+    self->nft_script = g_string_free(script, FALSE);
+    return TRUE;
+}
+
 void
 nm_utils_share_rules_add_all_rules(NMUtilsShareRules *self,
+                                   int                ifindex,
                                    const char *       ip_iface,
                                    in_addr_t          addr,
                                    guint              plen)
@@ -1773,6 +2051,9 @@ nm_utils_share_rules_add_all_rules(NMUtilsShareRules *self,
     network = addr & netmask;
     _nm_utils_inet4_ntop(network, str_addr);
 
+    if (self->use_nft && !_share_rules_add_all_nft(self, ifindex, ip_iface, str_addr, plen))
+        self->use_nft = FALSE;
+
     nm_utils_share_rules_add_rule_v(
         self,
         "nat",
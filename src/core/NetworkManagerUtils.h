@@ -226,7 +226,7 @@ NM_AUTO_DEFINE_FCN(NMDhcpLease *, _nm_auto_unref_dhcplease, nm_dhcp_lease_unref)
 
 typedef struct _NMUtilsShareRules NMUtilsShareRules;
 
-NMUtilsShareRules *nm_utils_share_rules_new(void);
+NMUtilsShareRules *nm_utils_share_rules_new(gboolean use_nft);
 
 void nm_utils_share_rules_free(NMUtilsShareRules *self);
 
@@ -243,12 +243,15 @@ nm_utils_share_rules_add_rule(NMUtilsShareRules *self, const char *table, const
     nm_utils_share_rules_add_rule_take((self), (table), g_strdup_printf(__VA_ARGS__))
 
 void nm_utils_share_rules_add_all_rules(NMUtilsShareRules *self,
+                                        int                ifindex,
                                         const char *       ip_iface,
                                         in_addr_t          addr,
                                         guint              plen);
 
 void nm_utils_share_rules_apply(NMUtilsShareRules *self, gboolean shared);
 
+gboolean _nmtst_utils_share_rules_is_busy(NMUtilsShareRules *self);
+
 /*****************************************************************************/
 
 #endif /* __NETWORKMANAGER_UTILS_H__ */
@@ -135,6 +135,7 @@ typedef struct {
     gpointer                callback_data;
     guint                   num_vfs;
     NMOptionBool            autoprobe;
+    NMPlatformVF **         vfs;
 } SriovOp;
 
 typedef void (*AcdCallback)(NMDevice *, NMIP4Config **, gboolean);
@@ -674,9 +675,16 @@ typedef struct _NMDevicePrivate {
          * p_cur_interval. */
         gint64 p_cur_basetime_ns;
 
+        /* with passive checking, the platform state when the last check returned
+         * full connectivity. */
+        NMConnectivityPassive p_passive;
+
         NMConnectivityState state;
     } concheck_x[2];
 
+    /* the IP ifindex whose neighbours we subscribed to for passive checking. */
+    int concheck_passive_neigh_ifindex;
+
     guint   check_delete_unrealized_id;
     guint32 interface_flags;
 
@@ -3999,13 +4007,45 @@ concheck_is_possible(NMDevice *self)
     return TRUE;
 }
 
+#define CONCHECK_P_PROBE_INTERVAL 1
+
+#define CONCHECK_P_JITTER_MAX_MSEC 30000u
+
+/* With passive checking, the neighbour entry of the gateway tells whether the
+ * kernel still reaches it. Stay subscribed to the neighbours of the IP interface
+ * as long as we trust the result of a previous check. */
+static void
+concheck_passive_neigh_sync(NMDevice *self)
+{
+    NMDevicePrivate *priv     = NM_DEVICE_GET_PRIVATE(self);
+    NMPlatform *     platform = nm_device_get_platform(self);
+    int              ifindex  = 0;
+
+    if (priv->concheck_x[0].p_passive.fingerprint != 0
+        || priv->concheck_x[1].p_passive.fingerprint != 0)
+        ifindex = NM_MAX(nm_device_get_ip_ifindex(self), 0);
+
+    if (ifindex == priv->concheck_passive_neigh_ifindex)
+        return;
+
+    if (priv->concheck_passive_neigh_ifindex > 0) {
+        nm_platform_neighbor_unsubscribe(platform,
+                                         NMP_OBJECT_TYPE_NEIGHBOR,
+                                         priv->concheck_passive_neigh_ifindex);
+    }
+    priv->concheck_passive_neigh_ifindex = ifindex;
+    if (ifindex > 0)
+        nm_platform_neighbor_subscribe(platform, NMP_OBJECT_TYPE_NEIGHBOR, ifindex);
+}
+
 static gboolean
 concheck_periodic_schedule_do(NMDevice *self, int addr_family, gint64 now_ns)
 {
     NMDevicePrivate *priv                    = NM_DEVICE_GET_PRIVATE(self);
     gboolean         periodic_check_disabled = FALSE;
     gint64           expiry, tdiff;
-    const int        IS_IPv4 = NM_IS_IPv4(addr_family);
+    guint            jitter_msec = 0;
+    const int        IS_IPv4     = NM_IS_IPv4(addr_family);
 
     /* we always cancel whatever was pending. */
     if (nm_clear_g_source(&priv->concheck_x[IS_IPv4].p_cur_id))
@@ -4030,16 +4070,29 @@ concheck_periodic_schedule_do(NMDevice *self, int addr_family, gint64 now_ns)
              + (priv->concheck_x[IS_IPv4].p_cur_interval * NM_UTILS_NSEC_PER_SEC);
     tdiff = expiry - now_ns;
 
+    if (priv->concheck_x[IS_IPv4].p_cur_interval > CONCHECK_P_PROBE_INTERVAL
+        && priv->concheck_x[IS_IPv4].p_cur_interval == priv->concheck_x[IS_IPv4].p_max_interval) {
+        /* In the steady state, all devices would check at the same intervals and
+         * (after startup) at the same time. Delay the timer by a random amount, so
+         * that their requests are spread out. This does not change cur-basetime, so
+         * the delay does not add up over time. */
+        jitter_msec = g_random_int_range(
+            0,
+            NM_MIN(priv->concheck_x[IS_IPv4].p_cur_interval * (1000 / 10),
+                   CONCHECK_P_JITTER_MAX_MSEC));
+    }
+
     _LOGT(LOGD_CONCHECK,
           "connectivity: [IPv%c] periodic-check: %sscheduled in %lld milliseconds (%u seconds "
-          "interval)",
+          "interval, %u milliseconds jitter)",
           nm_utils_addr_family_to_char(addr_family),
           periodic_check_disabled ? "re-" : "",
-          (long long) (tdiff / NM_UTILS_NSEC_PER_MSEC),
-          priv->concheck_x[IS_IPv4].p_cur_interval);
+          (long long) (tdiff / NM_UTILS_NSEC_PER_MSEC) + jitter_msec,
+          priv->concheck_x[IS_IPv4].p_cur_interval,
+          jitter_msec);
 
     priv->concheck_x[IS_IPv4].p_cur_id =
-        g_timeout_add(NM_MAX((gint64) 0, tdiff) / NM_UTILS_NSEC_PER_MSEC,
+        g_timeout_add((NM_MAX((gint64) 0, tdiff) / NM_UTILS_NSEC_PER_MSEC) + jitter_msec,
                       IS_IPv4 ? concheck_ip4_periodic_timeout_cb : concheck_ip6_periodic_timeout_cb,
                       self);
     return TRUE;
@@ -4049,10 +4102,82 @@ out:
               "connectivity: [IPv%c] periodic-check: unscheduled",
               nm_utils_addr_family_to_char(addr_family));
     }
+    if (priv->concheck_x[IS_IPv4].p_passive.fingerprint != 0) {
+        priv->concheck_x[IS_IPv4].p_passive.fingerprint = 0;
+        concheck_passive_neigh_sync(self);
+    }
     return FALSE;
 }
 
-#define CONCHECK_P_PROBE_INTERVAL 1
+static guint64
+concheck_passive_fingerprint(NMDevice *self, int addr_family, gboolean *out_gateway_confirmed)
+{
+    return nm_connectivity_passive_fingerprint(nm_device_get_platform(self),
+                                               nm_device_get_ip_ifindex(self),
+                                               addr_family,
+                                               out_gateway_confirmed);
+}
+
+static void
+concheck_passive_update(NMDevice *self, int addr_family, NMConnectivityState state)
+{
+    NMDevicePrivate *      priv    = NM_DEVICE_GET_PRIVATE(self);
+    const int              IS_IPv4 = NM_IS_IPv4(addr_family);
+    NMConnectivityPassive *passive = &priv->concheck_x[IS_IPv4].p_passive;
+
+    *passive = (NMConnectivityPassive){};
+    if (state == NM_CONNECTIVITY_FULL && nm_connectivity_get_passive(concheck_get_mgr(self))) {
+        passive->fingerprint = concheck_passive_fingerprint(self, addr_family, NULL);
+        passive->ts_msec     = nm_utils_get_monotonic_timestamp_msec();
+    }
+    concheck_passive_neigh_sync(self);
+}
+
+static gboolean
+concheck_passive_skip(NMDevice *self, int addr_family)
+{
+    NMDevicePrivate *priv    = NM_DEVICE_GET_PRIVATE(self);
+    const int        IS_IPv4 = NM_IS_IPv4(addr_family);
+    gboolean         gateway_confirmed;
+    guint64          fingerprint;
+
+    /* With passive checking, we trust the result of the last check as long as the
+     * kernel tells us that nothing changed on the interface. Only when the
+     * state is ambiguous (the last check did not give full connectivity, or carrier,
+     * addresses or default routes changed, or the gateway stopped answering), we
+     * send a request. */
+    if (!nm_connectivity_get_passive(concheck_get_mgr(self)))
+        return FALSE;
+
+    if (priv->concheck_x[IS_IPv4].state != NM_CONNECTIVITY_FULL)
+        return FALSE;
+
+    fingerprint = concheck_passive_fingerprint(self, addr_family, &gateway_confirmed);
+
+    switch (nm_connectivity_passive_check(&priv->concheck_x[IS_IPv4].p_passive,
+                                          fingerprint,
+                                          gateway_confirmed,
+                                          nm_utils_get_monotonic_timestamp_msec())) {
+    case NM_CONNECTIVITY_PASSIVE_CHECK:
+        return FALSE;
+    case NM_CONNECTIVITY_PASSIVE_CHECK_CHANGED:
+        _LOGT(LOGD_CONCHECK,
+              "connectivity: [IPv%c] periodic-check: platform state changed, check now",
+              nm_utils_addr_family_to_char(addr_family));
+        return FALSE;
+    case NM_CONNECTIVITY_PASSIVE_SKIP_CONFIRMED:
+        _LOGT(LOGD_CONCHECK,
+              "connectivity: [IPv%c] periodic-check: skipped (passive, gateway reachable)",
+              nm_utils_addr_family_to_char(addr_family));
+        return TRUE;
+    case NM_CONNECTIVITY_PASSIVE_SKIP:
+        _LOGT(LOGD_CONCHECK,
+              "connectivity: [IPv%c] periodic-check: skipped (passive, platform state unchanged)",
+              nm_utils_addr_family_to_char(addr_family));
+        return TRUE;
+    }
+    return nm_assert_unreachable_val(FALSE);
+}
 
 static void
 concheck_periodic_schedule_set(NMDevice *self, int addr_family, ConcheckScheduleMode mode)
@@ -4172,6 +4297,8 @@ concheck_periodic_schedule_set(NMDevice *self, int addr_family, ConcheckSchedule
         priv->concheck_x[IS_IPv4].p_cur_basetime_ns =
             (now_ns + tdiff) - (priv->concheck_x[IS_IPv4].p_cur_interval * NM_UTILS_NSEC_PER_SEC);
         if (concheck_periodic_schedule_do(self, addr_family, now_ns)) {
+            if (concheck_passive_skip(self, addr_family))
+                return;
             handle = concheck_start(self, addr_family, NULL, NULL, TRUE);
             if (old_interval != priv->concheck_x[IS_IPv4].p_cur_interval) {
                 /* we just bumped the interval already when scheduling this check.
@@ -4215,6 +4342,58 @@ concheck_periodic_schedule_set(NMDevice *self, int addr_family, ConcheckSchedule
     concheck_periodic_schedule_do(self, addr_family, now_ns);
 }
 
+/* Called when the carrier, the addresses, the routes or the neighbours of the device changed.
+ * With passive checking, a change of the platform state means that the last
+ * result can no longer be trusted. Check right away instead of waiting for the
+ * next periodic check. */
+static void
+concheck_passive_platform_changed(NMDevice *self, int addr_family)
+{
+    NMDevicePrivate *priv    = NM_DEVICE_GET_PRIVATE(self);
+    const int        IS_IPv4 = NM_IS_IPv4(addr_family);
+
+    if (priv->concheck_x[IS_IPv4].p_passive.fingerprint == 0)
+        return;
+
+    if (!priv->concheck_x[IS_IPv4].p_cur_id || !concheck_is_possible(self)
+        || !nm_connectivity_get_passive(concheck_get_mgr(self)))
+        return;
+
+    if (concheck_passive_fingerprint(self, addr_family, NULL)
+        == priv->concheck_x[IS_IPv4].p_passive.fingerprint)
+        return;
+
+    _LOGT(LOGD_CONCHECK,
+          "connectivity: [IPv%c] passive: platform state changed, check now",
+          nm_utils_addr_family_to_char(addr_family));
+
+    /* until the result is there, don't trigger again. Stay subscribed to the
+     * neighbours, so that the next fingerprint still sees a failed gateway. */
+    priv->concheck_x[IS_IPv4].p_passive.fingerprint = 0;
+
+    concheck_periodic_schedule_set(self, addr_family, CONCHECK_SCHEDULE_CHECK_EXTERNAL);
+    concheck_start(self, addr_family, NULL, NULL, FALSE);
+}
+
+static void
+concheck_passive_neighbor_changed_cb(NMPlatform *              platform,
+                                     int                       obj_type_i,
+                                     int                       ifindex,
+                                     const NMPlatformNeighbor *neighbor,
+                                     int                       change_type_i,
+                                     NMDevice *                self)
+{
+    NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE(self);
+
+    if (ifindex <= 0 || ifindex != priv->concheck_passive_neigh_ifindex)
+        return;
+
+    if (!NM_IN_SET(neighbor->addr_family, AF_INET, AF_INET6))
+        return;
+
+    concheck_passive_platform_changed(self, neighbor->addr_family);
+}
+
 static void
 concheck_update_interval(NMDevice *self, int addr_family, gboolean check_now)
 {
@@ -4473,6 +4652,8 @@ concheck_cb(NMConnectivity *           connectivity,
         allow_periodic_bump = handle->is_periodic_bump_on_complete || any_periodic_before;
     }
 
+    concheck_passive_update(self, handle->addr_family, state);
+
     /* first update the new state, and emit signals. */
     concheck_update_state(self, handle->addr_family, state, allow_periodic_bump);
 
@@ -5457,6 +5638,9 @@ device_link_changed(NMDevice *self)
                                           NM_DEVICE_STATE_REASON_NONE);
     }
 
+    concheck_passive_platform_changed(self, AF_INET);
+    concheck_passive_platform_changed(self, AF_INET6);
+
     return G_SOURCE_REMOVE;
 }
 
@@ -5777,6 +5961,44 @@ nm_device_update_from_platform_link(NMDevice *self, const NMPlatformLink *plink)
 
 /*****************************************************************************/
 
+static void
+sriov_op_free(SriovOp *op)
+{
+    nm_auto_freev NMPlatformVF **vfs = g_steal_pointer(&op->vfs);
+
+    nm_g_slice_free(op);
+}
+
+static void
+sriov_op_params_cb(GError *error, gpointer user_data)
+{
+    SriovOp *        op   = user_data;
+    NMDevice *       self = op->device;
+    NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE(self);
+
+    if (error) {
+        sriov_op_cb(error, op);
+        return;
+    }
+
+    if (g_cancellable_is_cancelled(op->cancellable)) {
+        gs_free_error GError *error_cancelled = NULL;
+
+        nm_utils_error_set_cancelled(&error_cancelled, FALSE, NULL);
+        sriov_op_cb(error_cancelled, op);
+        return;
+    }
+
+    /* The VFs now exist. Configure them on the same operation, so that
+     * a newer request still cancels us and they don't race with it. */
+    nm_platform_link_set_sriov_vfs_async(nm_device_get_platform(self),
+                                         priv->ifindex,
+                                         (const NMPlatformVF *const *) op->vfs,
+                                         sriov_op_cb,
+                                         op,
+                                         op->cancellable);
+}
+
 static void
 sriov_op_start(NMDevice *self, SriovOp *op)
 {
@@ -5792,7 +6014,7 @@ sriov_op_start(NMDevice *self, SriovOp *op)
                                             priv->ifindex,
                                             op->num_vfs,
                                             op->autoprobe,
-                                            sriov_op_cb,
+                                            op->vfs ? sriov_op_params_cb : sriov_op_cb,
                                             op,
                                             op->cancellable);
 }
@@ -5812,7 +6034,7 @@ sriov_op_cb(GError *error, gpointer user_data)
         op->callback(error, op->callback_data);
 
     priv->sriov.pending = NULL;
-    nm_g_slice_free(op);
+    sriov_op_free(op);
 
     if (priv->sriov.next) {
         sriov_op_start(self, g_steal_pointer(&priv->sriov.next));
@@ -5837,7 +6059,7 @@ sriov_op_queue_op(NMDevice *self, SriovOp *op)
             op_next->callback(error, op_next->callback_data);
         }
 
-        nm_g_slice_free(op_next);
+        sriov_op_free(op_next);
         return;
     }
 
@@ -5855,6 +6077,7 @@ static void
 sriov_op_queue(NMDevice *              self,
                guint                   num_vfs,
                NMOptionBool            autoprobe,
+               NMPlatformVF **         vfs,
                NMPlatformAsyncCallback callback,
                gpointer                callback_data)
 {
@@ -5883,6 +6106,7 @@ sriov_op_queue(NMDevice *              self,
     *op = (SriovOp){
         .num_vfs       = num_vfs,
         .autoprobe     = autoprobe,
+        .vfs           = vfs,
         .callback      = callback,
         .callback_data = callback_data,
     };
@@ -5903,7 +6127,7 @@ device_init_static_sriov_num_vfs(NMDevice *self)
                                                  NULL);
         num_vfs = _nm_utils_ascii_str_to_int64(value, 10, 0, G_MAXINT32, -1);
         if (num_vfs >= 0)
-            sriov_op_queue(self, num_vfs, NM_OPTION_BOOL_DEFAULT, NULL, NULL);
+            sriov_op_queue(self, num_vfs, NM_OPTION_BOOL_DEFAULT, NULL, NULL, NULL);
     }
 }
 
@@ -8010,11 +8234,8 @@ sriov_vf_config_to_platform(NMDevice *self, NMSriovVF *vf, GError **error)
 static void
 sriov_params_cb(GError *error, gpointer user_data)
 {
-    NMDevice *       self;
+    NMDevice *       self = user_data;
     NMDevicePrivate *priv;
-    nm_auto_freev NMPlatformVF **plat_vfs = NULL;
-
-    nm_utils_user_data_unpack(user_data, &self, &plat_vfs);
 
     if (nm_utils_error_is_cancelled_or_disposing(error))
         return;
@@ -8022,17 +8243,7 @@ sriov_params_cb(GError *error, gpointer user_data)
     priv = NM_DEVICE_GET_PRIVATE(self);
 
     if (error) {
-        _LOGE(LOGD_DEVICE, "failed to set SR-IOV parameters: %s", error->message);
-        nm_device_state_changed(self,
-                                NM_DEVICE_STATE_FAILED,
-                                NM_DEVICE_STATE_REASON_SRIOV_CONFIGURATION_FAILED);
-        return;
-    }
-
-    if (!nm_platform_link_set_sriov_vfs(nm_device_get_platform(self),
-                                        priv->ifindex,
-                                        (const NMPlatformVF *const *) plat_vfs)) {
-        _LOGE(LOGD_DEVICE, "failed to apply SR-IOV VFs");
+        _LOGE(LOGD_DEVICE, "failed to apply SR-IOV configuration: %s", error->message);
         nm_device_state_changed(self,
                                 NM_DEVICE_STATE_FAILED,
                                 NM_DEVICE_STATE_REASON_SRIOV_CONFIGURATION_FAILED);
@@ -8122,8 +8333,9 @@ activate_stage1_device_prepare(NMDevice *self)
             sriov_op_queue(self,
                            nm_setting_sriov_get_total_vfs(s_sriov),
                            NM_TERNARY_TO_OPTION_BOOL(autoprobe),
+                           g_steal_pointer(&plat_vfs),
                            sriov_params_cb,
-                           nm_utils_user_data_pack(self, g_steal_pointer(&plat_vfs)));
+                           self);
             priv->stage1_sriov_state = NM_DEVICE_STAGE_STATE_PENDING;
             return;
         }
@@ -11580,6 +11792,31 @@ nm_device_activate_schedule_ip_config_timeout(NMDevice *self, int addr_family)
                                addr_family);
 }
 
+static gboolean
+share_use_nft(NMDevice *self)
+{
+    gs_free char *backend = NULL;
+
+    backend = nm_config_data_get_value(NM_CONFIG_GET_DATA,
+                                       NM_CONFIG_KEYFILE_GROUP_MAIN,
+                                       NM_CONFIG_KEYFILE_KEY_MAIN_FIREWALL_BACKEND,
+                                       NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY);
+    if (!backend || nm_streq(backend, "iptables"))
+        return FALSE;
+
+    if (!nm_streq(backend, "nftables")) {
+        _LOGW(LOGD_SHARING, "share: unknown firewall-backend \"%s\", use iptables", backend);
+        return FALSE;
+    }
+
+    if (!g_file_test(NFT_PATH, G_FILE_TEST_IS_EXECUTABLE)) {
+        _LOGW(LOGD_SHARING, "share: cannot find nft at \"%s\", use iptables", NFT_PATH);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
 static gboolean
 share_init(NMDevice *self, GError **error)
 {
@@ -11672,9 +11909,13 @@ start_sharing(NMDevice *self, NMIP4Config *config, GError **error)
     req = nm_device_get_act_request(self);
     g_return_val_if_fail(req, FALSE);
 
-    share_rules = nm_utils_share_rules_new();
+    share_rules = nm_utils_share_rules_new(share_use_nft(self));
 
-    nm_utils_share_rules_add_all_rules(share_rules, ip_iface, ip4_addr->address, ip4_addr->plen);
+    nm_utils_share_rules_add_all_rules(share_rules,
+                                       nm_device_get_ip_ifindex(self),
+                                       ip_iface,
+                                       ip4_addr->address,
+                                       ip4_addr->plen);
 
     nm_utils_share_rules_apply(share_rules, TRUE);
 
@@ -14393,6 +14634,8 @@ queued_ip_config_change(NMDevice *self, int addr_family)
 
     update_ip_config(self, addr_family);
 
+    concheck_passive_platform_changed(self, addr_family);
+
     if (!IS_IPv4) {
         /* Check whether we need to complete waiting for link-local.
          * We are also called from an idle handler, so no problem doing state transitions
@@ -16569,6 +16812,7 @@ _set_state_full(NMDevice *self, NMDeviceState state, NMDeviceStateReason reason,
                 sriov_op_queue(self,
                                0,
                                NM_OPTION_BOOL_TRUE,
+                               NULL,
                                sriov_reset_on_deactivate_cb,
                                nm_utils_user_data_pack(self, GINT_TO_POINTER(reason)));
             }
@@ -16620,7 +16864,7 @@ _set_state_full(NMDevice *self, NMDeviceState state, NMDeviceStateReason reason,
         if (priv->ifindex > 0
             && (s_sriov = nm_device_get_applied_setting(self, NM_TYPE_SETTING_SRIOV))) {
             priv->sriov_reset_pending++;
-            sriov_op_queue(self, 0, NM_OPTION_BOOL_TRUE, sriov_reset_on_failure_cb, self);
+            sriov_op_queue(self, 0, NM_OPTION_BOOL_TRUE, NULL, sriov_reset_on_failure_cb, self);
             break;
         }
         /* Schedule the transition to DISCONNECTED.  The device can't transition
@@ -18258,6 +18502,10 @@ constructed(GObject *object)
                      G_CALLBACK(device_ipx_changed),
                      self);
     g_signal_connect(platform, NM_PLATFORM_SIGNAL_LINK_CHANGED, G_CALLBACK(link_changed_cb), self);
+    g_signal_connect(platform,
+                     NM_PLATFORM_SIGNAL_NEIGHBOR_CHANGED,
+                     G_CALLBACK(concheck_passive_neighbor_changed_cb),
+                     self);
 
     priv->manager  = g_object_ref(NM_MANAGER_GET);
     priv->settings = g_object_ref(NM_SETTINGS_GET);
@@ -18310,6 +18558,9 @@ dispose(GObject *object)
     platform = nm_device_get_platform(self);
     g_signal_handlers_disconnect_by_func(platform, G_CALLBACK(device_ipx_changed), self);
     g_signal_handlers_disconnect_by_func(platform, G_CALLBACK(link_changed_cb), self);
+    g_signal_handlers_disconnect_by_func(platform,
+                                         G_CALLBACK(concheck_passive_neighbor_changed_cb),
+                                         self);
 
     arp_cleanup(self);
 
@@ -18371,11 +18622,13 @@ dispose(GObject *object)
 
     nm_clear_g_source(&priv->concheck_x[0].p_cur_id);
     nm_clear_g_source(&priv->concheck_x[1].p_cur_id);
+    priv->concheck_x[0].p_passive.fingerprint = 0;
+    priv->concheck_x[1].p_passive.fingerprint = 0;
+    concheck_passive_neigh_sync(self);
 
     nm_assert(!priv->sriov.pending);
     if (priv->sriov.next) {
-        nm_g_slice_free(priv->sriov.next);
-        priv->sriov.next = NULL;
+        sriov_op_free(g_steal_pointer(&priv->sriov.next));
     }
 
     G_OBJECT_CLASS(nm_device_parent_class)->dispose(object);
@@ -22,6 +22,10 @@
 
 #define OVSDB_MAX_FAILURES 3
 
+/* The maximum number of queued calls that are merged into a single
+ * "transact" request. */
+#define OVSDB_MAX_BATCH 64
+
 /*****************************************************************************/
 
 #if JANSSON_VERSION_HEX < 0x020400
@@ -49,6 +53,7 @@ typedef struct {
     char *  name;
     char *  type;
     char *  connection_uuid;
+    char *  error;
     GArray *external_ids;
 } OpenvswitchInterface;
 
@@ -69,6 +74,8 @@ typedef enum {
 
 #define CALL_ID_UNSPEC G_MAXUINT64
 
+#define TXN_ID_NONE "00000000-0000-0000-0000-000000000000"
+
 typedef union {
     struct {
     } monitor;
@@ -103,6 +110,7 @@ typedef struct {
     OvsdbMethodCallback callback;
     gpointer            user_data;
     OvsdbMethodPayload  payload;
+    bool                no_batch : 1;
 } OvsdbMethodCall;
 
 /*****************************************************************************/
@@ -133,9 +141,11 @@ typedef struct {
     GHashTable *ports;      /* port uuid => OpenvswitchPort */
     GHashTable *bridges;    /* bridge uuid => OpenvswitchBridge */
     char *      db_uuid;
+    char *      last_txn_id; /* for resuming the monitor after reconnect */
     guint       num_failures;
     guint       num_pending_deletions;
     bool        ready : 1;
+    bool        monitor_cond_since_unsupported : 1;
 } NMOvsdbPrivate;
 
 struct _NMOvsdb {
@@ -321,6 +331,7 @@ _free_interface(OpenvswitchInterface *ovs_interface)
     g_free(ovs_interface->name);
     g_free(ovs_interface->connection_uuid);
     g_free(ovs_interface->type);
+    g_free(ovs_interface->error);
     nm_g_array_unref(ovs_interface->external_ids);
     nm_g_slice_free(ovs_interface);
 }
@@ -360,7 +371,7 @@ _signal_emit_interface_failed(NMOvsdb *   self,
  * ovsdb_call_method:
  *
  * Queues the ovsdb command. Eventually fires the command right away if
- * there's no command pending completion.
+ * it doesn't have to wait for the completion of pending commands.
  */
 static void
 ovsdb_call_method(NMOvsdb *                 self,
@@ -1153,11 +1164,11 @@ _add_interface(NMOvsdb *     self,
 /**
  * _delete_interface:
  *
- * Removes an interface of @ifname name, collecting empty ports and bridge
- * if last item is removed from them.
+ * Removes the interfaces whose names are in @ifnames, collecting empty ports
+ * and bridges if last item is removed from them.
  */
 static void
-_delete_interface(NMOvsdb *self, json_t *params, const char *ifname)
+_delete_interface(NMOvsdb *self, json_t *params, GHashTable *ifnames)
 {
     NMOvsdbPrivate *      priv = NM_OVSDB_GET_PRIVATE(self);
     GHashTableIter        iter;
@@ -1215,7 +1226,7 @@ _delete_interface(NMOvsdb *self, json_t *params, const char *ifname)
                 json_array_append_new(interfaces, json_pack("[s,s]", "uuid", interface_uuid));
 
                 if (ovs_interface) {
-                    if (nm_streq(ovs_interface->name, ifname)) {
+                    if (g_hash_table_contains(ifnames, ovs_interface->name)) {
                         /* skip the interface */
                         interfaces_changed = TRUE;
                         continue;
@@ -1256,77 +1267,215 @@ _delete_interface(NMOvsdb *self, json_t *params, const char *ifname)
     }
 }
 
+static gboolean
+_call_is_blind(const OvsdbMethodCall *call)
+{
+    /* These commands only update rows selected by name and don't depend on
+     * our cached view of the database. They can be sent while other calls
+     * are still waiting for a response. */
+    return NM_IN_SET(call->command, OVSDB_SET_INTERFACE_MTU, OVSDB_SET_EXTERNAL_IDS);
+}
+
+static void
+_append_blind_op(json_t *params, const OvsdbMethodCall *call)
+{
+    switch (call->command) {
+    case OVSDB_SET_INTERFACE_MTU:
+        json_array_append_new(params,
+                              json_pack("{s:s, s:s, s:{s: I}, s:[[s, s, s]]}",
+                                        "op",
+                                        "update",
+                                        "table",
+                                        "Interface",
+                                        "row",
+                                        "mtu_request",
+                                        (json_int_t) call->payload.set_interface_mtu.mtu,
+                                        "where",
+                                        "name",
+                                        "==",
+                                        call->payload.set_interface_mtu.ifname));
+        break;
+    case OVSDB_SET_EXTERNAL_IDS:
+        json_array_append_new(
+            params,
+            json_pack("{s:s, s:s, s:o, s:[[s, s, s]]}",
+                      "op",
+                      "mutate",
+                      "table",
+                      _device_type_to_table(call->payload.set_external_ids.device_type),
+                      "mutations",
+                      _j_create_external_ids_array_update(
+                          call->payload.set_external_ids.connection_uuid,
+                          call->payload.set_external_ids.exid_old,
+                          call->payload.set_external_ids.exid_new),
+                      "where",
+                      "name",
+                      "==",
+                      call->payload.set_external_ids.ifname));
+        break;
+    default:
+        nm_assert_not_reached();
+        break;
+    }
+}
+
+static OvsdbMethodCall *
+_call_next_batchable(NMOvsdb *self, OvsdbMethodCall *call, guint n_batch, gboolean want_delete)
+{
+    NMOvsdbPrivate * priv = NM_OVSDB_GET_PRIVATE(self);
+    OvsdbMethodCall *next;
+
+    if (n_batch >= OVSDB_MAX_BATCH || call->no_batch)
+        return NULL;
+    if (call->calls_lst.next == &priv->calls_lst_head)
+        return NULL;
+
+    next = c_list_entry(call->calls_lst.next, OvsdbMethodCall, calls_lst);
+    nm_assert(next->call_id == CALL_ID_UNSPEC);
+
+    if (next->no_batch)
+        return NULL;
+    if (want_delete ? (next->command != OVSDB_DEL_INTERFACE) : !_call_is_blind(next))
+        return NULL;
+    return next;
+}
+
 /**
  * ovsdb_next_command:
  *
- * Translates a higher level operation (add/remove bridge/port) to a RFC 7047
- * command serialized into JSON ands sends it over to the database.
-
- * Only called when no command is waiting for a response, since the serialized
- * command might depend on result of a previous one (add and remove need to
- * include an up to date bridge list in their transactions to rule out races).
+ * Translates higher level operations (add/remove bridge/port) to RFC 7047
+ * commands serialized into JSON and sends them over to the database.
+ *
+ * Consecutive queued calls are merged into a single "transact": interface
+ * deletions are computed together, and calls that only update rows by name
+ * (MTU, external-ids) are appended to the preceding operation. Adding an
+ * interface, deleting one or monitoring is only serialized when no other
+ * command is waiting for a response, since the serialized command depends
+ * on the result of previous ones (add and remove need to include an up to
+ * date bridge list in their transactions to rule out races). The other
+ * calls are pipelined behind pending calls of the same kind.
  */
 static void
 ovsdb_next_command(NMOvsdb *self)
 {
-    NMOvsdbPrivate *    priv = NM_OVSDB_GET_PRIVATE(self);
-    OvsdbMethodCall *   call;
-    char *              cmd;
-    nm_auto_decref_json json_t *msg = NULL;
+    NMOvsdbPrivate * priv = NM_OVSDB_GET_PRIVATE(self);
+    OvsdbMethodCall *call;
+    OvsdbMethodCall *iter;
+    OvsdbMethodCall *next;
+    gboolean         in_flight;
+    gboolean         in_flight_all_blind;
+    guint            n_batch;
 
     if (!priv->conn)
         return;
 
-    if (c_list_is_empty(&priv->calls_lst_head))
+    /* Wait until the previous request is written out. The output buffer
+     * must not be modified while a write is in progress, and waiting lets
+     * more calls accumulate into the next batch. */
+    if (priv->output->len > 0)
+        return;
+
+    call                = NULL;
+    in_flight           = FALSE;
+    in_flight_all_blind = TRUE;
+    c_list_for_each_entry (iter, &priv->calls_lst_head, calls_lst) {
+        if (iter->call_id == CALL_ID_UNSPEC) {
+            call = iter;
+            break;
+        }
+        in_flight = TRUE;
+        if (!_call_is_blind(iter))
+            in_flight_all_blind = FALSE;
+    }
+
+    if (!call)
         return;
 
-    call = c_list_first_entry(&priv->calls_lst_head, OvsdbMethodCall, calls_lst);
-    if (call->call_id != CALL_ID_UNSPEC)
+    if (in_flight && (!in_flight_all_blind || !_call_is_blind(call)))
         return;
 
     call->call_id = ++priv->call_id_counter;
+    n_batch       = 1;
 
     switch (call->command) {
     case OVSDB_MONITOR:
-        msg = json_pack("{s:I, s:s, s:[s, n, {"
-                        "  s:[{s:[s, s, s]}],"
-                        "  s:[{s:[s, s, s]}],"
-                        "  s:[{s:[s, s, s, s]}],"
-                        "  s:[{s:[]}]"
-                        "}]}",
-                        "id",
-                        (json_int_t) call->call_id,
-                        "method",
-                        "monitor",
-                        "params",
-                        "Open_vSwitch",
-                        "Bridge",
-                        "columns",
-                        "name",
-                        "ports",
-                        "external_ids",
-                        "Port",
-                        "columns",
-                        "name",
-                        "interfaces",
-                        "external_ids",
-                        "Interface",
-                        "columns",
-                        "name",
-                        "type",
-                        "external_ids",
-                        "error",
-                        "Open_vSwitch",
-                        "columns");
-        break;
+    {
+        nm_auto_decref_json json_t *msg      = NULL;
+        nm_auto_decref_json json_t *requests = NULL;
+        char *                      cmd;
+
+        requests = json_pack("{"
+                             "  s:[{s:[s, s, s]}],"
+                             "  s:[{s:[s, s, s]}],"
+                             "  s:[{s:[s, s, s, s]}],"
+                             "  s:[{s:[]}]"
+                             "}",
+                             "Bridge",
+                             "columns",
+                             "name",
+                             "ports",
+                             "external_ids",
+                             "Port",
+                             "columns",
+                             "name",
+                             "interfaces",
+                             "external_ids",
+                             "Interface",
+                             "columns",
+                             "name",
+                             "type",
+                             "external_ids",
+                             "error",
+                             "Open_vSwitch",
+                             "columns");
+        g_return_if_fail(requests);
+
+        if (priv->monitor_cond_since_unsupported) {
+            msg = json_pack("{s:I, s:s, s:[s, n, O]}",
+                            "id",
+                            (json_int_t) call->call_id,
+                            "method",
+                            "monitor",
+                            "params",
+                            "Open_vSwitch",
+                            requests);
+        } else {
+            /* With the ID of the last transaction we have seen, the server only
+             * sends us what changed while we were disconnected. */
+            msg = json_pack("{s:I, s:s, s:[s, n, O, s]}",
+                            "id",
+                            (json_int_t) call->call_id,
+                            "method",
+                            "monitor_cond_since",
+                            "params",
+                            "Open_vSwitch",
+                            requests,
+                            priv->last_txn_id ?: TXN_ID_NONE);
+        }
+        g_return_if_fail(msg);
+
+        cmd = json_dumps(msg, 0);
+        _LOGT_call(call, "send: call-id=%" G_GUINT64_FORMAT ", %s", call->call_id, cmd);
+        g_string_append(priv->output, cmd);
+        free(cmd);
+
+        /* Nothing can be sent before we have the reply to the monitor
+         * call. */
+        ovsdb_write(self);
+        return;
+    }
     default:
     {
-        json_t *params = NULL;
+        nm_auto_decref_json json_t *msg    = NULL;
+        json_t *                    params = NULL;
+        char *                      cmd;
 
         params = json_array();
         json_array_append_new(params, json_string("Open_vSwitch"));
         json_array_append_new(params, _inc_next_cfg(priv->db_uuid));
 
+        iter = call;
+
         switch (call->command) {
         case OVSDB_ADD_INTERFACE:
             _add_interface(self,
@@ -1338,47 +1487,38 @@ ovsdb_next_command(NMOvsdb *self)
                            call->payload.add_interface.interface_device);
             break;
         case OVSDB_DEL_INTERFACE:
-            _delete_interface(self, params, call->payload.del_interface.ifname);
+        {
+            gs_unref_hashtable GHashTable *ifnames = NULL;
+
+            ifnames = g_hash_table_new(nm_str_hash, g_str_equal);
+            g_hash_table_add(ifnames, call->payload.del_interface.ifname);
+            while ((next = _call_next_batchable(self, iter, n_batch, TRUE))) {
+                next->call_id = call->call_id;
+                g_hash_table_add(ifnames, next->payload.del_interface.ifname);
+                _LOGT_call(next, "send: call-id=%" G_GUINT64_FORMAT " (batched)", next->call_id);
+                iter = next;
+                n_batch++;
+            }
+            _delete_interface(self, params, ifnames);
             break;
+        }
         case OVSDB_SET_INTERFACE_MTU:
-            json_array_append_new(params,
-                                  json_pack("{s:s, s:s, s:{s: I}, s:[[s, s, s]]}",
-                                            "op",
-                                            "update",
-                                            "table",
-                                            "Interface",
-                                            "row",
-                                            "mtu_request",
-                                            (json_int_t) call->payload.set_interface_mtu.mtu,
-                                            "where",
-                                            "name",
-                                            "==",
-                                            call->payload.set_interface_mtu.ifname));
-            break;
         case OVSDB_SET_EXTERNAL_IDS:
-            json_array_append_new(
-                params,
-                json_pack("{s:s, s:s, s:o, s:[[s, s, s]]}",
-                          "op",
-                          "mutate",
-                          "table",
-                          _device_type_to_table(call->payload.set_external_ids.device_type),
-                          "mutations",
-                          _j_create_external_ids_array_update(
-                              call->payload.set_external_ids.connection_uuid,
-                              call->payload.set_external_ids.exid_old,
-                              call->payload.set_external_ids.exid_new),
-                          "where",
-                          "name",
-                          "==",
-                          call->payload.set_external_ids.ifname));
+            _append_blind_op(params, call);
             break;
-
         default:
             nm_assert_not_reached();
             break;
         }
 
+        while ((next = _call_next_batchable(self, iter, n_batch, FALSE))) {
+            next->call_id = call->call_id;
+            _append_blind_op(params, next);
+            _LOGT_call(next, "send: call-id=%" G_GUINT64_FORMAT " (batched)", next->call_id);
+            iter = next;
+            n_batch++;
+        }
+
         msg = json_pack("{s:I, s:s, s:o}",
                         "id",
                         (json_int_t) call->call_id,
@@ -1386,17 +1526,22 @@ ovsdb_next_command(NMOvsdb *self)
                         "transact",
                         "params",
                         params);
+        g_return_if_fail(msg);
+
+        cmd = json_dumps(msg, 0);
+        _LOGT_call(call,
+                   "send: call-id=%" G_GUINT64_FORMAT ", %u call(s), %s",
+                   call->call_id,
+                   n_batch,
+                   cmd);
+        g_string_append(priv->output, cmd);
+        free(cmd);
         break;
     }
     }
 
-    g_return_if_fail(msg);
-
-    cmd = json_dumps(msg, 0);
-    _LOGT_call(call, "send: call-id=%" G_GUINT64_FORMAT ", %s", call->call_id, cmd);
-    g_string_append(priv->output, cmd);
-    free(cmd);
-
+    /* Once the request is written out, ovsdb_write_cb() calls us again to
+     * pipeline further calls that don't need to wait for the response. */
     ovsdb_write(self);
 }
 
@@ -1545,272 +1690,423 @@ _external_ids_to_string(const GArray *arr)
 
 /*****************************************************************************/
 
+static const char *
+_external_ids_get_connection_uuid(const GArray *arr)
+{
+    guint i;
+
+    for (i = 0; i < nm_g_array_len(arr); i++) {
+        const NMUtilsNamedValue *n = &g_array_index(arr, NMUtilsNamedValue, i);
+
+        if (nm_streq(n->name, NM_OVS_EXTERNAL_ID_NM_CONNECTION_UUID))
+            return n->value_str;
+    }
+    return NULL;
+}
+
 /**
- * ovsdb_got_update:
+ * _external_ids_apply_diff:
  *
- * Called when we've got an "update" method call (we asked for it with the monitor
- * command). We use it to maintain a consistent view of bridge list regardless of
- * whether the changes are done by us or externally.
+ * Applies a map difference from an "update2" notification: a pair with a
+ * new key is added, a pair with an existing key and the same value is
+ * removed, and a pair with an existing key and a different value replaces
+ * the old value.
+ *
+ * Returns: whether the map changed.
  */
-static void
-ovsdb_got_update(NMOvsdb *self, json_t *msg)
+static gboolean
+_external_ids_apply_diff(GArray **p_arr, json_t *diff)
 {
-    NMOvsdbPrivate *priv      = NM_OVSDB_GET_PRIVATE(self);
-    json_t *        ovs       = NULL;
-    json_t *        bridge    = NULL;
-    json_t *        port      = NULL;
-    json_t *        interface = NULL;
-    json_t *        items;
-    json_t *        external_ids;
-    json_error_t    json_error = {
-        0,
-    };
-    void *      iter;
-    const char *name;
-    const char *key;
-    const char *type;
-    json_t *    value;
+    gs_unref_array GArray *diff_arr = NULL;
+    guint                  i;
+    guint                  j;
 
-    if (json_unpack_ex(msg,
-                       &json_error,
-                       0,
-                       "{s?:o, s?:o, s?:o, s?:o}",
-                       "Open_vSwitch",
-                       &ovs,
-                       "Bridge",
-                       &bridge,
-                       "Port",
-                       &port,
-                       "Interface",
-                       &interface)
-        == -1) {
-        /* This doesn't really have to be an error; the key might
-         * be missing if there really are no bridges present. */
-        _LOGD("Bad update: %s", json_error.text);
-    }
+    _external_ids_extract(diff, &diff_arr, NULL);
 
-    if (ovs) {
-        const char *s;
-
-        iter = json_object_iter(ovs);
-        s    = json_object_iter_key(iter);
-        if (s)
-            nm_utils_strdup_reset(&priv->db_uuid, s);
-    }
-
-    json_object_foreach (interface, key, value) {
-        OpenvswitchInterface *ovs_interface;
-        gs_unref_array GArray *external_ids_arr = NULL;
-        const char *           connection_uuid  = NULL;
-        json_t *               error            = NULL;
-        int                    r;
-
-        r = json_unpack(value,
-                        "{s:{s:s, s:s, s?:o, s:o}}",
-                        "new",
-                        "name",
-                        &name,
-                        "type",
-                        &type,
-                        "error",
-                        &error,
-                        "external_ids",
-                        &external_ids);
-        if (r != 0) {
-            gpointer unused;
-
-            r = json_unpack(value, "{s:{}}", "old");
-            if (r != 0)
-                continue;
+    for (i = 0; i < nm_g_array_len(diff_arr); i++) {
+        NMUtilsNamedValue *d = &g_array_index(diff_arr, NMUtilsNamedValue, i);
+        NMUtilsNamedValue *v = NULL;
 
-            if (!g_hash_table_steal_extended(priv->interfaces,
-                                             &key,
-                                             (gpointer *) &ovs_interface,
-                                             &unused))
-                continue;
+        for (j = 0; j < nm_g_array_len(*p_arr); j++) {
+            v = &g_array_index(*p_arr, NMUtilsNamedValue, j);
+            if (nm_streq(v->name, d->name))
+                break;
+        }
 
-            _LOGT("obj[iface:%s]: removed an '%s' interface: %s%s%s",
-                  key,
-                  ovs_interface->type,
-                  ovs_interface->name,
-                  NM_PRINT_FMT_QUOTED2(ovs_interface->connection_uuid,
-                                       ", ",
-                                       ovs_interface->connection_uuid,
-                                       ""));
-            _signal_emit_device_removed(self,
-                                        ovs_interface->name,
-                                        NM_DEVICE_TYPE_OVS_INTERFACE,
-                                        ovs_interface->type);
-            _free_interface(ovs_interface);
+        if (j < nm_g_array_len(*p_arr)) {
+            if (nm_streq(v->value_str, d->value_str))
+                g_array_remove_index(*p_arr, j);
+            else
+                NM_SWAP(&v->value_str, &d->value_str);
             continue;
         }
 
-        ovs_interface = g_hash_table_lookup(priv->interfaces, &key);
-
-        if (ovs_interface
-            && (!nm_streq0(ovs_interface->name, name) || !nm_streq0(ovs_interface->type, type))) {
-            if (!g_hash_table_steal(priv->interfaces, ovs_interface))
-                nm_assert_not_reached();
-            _signal_emit_device_removed(self,
-                                        ovs_interface->name,
-                                        NM_DEVICE_TYPE_OVS_INTERFACE,
-                                        ovs_interface->type);
-            nm_clear_pointer(&ovs_interface, _free_interface);
+        if (!*p_arr) {
+            *p_arr = g_array_new(FALSE, FALSE, sizeof(NMUtilsNamedValue));
+            g_array_set_clear_func(*p_arr, (GDestroyNotify) nm_utils_named_value_clear_with_g_free);
         }
+        v  = nm_g_array_append_new(*p_arr, NMUtilsNamedValue);
+        *v = *d;
+        *d = (NMUtilsNamedValue){};
+    }
 
-        _external_ids_extract(external_ids, &external_ids_arr, &connection_uuid);
+    if (nm_g_array_len(*p_arr) == 0)
+        nm_clear_pointer(p_arr, g_array_unref);
 
-        if (ovs_interface) {
-            gboolean changed = FALSE;
+    return nm_g_array_len(diff_arr) > 0;
+}
 
-            nm_assert(nm_streq0(ovs_interface->name, name));
+/**
+ * _uuids_apply_diff:
+ *
+ * Applies a set difference from an "update2" notification: every UUID in
+ * @diff is either added to or removed from @array.
+ *
+ * Returns: whether the set changed.
+ */
+static gboolean
+_uuids_apply_diff(GPtrArray *array, json_t *diff)
+{
+    gs_unref_ptrarray GPtrArray *diff_arr = NULL;
+    guint                        i;
+    guint                        j;
 
-            changed |= nm_utils_strdup_reset(&ovs_interface->type, type);
-            changed |= nm_utils_strdup_reset(&ovs_interface->connection_uuid, connection_uuid);
-            if (!_external_ids_equal(ovs_interface->external_ids, external_ids_arr)) {
-                NM_SWAP(&ovs_interface->external_ids, &external_ids_arr);
-                changed = TRUE;
-            }
-            if (changed) {
-                gs_free char *strtmp = NULL;
-
-                _LOGT("obj[iface:%s]: changed an '%s' interface: %s%s%s, external-ids=%s",
-                      key,
-                      type,
-                      ovs_interface->name,
-                      NM_PRINT_FMT_QUOTED2(ovs_interface->connection_uuid,
-                                           ", ",
-                                           ovs_interface->connection_uuid,
-                                           ""),
-                      (strtmp = _external_ids_to_string(ovs_interface->external_ids)));
-            }
-        } else {
+    diff_arr = _uuids_to_array(diff);
+
+    for (i = 0; i < diff_arr->len; i++) {
+        const char *uuid = diff_arr->pdata[i];
+
+        for (j = 0; j < array->len; j++) {
+            if (nm_streq(array->pdata[j], uuid))
+                break;
+        }
+        if (j < array->len)
+            g_ptr_array_remove_index(array, j);
+        else
+            g_ptr_array_add(array, g_strdup(uuid));
+    }
+
+    return diff_arr->len > 0;
+}
+
+/**
+ * _optional_string_apply_diff:
+ *
+ * Applies a difference to a string column with at most one element (like the
+ * "error" column of interfaces). The difference contains the old value if it
+ * was removed and the new value if one was set.
+ */
+static void
+_optional_string_apply_diff(char **p_str, json_t *diff)
+{
+    gs_free char *old_str = g_strdup(*p_str);
+    json_t *      set;
+    json_t *      value;
+    size_t        index;
+
+    if (json_is_string(diff)) {
+        if (nm_streq0(json_string_value(diff), old_str))
+            nm_clear_g_free(p_str);
+        else
+            nm_utils_strdup_reset(p_str, json_string_value(diff));
+        return;
+    }
+
+    if (!nm_streq0("set", json_string_value(json_array_get(diff, 0))))
+        return;
+
+    set = json_array_get(diff, 1);
+    json_array_foreach (set, index, value) {
+        const char *str = json_string_value(value);
+
+        if (!str)
+            continue;
+        if (nm_streq0(str, old_str)) {
+            if (nm_streq0(*p_str, old_str))
+                nm_clear_g_free(p_str);
+        } else
+            nm_utils_strdup_reset(p_str, str);
+    }
+}
+
+/*****************************************************************************/
+
+static void
+_interface_remove(NMOvsdb *self, const char *key)
+{
+    NMOvsdbPrivate *      priv = NM_OVSDB_GET_PRIVATE(self);
+    OpenvswitchInterface *ovs_interface;
+    gpointer              unused;
+
+    if (!g_hash_table_steal_extended(priv->interfaces, &key, (gpointer *) &ovs_interface, &unused))
+        return;
+
+    _LOGT("obj[iface:%s]: removed an '%s' interface: %s%s%s",
+          key,
+          ovs_interface->type,
+          ovs_interface->name,
+          NM_PRINT_FMT_QUOTED2(ovs_interface->connection_uuid,
+                               ", ",
+                               ovs_interface->connection_uuid,
+                               ""));
+    _signal_emit_device_removed(self,
+                                ovs_interface->name,
+                                NM_DEVICE_TYPE_OVS_INTERFACE,
+                                ovs_interface->type);
+    _free_interface(ovs_interface);
+}
+
+static void
+_port_remove(NMOvsdb *self, const char *key)
+{
+    NMOvsdbPrivate * priv = NM_OVSDB_GET_PRIVATE(self);
+    OpenvswitchPort *ovs_port;
+    gpointer         unused;
+
+    if (!g_hash_table_steal_extended(priv->ports, &key, (gpointer *) &ovs_port, &unused))
+        return;
+
+    _LOGT("obj[port:%s]: removed a port: %s%s%s",
+          key,
+          ovs_port->name,
+          NM_PRINT_FMT_QUOTED2(ovs_port->connection_uuid, ", ", ovs_port->connection_uuid, ""));
+    _signal_emit_device_removed(self, ovs_port->name, NM_DEVICE_TYPE_OVS_PORT, NULL);
+    _free_port(ovs_port);
+}
+
+static void
+_bridge_remove(NMOvsdb *self, const char *key)
+{
+    NMOvsdbPrivate *   priv = NM_OVSDB_GET_PRIVATE(self);
+    OpenvswitchBridge *ovs_bridge;
+    gpointer           unused;
+
+    if (!g_hash_table_steal_extended(priv->bridges, &key, (gpointer *) &ovs_bridge, &unused))
+        return;
+
+    _LOGT("obj[bridge:%s]: removed a bridge: %s%s%s",
+          key,
+          ovs_bridge->name,
+          NM_PRINT_FMT_QUOTED2(ovs_bridge->connection_uuid,
+                               ", ",
+                               ovs_bridge->connection_uuid,
+                               ""));
+    _signal_emit_device_removed(self, ovs_bridge->name, NM_DEVICE_TYPE_OVS_BRIDGE, NULL);
+    _free_bridge(ovs_bridge);
+}
+
+/**
+ * _prune_stale_objects:
+ *
+ * Called with a reply that contains the full content of the database. Objects
+ * that we still have from before a reconnect but which are no longer in the
+ * database are removed.
+ */
+static void
+_prune_stale_objects(NMOvsdb *self, json_t *msg)
+{
+    NMOvsdbPrivate *priv = NM_OVSDB_GET_PRIVATE(self);
+    struct {
+        GHashTable *objs;
+        const char *table;
+        void (*remove)(NMOvsdb *self, const char *key);
+    } const tables[] = {
+        {priv->interfaces, "Interface", _interface_remove},
+        {priv->ports, "Port", _port_remove},
+        {priv->bridges, "Bridge", _bridge_remove},
+    };
+    int i;
+
+    for (i = 0; i < (int) G_N_ELEMENTS(tables); i++) {
+        gs_free const char **keys = NULL;
+        json_t *             rows;
+        guint                n_keys;
+        guint                j;
+
+        rows = json_object_get(msg, tables[i].table);
+
+        /* The first member of all object types is the UUID string. */
+        keys = (const char **) nm_utils_hash_keys_to_array(tables[i].objs, NULL, NULL, &n_keys);
+        for (j = 0; j < n_keys; j++) {
+            gs_free char *key = g_strdup(*((const char *const *) keys[j]));
+
+            if (!json_object_get(rows, key))
+                tables[i].remove(self, key);
+        }
+    }
+}
+
+/*****************************************************************************/
+
+static void
+_interface_update(NMOvsdb *self, const char *key, json_t *value)
+{
+    NMOvsdbPrivate *      priv = NM_OVSDB_GET_PRIVATE(self);
+    OpenvswitchInterface *ovs_interface;
+    gs_unref_array GArray *external_ids_arr = NULL;
+    const char *           connection_uuid  = NULL;
+    json_t *               external_ids;
+    json_t *               error = NULL;
+    const char *           name;
+    const char *           type;
+    int                    r;
+
+    r = json_unpack(value,
+                    "{s:{s:s, s:s, s?:o, s:o}}",
+                    "new",
+                    "name",
+                    &name,
+                    "type",
+                    &type,
+                    "error",
+                    &error,
+                    "external_ids",
+                    &external_ids);
+    if (r != 0) {
+        r = json_unpack(value, "{s:{}}", "old");
+        if (r == 0)
+            _interface_remove(self, key);
+        return;
+    }
+
+    ovs_interface = g_hash_table_lookup(priv->interfaces, &key);
+
+    if (ovs_interface
+        && (!nm_streq0(ovs_interface->name, name) || !nm_streq0(ovs_interface->type, type))) {
+        if (!g_hash_table_steal(priv->interfaces, ovs_interface))
+            nm_assert_not_reached();
+        _signal_emit_device_removed(self,
+                                    ovs_interface->name,
+                                    NM_DEVICE_TYPE_OVS_INTERFACE,
+                                    ovs_interface->type);
+        nm_clear_pointer(&ovs_interface, _free_interface);
+    }
+
+    _external_ids_extract(external_ids, &external_ids_arr, &connection_uuid);
+
+    if (ovs_interface) {
+        gboolean changed = FALSE;
+
+        nm_assert(nm_streq0(ovs_interface->name, name));
+
+        changed |= nm_utils_strdup_reset(&ovs_interface->type, type);
+        changed |= nm_utils_strdup_reset(&ovs_interface->connection_uuid, connection_uuid);
+        if (!_external_ids_equal(ovs_interface->external_ids, external_ids_arr)) {
+            NM_SWAP(&ovs_interface->external_ids, &external_ids_arr);
+            changed = TRUE;
+        }
+        if (changed) {
             gs_free char *strtmp = NULL;
 
-            ovs_interface  = g_slice_new(OpenvswitchInterface);
-            *ovs_interface = (OpenvswitchInterface){
-                .interface_uuid  = g_strdup(key),
-                .name            = g_strdup(name),
-                .type            = g_strdup(type),
-                .connection_uuid = g_strdup(connection_uuid),
-                .external_ids    = g_steal_pointer(&external_ids_arr),
-            };
-            g_hash_table_add(priv->interfaces, ovs_interface);
-            _LOGT("obj[iface:%s]: added an '%s' interface: %s%s%s, external-ids=%s",
+            _LOGT("obj[iface:%s]: changed an '%s' interface: %s%s%s, external-ids=%s",
                   key,
-                  ovs_interface->type,
+                  type,
                   ovs_interface->name,
                   NM_PRINT_FMT_QUOTED2(ovs_interface->connection_uuid,
                                        ", ",
                                        ovs_interface->connection_uuid,
                                        ""),
                   (strtmp = _external_ids_to_string(ovs_interface->external_ids)));
-            _signal_emit_device_added(self,
-                                      ovs_interface->name,
-                                      NM_DEVICE_TYPE_OVS_INTERFACE,
-                                      ovs_interface->type);
-        }
-
-        /* The error is a string. No error is indicated by an empty set,
-         * Why not: [ "set": [] ] ? */
-        if (error && json_is_string(error)) {
-            _signal_emit_interface_failed(self,
-                                          ovs_interface->name,
-                                          ovs_interface->connection_uuid,
-                                          json_string_value(error));
         }
+    } else {
+        gs_free char *strtmp = NULL;
+
+        ovs_interface  = g_slice_new(OpenvswitchInterface);
+        *ovs_interface = (OpenvswitchInterface){
+            .interface_uuid  = g_strdup(key),
+            .name            = g_strdup(name),
+            .type            = g_strdup(type),
+            .connection_uuid = g_strdup(connection_uuid),
+            .external_ids    = g_steal_pointer(&external_ids_arr),
+        };
+        g_hash_table_add(priv->interfaces, ovs_interface);
+        _LOGT("obj[iface:%s]: added an '%s' interface: %s%s%s, external-ids=%s",
+              key,
+              ovs_interface->type,
+              ovs_interface->name,
+              NM_PRINT_FMT_QUOTED2(ovs_interface->connection_uuid,
+                                   ", ",
+                                   ovs_interface->connection_uuid,
+                                   ""),
+              (strtmp = _external_ids_to_string(ovs_interface->external_ids)));
+        _signal_emit_device_added(self,
+                                  ovs_interface->name,
+                                  NM_DEVICE_TYPE_OVS_INTERFACE,
+                                  ovs_interface->type);
     }
 
-    json_object_foreach (port, key, value) {
-        gs_unref_ptrarray GPtrArray *interfaces = NULL;
-        OpenvswitchPort *            ovs_port;
-        gs_unref_array GArray *external_ids_arr = NULL;
-        const char *           connection_uuid  = NULL;
-        int                    r;
-
-        r = json_unpack(value,
-                        "{s:{s:s, s:o, s:o}}",
-                        "new",
-                        "name",
-                        &name,
-                        "external_ids",
-                        &external_ids,
-                        "interfaces",
-                        &items);
-        if (r != 0) {
-            gpointer unused;
-
-            r = json_unpack(value, "{s:{}}", "old");
-            if (r != 0)
-                continue;
-
-            if (!g_hash_table_steal_extended(priv->ports, &key, (gpointer *) &ovs_port, &unused))
-                continue;
+    /* The error is a string. No error is indicated by an empty set,
+     * Why not: [ "set": [] ] ? */
+    nm_utils_strdup_reset(&ovs_interface->error,
+                          json_is_string(error) ? json_string_value(error) : NULL);
+    if (ovs_interface->error) {
+        _signal_emit_interface_failed(self,
+                                      ovs_interface->name,
+                                      ovs_interface->connection_uuid,
+                                      ovs_interface->error);
+    }
+}
 
-            _LOGT("obj[port:%s]: removed a port: %s%s%s",
-                  key,
-                  ovs_port->name,
-                  NM_PRINT_FMT_QUOTED2(ovs_port->connection_uuid,
-                                       ", ",
-                                       ovs_port->connection_uuid,
-                                       ""));
-            _signal_emit_device_removed(self, ovs_port->name, NM_DEVICE_TYPE_OVS_PORT, NULL);
-            _free_port(ovs_port);
-            continue;
-        }
+static void
+_port_update(NMOvsdb *self, const char *key, json_t *value)
+{
+    NMOvsdbPrivate *             priv       = NM_OVSDB_GET_PRIVATE(self);
+    gs_unref_ptrarray GPtrArray *interfaces = NULL;
+    OpenvswitchPort *            ovs_port;
+    gs_unref_array GArray *external_ids_arr = NULL;
+    const char *           connection_uuid  = NULL;
+    json_t *               external_ids;
+    json_t *               items;
+    const char *           name;
+    int                    r;
+
+    r = json_unpack(value,
+                    "{s:{s:s, s:o, s:o}}",
+                    "new",
+                    "name",
+                    &name,
+                    "external_ids",
+                    &external_ids,
+                    "interfaces",
+                    &items);
+    if (r != 0) {
+        r = json_unpack(value, "{s:{}}", "old");
+        if (r == 0)
+            _port_remove(self, key);
+        return;
+    }
 
-        ovs_port = g_hash_table_lookup(priv->ports, &key);
+    ovs_port = g_hash_table_lookup(priv->ports, &key);
 
-        if (ovs_port && !nm_streq0(ovs_port->name, name)) {
-            if (!g_hash_table_steal(priv->ports, ovs_port))
-                nm_assert_not_reached();
-            _signal_emit_device_removed(self, ovs_port->name, NM_DEVICE_TYPE_OVS_PORT, NULL);
-            nm_clear_pointer(&ovs_port, _free_port);
-        }
+    if (ovs_port && !nm_streq0(ovs_port->name, name)) {
+        if (!g_hash_table_steal(priv->ports, ovs_port))
+            nm_assert_not_reached();
+        _signal_emit_device_removed(self, ovs_port->name, NM_DEVICE_TYPE_OVS_PORT, NULL);
+        nm_clear_pointer(&ovs_port, _free_port);
+    }
 
-        _external_ids_extract(external_ids, &external_ids_arr, &connection_uuid);
-        interfaces = _uuids_to_array(items);
+    _external_ids_extract(external_ids, &external_ids_arr, &connection_uuid);
+    interfaces = _uuids_to_array(items);
 
-        if (ovs_port) {
-            gboolean changed = FALSE;
+    if (ovs_port) {
+        gboolean changed = FALSE;
 
-            nm_assert(nm_streq0(ovs_port->name, name));
+        nm_assert(nm_streq0(ovs_port->name, name));
 
-            changed |= nm_utils_strdup_reset(&ovs_port->name, name);
-            changed |= nm_utils_strdup_reset(&ovs_port->connection_uuid, connection_uuid);
-            if (nm_strv_ptrarray_cmp(ovs_port->interfaces, interfaces) != 0) {
-                NM_SWAP(&ovs_port->interfaces, &interfaces);
-                changed = TRUE;
-            }
-            if (!_external_ids_equal(ovs_port->external_ids, external_ids_arr)) {
-                NM_SWAP(&ovs_port->external_ids, &external_ids_arr);
-                changed = TRUE;
-            }
-            if (changed) {
-                gs_free char *strtmp = NULL;
-
-                _LOGT("obj[port:%s]: changed a port: %s%s%s, external-ids=%s",
-                      key,
-                      ovs_port->name,
-                      NM_PRINT_FMT_QUOTED2(ovs_port->connection_uuid,
-                                           ", ",
-                                           ovs_port->connection_uuid,
-                                           ""),
-                      (strtmp = _external_ids_to_string(ovs_port->external_ids)));
-            }
-        } else {
+        changed |= nm_utils_strdup_reset(&ovs_port->name, name);
+        changed |= nm_utils_strdup_reset(&ovs_port->connection_uuid, connection_uuid);
+        if (nm_strv_ptrarray_cmp(ovs_port->interfaces, interfaces) != 0) {
+            NM_SWAP(&ovs_port->interfaces, &interfaces);
+            changed = TRUE;
+        }
+        if (!_external_ids_equal(ovs_port->external_ids, external_ids_arr)) {
+            NM_SWAP(&ovs_port->external_ids, &external_ids_arr);
+            changed = TRUE;
+        }
+        if (changed) {
             gs_free char *strtmp = NULL;
 
-            ovs_port  = g_slice_new(OpenvswitchPort);
-            *ovs_port = (OpenvswitchPort){
-                .port_uuid       = g_strdup(key),
-                .name            = g_strdup(name),
-                .connection_uuid = g_strdup(connection_uuid),
-                .interfaces      = g_steal_pointer(&interfaces),
-                .external_ids    = g_steal_pointer(&external_ids_arr),
-            };
-            g_hash_table_add(priv->ports, ovs_port);
-            _LOGT("obj[port:%s]: added a port: %s%s%s, external-ids=%s",
+            _LOGT("obj[port:%s]: changed a port: %s%s%s, external-ids=%s",
                   key,
                   ovs_port->name,
                   NM_PRINT_FMT_QUOTED2(ovs_port->connection_uuid,
@@ -1818,104 +2114,88 @@ ovsdb_got_update(NMOvsdb *self, json_t *msg)
                                        ovs_port->connection_uuid,
                                        ""),
                   (strtmp = _external_ids_to_string(ovs_port->external_ids)));
-            _signal_emit_device_added(self, ovs_port->name, NM_DEVICE_TYPE_OVS_PORT, NULL);
         }
+    } else {
+        gs_free char *strtmp = NULL;
+
+        ovs_port  = g_slice_new(OpenvswitchPort);
+        *ovs_port = (OpenvswitchPort){
+            .port_uuid       = g_strdup(key),
+            .name            = g_strdup(name),
+            .connection_uuid = g_strdup(connection_uuid),
+            .interfaces      = g_steal_pointer(&interfaces),
+            .external_ids    = g_steal_pointer(&external_ids_arr),
+        };
+        g_hash_table_add(priv->ports, ovs_port);
+        _LOGT("obj[port:%s]: added a port: %s%s%s, external-ids=%s",
+              key,
+              ovs_port->name,
+              NM_PRINT_FMT_QUOTED2(ovs_port->connection_uuid, ", ", ovs_port->connection_uuid, ""),
+              (strtmp = _external_ids_to_string(ovs_port->external_ids)));
+        _signal_emit_device_added(self, ovs_port->name, NM_DEVICE_TYPE_OVS_PORT, NULL);
     }
+}
 
-    json_object_foreach (bridge, key, value) {
-        gs_unref_ptrarray GPtrArray *ports = NULL;
-        OpenvswitchBridge *          ovs_bridge;
-        gs_unref_array GArray *external_ids_arr = NULL;
-        const char *           connection_uuid  = NULL;
-        int                    r;
-
-        r = json_unpack(value,
-                        "{s:{s:s, s:o, s:o}}",
-                        "new",
-                        "name",
-                        &name,
-                        "external_ids",
-                        &external_ids,
-                        "ports",
-                        &items);
-
-        if (r != 0) {
-            gpointer unused;
-
-            r = json_unpack(value, "{s:{}}", "old");
-            if (r != 0)
-                continue;
-
-            if (!g_hash_table_steal_extended(priv->bridges,
-                                             &key,
-                                             (gpointer *) &ovs_bridge,
-                                             &unused))
-                continue;
-
-            _LOGT("obj[bridge:%s]: removed a bridge: %s%s%s",
-                  key,
-                  ovs_bridge->name,
-                  NM_PRINT_FMT_QUOTED2(ovs_bridge->connection_uuid,
-                                       ", ",
-                                       ovs_bridge->connection_uuid,
-                                       ""));
-            _signal_emit_device_removed(self, ovs_bridge->name, NM_DEVICE_TYPE_OVS_BRIDGE, NULL);
-            _free_bridge(ovs_bridge);
-            continue;
-        }
+static void
+_bridge_update(NMOvsdb *self, const char *key, json_t *value)
+{
+    NMOvsdbPrivate *             priv  = NM_OVSDB_GET_PRIVATE(self);
+    gs_unref_ptrarray GPtrArray *ports = NULL;
+    OpenvswitchBridge *          ovs_bridge;
+    gs_unref_array GArray *external_ids_arr = NULL;
+    const char *           connection_uuid  = NULL;
+    json_t *               external_ids;
+    json_t *               items;
+    const char *           name;
+    int                    r;
+
+    r = json_unpack(value,
+                    "{s:{s:s, s:o, s:o}}",
+                    "new",
+                    "name",
+                    &name,
+                    "external_ids",
+                    &external_ids,
+                    "ports",
+                    &items);
+    if (r != 0) {
+        r = json_unpack(value, "{s:{}}", "old");
+        if (r == 0)
+            _bridge_remove(self, key);
+        return;
+    }
 
-        ovs_bridge = g_hash_table_lookup(priv->bridges, &key);
+    ovs_bridge = g_hash_table_lookup(priv->bridges, &key);
 
-        if (ovs_bridge && !nm_streq0(ovs_bridge->name, name)) {
-            if (!g_hash_table_steal(priv->bridges, ovs_bridge))
-                nm_assert_not_reached();
-            _signal_emit_device_removed(self, ovs_bridge->name, NM_DEVICE_TYPE_OVS_BRIDGE, NULL);
-            nm_clear_pointer(&ovs_bridge, _free_bridge);
-        }
+    if (ovs_bridge && !nm_streq0(ovs_bridge->name, name)) {
+        if (!g_hash_table_steal(priv->bridges, ovs_bridge))
+            nm_assert_not_reached();
+        _signal_emit_device_removed(self, ovs_bridge->name, NM_DEVICE_TYPE_OVS_BRIDGE, NULL);
+        nm_clear_pointer(&ovs_bridge, _free_bridge);
+    }
 
-        _external_ids_extract(external_ids, &external_ids_arr, &connection_uuid);
-        ports = _uuids_to_array(items);
+    _external_ids_extract(external_ids, &external_ids_arr, &connection_uuid);
+    ports = _uuids_to_array(items);
 
-        if (ovs_bridge) {
-            gboolean changed = FALSE;
+    if (ovs_bridge) {
+        gboolean changed = FALSE;
 
-            nm_assert(nm_streq0(ovs_bridge->name, name));
+        nm_assert(nm_streq0(ovs_bridge->name, name));
 
-            changed = nm_utils_strdup_reset(&ovs_bridge->name, name);
-            changed = nm_utils_strdup_reset(&ovs_bridge->connection_uuid, connection_uuid);
-            if (nm_strv_ptrarray_cmp(ovs_bridge->ports, ports) != 0) {
-                NM_SWAP(&ovs_bridge->ports, &ports);
-                changed = TRUE;
-            }
-            if (!_external_ids_equal(ovs_bridge->external_ids, external_ids_arr)) {
-                NM_SWAP(&ovs_bridge->external_ids, &external_ids_arr);
-                changed = TRUE;
-            }
-            if (changed) {
-                gs_free char *strtmp = NULL;
-
-                _LOGT("obj[bridge:%s]: changed a bridge: %s%s%s, external-ids=%s",
-                      key,
-                      ovs_bridge->name,
-                      NM_PRINT_FMT_QUOTED2(ovs_bridge->connection_uuid,
-                                           ", ",
-                                           ovs_bridge->connection_uuid,
-                                           ""),
-                      (strtmp = _external_ids_to_string(ovs_bridge->external_ids)));
-            }
-        } else {
+        changed = nm_utils_strdup_reset(&ovs_bridge->name, name);
+        changed = nm_utils_strdup_reset(&ovs_bridge->connection_uuid, connection_uuid);
+        if (nm_strv_ptrarray_cmp(ovs_bridge->ports, ports) != 0) {
+            NM_SWAP(&ovs_bridge->ports, &ports);
+            changed = TRUE;
+        }
+        if (!_external_ids_equal(ovs_bridge->external_ids, external_ids_arr)) {
+            NM_SWAP(&ovs_bridge->external_ids, &external_ids_arr);
+            changed = TRUE;
+        }
+        if (changed) {
             gs_free char *strtmp = NULL;
 
-            ovs_bridge  = g_slice_new(OpenvswitchBridge);
-            *ovs_bridge = (OpenvswitchBridge){
-                .bridge_uuid     = g_strdup(key),
-                .name            = g_strdup(name),
-                .connection_uuid = g_strdup(connection_uuid),
-                .ports           = g_steal_pointer(&ports),
-                .external_ids    = g_steal_pointer(&external_ids_arr),
-            };
-            g_hash_table_add(priv->bridges, ovs_bridge);
-            _LOGT("obj[bridge:%s]: added a bridge: %s%s%s, external-ids=%s",
+            _LOGT("obj[bridge:%s]: changed a bridge: %s%s%s, external-ids=%s",
                   key,
                   ovs_bridge->name,
                   NM_PRINT_FMT_QUOTED2(ovs_bridge->connection_uuid,
@@ -1923,7 +2203,373 @@ ovsdb_got_update(NMOvsdb *self, json_t *msg)
                                        ovs_bridge->connection_uuid,
                                        ""),
                   (strtmp = _external_ids_to_string(ovs_bridge->external_ids)));
-            _signal_emit_device_added(self, ovs_bridge->name, NM_DEVICE_TYPE_OVS_BRIDGE, NULL);
+        }
+    } else {
+        gs_free char *strtmp = NULL;
+
+        ovs_bridge  = g_slice_new(OpenvswitchBridge);
+        *ovs_bridge = (OpenvswitchBridge){
+            .bridge_uuid     = g_strdup(key),
+            .name            = g_strdup(name),
+            .connection_uuid = g_strdup(connection_uuid),
+            .ports           = g_steal_pointer(&ports),
+            .external_ids    = g_steal_pointer(&external_ids_arr),
+        };
+        g_hash_table_add(priv->bridges, ovs_bridge);
+        _LOGT("obj[bridge:%s]: added a bridge: %s%s%s, external-ids=%s",
+              key,
+              ovs_bridge->name,
+              NM_PRINT_FMT_QUOTED2(ovs_bridge->connection_uuid,
+                                   ", ",
+                                   ovs_bridge->connection_uuid,
+                                   ""),
+              (strtmp = _external_ids_to_string(ovs_bridge->external_ids)));
+        _signal_emit_device_added(self, ovs_bridge->name, NM_DEVICE_TYPE_OVS_BRIDGE, NULL);
+    }
+}
+
+/*****************************************************************************/
+
+static void
+_interface_modify(NMOvsdb *self, const char *key, json_t *row)
+{
+    NMOvsdbPrivate *      priv = NM_OVSDB_GET_PRIVATE(self);
+    OpenvswitchInterface *ovs_interface;
+    const char *          name;
+    const char *          type;
+    json_t *              value;
+    gboolean              renamed;
+    gboolean              changed;
+
+    ovs_interface = g_hash_table_lookup(priv->interfaces, &key);
+    if (!ovs_interface) {
+        _LOGD("obj[iface:%s]: modification of unknown interface", key);
+        return;
+    }
+
+    name    = json_string_value(json_object_get(row, "name"));
+    type    = json_string_value(json_object_get(row, "type"));
+    renamed = (name && !nm_streq0(name, ovs_interface->name))
+              || (type && !nm_streq0(type, ovs_interface->type));
+
+    if (renamed) {
+        _signal_emit_device_removed(self,
+                                    ovs_interface->name,
+                                    NM_DEVICE_TYPE_OVS_INTERFACE,
+                                    ovs_interface->type);
+        if (name)
+            nm_utils_strdup_reset(&ovs_interface->name, name);
+        if (type)
+            nm_utils_strdup_reset(&ovs_interface->type, type);
+    }
+
+    changed = renamed;
+
+    value = json_object_get(row, "external_ids");
+    if (value && _external_ids_apply_diff(&ovs_interface->external_ids, value)) {
+        nm_utils_strdup_reset(&ovs_interface->connection_uuid,
+                              _external_ids_get_connection_uuid(ovs_interface->external_ids));
+        changed = TRUE;
+    }
+
+    value = json_object_get(row, "error");
+    if (value)
+        _optional_string_apply_diff(&ovs_interface->error, value);
+
+    if (changed) {
+        gs_free char *strtmp = NULL;
+
+        _LOGT("obj[iface:%s]: changed an '%s' interface: %s%s%s, external-ids=%s",
+              key,
+              ovs_interface->type,
+              ovs_interface->name,
+              NM_PRINT_FMT_QUOTED2(ovs_interface->connection_uuid,
+                                   ", ",
+                                   ovs_interface->connection_uuid,
+                                   ""),
+              (strtmp = _external_ids_to_string(ovs_interface->external_ids)));
+    }
+
+    if (renamed) {
+        _signal_emit_device_added(self,
+                                  ovs_interface->name,
+                                  NM_DEVICE_TYPE_OVS_INTERFACE,
+                                  ovs_interface->type);
+    }
+
+    if (ovs_interface->error) {
+        _signal_emit_interface_failed(self,
+                                      ovs_interface->name,
+                                      ovs_interface->connection_uuid,
+                                      ovs_interface->error);
+    }
+}
+
+static void
+_port_modify(NMOvsdb *self, const char *key, json_t *row)
+{
+    NMOvsdbPrivate * priv = NM_OVSDB_GET_PRIVATE(self);
+    OpenvswitchPort *ovs_port;
+    const char *     name;
+    json_t *         value;
+    gboolean         renamed;
+    gboolean         changed;
+
+    ovs_port = g_hash_table_lookup(priv->ports, &key);
+    if (!ovs_port) {
+        _LOGD("obj[port:%s]: modification of unknown port", key);
+        return;
+    }
+
+    name    = json_string_value(json_object_get(row, "name"));
+    renamed = name && !nm_streq0(name, ovs_port->name);
+
+    if (renamed) {
+        _signal_emit_device_removed(self, ovs_port->name, NM_DEVICE_TYPE_OVS_PORT, NULL);
+        nm_utils_strdup_reset(&ovs_port->name, name);
+    }
+
+    changed = renamed;
+
+    value = json_object_get(row, "interfaces");
+    if (value && _uuids_apply_diff(ovs_port->interfaces, value))
+        changed = TRUE;
+
+    value = json_object_get(row, "external_ids");
+    if (value && _external_ids_apply_diff(&ovs_port->external_ids, value)) {
+        nm_utils_strdup_reset(&ovs_port->connection_uuid,
+                              _external_ids_get_connection_uuid(ovs_port->external_ids));
+        changed = TRUE;
+    }
+
+    if (changed) {
+        gs_free char *strtmp = NULL;
+
+        _LOGT("obj[port:%s]: changed a port: %s%s%s, external-ids=%s",
+              key,
+              ovs_port->name,
+              NM_PRINT_FMT_QUOTED2(ovs_port->connection_uuid, ", ", ovs_port->connection_uuid, ""),
+              (strtmp = _external_ids_to_string(ovs_port->external_ids)));
+    }
+
+    if (renamed)
+        _signal_emit_device_added(self, ovs_port->name, NM_DEVICE_TYPE_OVS_PORT, NULL);
+}
+
+static void
+_bridge_modify(NMOvsdb *self, const char *key, json_t *row)
+{
+    NMOvsdbPrivate *   priv = NM_OVSDB_GET_PRIVATE(self);
+    OpenvswitchBridge *ovs_bridge;
+    const char *       name;
+    json_t *           value;
+    gboolean           renamed;
+    gboolean           changed;
+
+    ovs_bridge = g_hash_table_lookup(priv->bridges, &key);
+    if (!ovs_bridge) {
+        _LOGD("obj[bridge:%s]: modification of unknown bridge", key);
+        return;
+    }
+
+    name    = json_string_value(json_object_get(row, "name"));
+    renamed = name && !nm_streq0(name, ovs_bridge->name);
+
+    if (renamed) {
+        _signal_emit_device_removed(self, ovs_bridge->name, NM_DEVICE_TYPE_OVS_BRIDGE, NULL);
+        nm_utils_strdup_reset(&ovs_bridge->name, name);
+    }
+
+    changed = renamed;
+
+    value = json_object_get(row, "ports");
+    if (value && _uuids_apply_diff(ovs_bridge->ports, value))
+        changed = TRUE;
+
+    value = json_object_get(row, "external_ids");
+    if (value && _external_ids_apply_diff(&ovs_bridge->external_ids, value)) {
+        nm_utils_strdup_reset(&ovs_bridge->connection_uuid,
+                              _external_ids_get_connection_uuid(ovs_bridge->external_ids));
+        changed = TRUE;
+    }
+
+    if (changed) {
+        gs_free char *strtmp = NULL;
+
+        _LOGT("obj[bridge:%s]: changed a bridge: %s%s%s, external-ids=%s",
+              key,
+              ovs_bridge->name,
+              NM_PRINT_FMT_QUOTED2(ovs_bridge->connection_uuid,
+                                   ", ",
+                                   ovs_bridge->connection_uuid,
+                                   ""),
+              (strtmp = _external_ids_to_string(ovs_bridge->external_ids)));
+    }
+
+    if (renamed)
+        _signal_emit_device_added(self, ovs_bridge->name, NM_DEVICE_TYPE_OVS_BRIDGE, NULL);
+}
+
+/*****************************************************************************/
+
+static void
+_db_uuid_update(NMOvsdb *self, json_t *ovs)
+{
+    NMOvsdbPrivate *priv = NM_OVSDB_GET_PRIVATE(self);
+    const char *    s;
+
+    s = json_object_iter_key(json_object_iter(ovs));
+    if (s)
+        nm_utils_strdup_reset(&priv->db_uuid, s);
+}
+
+/**
+ * ovsdb_got_update:
+ *
+ * Called when we've got an "update" method call (we asked for it with the monitor
+ * command). We use it to maintain a consistent view of bridge list regardless of
+ * whether the changes are done by us or externally.
+ */
+static void
+ovsdb_got_update(NMOvsdb *self, json_t *msg)
+{
+    json_t *     ovs       = NULL;
+    json_t *     bridge    = NULL;
+    json_t *     port      = NULL;
+    json_t *     interface = NULL;
+    json_error_t json_error = {
+        0,
+    };
+    const char *key;
+    json_t *    value;
+
+    if (json_unpack_ex(msg,
+                       &json_error,
+                       0,
+                       "{s?:o, s?:o, s?:o, s?:o}",
+                       "Open_vSwitch",
+                       &ovs,
+                       "Bridge",
+                       &bridge,
+                       "Port",
+                       &port,
+                       "Interface",
+                       &interface)
+        == -1) {
+        /* This doesn't really have to be an error; the key might
+         * be missing if there really are no bridges present. */
+        _LOGD("Bad update: %s", json_error.text);
+    }
+
+    if (ovs)
+        _db_uuid_update(self, ovs);
+
+    json_object_foreach (interface, key, value)
+        _interface_update(self, key, value);
+
+    json_object_foreach (port, key, value)
+        _port_update(self, key, value);
+
+    json_object_foreach (bridge, key, value)
+        _bridge_update(self, key, value);
+}
+
+/**
+ * _row_fill_defaults:
+ *
+ * In the "update2" format, "initial" and "insert" rows omit the columns that
+ * have their default value. Return a copy of @row with the given @columns
+ * added back, so that it can be parsed like a row of the "update" format.
+ */
+static json_t *
+_row_fill_defaults(json_t *row, const char *const *columns)
+{
+    json_t *filled;
+
+    filled = json_copy(row);
+    for (; *columns; columns++) {
+        json_t *value;
+
+        if (json_object_get(filled, *columns))
+            continue;
+
+        if (NM_IN_STRSET(*columns, "name", "type"))
+            value = json_string("");
+        else if (nm_streq(*columns, "external_ids"))
+            value = json_pack("[s, []]", "map");
+        else
+            value = json_pack("[s, []]", "set");
+        json_object_set_new(filled, *columns, value);
+    }
+    return filled;
+}
+
+/**
+ * ovsdb_got_update2:
+ *
+ * Like ovsdb_got_update(), but for the "update2" format used by the replies
+ * to "monitor_cond_since" and by "update3" notifications. Instead of full
+ * rows, modifications only contain the difference to the previous content,
+ * so that a change to a bridge with many ports doesn't require to parse all
+ * its ports again.
+ */
+static void
+ovsdb_got_update2(NMOvsdb *self, json_t *msg)
+{
+    static const struct {
+        const char *table;
+        const char *columns[4];
+        void (*update)(NMOvsdb *self, const char *key, json_t *value);
+        void (*modify)(NMOvsdb *self, const char *key, json_t *row);
+        void (*remove)(NMOvsdb *self, const char *key);
+    } tables[] = {
+        {
+            "Interface",
+            {"name", "type", "external_ids", NULL},
+            _interface_update,
+            _interface_modify,
+            _interface_remove,
+        },
+        {
+            "Port",
+            {"name", "interfaces", "external_ids", NULL},
+            _port_update,
+            _port_modify,
+            _port_remove,
+        },
+        {
+            "Bridge",
+            {"name", "ports", "external_ids", NULL},
+            _bridge_update,
+            _bridge_modify,
+            _bridge_remove,
+        },
+    };
+    json_t *    ovs;
+    json_t *    rows;
+    const char *key;
+    json_t *    value;
+    int         i;
+
+    ovs = json_object_get(msg, "Open_vSwitch");
+    if (ovs)
+        _db_uuid_update(self, ovs);
+
+    for (i = 0; i < (int) G_N_ELEMENTS(tables); i++) {
+        rows = json_object_get(msg, tables[i].table);
+        json_object_foreach (rows, key, value) {
+            json_t *row;
+
+            if ((row = json_object_get(value, "initial"))
+                || (row = json_object_get(value, "insert"))) {
+                nm_auto_decref_json json_t *update = NULL;
+
+                update = json_pack("{s:o}", "new", _row_fill_defaults(row, tables[i].columns));
+                tables[i].update(self, key, update);
+            } else if ((row = json_object_get(value, "modify")))
+                tables[i].modify(self, key, row);
+            else if (json_object_get(value, "delete"))
+                tables[i].remove(self, key);
         }
     }
 }
@@ -1953,6 +2599,35 @@ ovsdb_got_echo(NMOvsdb *self, json_int_t id, json_t *data)
         ovsdb_write(self);
 }
 
+static OvsdbMethodCall *
+_calls_find_by_id(NMOvsdb *self, json_int_t id)
+{
+    NMOvsdbPrivate * priv = NM_OVSDB_GET_PRIVATE(self);
+    OvsdbMethodCall *call;
+
+    /* The calls that were sent are at the head of the queue. */
+    c_list_for_each_entry (call, &priv->calls_lst_head, calls_lst) {
+        if (call->call_id == CALL_ID_UNSPEC)
+            break;
+        if (call->call_id == (guint64) id)
+            return call;
+    }
+    return NULL;
+}
+
+static gboolean
+_transact_result_has_error(json_t *result)
+{
+    size_t  index;
+    json_t *value;
+
+    json_array_foreach (result, index, value) {
+        if (json_is_object(value) && json_object_get(value, "error"))
+            return TRUE;
+    }
+    return FALSE;
+}
+
 /**
  * ovsdb_got_msg::
  *
@@ -2007,6 +2682,13 @@ ovsdb_got_msg(NMOvsdb *self, json_t *msg)
         if (nm_streq0(method, "update")) {
             /* This is a update method call. */
             ovsdb_got_update(self, json_array_get(params, 1));
+        } else if (nm_streq0(method, "update3")) {
+            /* An update for "monitor_cond_since", with the transaction ID. */
+            const char *txn_id = json_string_value(json_array_get(params, 1));
+
+            if (txn_id)
+                nm_utils_strdup_reset(&priv->last_txn_id, txn_id);
+            ovsdb_got_update2(self, json_array_get(params, 2));
         } else if (nm_streq0(method, "echo")) {
             /* This is an echo request. */
             ovsdb_got_echo(self, id, params);
@@ -2018,23 +2700,19 @@ ovsdb_got_msg(NMOvsdb *self, json_t *msg)
 
     if (id >= 0) {
         OvsdbMethodCall *call;
+        OvsdbMethodCall *iter;
         gs_free_error GError *local      = NULL;
         gs_free char *        msg_as_str = NULL;
+        guint                 n_batch    = 0;
+        gboolean              in_flight  = FALSE;
 
         /* This is a response to a method call. */
-        if (c_list_is_empty(&priv->calls_lst_head)) {
+        call = _calls_find_by_id(self, id);
+        if (!call) {
             _LOGE("there are no queued calls expecting response %" G_GUINT64_FORMAT, (guint64) id);
             ovsdb_disconnect(self, FALSE, FALSE);
             return;
         }
-        call = c_list_first_entry(&priv->calls_lst_head, OvsdbMethodCall, calls_lst);
-        if (call->call_id != id) {
-            _LOGE("expected a response to call %" G_GUINT64_FORMAT ", not %" G_GUINT64_FORMAT,
-                  call->call_id,
-                  (guint64) id);
-            ovsdb_disconnect(self, FALSE, FALSE);
-            return;
-        }
         /* Cool, we found a corresponding call. Finish it. */
 
         _LOGT_call(call, "response: %s", (msg_as_str = json_dumps(msg, 0)));
@@ -2048,7 +2726,32 @@ ovsdb_got_msg(NMOvsdb *self, json_t *msg)
                         json_string_value(error));
         }
 
-        _call_complete(call, result, local);
+        c_list_for_each_entry (iter, &priv->calls_lst_head, calls_lst) {
+            if (iter->call_id == CALL_ID_UNSPEC)
+                break;
+            if (iter->call_id == (guint64) id)
+                n_batch++;
+            else
+                in_flight = TRUE;
+        }
+
+        if (n_batch > 1 && !in_flight && (local || _transact_result_has_error(result))) {
+            /* A transaction is atomic, so one failing operation fails the
+             * calls that were merged with it. Retry them one by one. As no
+             * other call is pending, this doesn't reorder the calls. */
+            _LOGT_call(call, "batch of %u calls failed, retry them separately", n_batch);
+            c_list_for_each_entry (iter, &priv->calls_lst_head, calls_lst) {
+                if (iter->call_id != (guint64) id)
+                    break;
+                iter->call_id  = CALL_ID_UNSPEC;
+                iter->no_batch = TRUE;
+            }
+            ovsdb_next_command(self);
+            return;
+        }
+
+        while ((call = _calls_find_by_id(self, id)))
+            _call_complete(call, result, local);
 
         priv->num_failures = 0;
 
@@ -2178,7 +2881,10 @@ ovsdb_write_cb(GObject *source_object, GAsyncResult *res, gpointer user_data)
 
     g_string_erase(priv->output, 0, size);
 
-    ovsdb_write(self);
+    if (priv->output->len > 0)
+        ovsdb_write(self);
+    else
+        ovsdb_next_command(self);
 }
 
 static void
@@ -2232,10 +2938,8 @@ ovsdb_disconnect(NMOvsdb *self, gboolean retry, gboolean is_disposing)
      * shutting down, and cancel the remaining calls after the timeout. */
 
     if (retry) {
-        if (!c_list_is_empty(&priv->calls_lst_head)) {
-            call          = c_list_first_entry(&priv->calls_lst_head, OvsdbMethodCall, calls_lst);
+        c_list_for_each_entry (call, &priv->calls_lst_head, calls_lst)
             call->call_id = CALL_ID_UNSPEC;
-        }
     } else {
         gs_free_error GError *error = NULL;
 
@@ -2252,9 +2956,12 @@ ovsdb_disconnect(NMOvsdb *self, gboolean retry, gboolean is_disposing)
     g_string_truncate(priv->output, 0);
     g_clear_object(&priv->client);
     g_clear_object(&priv->conn);
-    nm_clear_g_free(&priv->db_uuid);
     nm_clear_g_cancellable(&priv->cancellable);
 
+    /* Keep the db_uuid along with last_txn_id. When the monitor resumes from the
+     * last transaction, the server only sends what changed since, which usually
+     * doesn't include the Open_vSwitch row. A full update sets it anew. */
+
     if (retry)
         ovsdb_try_connect(self);
 }
@@ -2332,17 +3039,60 @@ ovsdb_cleanup_initial_interfaces(NMOvsdb *self)
 static void
 _monitor_bridges_cb(NMOvsdb *self, json_t *result, GError *error, gpointer user_data)
 {
+    NMOvsdbPrivate *priv = NM_OVSDB_GET_PRIVATE(self);
+    json_t *        updates;
+    const char *    txn_id;
+    int             found;
+
     if (error) {
-        if (!nm_utils_error_is_cancelled_or_disposing(error)) {
-            _LOGI("%s", error->message);
-            ovsdb_disconnect(self, FALSE, FALSE);
+        if (nm_utils_error_is_cancelled_or_disposing(error))
+            return;
+
+        if (result && !priv->monitor_cond_since_unsupported) {
+            /* The server replied with an error. It probably doesn't know
+             * "monitor_cond_since" (added in Open vSwitch 2.12). Fall back to
+             * "monitor". */
+            _LOGD("monitor_cond_since failed (%s), use monitor instead", error->message);
+            priv->monitor_cond_since_unsupported = TRUE;
+            ovsdb_call_method(self,
+                              _monitor_bridges_cb,
+                              NULL,
+                              TRUE,
+                              OVSDB_MONITOR,
+                              OVSDB_METHOD_PAYLOAD_MONITOR());
+            return;
         }
+
+        _LOGI("%s", error->message);
+        ovsdb_disconnect(self, FALSE, FALSE);
         return;
     }
 
-    /* Treat the first response the same as the subsequent "update"
-     * messages we eventually get. */
-    ovsdb_got_update(self, result);
+    if (priv->monitor_cond_since_unsupported) {
+        /* The reply contains the full database, which might be missing objects
+         * that we still know from before a reconnect. Treat it otherwise the
+         * same as the subsequent "update" messages we eventually get. */
+        _prune_stale_objects(self, result);
+        ovsdb_got_update(self, result);
+    } else {
+        if (json_unpack(result, "[b, s, o]", &found, &txn_id, &updates) != 0) {
+            _LOGI("unexpected reply to monitor_cond_since");
+            ovsdb_disconnect(self, FALSE, FALSE);
+            return;
+        }
+
+        if (!found) {
+            /* The server doesn't know our last transaction and sent us the
+             * full content of the database. */
+            _prune_stale_objects(self, updates);
+        }
+        _LOGD("monitor: %s (last transaction %s)",
+              found ? "resumed from last transaction" : "got database content",
+              txn_id);
+
+        ovsdb_got_update2(self, updates);
+        nm_utils_strdup_reset(&priv->last_txn_id, txn_id);
+    }
 
     ovsdb_cleanup_initial_interfaces(self);
 }
@@ -2555,6 +3305,38 @@ nm_ovsdb_set_external_ids(NMOvsdb *                self,
 
 /*****************************************************************************/
 
+void
+_nmtst_ovsdb_got_update2(NMOvsdb *self, const char *msg_str)
+{
+    nm_auto_decref_json json_t *msg = NULL;
+    json_error_t                json_error;
+
+    g_return_if_fail(NM_IS_OVSDB(self));
+
+    msg = json_loads(msg_str, 0, &json_error);
+    g_return_if_fail(msg);
+
+    ovsdb_got_update2(self, msg);
+}
+
+void
+_nmtst_ovsdb_reconnect(NMOvsdb *self)
+{
+    g_return_if_fail(NM_IS_OVSDB(self));
+
+    ovsdb_disconnect(self, TRUE, FALSE);
+}
+
+const char *
+_nmtst_ovsdb_get_db_uuid(NMOvsdb *self)
+{
+    g_return_val_if_fail(NM_IS_OVSDB(self), NULL);
+
+    return NM_OVSDB_GET_PRIVATE(self)->db_uuid;
+}
+
+/*****************************************************************************/
+
 static void
 nm_ovsdb_init(NMOvsdb *self)
 {
@@ -2596,6 +3378,8 @@ dispose(GObject *object)
     nm_clear_pointer(&priv->bridges, g_hash_table_destroy);
     nm_clear_pointer(&priv->ports, g_hash_table_destroy);
     nm_clear_pointer(&priv->interfaces, g_hash_table_destroy);
+    nm_clear_g_free(&priv->db_uuid);
+    nm_clear_g_free(&priv->last_txn_id);
 
     G_OBJECT_CLASS(nm_ovsdb_parent_class)->dispose(object);
 }
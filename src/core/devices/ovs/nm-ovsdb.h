@@ -58,4 +58,8 @@ void nm_ovsdb_set_external_ids(NMOvsdb *                        self,
 
 gboolean nm_ovsdb_is_ready(NMOvsdb *self);
 
+void        _nmtst_ovsdb_got_update2(NMOvsdb *self, const char *msg_str);
+void        _nmtst_ovsdb_reconnect(NMOvsdb *self);
+const char *_nmtst_ovsdb_get_db_uuid(NMOvsdb *self);
+
 #endif /* __NETWORKMANAGER_OVSDB_H__ */
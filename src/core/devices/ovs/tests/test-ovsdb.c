@@ -0,0 +1,169 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "nm-default.h"
+
+#include "devices/ovs/nm-ovsdb.h"
+
+#include "nm-test-utils-core.h"
+
+/*****************************************************************************/
+
+static const char *
+_device_type_to_string(guint device_type)
+{
+    switch (device_type) {
+    case NM_DEVICE_TYPE_OVS_INTERFACE:
+        return "iface";
+    case NM_DEVICE_TYPE_OVS_PORT:
+        return "port";
+    case NM_DEVICE_TYPE_OVS_BRIDGE:
+        return "bridge";
+    }
+    g_assert_not_reached();
+    return NULL;
+}
+
+static void
+_device_added_cb(NMOvsdb *   ovsdb,
+                 const char *name,
+                 guint       device_type,
+                 const char *subtype,
+                 GPtrArray * events)
+{
+    g_ptr_array_add(events,
+                    g_strdup_printf("+%s:%s:%s",
+                                    _device_type_to_string(device_type),
+                                    name,
+                                    subtype ?: ""));
+}
+
+static void
+_device_removed_cb(NMOvsdb *   ovsdb,
+                   const char *name,
+                   guint       device_type,
+                   const char *subtype,
+                   GPtrArray * events)
+{
+    g_ptr_array_add(events,
+                    g_strdup_printf("-%s:%s:%s",
+                                    _device_type_to_string(device_type),
+                                    name,
+                                    subtype ?: ""));
+}
+
+static void
+_assert_events(GPtrArray *events, const char *const *expected)
+{
+    guint i;
+
+    for (i = 0; i < events->len; i++) {
+        g_assert(expected[i]);
+        g_assert_cmpstr(events->pdata[i], ==, expected[i]);
+    }
+    g_assert(!expected[i]);
+
+    g_ptr_array_set_size(events, 0);
+}
+
+static void
+test_update2(void)
+{
+    gs_unref_object NMOvsdb *ovsdb      = NULL;
+    gs_unref_ptrarray GPtrArray *events = NULL;
+
+    events = g_ptr_array_new_with_free_func(g_free);
+
+    ovsdb = g_object_new(NM_TYPE_OVSDB, NULL);
+    g_signal_connect(ovsdb, NM_OVSDB_DEVICE_ADDED, G_CALLBACK(_device_added_cb), events);
+    g_signal_connect(ovsdb, NM_OVSDB_DEVICE_REMOVED, G_CALLBACK(_device_removed_cb), events);
+
+    /* Rows of the "update2" format omit the columns that have their default
+     * value: an empty type, and empty external_ids, ports and interfaces. */
+    _nmtst_ovsdb_got_update2(
+        ovsdb,
+        "{"
+        "  \"Interface\": {\"i1\": {\"initial\": {\"name\": \"ovs0\"}}},"
+        "  \"Port\": {\"p1\": {\"initial\": {\"name\": \"ovs0\","
+        "                                    \"interfaces\": [\"uuid\", \"i1\"]}}},"
+        "  \"Bridge\": {\"b1\": {\"initial\": {\"name\": \"ovs0\","
+        "                                      \"ports\": [\"uuid\", \"p1\"]}}}"
+        "}");
+    _assert_events(events,
+                   NM_MAKE_STRV("+iface:ovs0:", "+port:ovs0:", "+bridge:ovs0:"));
+
+    _nmtst_ovsdb_got_update2(ovsdb,
+                             "{\"Interface\": {\"i2\": {\"insert\": {\"name\": \"eth1\"}}}}");
+    _assert_events(events, NM_MAKE_STRV("+iface:eth1:"));
+
+    /* Changing the type replaces the device. */
+    _nmtst_ovsdb_got_update2(
+        ovsdb,
+        "{\"Interface\": {\"i2\": {\"modify\": {\"type\": \"internal\"}}}}");
+    _assert_events(events, NM_MAKE_STRV("-iface:eth1:", "+iface:eth1:internal"));
+
+    /* Changing external-ids or the set of ports does not. */
+    _nmtst_ovsdb_got_update2(
+        ovsdb,
+        "{"
+        "  \"Interface\": {\"i2\": {\"modify\": {\"external_ids\": [\"map\", [[\"a\", \"b\"]]]}}},"
+        "  \"Bridge\": {\"b1\": {\"modify\": {\"ports\": [\"uuid\", \"p1\"]}}}"
+        "}");
+    _assert_events(events, NM_MAKE_STRV());
+
+    _nmtst_ovsdb_got_update2(ovsdb, "{\"Interface\": {\"i2\": {\"delete\": null}}}");
+    _assert_events(events, NM_MAKE_STRV("-iface:eth1:internal"));
+}
+
+static void
+test_resume_keeps_db_uuid(void)
+{
+    gs_unref_object NMOvsdb *ovsdb      = NULL;
+    gs_unref_ptrarray GPtrArray *events = NULL;
+
+    events = g_ptr_array_new_with_free_func(g_free);
+
+    ovsdb = g_object_new(NM_TYPE_OVSDB, NULL);
+    g_signal_connect(ovsdb, NM_OVSDB_DEVICE_ADDED, G_CALLBACK(_device_added_cb), events);
+    g_signal_connect(ovsdb, NM_OVSDB_DEVICE_REMOVED, G_CALLBACK(_device_removed_cb), events);
+
+    _nmtst_ovsdb_got_update2(
+        ovsdb,
+        "{"
+        "  \"Open_vSwitch\": {\"o1\": {\"initial\": {\"bridges\": [\"set\", []]}}},"
+        "  \"Interface\": {\"i1\": {\"initial\": {\"name\": \"eth0\"}}}"
+        "}");
+    _assert_events(events, NM_MAKE_STRV("+iface:eth0:"));
+    g_assert_cmpstr(_nmtst_ovsdb_get_db_uuid(ovsdb), ==, "o1");
+
+    /* After a reconnect, the monitor resumes from the last transaction. The
+     * update only has the rows that changed meanwhile, without the Open_vSwitch
+     * row. We still need its uuid to add or remove bridges. */
+    _nmtst_ovsdb_reconnect(ovsdb);
+    g_assert_cmpstr(_nmtst_ovsdb_get_db_uuid(ovsdb), ==, "o1");
+
+    _nmtst_ovsdb_got_update2(ovsdb,
+                             "{\"Interface\": {\"i2\": {\"insert\": {\"name\": \"eth1\"}}}}");
+    _assert_events(events, NM_MAKE_STRV("+iface:eth1:"));
+    g_assert_cmpstr(_nmtst_ovsdb_get_db_uuid(ovsdb), ==, "o1");
+
+    /* A full update for a recreated database brings a new uuid. */
+    _nmtst_ovsdb_got_update2(
+        ovsdb,
+        "{\"Open_vSwitch\": {\"o2\": {\"initial\": {\"bridges\": [\"set\", []]}}}}");
+    g_assert_cmpstr(_nmtst_ovsdb_get_db_uuid(ovsdb), ==, "o2");
+}
+
+/*****************************************************************************/
+
+NMTST_DEFINE();
+
+int
+main(int argc, char **argv)
+{
+    nmtst_init_assert_logging(&argc, &argv, "INFO", "DEFAULT");
+
+    g_test_add_func("/ovsdb/update2", test_update2);
+    g_test_add_func("/ovsdb/resume-keeps-db-uuid", test_resume_keeps_db_uuid);
+
+    return g_test_run();
+}
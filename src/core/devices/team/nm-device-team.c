@@ -41,6 +41,7 @@ typedef struct {
     guint              teamd_read_timeout;
     guint              teamd_dbus_watch;
     bool               kill_in_progress : 1;
+    bool               kernel_mode : 1;
     GFileMonitor *     usock_monitor;
     NMDeviceStageState stage1_state : 3;
 } NMDeviceTeamPrivate;
@@ -207,6 +208,13 @@ master_update_slave_connection(NMDevice *    self,
     const char *       iface            = nm_device_get_iface(self);
     const char *       iface_slave      = nm_device_get_iface(slave);
 
+    if (NM_DEVICE_TEAM_GET_PRIVATE(self)->kernel_mode) {
+        /* without teamd, the port has exactly the config that we applied. */
+        s_port = nm_device_get_applied_setting(slave, NM_TYPE_SETTING_TEAM_PORT);
+        port_config = g_strdup(s_port ? nm_setting_team_port_get_config(s_port) : NULL);
+        goto out;
+    }
+
     tdc = teamdctl_alloc();
     if (!tdc) {
         g_set_error(error,
@@ -250,6 +258,7 @@ master_update_slave_connection(NMDevice *    self,
         return FALSE;
     }
 
+out:
     s_port = nm_connection_get_setting_team_port(connection);
     if (!s_port) {
         s_port = (NMSettingTeamPort *) nm_setting_team_port_new();
@@ -718,6 +727,273 @@ teamd_start(NMDeviceTeam *self)
     return TRUE;
 }
 
+/*****************************************************************************/
+
+/* In kernel mode, NetworkManager configures the team driver directly over
+ * generic netlink and no teamd is spawned. That only works for runners that
+ * are implemented entirely by a kernel team mode and that don't need a
+ * user-space link watcher. activebackup, loadbalance and lacp select ports,
+ * compute tx hashes or speak LACP in teamd, so they always use teamd. */
+
+#define KERNEL_MODE_MAX_OPTIONS 5
+
+static gboolean
+_kernel_mode_enabled(NMDeviceTeam *self)
+{
+    return nm_config_data_get_device_config_boolean(NM_CONFIG_GET_DATA,
+                                                    NM_CONFIG_KEYFILE_KEY_DEVICE_TEAM_KERNEL_MODE,
+                                                    NM_DEVICE(self),
+                                                    FALSE,
+                                                    FALSE);
+}
+
+static gboolean
+_kernel_mode_link_watch_ok(json_t *link_watch)
+{
+    const char *key;
+    json_t *    value;
+
+    if (json_is_array(link_watch)) {
+        if (json_array_size(link_watch) == 0)
+            return TRUE;
+        if (json_array_size(link_watch) > 1)
+            return FALSE;
+        link_watch = json_array_get(link_watch, 0);
+    }
+
+    if (!json_is_object(link_watch))
+        return FALSE;
+
+    /* The kernel follows the carrier of the ports, which is what teamd's
+     * ethtool watcher does when it has no delays. */
+    json_object_foreach (link_watch, key, value) {
+        if (nm_streq(key, "name")) {
+            if (!json_is_string(value) || !nm_streq(json_string_value(value), "ethtool"))
+                return FALSE;
+        } else if (NM_IN_STRSET(key, "delay_up", "delay_down")) {
+            if (!json_is_integer(value) || json_integer_value(value) != 0)
+                return FALSE;
+        } else
+            return FALSE;
+    }
+    return TRUE;
+}
+
+/* Fills @options with the team driver options for @config. Returns FALSE
+ * if @config needs teamd. */
+static gboolean
+_kernel_mode_get_options(const char *          config,
+                         NMPlatformTeamOption *options,
+                         guint *               out_n_options)
+{
+    static const struct {
+        const char *object;
+        const char *key;
+        const char *option;
+    } counters[] = {
+        {"notify_peers", "count", "notify_peers_count"},
+        {"notify_peers", "interval", "notify_peers_interval"},
+        {"mcast_rejoin", "count", "mcast_rejoin_count"},
+        {"mcast_rejoin", "interval", "mcast_rejoin_interval"},
+    };
+    nm_auto_decref_json json_t *json = NULL;
+    json_error_t                jerror;
+    const char *                key;
+    json_t *                    value;
+    const char *                mode = NM_SETTING_TEAM_RUNNER_ROUNDROBIN;
+    guint                       n    = 0;
+    guint                       i;
+
+    G_STATIC_ASSERT_EXPR(G_N_ELEMENTS(counters) + 1 == KERNEL_MODE_MAX_OPTIONS);
+
+    json = json_loads(config ?: "{}", JSON_REJECT_DUPLICATES, &jerror);
+    if (!json || !json_is_object(json))
+        return FALSE;
+
+    json_object_foreach (json, key, value) {
+        if (nm_streq(key, "device"))
+            continue;
+        if (nm_streq(key, "runner")) {
+            const char *runner_key;
+            json_t *    runner_value;
+
+            if (!json_is_object(value))
+                return FALSE;
+            json_object_foreach (value, runner_key, runner_value) {
+                if (!nm_streq(runner_key, "name") || !json_is_string(runner_value))
+                    return FALSE;
+                mode = json_string_value(runner_value);
+            }
+            continue;
+        }
+        if (nm_streq(key, "link_watch")) {
+            if (!_kernel_mode_link_watch_ok(value))
+                return FALSE;
+            continue;
+        }
+        if (NM_IN_STRSET(key, "notify_peers", "mcast_rejoin")) {
+            const char *sub_key;
+            json_t *    sub_value;
+
+            if (!json_is_object(value))
+                return FALSE;
+            json_object_foreach (value, sub_key, sub_value) {
+                if (!NM_IN_STRSET(sub_key, "count", "interval") || !json_is_integer(sub_value)
+                    || json_integer_value(sub_value) < 0
+                    || json_integer_value(sub_value) > G_MAXUINT32)
+                    return FALSE;
+            }
+            continue;
+        }
+        return FALSE;
+    }
+
+    if (nm_streq(mode, NM_SETTING_TEAM_RUNNER_BROADCAST))
+        mode = NM_SETTING_TEAM_RUNNER_BROADCAST;
+    else if (nm_streq(mode, NM_SETTING_TEAM_RUNNER_ROUNDROBIN))
+        mode = NM_SETTING_TEAM_RUNNER_ROUNDROBIN;
+    else if (nm_streq(mode, NM_SETTING_TEAM_RUNNER_RANDOM))
+        mode = NM_SETTING_TEAM_RUNNER_RANDOM;
+    else
+        return FALSE;
+
+    options[n++] = (NMPlatformTeamOption){
+        .name     = "mode",
+        .type     = NM_PLATFORM_TEAM_OPTION_TYPE_STRING,
+        .v_string = mode,
+    };
+
+    for (i = 0; i < G_N_ELEMENTS(counters); i++) {
+        value = json_object_get(json, counters[i].object);
+        if (!value || !(value = json_object_get(value, counters[i].key)))
+            continue;
+        options[n++] = (NMPlatformTeamOption){
+            .name  = counters[i].option,
+            .type  = NM_PLATFORM_TEAM_OPTION_TYPE_U32,
+            .v_u32 = json_integer_value(value),
+        };
+    }
+
+    *out_n_options = n;
+    return TRUE;
+}
+
+static gboolean
+_kernel_mode_set_port_options(NMDeviceTeam *self, NMDevice *slave, const char *port_config)
+{
+    NMPlatformTeamOption        options[2];
+    nm_auto_decref_json json_t *json = NULL;
+    json_error_t                jerror;
+    const char *                key;
+    json_t *                    value;
+    guint                       n = 0;
+    int                         r;
+
+    json = json_loads(port_config, JSON_REJECT_DUPLICATES, &jerror);
+    if (!json || !json_is_object(json)) {
+        _LOGW(LOGD_TEAM,
+              "team port %s has an invalid config: %s",
+              nm_device_get_ip_iface(slave),
+              jerror.text);
+        return FALSE;
+    }
+
+    json_object_foreach (json, key, value) {
+        if (nm_streq(key, "prio") && json_is_integer(value)) {
+            options[n++] = (NMPlatformTeamOption){
+                .name         = "priority",
+                .port_ifindex = nm_device_get_ip_ifindex(slave),
+                .type         = NM_PLATFORM_TEAM_OPTION_TYPE_S32,
+                .v_s32        = json_integer_value(value),
+            };
+        } else if (nm_streq(key, "queue_id") && json_is_integer(value)
+                   && json_integer_value(value) >= 0) {
+            options[n++] = (NMPlatformTeamOption){
+                .name         = "queue_id",
+                .port_ifindex = nm_device_get_ip_ifindex(slave),
+                .type         = NM_PLATFORM_TEAM_OPTION_TYPE_U32,
+                .v_u32        = json_integer_value(value),
+            };
+        } else {
+            /* the remaining port options only matter for runners implemented
+             * in teamd. */
+            _LOGD(LOGD_TEAM,
+                  "team port %s: ignore option \"%s\" in kernel mode",
+                  nm_device_get_ip_iface(slave),
+                  key);
+        }
+    }
+
+    if (n == 0)
+        return TRUE;
+
+    r = nm_platform_link_team_set_options(nm_device_get_platform(NM_DEVICE(self)),
+                                          nm_device_get_ip_ifindex(NM_DEVICE(self)),
+                                          options,
+                                          n);
+    if (r < 0) {
+        _LOGW(LOGD_TEAM,
+              "failed to update config for port %s: %s",
+              nm_device_get_ip_iface(slave),
+              nm_strerror(r));
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static NMActStageReturn
+_kernel_mode_prepare(NMDeviceTeam *       self,
+                     NMSettingTeam *      s_team,
+                     NMDeviceStateReason *out_failure_reason)
+{
+    NMDeviceTeamPrivate *priv   = NM_DEVICE_TEAM_GET_PRIVATE(self);
+    NMDevice *           device = NM_DEVICE(self);
+    NMPlatformTeamOption options[KERNEL_MODE_MAX_OPTIONS];
+    const char *         config = nm_setting_team_get_config(s_team);
+    guint                n_options;
+    int                  r;
+
+    if (!_kernel_mode_get_options(config, options, &n_options))
+        return NM_ACT_STAGE_RETURN_POSTPONE;
+
+    /* The mode can only be changed while the team has no ports, and like
+     * teamd, we set it with the device down. */
+    nm_device_take_down(device, TRUE);
+    r = nm_platform_link_team_set_options(nm_device_get_platform(device),
+                                          nm_device_get_ifindex(device),
+                                          options,
+                                          n_options);
+    if (r < 0) {
+        nm_device_bring_up(device, TRUE, NULL);
+        _LOGD(LOGD_TEAM,
+              "kernel mode: cannot configure team driver (%s), use teamd",
+              nm_strerror(r));
+        return NM_ACT_STAGE_RETURN_POSTPONE;
+    }
+
+    if (!nm_device_hw_addr_set_cloned(device, nm_device_get_applied_connection(device), FALSE)) {
+        nm_device_bring_up(device, TRUE, NULL);
+        NM_SET_OUT(out_failure_reason, NM_DEVICE_STATE_REASON_CONFIG_FAILED);
+        return NM_ACT_STAGE_RETURN_FAILURE;
+    }
+    nm_device_bring_up(device, TRUE, NULL);
+
+    _LOGI(LOGD_TEAM, "Activation: (team) configured team driver without teamd");
+
+    priv->kernel_mode  = TRUE;
+    priv->stage1_state = NM_DEVICE_STAGE_STATE_COMPLETED;
+
+    if (!nm_streq0(config, priv->config)) {
+        g_free(priv->config);
+        priv->config = g_strdup(config ?: "");
+        _notify(self, PROP_CONFIG);
+    }
+
+    return NM_ACT_STAGE_RETURN_SUCCESS;
+}
+
+/*****************************************************************************/
+
 static NMActStageReturn
 act_stage1_prepare(NMDevice *device, NMDeviceStateReason *out_failure_reason)
 {
@@ -745,6 +1021,15 @@ act_stage1_prepare(NMDevice *device, NMDeviceStateReason *out_failure_reason)
     if (priv->stage1_state == NM_DEVICE_STAGE_STATE_COMPLETED)
         return NM_ACT_STAGE_RETURN_SUCCESS;
 
+    if (!priv->tdc && !priv->teamd_pid && !priv->kill_in_progress && _kernel_mode_enabled(self)) {
+        NMActStageReturn ret;
+
+        /* POSTPONE means that the profile needs teamd. */
+        ret = _kernel_mode_prepare(self, s_team, out_failure_reason);
+        if (ret != NM_ACT_STAGE_RETURN_POSTPONE)
+            return ret;
+    }
+
     priv->stage1_state = NM_DEVICE_STAGE_STATE_PENDING;
 
     if (priv->tdc) {
@@ -796,6 +1081,12 @@ deactivate(NMDevice *device)
     if (nm_device_sys_iface_state_is_external(device))
         return;
 
+    if (priv->kernel_mode) {
+        /* no teamd to stop. The ports are released by NMDevice. */
+        priv->kernel_mode = FALSE;
+        return;
+    }
+
     if (priv->teamd_pid || priv->tdc)
         _LOGI(LOGD_TEAM, "deactivation: stopping teamd...");
 
@@ -817,44 +1108,78 @@ enslave_slave(NMDevice *device, NMDevice *slave, NMConnection *connection, gbool
     nm_device_master_check_slave_physical_port(device, slave, LOGD_TEAM);
 
     if (configure) {
+        const char *config = NULL;
+
         nm_device_take_down(slave, TRUE);
 
         s_team_port = nm_connection_get_setting_team_port(connection);
-        if (s_team_port) {
-            const char *config = nm_setting_team_port_get_config(s_team_port);
-
-            if (config) {
-                if (!priv->tdc) {
-                    _LOGW(LOGD_TEAM,
-                          "enslaved team port %s config not changed, not connected to teamd",
-                          slave_iface);
-                } else {
-                    int   err;
-                    char *sanitized_config;
-
-                    sanitized_config = g_strdelimit(g_strdup(config), "\r\n", ' ');
-                    err = teamdctl_port_config_update_raw(priv->tdc, slave_iface, sanitized_config);
-                    g_free(sanitized_config);
-                    if (err != 0) {
-                        _LOGE(LOGD_TEAM,
-                              "failed to update config for port %s (err=%d)",
-                              slave_iface,
-                              err);
-                        return FALSE;
-                    }
+        if (s_team_port)
+            config = nm_setting_team_port_get_config(s_team_port);
+
+        if (config && !priv->kernel_mode) {
+            if (!priv->tdc) {
+                _LOGW(LOGD_TEAM,
+                      "enslaved team port %s config not changed, not connected to teamd",
+                      slave_iface);
+            } else {
+                int   err;
+                char *sanitized_config;
+
+                sanitized_config = g_strdelimit(g_strdup(config), "\r\n", ' ');
+                err = teamdctl_port_config_update_raw(priv->tdc, slave_iface, sanitized_config);
+                g_free(sanitized_config);
+                if (err != 0) {
+                    _LOGE(LOGD_TEAM,
+                          "failed to update config for port %s (err=%d)",
+                          slave_iface,
+                          err);
+                    return FALSE;
                 }
             }
         }
+
         success = nm_platform_link_enslave(nm_device_get_platform(device),
                                            nm_device_get_ip_ifindex(device),
                                            nm_device_get_ip_ifindex(slave));
+
+        if (success && priv->kernel_mode) {
+            gconstpointer hwaddr;
+            size_t        hwaddr_len = 0;
+
+            /* teamd's runners give all ports the address of the team. The kernel
+             * remembers the address that the port has when it gets enslaved, and
+             * restores it on release. So only change it now. */
+            hwaddr = nm_platform_link_get_address(nm_device_get_platform(device),
+                                                  nm_device_get_ip_ifindex(device),
+                                                  &hwaddr_len);
+            if (hwaddr && hwaddr_len > 0) {
+                nm_platform_link_set_address(nm_device_get_platform(device),
+                                             nm_device_get_ip_ifindex(slave),
+                                             hwaddr,
+                                             hwaddr_len);
+            }
+
+            /* The kernel only has options for interfaces that are ports already.
+             * Don't leave behind a port without its priority and queue. */
+            if (config && !_kernel_mode_set_port_options(self, slave, config)) {
+                if (!nm_platform_link_release(nm_device_get_platform(device),
+                                              nm_device_get_ip_ifindex(device),
+                                              nm_device_get_ip_ifindex(slave))) {
+                    _LOGW(LOGD_TEAM, "failed to release team port %s", slave_iface);
+                }
+                success = FALSE;
+            }
+        }
+
         nm_device_bring_up(slave, TRUE, NULL);
 
         if (!success)
             return FALSE;
 
-        nm_clear_g_source(&priv->teamd_read_timeout);
-        priv->teamd_read_timeout = g_timeout_add_seconds(5, teamd_read_timeout_cb, self);
+        if (!priv->kernel_mode) {
+            nm_clear_g_source(&priv->teamd_read_timeout);
+            priv->teamd_read_timeout = g_timeout_add_seconds(5, teamd_read_timeout_cb, self);
+        }
 
         _LOGI(LOGD_TEAM, "enslaved team port %s", slave_iface);
     } else
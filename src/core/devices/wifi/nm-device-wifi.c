@@ -49,6 +49,10 @@
 #define SCAN_INTERVAL_SEC_STEP 20
 #define SCAN_INTERVAL_SEC_MAX  120
 
+/* the number of periodic scans restricted to known channels between two
+ * full scans. */
+#define SCAN_TARGETED_MAX 3
+
 #define SCAN_EXTRA_DELAY_MSEC 500
 
 #define SCAN_RAND_MAC_ADDRESS_EXPIRE_SEC (5 * 60)
@@ -92,6 +96,13 @@ typedef struct {
     GHashTable *scan_request_ssids_hash;
     CList       scan_request_ssids_lst_head;
 
+    /* channels where networks with a profile were seen (NMWifiScanFreq). */
+    GArray *scan_freqs;
+
+    /* the SSIDs of the infrastructure Wi-Fi profiles, see
+     * nm_wifi_utils_scan_freqs_update(). */
+    GHashTable *scan_profiles;
+
     NMActRequestGetSecretsCallId *wifi_secrets_id;
 
     NMSupplicantManager *        sup_mgr;
@@ -107,6 +118,8 @@ typedef struct {
 
     guint ap_dump_id;
 
+    guint recheck_available_connections_id;
+
     guint periodic_update_id;
 
     guint link_timeout_id;
@@ -126,6 +139,7 @@ typedef struct {
     guint32 rate;
 
     guint8 scan_periodic_interval_sec;
+    guint8 scan_targeted_count;
 
     bool enabled : 1; /* rfkilled or not */
     bool scan_is_scanning : 1;
@@ -134,6 +148,8 @@ typedef struct {
     bool scan_explicit_requested : 1;
     bool ssid_found : 1;
     bool hidden_probe_scan_warn : 1;
+    bool scan_request_full : 1;
+    bool scan_profiles_dirty : 1;
 
 } NMDeviceWifiPrivate;
 
@@ -203,6 +219,8 @@ static void _scan_kickoff(NMDeviceWifi *self);
 
 static gboolean _scan_notify_allowed(NMDeviceWifi *self, NMTernary do_kickoff);
 
+static gboolean _scan_freqs_update(NMDeviceWifi *self, gboolean do_age);
+
 /*****************************************************************************/
 
 typedef struct {
@@ -448,6 +466,13 @@ _scan_notify_is_scanning(NMDeviceWifi *self)
           scanning ? "scanning" : "idle",
           last_scan_changed ? " (notify last-scan)" : "");
 
+    if (!scanning) {
+        /* Only a scan over all channels tells us that known networks are
+         * gone from a channel. */
+        _scan_freqs_update(self, priv->scan_request_full);
+        priv->scan_request_full = FALSE;
+    }
+
     state = nm_device_get_state(NM_DEVICE(self));
 
     if (scanning) {
@@ -825,6 +850,31 @@ ap_add_remove(NMDeviceWifi *self,
         nm_device_recheck_available_connections(NM_DEVICE(self));
 }
 
+static gboolean
+_recheck_available_connections_cb(gpointer user_data)
+{
+    NMDeviceWifi *       self = user_data;
+    NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE(self);
+
+    priv->recheck_available_connections_id = 0;
+    nm_device_recheck_available_connections(NM_DEVICE(self));
+    nm_device_emit_recheck_auto_activate(NM_DEVICE(self));
+    return G_SOURCE_REMOVE;
+}
+
+static void
+_recheck_available_connections_schedule(NMDeviceWifi *self)
+{
+    NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE(self);
+
+    /* A scan result can add or remove hundreds of BSSs in a row. Checking all
+     * profiles against all APs for each of them is expensive, so do it once
+     * after the batch. */
+    if (!priv->recheck_available_connections_id)
+        priv->recheck_available_connections_id =
+            g_idle_add(_recheck_available_connections_cb, self);
+}
+
 static void
 remove_all_aps(NMDeviceWifi *self)
 {
@@ -839,6 +889,7 @@ remove_all_aps(NMDeviceWifi *self)
     while ((ap = c_list_first_entry(&priv->aps_lst_head, NMWifiAP, aps_lst)))
         ap_add_remove(self, FALSE, ap, FALSE);
 
+    nm_clear_g_source(&priv->recheck_available_connections_id);
     nm_device_recheck_available_connections(NM_DEVICE(self));
 }
 
@@ -1543,6 +1594,140 @@ hidden_filter_func(NMSettings *settings, NMSettingsConnection *set_con, gpointer
     return nm_setting_wireless_get_hidden(s_wifi);
 }
 
+static void
+_scan_profiles_sync(NMDeviceWifi *self)
+{
+    NMDeviceWifiPrivate *        priv = NM_DEVICE_WIFI_GET_PRIVATE(self);
+    NMSettingsConnection *const *connections;
+    GHashTable *                 scan_profiles;
+    guint                        i;
+
+    if (!priv->scan_profiles_dirty)
+        return;
+
+    priv->scan_profiles_dirty = FALSE;
+
+    /* keep the misses of profiles whose SSID didn't change. */
+    scan_profiles = g_hash_table_new_full(nm_gbytes_hash,
+                                          nm_gbytes_equal,
+                                          (GDestroyNotify) g_bytes_unref,
+                                          NULL);
+
+    connections = nm_settings_get_connections(nm_device_get_settings((NMDevice *) self), NULL);
+    for (i = 0; connections[i]; i++) {
+        NMConnection *     connection = nm_settings_connection_get_connection(connections[i]);
+        NMSettingWireless *s_wifi;
+        GBytes *           ssid;
+
+        if (!nm_connection_is_type(connection, NM_SETTING_WIRELESS_SETTING_NAME))
+            continue;
+        s_wifi = nm_connection_get_setting_wireless(connection);
+        if (!s_wifi
+            || !NM_IN_STRSET(nm_setting_wireless_get_mode(s_wifi),
+                             NULL,
+                             NM_SETTING_WIRELESS_MODE_INFRA))
+            continue;
+        ssid = nm_setting_wireless_get_ssid(s_wifi);
+        if (!ssid || g_hash_table_contains(scan_profiles, ssid))
+            continue;
+
+        g_hash_table_insert(scan_profiles,
+                            g_bytes_ref(ssid),
+                            priv->scan_profiles ? g_hash_table_lookup(priv->scan_profiles, ssid)
+                                                : NULL);
+    }
+
+    nm_g_hash_table_unref(priv->scan_profiles);
+    priv->scan_profiles = scan_profiles;
+}
+
+static void
+_scan_profiles_changed_cb(NMSettings *settings, NMSettingsConnection *sett_conn, NMDeviceWifi *self)
+{
+    NM_DEVICE_WIFI_GET_PRIVATE(self)->scan_profiles_dirty = TRUE;
+}
+
+static void
+_scan_profiles_updated_cb(NMSettings *          settings,
+                          NMSettingsConnection *sett_conn,
+                          guint                 update_reason_u,
+                          NMDeviceWifi *        self)
+{
+    NM_DEVICE_WIFI_GET_PRIVATE(self)->scan_profiles_dirty = TRUE;
+}
+
+static gboolean
+_scan_freqs_update(NMDeviceWifi *self, gboolean do_age)
+{
+    NMDeviceWifiPrivate *priv      = NM_DEVICE_WIFI_GET_PRIVATE(self);
+    gs_free GBytes **    bss_ssids = NULL;
+    gs_free guint32 *    bss_freqs = NULL;
+    guint                n_bss;
+    NMWifiAP *           ap;
+    guint                i;
+
+    _scan_profiles_sync(self);
+
+    n_bss     = c_list_length(&priv->aps_lst_head);
+    bss_ssids = g_new(GBytes *, n_bss);
+    bss_freqs = g_new(guint32, n_bss);
+    i         = 0;
+    c_list_for_each_entry (ap, &priv->aps_lst_head, aps_lst) {
+        bss_ssids[i] = nm_wifi_ap_get_ssid(ap);
+        bss_freqs[i] = nm_wifi_ap_get_freq(ap);
+        i++;
+    }
+
+    return nm_wifi_utils_scan_freqs_update(priv->scan_freqs,
+                                           priv->scan_profiles,
+                                           do_age,
+                                           (GBytes *const *) bss_ssids,
+                                           bss_freqs,
+                                           n_bss);
+}
+
+static guint32 *
+_scan_freqs_build_targeted(NMDeviceWifi *self, gboolean is_explicit, guint *out_len)
+{
+    NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE(self);
+    guint32 *            freqs;
+    guint                n_freqs;
+    guint                i;
+    guint                j;
+
+    *out_len = 0;
+
+    /* explicit scans are requested by a user who wants to see everything.
+     * Periodic scans mostly look for networks we can connect to, so most of
+     * them only cover the channels where such networks were seen before.
+     * But while a profile has no network in the scan results (e.g. because
+     * it is hidden, or was just added), we don't know where to look for it,
+     * and scan all channels until a few full scans missed it too. */
+    if (is_explicit || priv->scan_targeted_count >= SCAN_TARGETED_MAX
+        || !_scan_freqs_update(self, FALSE) || priv->scan_freqs->len == 0) {
+        priv->scan_targeted_count = 0;
+        return NULL;
+    }
+
+    /* several networks can share a channel. */
+    freqs   = g_new(guint32, priv->scan_freqs->len);
+    n_freqs = 0;
+    for (i = 0; i < priv->scan_freqs->len; i++) {
+        guint32 freq = g_array_index(priv->scan_freqs, NMWifiScanFreq, i).freq;
+
+        for (j = 0; j < n_freqs; j++) {
+            if (freqs[j] == freq)
+                break;
+        }
+        if (j == n_freqs)
+            freqs[n_freqs++] = freq;
+    }
+
+    priv->scan_targeted_count++;
+    *out_len = n_freqs;
+    return freqs;
+}
+
 static GPtrArray *
 _scan_request_ssids_build_hidden(NMDeviceWifi *self,
                                  gint64        now_msec,
@@ -1699,6 +1884,8 @@ _scan_kickoff(NMDeviceWifi *self)
 {
     NMDeviceWifiPrivate *priv               = NM_DEVICE_WIFI_GET_PRIVATE(self);
     gs_unref_ptrarray GPtrArray *ssids      = NULL;
+    gs_free guint32 *            freqs      = NULL;
+    guint                        freqs_len;
     gboolean                     is_explict = FALSE;
     NMDeviceState                device_state;
     gboolean                     has_hidden_profiles;
@@ -1795,6 +1982,8 @@ _scan_kickoff(NMDeviceWifi *self)
     } else if (!is_explict)
         priv->hidden_probe_scan_warn = TRUE;
 
+    freqs = _scan_freqs_build_targeted(self, is_explict, &freqs_len);
+
     if (_LOGD_ENABLED(LOGD_WIFI)) {
         gs_free char *ssids_str = NULL;
         guint         ssids_len = 0;
@@ -1815,12 +2004,16 @@ _scan_kickoff(NMDeviceWifi *self)
             ssids_len = ssids->len;
         }
         _LOGD(LOGD_WIFI,
-              "wifi-scan: start %s scan (%u SSIDs to probe scan%s%s%s)",
+              "wifi-scan: start %s scan (%u SSIDs to probe scan%s%s%s, %s%s)",
               is_explict ? "explicit" : "periodic",
               ssids_len,
-              NM_PRINT_FMT_QUOTED(ssids_str, " [", ssids_str, "]", ""));
+              NM_PRINT_FMT_QUOTED(ssids_str, " [", ssids_str, "]", ""),
+              freqs ? nm_sprintf_bufa(30, "%u", freqs_len) : "all",
+              freqs_len == 1 ? " channel" : " channels");
     }
 
+    priv->scan_request_full = !freqs;
+
     priv->scan_last_request_started_at_msec = now_msec;
 
     if (is_explict)
@@ -1837,6 +2030,8 @@ _scan_kickoff(NMDeviceWifi *self)
     nm_supplicant_interface_request_scan(priv->sup_iface,
                                          ssids ? (GBytes *const *) ssids->pdata : NULL,
                                          ssids ? ssids->len : 0u,
+                                         freqs,
+                                         freqs_len,
                                          priv->scan_request_cancellable,
                                          _scan_supplicant_request_scan_cb,
                                          self);
@@ -1945,7 +2140,8 @@ supplicant_iface_bss_changed_cb(NMSupplicantInterface *iface,
             if (nm_wifi_ap_set_fake(found_ap, TRUE))
                 _ap_dump(self, LOGL_DEBUG, found_ap, "updated", 0);
         } else {
-            ap_add_remove(self, FALSE, found_ap, TRUE);
+            ap_add_remove(self, FALSE, found_ap, FALSE);
+            _recheck_available_connections_schedule(self);
             schedule_ap_list_dump(self);
         }
         return;
@@ -1988,7 +2184,8 @@ supplicant_iface_bss_changed_cb(NMSupplicantInterface *iface,
             }
         }
 
-        ap_add_remove(self, TRUE, ap, TRUE);
+        ap_add_remove(self, TRUE, ap, FALSE);
+        _recheck_available_connections_schedule(self);
     }
 
     /* Update the current AP if the supplicant notified a current BSS change
@@ -3666,6 +3863,8 @@ nm_device_wifi_init(NMDeviceWifi *self)
     c_list_init(&priv->scanning_prohibited_lst_head);
     c_list_init(&priv->scan_request_ssids_lst_head);
     priv->aps_idx_by_supplicant_path = g_hash_table_new(nm_direct_hash, NULL);
+    priv->scan_freqs                 = nm_wifi_utils_scan_freqs_new();
+    priv->scan_profiles_dirty        = TRUE;
 
     priv->scan_last_request_started_at_msec = G_MININT64;
     priv->hidden_probe_scan_warn            = TRUE;
@@ -3684,6 +3883,19 @@ constructed(GObject *object)
     if (priv->capabilities & NM_WIFI_DEVICE_CAP_AP)
         _LOGI(LOGD_PLATFORM | LOGD_WIFI, "driver supports Access Point (AP) mode");
 
+    g_signal_connect(nm_device_get_settings(NM_DEVICE(self)),
+                     NM_SETTINGS_SIGNAL_CONNECTION_ADDED,
+                     G_CALLBACK(_scan_profiles_changed_cb),
+                     self);
+    g_signal_connect(nm_device_get_settings(NM_DEVICE(self)),
+                     NM_SETTINGS_SIGNAL_CONNECTION_UPDATED,
+                     G_CALLBACK(_scan_profiles_updated_cb),
+                     self);
+    g_signal_connect(nm_device_get_settings(NM_DEVICE(self)),
+                     NM_SETTINGS_SIGNAL_CONNECTION_REMOVED,
+                     G_CALLBACK(_scan_profiles_changed_cb),
+                     self);
+
     /* Connect to the supplicant manager */
     priv->sup_mgr = g_object_ref(nm_supplicant_manager_get());
 }
@@ -3716,6 +3928,16 @@ dispose(GObject *object)
     nm_assert(c_list_is_empty(&priv->scanning_prohibited_lst_head));
 
     nm_clear_g_source(&priv->periodic_update_id);
+    nm_clear_g_source(&priv->recheck_available_connections_id);
+
+    if (nm_device_get_settings(NM_DEVICE(self))) {
+        g_signal_handlers_disconnect_by_func(nm_device_get_settings(NM_DEVICE(self)),
+                                             _scan_profiles_changed_cb,
+                                             self);
+        g_signal_handlers_disconnect_by_func(nm_device_get_settings(NM_DEVICE(self)),
+                                             _scan_profiles_updated_cb,
+                                             self);
+    }
 
     wifi_secrets_cancel(self);
 
@@ -3746,6 +3968,8 @@ finalize(GObject *object)
     nm_assert(g_hash_table_size(priv->aps_idx_by_supplicant_path) == 0);
 
     g_hash_table_unref(priv->aps_idx_by_supplicant_path);
+    g_array_unref(priv->scan_freqs);
+    nm_g_hash_table_unref(priv->scan_profiles);
 
     G_OBJECT_CLASS(nm_device_wifi_parent_class)->finalize(object);
 }
@@ -895,6 +895,130 @@ nm_wifi_utils_is_manf_default_ssid(GBytes *ssid)
     return FALSE;
 }
 
+static void
+_scan_freq_clear(gpointer data)
+{
+    NMWifiScanFreq *scan_freq = data;
+
+    g_bytes_unref(scan_freq->ssid);
+}
+
+/**
+ * nm_wifi_utils_scan_freqs_new:
+ *
+ * Returns: an empty array of #NMWifiScanFreq, for
+ *   nm_wifi_utils_scan_freqs_update().
+ */
+GArray *
+nm_wifi_utils_scan_freqs_new(void)
+{
+    GArray *scan_freqs;
+
+    scan_freqs = g_array_new(FALSE, FALSE, sizeof(NMWifiScanFreq));
+    g_array_set_clear_func(scan_freqs, _scan_freq_clear);
+    return scan_freqs;
+}
+
+/**
+ * nm_wifi_utils_scan_freqs_update:
+ * @scan_freqs: the #NMWifiScanFreq array with the channels where the
+ *   network of each profile was seen.
+ * @scan_profiles: maps the SSID of each Wi-Fi profile to the number of
+ *   full scans in a row that missed its network, as GUINT_TO_POINTER().
+ * @do_age: whether a scan over all channels just completed. Only such a scan
+ *   tells that networks are gone from a channel, so only then the score of
+ *   all channels is halved, channels with a score of zero are dropped, and
+ *   profiles without network count a miss.
+ * @bss_ssids: the SSIDs of the BSSs that are currently known.
+ * @bss_freqs: the frequencies of these BSSs.
+ * @n_bss: the number of BSSs.
+ *
+ * Adds the channels of the BSSs that match a profile to @scan_freqs, and
+ * resets their score. Channels of networks that no longer have a profile
+ * are dropped.
+ *
+ * Returns: %TRUE if the network of each profile was either seen, or is out
+ *   of range since %NM_WIFI_SCAN_PROFILE_MISSED_MAX full scans. Otherwise,
+ *   we don't know on which channel to look for a network that we could
+ *   connect to, and a scan restricted to @scan_freqs might miss it.
+ */
+gboolean
+nm_wifi_utils_scan_freqs_update(GArray *       scan_freqs,
+                                GHashTable *   scan_profiles,
+                                gboolean       do_age,
+                                GBytes *const *bss_ssids,
+                                const guint32 *bss_freqs,
+                                guint          n_bss)
+{
+    gs_unref_hashtable GHashTable *matched = NULL;
+    GHashTableIter                 iter;
+    gpointer                       ssid;
+    gpointer                       n_missed;
+    gboolean                       all_known = TRUE;
+    guint                          i;
+    guint                          j;
+
+    for (i = 0; i < scan_freqs->len;) {
+        NMWifiScanFreq *data = &g_array_index(scan_freqs, NMWifiScanFreq, i);
+
+        if (do_age)
+            data->score >>= 1;
+        if (data->score == 0 || !nm_g_hash_table_contains(scan_profiles, data->ssid))
+            g_array_remove_index_fast(scan_freqs, i);
+        else
+            i++;
+    }
+
+    if (nm_g_hash_table_size(scan_profiles) == 0)
+        return TRUE;
+
+    matched = g_hash_table_new(nm_gbytes_hash, nm_gbytes_equal);
+
+    for (i = 0; i < n_bss; i++) {
+        if (!bss_ssids[i] || bss_freqs[i] == 0
+            || !g_hash_table_lookup_extended(scan_profiles, bss_ssids[i], &ssid, NULL))
+            continue;
+
+        g_hash_table_add(matched, ssid);
+
+        for (j = 0; j < scan_freqs->len; j++) {
+            NMWifiScanFreq *data = &g_array_index(scan_freqs, NMWifiScanFreq, j);
+
+            if (data->freq == bss_freqs[i] && g_bytes_equal(data->ssid, ssid)) {
+                data->score = NM_WIFI_SCAN_FREQ_SCORE_SEEN;
+                break;
+            }
+        }
+        if (j == scan_freqs->len) {
+            g_array_append_val(scan_freqs,
+                               ((NMWifiScanFreq){
+                                   .ssid  = g_bytes_ref(ssid),
+                                   .freq  = bss_freqs[i],
+                                   .score = NM_WIFI_SCAN_FREQ_SCORE_SEEN,
+                               }));
+        }
+    }
+
+    g_hash_table_iter_init(&iter, scan_profiles);
+    while (g_hash_table_iter_next(&iter, &ssid, &n_missed)) {
+        if (g_hash_table_contains(matched, ssid)) {
+            g_hash_table_iter_replace(&iter, GUINT_TO_POINTER(0));
+            continue;
+        }
+        if (GPOINTER_TO_UINT(n_missed) >= NM_WIFI_SCAN_PROFILE_MISSED_MAX)
+            continue;
+        if (do_age) {
+            n_missed = GUINT_TO_POINTER(GPOINTER_TO_UINT(n_missed) + 1u);
+            g_hash_table_iter_replace(&iter, n_missed);
+            if (GPOINTER_TO_UINT(n_missed) >= NM_WIFI_SCAN_PROFILE_MISSED_MAX)
+                continue;
+        }
+        all_known = FALSE;
+    }
+
+    return all_known;
+}
+
 /* To be used for connections where the SSID has been validated before */
 gboolean
 nm_wifi_connection_get_iwd_ssid_and_security(NMConnection *        connection,
@@ -32,6 +32,30 @@ gboolean nm_wifi_utils_complete_connection(GBytes *      ssid,
 
 gboolean nm_wifi_utils_is_manf_default_ssid(GBytes *ssid);
 
+typedef struct {
+    GBytes *ssid;
+    guint32 freq;
+    guint8  score;
+} NMWifiScanFreq;
+
+/* score of a channel where a known network was just seen. Each full scan
+ * halves the score of all channels, so a channel where a network is no
+ * longer seen is dropped after four full scans. */
+#define NM_WIFI_SCAN_FREQ_SCORE_SEEN 8
+
+/* number of full scans that must miss a profile's network, before the
+ * network is considered out of range. */
+#define NM_WIFI_SCAN_PROFILE_MISSED_MAX 2
+
+GArray *nm_wifi_utils_scan_freqs_new(void);
+
+gboolean nm_wifi_utils_scan_freqs_update(GArray *       scan_freqs,
+                                         GHashTable *   scan_profiles,
+                                         gboolean       do_age,
+                                         GBytes *const *bss_ssids,
+                                         const guint32 *bss_freqs,
+                                         guint          n_bss);
+
 gboolean nm_wifi_connection_get_iwd_ssid_and_security(NMConnection *        connection,
                                                       char **               ssid,
                                                       NMIwdNetworkSecurity *security);
@@ -1459,6 +1459,148 @@ test_ssids_options_to_ptrarray(void)
 
 /*****************************************************************************/
 
+static void
+_assert_scan_freqs(GArray *       scan_freqs,
+                   GBytes *const *ssids,
+                   const guint32 *freqs,
+                   const guint8 * scores,
+                   guint          len)
+{
+    guint i;
+    guint j;
+
+    g_assert_cmpint(scan_freqs->len, ==, len);
+    for (i = 0; i < len; i++) {
+        for (j = 0; j < scan_freqs->len; j++) {
+            const NMWifiScanFreq *data = &g_array_index(scan_freqs, NMWifiScanFreq, j);
+
+            if (data->freq == freqs[i] && g_bytes_equal(data->ssid, ssids[i]))
+                break;
+        }
+        g_assert_cmpint(j, <, scan_freqs->len);
+        g_assert_cmpint(g_array_index(scan_freqs, NMWifiScanFreq, j).score, ==, scores[i]);
+    }
+}
+
+static void
+test_scan_freqs_update(void)
+{
+    gs_unref_array GArray *scan_freqs            = NULL;
+    gs_unref_hashtable GHashTable *scan_profiles = NULL;
+    gs_unref_bytes GBytes *ssid_a                = g_bytes_new_static("a", 1);
+    gs_unref_bytes GBytes *ssid_b                = g_bytes_new_static("b", 1);
+    gs_unref_bytes GBytes *ssid_c                = g_bytes_new_static("c", 1);
+    const guint8           S                     = NM_WIFI_SCAN_FREQ_SCORE_SEEN;
+    GBytes *               bss_ssids_1[]         = {ssid_a, ssid_c, NULL, ssid_b};
+    const guint32          bss_freqs_1[]         = {2412, 5180, 2437, 0};
+    GBytes *               bss_ssids_2[]         = {ssid_a, ssid_b, ssid_b};
+    const guint32          bss_freqs_2[]         = {2412, 5200, 2412};
+    GBytes *               bss_ssids_3[]         = {ssid_b};
+    const guint32          bss_freqs_3[]         = {5200};
+
+    scan_freqs = nm_wifi_utils_scan_freqs_new();
+
+    /* without profiles, there is nothing to look for. */
+    g_assert(nm_wifi_utils_scan_freqs_update(scan_freqs, NULL, FALSE, bss_ssids_2, bss_freqs_2, 3));
+    _assert_scan_freqs(scan_freqs, NULL, NULL, NULL, 0);
+
+    scan_profiles = g_hash_table_new_full(nm_gbytes_hash,
+                                          nm_gbytes_equal,
+                                          (GDestroyNotify) g_bytes_unref,
+                                          NULL);
+    g_hash_table_insert(scan_profiles, g_bytes_ref(ssid_a), NULL);
+    g_hash_table_insert(scan_profiles, g_bytes_ref(ssid_b), NULL);
+
+    /* "b" is only seen without a frequency, so it doesn't count. "c" and the
+     * BSS without SSID don't belong to a profile. */
+    g_assert(!nm_wifi_utils_scan_freqs_update(scan_freqs,
+                                              scan_profiles,
+                                              FALSE,
+                                              bss_ssids_1,
+                                              bss_freqs_1,
+                                              G_N_ELEMENTS(bss_ssids_1)));
+    _assert_scan_freqs(scan_freqs, (GBytes *[]){ssid_a}, (guint32[]){2412}, (guint8[]){S}, 1);
+
+    /* the channels are tracked per network. */
+    g_assert(nm_wifi_utils_scan_freqs_update(scan_freqs,
+                                             scan_profiles,
+                                             FALSE,
+                                             bss_ssids_2,
+                                             bss_freqs_2,
+                                             G_N_ELEMENTS(bss_ssids_2)));
+    _assert_scan_freqs(scan_freqs,
+                       (GBytes *[]){ssid_a, ssid_b, ssid_b},
+                       (guint32[]){2412, 5200, 2412},
+                       (guint8[]){S, S, S},
+                       3);
+
+    /* A full scan halves the scores, before the channels of the networks
+     * that are still seen are reset. "a" was missed once, and is not yet
+     * out of range. */
+    g_assert(!nm_wifi_utils_scan_freqs_update(scan_freqs,
+                                              scan_profiles,
+                                              TRUE,
+                                              bss_ssids_3,
+                                              bss_freqs_3,
+                                              G_N_ELEMENTS(bss_ssids_3)));
+    _assert_scan_freqs(scan_freqs,
+                       (GBytes *[]){ssid_a, ssid_b, ssid_b},
+                       (guint32[]){2412, 5200, 2412},
+                       (guint8[]){S / 2, S, S / 2},
+                       3);
+
+    /* Without a full scan, nothing is aged. */
+    g_assert(!nm_wifi_utils_scan_freqs_update(scan_freqs, scan_profiles, FALSE, NULL, NULL, 0));
+    _assert_scan_freqs(scan_freqs,
+                       (GBytes *[]){ssid_a, ssid_b, ssid_b},
+                       (guint32[]){2412, 5200, 2412},
+                       (guint8[]){S / 2, S, S / 2},
+                       3);
+
+    /* After two full scans that missed it, "a" is out of range and no
+     * longer requires full scans. "b" was missed once. */
+    g_assert(!nm_wifi_utils_scan_freqs_update(scan_freqs, scan_profiles, TRUE, NULL, NULL, 0));
+    g_assert(nm_wifi_utils_scan_freqs_update(scan_freqs, scan_profiles, TRUE, NULL, NULL, 0));
+    g_assert_cmpint(GPOINTER_TO_UINT(g_hash_table_lookup(scan_profiles, ssid_a)),
+                    ==,
+                    NM_WIFI_SCAN_PROFILE_MISSED_MAX);
+    _assert_scan_freqs(scan_freqs,
+                       (GBytes *[]){ssid_a, ssid_b, ssid_b},
+                       (guint32[]){2412, 5200, 2412},
+                       (guint8[]){S / 8, S / 4, S / 8},
+                       3);
+
+    /* A profile whose network is seen again is back in range. */
+    g_assert(nm_wifi_utils_scan_freqs_update(scan_freqs,
+                                             scan_profiles,
+                                             FALSE,
+                                             bss_ssids_3,
+                                             bss_freqs_3,
+                                             G_N_ELEMENTS(bss_ssids_3)));
+    g_assert_cmpint(GPOINTER_TO_UINT(g_hash_table_lookup(scan_profiles, ssid_b)), ==, 0);
+
+    /* A new profile requires full scans again. */
+    g_hash_table_insert(scan_profiles, g_bytes_ref(ssid_c), NULL);
+    g_assert(!nm_wifi_utils_scan_freqs_update(scan_freqs,
+                                              scan_profiles,
+                                              FALSE,
+                                              bss_ssids_3,
+                                              bss_freqs_3,
+                                              G_N_ELEMENTS(bss_ssids_3)));
+    g_hash_table_remove(scan_profiles, ssid_c);
+
+    /* A channel is dropped once its score reaches zero. */
+    g_assert(!nm_wifi_utils_scan_freqs_update(scan_freqs, scan_profiles, TRUE, NULL, NULL, 0));
+    _assert_scan_freqs(scan_freqs, (GBytes *[]){ssid_b}, (guint32[]){5200}, (guint8[]){S / 2}, 1);
+
+    /* The channels of a network without profile are dropped right away. */
+    g_hash_table_remove(scan_profiles, ssid_b);
+    g_assert(nm_wifi_utils_scan_freqs_update(scan_freqs, scan_profiles, FALSE, NULL, NULL, 0));
+    _assert_scan_freqs(scan_freqs, NULL, NULL, NULL, 0);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -1605,5 +1747,7 @@ main(int argc, char **argv)
 
     g_test_add_func("/wifi/ssids_options_to_ptrarray", test_ssids_options_to_ptrarray);
 
+    g_test_add_func("/wifi/scan_freqs_update", test_scan_freqs_update);
+
     return g_test_run();
 }
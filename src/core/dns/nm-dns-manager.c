@@ -34,6 +34,7 @@
 #include "nm-manager.h"
 
 #include "nm-dns-plugin.h"
+#include "nm-dns-rc-writer.h"
 #include "nm-dns-dnsmasq.h"
 #include "nm-dns-systemd-resolved.h"
 #include "nm-dns-unbound.h"
@@ -56,7 +57,15 @@
 
 /*****************************************************************************/
 
-typedef enum { SR_SUCCESS, SR_NOTFOUND, SR_ERROR } SpawnResult;
+/* SR_PENDING means that the change was handed to a helper (resolvconf,
+ * netconfig) or to the resolv.conf writer thread, and it is not yet known
+ * whether it succeeds. When it completes, success emits config-changed and
+ * a failure is logged as warning, which is all that the callers of
+ * update_dns() would do with it. */
+typedef enum { SR_SUCCESS, SR_PENDING, SR_NOTFOUND, SR_ERROR } SpawnResult;
+
+/* upper limit for the "rc-write-delay" setting. */
+#define RC_WRITE_DELAY_MAX_MSEC 10000
 
 typedef struct {
     GPtrArray * nameservers;
@@ -67,6 +76,45 @@ typedef struct {
     NMTernary   has_trust_ad;
 } NMResolvConfData;
 
+/* What we last successfully wrote to one resolv.conf target. Used to skip
+ * rewriting (and fsync-ing) identical content on every DNS update. */
+typedef struct {
+    char *content;
+
+    /* a hash over the stat() data of the written files, taken right after
+     * writing them. If somebody else touches the files, it changes. */
+    guint64 fingerprint;
+
+    int rc_manager;
+} ResolvConfWritten;
+
+/* One run of resolvconf or netconfig, with the data for its stdin. */
+typedef struct {
+    char **argv;
+    char * input;
+} RcSpawnJob;
+
+/* One write of the resolv.conf files on the writer thread. @content and
+ * @content_no_stub are NULL, if that file is unchanged. The other fields
+ * are the results, filled in by the thread. */
+typedef struct {
+    char *                        content;
+    char *                        content_no_stub;
+    NMDnsManagerResolvConfManager rc_manager;
+
+    /* whether @rc_manager is the configured one, and not only the write of
+     * the internal file. Then the result matters. */
+    bool report_result;
+
+    SpawnResult result;
+    guint64     fingerprint;
+    guint64     fingerprint_no_stub;
+    GError *    error_no_stub;
+
+    /* trace messages, logged on the main thread. */
+    GPtrArray *trace;
+} RcWriteData;
+
 /*****************************************************************************/
 
 enum {
@@ -109,6 +157,26 @@ typedef struct {
 
     NMConfig *config;
 
+    ResolvConfWritten rc_written;
+    ResolvConfWritten rc_written_no_stub;
+
+    /* what was last handed to resolvconf or netconfig. It is cleared
+     * again when the helper fails. */
+    ResolvConfWritten rc_written_spawn;
+
+    /* The helpers are not waited for on the main loop. Only one runs at a
+     * time. While it runs, a newer update replaces the queued @next job, so
+     * that a burst of updates results in at most one more run. */
+    struct {
+        RcSpawnJob *job;
+        RcSpawnJob *next;
+        GPid        pid;
+        guint       watch_id;
+    } rc_spawn;
+
+    /* writes resolv.conf and the no-stub file, see RcWriteData. */
+    NMDnsRcWriter *rc_writer;
+
     struct {
         guint64 ts;
         guint   num_restarts;
@@ -542,37 +610,6 @@ merge_one_ip_config(NMResolvConfData *rc, int ifindex, const NMIPConfig *ip_conf
     }
 }
 
-static GPid
-run_netconfig(NMDnsManager *self, GError **error, int *stdin_fd)
-{
-    char *        argv[5];
-    gs_free char *tmp = NULL;
-    GPid          pid = -1;
-
-    argv[0] = NETCONFIG_PATH;
-    argv[1] = "modify";
-    argv[2] = "--service";
-    argv[3] = "NetworkManager";
-    argv[4] = NULL;
-
-    _LOGD("spawning '%s'", (tmp = g_strjoinv(" ", argv)));
-
-    if (!g_spawn_async_with_pipes(NULL,
-                                  argv,
-                                  NULL,
-                                  G_SPAWN_DO_NOT_REAP_CHILD,
-                                  NULL,
-                                  NULL,
-                                  &pid,
-                                  stdin_fd,
-                                  NULL,
-                                  NULL,
-                                  error))
-        return -1;
-
-    return pid;
-}
-
 static void
 netconfig_construct_str(NMDnsManager *self, GString *str, const char *key, const char *value)
 {
@@ -596,72 +633,6 @@ netconfig_construct_strv(NMDnsManager *     self,
     }
 }
 
-static SpawnResult
-dispatch_netconfig(NMDnsManager *     self,
-                   const char *const *searches,
-                   const char *const *nameservers,
-                   const char *       nis_domain,
-                   const char *const *nis_servers,
-                   GError **          error)
-{
-    GPid                 pid;
-    int                  fd;
-    int                  errsv;
-    int                  status;
-    gssize               l;
-    nm_auto_free_gstring GString *str = NULL;
-
-    pid = run_netconfig(self, error, &fd);
-    if (pid <= 0)
-        return SR_NOTFOUND;
-
-    str = g_string_new("");
-
-    /* NM is writing already-merged DNS information to netconfig, so it
-     * does not apply to a specific network interface.
-     */
-    netconfig_construct_str(self, str, "INTERFACE", "NetworkManager");
-    netconfig_construct_strv(self, str, "DNSSEARCH", searches);
-    netconfig_construct_strv(self, str, "DNSSERVERS", nameservers);
-    netconfig_construct_str(self, str, "NISDOMAIN", nis_domain);
-    netconfig_construct_strv(self, str, "NISSERVERS", nis_servers);
-
-again:
-    l = write(fd, str->str, str->len);
-    if (l == -1) {
-        if (errno == EINTR)
-            goto again;
-    }
-
-    nm_close(fd);
-
-    /* FIXME: don't write to netconfig synchronously. */
-
-    /* Wait until the process exits */
-    if (!nm_utils_kill_child_sync(pid, 0, LOGD_DNS, "netconfig", &status, 1000, 0)) {
-        errsv = errno;
-        g_set_error(error,
-                    NM_MANAGER_ERROR,
-                    NM_MANAGER_ERROR_FAILED,
-                    "Error waiting for netconfig to exit: %s",
-                    nm_strerror_native(errsv));
-        return SR_ERROR;
-    }
-    if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
-        g_set_error(error,
-                    NM_MANAGER_ERROR,
-                    NM_MANAGER_ERROR_FAILED,
-                    "Error calling netconfig: %s %d",
-                    WIFEXITED(status) ? "exited with status"
-                                      : (WIFSIGNALED(status) ? "exited with signal"
-                                                             : "exited with unknown reason"),
-                    WIFEXITED(status) ? WEXITSTATUS(status)
-                                      : (WIFSIGNALED(status) ? WTERMSIG(status) : status));
-        return SR_ERROR;
-    }
-    return SR_SUCCESS;
-}
-
 static char *
 create_resolv_conf(const char *const *searches,
                    const char *const *nameservers,
@@ -745,6 +716,64 @@ nmtst_dns_create_resolv_conf(const char *const *searches,
     return create_resolv_conf(searches, nameservers, options);
 }
 
+static guint64
+_rc_written_fingerprint(const char *const *paths)
+{
+    NMHashState h;
+    struct stat st;
+
+    nm_hash_init(&h, 1630371803u);
+    for (; paths && *paths; paths++) {
+        if (lstat(*paths, &st) != 0) {
+            nm_hash_update_val(&h, 1u);
+            continue;
+        }
+        nm_hash_update_vals(&h,
+                            st.st_dev,
+                            st.st_ino,
+                            st.st_mode,
+                            st.st_size,
+                            st.st_mtim.tv_sec,
+                            st.st_mtim.tv_nsec);
+        if (S_ISLNK(st.st_mode) && stat(*paths, &st) == 0) {
+            nm_hash_update_vals(&h,
+                                st.st_dev,
+                                st.st_ino,
+                                st.st_size,
+                                st.st_mtim.tv_sec,
+                                st.st_mtim.tv_nsec);
+        }
+    }
+    return nm_hash_complete_u64(&h);
+}
+
+static gboolean
+_rc_written_is_unchanged(const ResolvConfWritten *w,
+                         int                      rc_manager,
+                         const char *             content,
+                         guint64                  fingerprint)
+{
+    return w->content && w->rc_manager == rc_manager && w->fingerprint == fingerprint
+           && nm_streq(w->content, content);
+}
+
+static void
+_rc_written_set(ResolvConfWritten *w, int rc_manager, const char *content, guint64 fingerprint)
+{
+    if (!nm_streq0(w->content, content)) {
+        g_free(w->content);
+        w->content = g_strdup(content);
+    }
+    w->rc_manager  = rc_manager;
+    w->fingerprint = fingerprint;
+}
+
+static void
+_rc_written_clear(ResolvConfWritten *w)
+{
+    nm_clear_g_free(&w->content);
+}
+
 static gboolean
 write_resolv_conf_contents(FILE *f, const char *content, GError **error)
 {
@@ -764,17 +793,192 @@ write_resolv_conf_contents(FILE *f, const char *content, GError **error)
     return TRUE;
 }
 
+static void
+_rc_spawn_job_free(RcSpawnJob *job)
+{
+    if (!job)
+        return;
+    g_strfreev(job->argv);
+    g_free(job->input);
+    nm_g_slice_free(job);
+}
+
 static gboolean
-write_resolv_conf(FILE *             f,
-                  const char *const *searches,
-                  const char *const *nameservers,
-                  const char *const *options,
-                  GError **          error)
+_rc_spawn_check_status(const RcSpawnJob *job, int status, GError **error)
 {
-    gs_free char *content = NULL;
+    if (WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS)
+        return TRUE;
 
-    content = create_resolv_conf(searches, nameservers, options);
-    return write_resolv_conf_contents(f, content, error);
+    g_set_error(error,
+                NM_MANAGER_ERROR,
+                NM_MANAGER_ERROR_FAILED,
+                "error calling %s: %s %d",
+                job->argv[0],
+                WIFEXITED(status) ? "exited with status"
+                                  : (WIFSIGNALED(status) ? "exited with signal"
+                                                         : "exited with unknown reason"),
+                WIFEXITED(status) ? WEXITSTATUS(status)
+                                  : (WIFSIGNALED(status) ? WTERMSIG(status) : status));
+    return FALSE;
+}
+
+static void _rc_spawn_watch_cb(GPid pid, int status, gpointer user_data);
+
+static gboolean
+_rc_spawn_start(NMDnsManager *self, RcSpawnJob *job, GError **error)
+{
+    NMDnsManagerPrivate *priv = NM_DNS_MANAGER_GET_PRIVATE(self);
+    gs_free char *       tmp  = NULL;
+    GPid                 pid;
+    int                  fd = -1;
+    gsize                n;
+    gssize               l;
+
+    nm_assert(priv->rc_spawn.pid <= 0);
+    nm_assert(!priv->rc_spawn.job);
+
+    _LOGD("update-dns: spawning '%s'", (tmp = g_strjoinv(" ", job->argv)));
+
+    if (!g_spawn_async_with_pipes("/",
+                                  job->argv,
+                                  NULL,
+                                  G_SPAWN_DO_NOT_REAP_CHILD,
+                                  NULL,
+                                  NULL,
+                                  &pid,
+                                  job->input ? &fd : NULL,
+                                  NULL,
+                                  NULL,
+                                  error)) {
+        _rc_spawn_job_free(job);
+        return FALSE;
+    }
+
+    /* The data is small and fits into the pipe buffer. Writing it does not
+     * wait for the helper, only its exit is handled asynchronously. */
+    for (n = 0; job->input && job->input[n];) {
+        l = write(fd, &job->input[n], strlen(&job->input[n]));
+        if (l < 0) {
+            if (errno == EINTR)
+                continue;
+            _LOGD("update-dns: failed writing to %s: %s",
+                  job->argv[0],
+                  nm_strerror_native(errno));
+            break;
+        }
+        n += l;
+    }
+    if (fd >= 0)
+        nm_close(fd);
+
+    priv->rc_spawn.job      = job;
+    priv->rc_spawn.pid      = pid;
+    priv->rc_spawn.watch_id = g_child_watch_add(pid, _rc_spawn_watch_cb, self);
+    return TRUE;
+}
+
+static void
+_rc_spawn_watch_cb(GPid pid, int status, gpointer user_data)
+{
+    NMDnsManager *        self  = user_data;
+    NMDnsManagerPrivate * priv  = NM_DNS_MANAGER_GET_PRIVATE(self);
+    gs_free_error GError *error = NULL;
+
+    priv->rc_spawn.watch_id = 0;
+    priv->rc_spawn.pid      = 0;
+
+    if (_rc_spawn_check_status(priv->rc_spawn.job, status, &error))
+        _LOGD("update-dns: %s finished", priv->rc_spawn.job->argv[0]);
+    else {
+        /* try again on the next update. */
+        _rc_written_clear(&priv->rc_written_spawn);
+    }
+    nm_clear_pointer(&priv->rc_spawn.job, _rc_spawn_job_free);
+
+    if (priv->rc_spawn.next) {
+        /* the result of this run is superseded by the queued one. */
+        if (error)
+            _LOGD("update-dns: %s", error->message);
+        g_clear_error(&error);
+
+        if (!_rc_spawn_start(self, g_steal_pointer(&priv->rc_spawn.next), &error)) {
+            _LOGW("could not commit DNS changes: could not spawn helper: %s", error->message);
+            _rc_written_clear(&priv->rc_written_spawn);
+        }
+        return;
+    }
+
+    if (error) {
+        _LOGW("could not commit DNS changes: %s", error->message);
+        return;
+    }
+
+    g_signal_emit(self, signals[CONFIG_CHANGED], 0);
+}
+
+static SpawnResult
+_rc_spawn_queue(NMDnsManager *self, const char *const *argv, const char *input, GError **error)
+{
+    NMDnsManagerPrivate *priv = NM_DNS_MANAGER_GET_PRIVATE(self);
+    RcSpawnJob *         job;
+
+    job  = g_slice_new(RcSpawnJob);
+    *job = (RcSpawnJob){
+        .argv  = g_strdupv((char **) argv),
+        .input = g_strdup(input),
+    };
+
+    if (priv->rc_spawn.pid > 0) {
+        if (priv->rc_spawn.next)
+            _LOGT("update-dns: drop queued call of %s, superseded", argv[0]);
+        else
+            _LOGT("update-dns: %s still running, queue call", argv[0]);
+        _rc_spawn_job_free(priv->rc_spawn.next);
+        priv->rc_spawn.next = job;
+        return SR_PENDING;
+    }
+
+    if (!_rc_spawn_start(self, job, error)) {
+        _rc_written_clear(&priv->rc_written_spawn);
+        return SR_ERROR;
+    }
+    return SR_PENDING;
+}
+
+static void
+_rc_spawn_flush_sync(NMDnsManager *self)
+{
+    NMDnsManagerPrivate *priv = NM_DNS_MANAGER_GET_PRIVATE(self);
+    int                  status;
+
+    /* On shutdown, wait for the running helper and also run the queued
+     * one, so that the last update is not lost. */
+    while (priv->rc_spawn.pid > 0 || priv->rc_spawn.next) {
+        if (priv->rc_spawn.pid <= 0) {
+            gs_free_error GError *error = NULL;
+
+            if (!_rc_spawn_start(self, g_steal_pointer(&priv->rc_spawn.next), &error)) {
+                _LOGW("update-dns: could not spawn helper: %s", error->message);
+                continue;
+            }
+        }
+
+        nm_clear_g_source(&priv->rc_spawn.watch_id);
+        if (nm_utils_kill_child_sync(priv->rc_spawn.pid,
+                                     0,
+                                     LOGD_DNS,
+                                     priv->rc_spawn.job->argv[0],
+                                     &status,
+                                     1000,
+                                     0)) {
+            gs_free_error GError *error = NULL;
+
+            if (!_rc_spawn_check_status(priv->rc_spawn.job, status, &error))
+                _LOGW("could not commit DNS changes on shutdown: %s", error->message);
+        }
+        priv->rc_spawn.pid = 0;
+        nm_clear_pointer(&priv->rc_spawn.job, _rc_spawn_job_free);
+    }
 }
 
 static SpawnResult
@@ -784,13 +988,10 @@ dispatch_resolvconf(NMDnsManager *self,
                     char **       options,
                     GError **     error)
 {
-    gs_free char *cmd = NULL;
-    FILE *        f;
-    gboolean      success = FALSE;
-    int           errsv;
-    int           err;
-    char *        argv[] = {RESOLVCONF_PATH, "-d", "NetworkManager", NULL};
-    int           status;
+    NMDnsManagerPrivate *    priv       = NM_DNS_MANAGER_GET_PRIVATE(self);
+    static const char *const argv_add[] = {RESOLVCONF_PATH, "-a", "NetworkManager", NULL};
+    static const char *const argv_del[] = {RESOLVCONF_PATH, "-d", "NetworkManager", NULL};
+    gs_free char *           content    = NULL;
 
     if (!g_file_test(RESOLVCONF_PATH, G_FILE_TEST_IS_EXECUTABLE)) {
         g_set_error_literal(error,
@@ -800,63 +1001,77 @@ dispatch_resolvconf(NMDnsManager *self,
         return SR_NOTFOUND;
     }
 
-    if (!searches && !nameservers) {
-        _LOGI("Removing DNS information from %s", RESOLVCONF_PATH);
-
-        if (!g_spawn_sync("/", argv, NULL, 0, NULL, NULL, NULL, NULL, &status, error))
-            return SR_ERROR;
-
-        if (status != 0) {
-            g_set_error(error,
-                        NM_MANAGER_ERROR,
-                        NM_MANAGER_ERROR_FAILED,
-                        "%s returned error code",
-                        RESOLVCONF_PATH);
-            return SR_ERROR;
-        }
-
+    /* resolvconf keeps what we gave it last time. Don't spawn it again
+     * for the same content. An empty content means that we removed our
+     * information. */
+    if (searches || nameservers) {
+        content = create_resolv_conf(NM_CAST_STRV_CC(searches),
+                                     NM_CAST_STRV_CC(nameservers),
+                                     NM_CAST_STRV_CC(options));
+    }
+    if (_rc_written_is_unchanged(&priv->rc_written_spawn,
+                                 NM_DNS_MANAGER_RESOLV_CONF_MAN_RESOLVCONF,
+                                 content ?: "",
+                                 0)) {
+        _LOGT("update-resolv-conf: content for %s unchanged, don't call it", RESOLVCONF_PATH);
         return SR_SUCCESS;
     }
+    _rc_written_set(&priv->rc_written_spawn,
+                    NM_DNS_MANAGER_RESOLV_CONF_MAN_RESOLVCONF,
+                    content ?: "",
+                    0);
+
+    if (!content) {
+        _LOGI("Removing DNS information from %s", RESOLVCONF_PATH);
+        return _rc_spawn_queue(self, argv_del, NULL, error);
+    }
 
     _LOGI("Writing DNS information to %s", RESOLVCONF_PATH);
+    return _rc_spawn_queue(self, argv_add, content, error);
+}
 
-    /* FIXME: don't write to resolvconf synchronously. */
+static SpawnResult
+dispatch_netconfig(NMDnsManager *     self,
+                   const char *const *searches,
+                   const char *const *nameservers,
+                   const char *       nis_domain,
+                   const char *const *nis_servers,
+                   GError **          error)
+{
+    NMDnsManagerPrivate *    priv = NM_DNS_MANAGER_GET_PRIVATE(self);
+    static const char *const argv[] =
+        {NETCONFIG_PATH, "modify", "--service", "NetworkManager", NULL};
+    nm_auto_free_gstring GString *str = NULL;
 
-    cmd = g_strconcat(RESOLVCONF_PATH, " -a ", "NetworkManager", NULL);
-    if ((f = popen(cmd, "w")) == NULL) {
-        errsv = errno;
-        g_set_error(error,
-                    NM_MANAGER_ERROR,
-                    NM_MANAGER_ERROR_FAILED,
-                    "Could not write to %s: %s",
-                    RESOLVCONF_PATH,
-                    nm_strerror_native(errsv));
-        return SR_ERROR;
+    if (!g_file_test(NETCONFIG_PATH, G_FILE_TEST_IS_EXECUTABLE)) {
+        g_set_error_literal(error,
+                            NM_MANAGER_ERROR,
+                            NM_MANAGER_ERROR_FAILED,
+                            NETCONFIG_PATH " is not executable");
+        return SR_NOTFOUND;
     }
 
-    success = write_resolv_conf(f,
-                                NM_CAST_STRV_CC(searches),
-                                NM_CAST_STRV_CC(nameservers),
-                                NM_CAST_STRV_CC(options),
-                                error);
-    err     = pclose(f);
-    if (err < 0) {
-        errsv = errno;
-        g_clear_error(error);
-        g_set_error(error,
-                    G_IO_ERROR,
-                    g_io_error_from_errno(errsv),
-                    "Failed to close pipe to resolvconf: %d",
-                    errsv);
-        return SR_ERROR;
-    } else if (err > 0) {
-        _LOGW("resolvconf failed with status %d", err);
-        g_clear_error(error);
-        g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED, "resolvconf failed with status %d", err);
-        return SR_ERROR;
+    str = g_string_new("");
+
+    /* NM is writing already-merged DNS information to netconfig, so it
+     * does not apply to a specific network interface.
+     */
+    netconfig_construct_str(self, str, "INTERFACE", "NetworkManager");
+    netconfig_construct_strv(self, str, "DNSSEARCH", searches);
+    netconfig_construct_strv(self, str, "DNSSERVERS", nameservers);
+    netconfig_construct_str(self, str, "NISDOMAIN", nis_domain);
+    netconfig_construct_strv(self, str, "NISSERVERS", nis_servers);
+
+    if (_rc_written_is_unchanged(&priv->rc_written_spawn,
+                                 NM_DNS_MANAGER_RESOLV_CONF_MAN_NETCONFIG,
+                                 str->str,
+                                 0)) {
+        _LOGT("update-resolv-conf: content for %s unchanged, don't call it", NETCONFIG_PATH);
+        return SR_SUCCESS;
     }
+    _rc_written_set(&priv->rc_written_spawn, NM_DNS_MANAGER_RESOLV_CONF_MAN_NETCONFIG, str->str, 0);
 
-    return success ? SR_SUCCESS : SR_ERROR;
+    return _rc_spawn_queue(self, argv, str->str, error);
 }
 
 static const char *
@@ -881,42 +1096,46 @@ _read_link_cached(const char *path, gboolean *is_cached, char **cached)
 
 static void
 update_resolv_conf_no_stub(NMDnsManager *     self,
+                           RcWriteData *      rc_write,
                            const char *const *searches,
                            const char *const *nameservers,
                            const char *const *options)
 {
-    gs_free char *content = NULL;
-    GError *      local   = NULL;
+    NMDnsManagerPrivate *     priv    = NM_DNS_MANAGER_GET_PRIVATE(self);
+    static const char *const paths[] = {NO_STUB_RESOLV_CONF, NULL};
+    gs_free char *           content = NULL;
 
     content = create_resolv_conf(searches, nameservers, options);
 
-    if (!g_file_set_contents(NO_STUB_RESOLV_CONF, content, -1, &local)) {
-        _LOGD("update-resolv-no-stub: failure to write file: %s", local->message);
-        g_error_free(local);
+    /* while a write is pending, what we last wrote is outdated anyway. */
+    if (!nm_dns_rc_writer_is_busy(priv->rc_writer)
+        && _rc_written_is_unchanged(&priv->rc_written_no_stub,
+                                    0,
+                                    content,
+                                    _rc_written_fingerprint(paths))) {
+        _LOGT("update-resolv-no-stub: '%s' unchanged", NO_STUB_RESOLV_CONF);
         return;
     }
+    _rc_written_clear(&priv->rc_written_no_stub);
 
-    _LOGT("update-resolv-no-stub: '%s' successfully written", NO_STUB_RESOLV_CONF);
+    rc_write->content_no_stub = g_steal_pointer(&content);
 }
 
+#define _TRACE(...) g_ptr_array_add(trace, g_strdup_printf(__VA_ARGS__))
+
 static SpawnResult
-update_resolv_conf(NMDnsManager *                self,
-                   const char *const *           searches,
-                   const char *const *           nameservers,
-                   const char *const *           options,
-                   GError **                     error,
-                   NMDnsManagerResolvConfManager rc_manager)
+_update_resolv_conf_write(const char *                  content,
+                          NMDnsManagerResolvConfManager rc_manager,
+                          GPtrArray *                   trace,
+                          GError **                     error)
 {
     FILE *        f;
     gboolean      success;
-    gs_free char *content           = NULL;
     SpawnResult   write_file_result = SR_SUCCESS;
     int           errsv;
     gboolean      resconf_link_cached = FALSE;
     gs_free char *resconf_link        = NULL;
 
-    content = create_resolv_conf(searches, nameservers, options);
-
     if (rc_manager == NM_DNS_MANAGER_RESOLV_CONF_MAN_FILE
         || (rc_manager == NM_DNS_MANAGER_RESOLV_CONF_MAN_SYMLINK
             && !_read_link_cached(_PATH_RESCONF, &resconf_link_cached, &resconf_link))) {
@@ -947,19 +1166,19 @@ update_resolv_conf(NMDnsManager *                self,
          * we still continue to write to runstatedir but remember the
          * error. */
         if (!g_file_set_contents(rc_path, content, -1, &local)) {
-            _LOGT("update-resolv-conf: write to %s failed (rc-manager=%s, %s)",
-                  rc_path,
-                  _rc_manager_to_string(rc_manager),
-                  local->message);
+            _TRACE("write to %s failed (rc-manager=%s, %s)",
+                   rc_path,
+                   _rc_manager_to_string(rc_manager),
+                   local->message);
             g_propagate_error(error, local);
             /* clear @error, so that we don't try reset it. This is the error
              * we want to propagate to the caller. */
             error             = NULL;
             write_file_result = SR_ERROR;
         } else {
-            _LOGT("update-resolv-conf: write to %s succeeded (rc-manager=%s)",
-                  rc_path,
-                  _rc_manager_to_string(rc_manager));
+            _TRACE("write to %s succeeded (rc-manager=%s)",
+                   rc_path,
+                   _rc_manager_to_string(rc_manager));
         }
     }
 
@@ -971,18 +1190,16 @@ update_resolv_conf(NMDnsManager *                self,
                     "Could not open %s: %s",
                     MY_RESOLV_CONF_TMP,
                     nm_strerror_native(errsv));
-        _LOGT("update-resolv-conf: open temporary file %s failed (%s)",
-              MY_RESOLV_CONF_TMP,
-              nm_strerror_native(errsv));
+        _TRACE("open temporary file %s failed (%s)", MY_RESOLV_CONF_TMP, nm_strerror_native(errsv));
         return SR_ERROR;
     }
 
     success = write_resolv_conf_contents(f, content, error);
     if (!success) {
         errsv = errno;
-        _LOGT("update-resolv-conf: write temporary file %s failed (%s)",
-              MY_RESOLV_CONF_TMP,
-              nm_strerror_native(errsv));
+        _TRACE("write temporary file %s failed (%s)",
+               MY_RESOLV_CONF_TMP,
+               nm_strerror_native(errsv));
     }
 
     if (fclose(f) < 0) {
@@ -997,9 +1214,9 @@ update_resolv_conf(NMDnsManager *                self,
                         "Could not close %s: %s",
                         MY_RESOLV_CONF_TMP,
                         nm_strerror_native(errsv));
-            _LOGT("update-resolv-conf: close temporary file %s failed (%s)",
-                  MY_RESOLV_CONF_TMP,
-                  nm_strerror_native(errsv));
+            _TRACE("close temporary file %s failed (%s)",
+                   MY_RESOLV_CONF_TMP,
+                   nm_strerror_native(errsv));
         }
         return SR_ERROR;
     } else if (!success)
@@ -1013,33 +1230,33 @@ update_resolv_conf(NMDnsManager *                self,
                     "Could not replace %s: %s",
                     MY_RESOLV_CONF,
                     nm_strerror_native(errsv));
-        _LOGT("update-resolv-conf: failed to rename temporary file %s to %s (%s)",
-              MY_RESOLV_CONF_TMP,
-              MY_RESOLV_CONF,
-              nm_strerror_native(errsv));
+        _TRACE("failed to rename temporary file %s to %s (%s)",
+               MY_RESOLV_CONF_TMP,
+               MY_RESOLV_CONF,
+               nm_strerror_native(errsv));
         return SR_ERROR;
     }
 
     if (rc_manager == NM_DNS_MANAGER_RESOLV_CONF_MAN_FILE) {
-        _LOGT("update-resolv-conf: write internal file %s succeeded (rc-manager=%s)",
-              MY_RESOLV_CONF,
-              _rc_manager_to_string(rc_manager));
+        _TRACE("write internal file %s succeeded (rc-manager=%s)",
+               MY_RESOLV_CONF,
+               _rc_manager_to_string(rc_manager));
         return write_file_result;
     }
 
     if (rc_manager != NM_DNS_MANAGER_RESOLV_CONF_MAN_SYMLINK
         || !_read_link_cached(_PATH_RESCONF, &resconf_link_cached, &resconf_link)) {
-        _LOGT("update-resolv-conf: write internal file %s succeeded", MY_RESOLV_CONF);
+        _TRACE("write internal file %s succeeded", MY_RESOLV_CONF);
         return write_file_result;
     }
 
     if (!nm_streq0(_read_link_cached(_PATH_RESCONF, &resconf_link_cached, &resconf_link),
                    MY_RESOLV_CONF)) {
-        _LOGT("update-resolv-conf: write internal file %s succeeded (don't touch symlink %s "
-              "linking to %s)",
-              MY_RESOLV_CONF,
-              _PATH_RESCONF,
-              _read_link_cached(_PATH_RESCONF, &resconf_link_cached, &resconf_link));
+        _TRACE("write internal file %s succeeded (don't touch symlink %s "
+               "linking to %s)",
+               MY_RESOLV_CONF,
+               _PATH_RESCONF,
+               _read_link_cached(_PATH_RESCONF, &resconf_link_cached, &resconf_link));
         return write_file_result;
     }
 
@@ -1054,11 +1271,11 @@ update_resolv_conf(NMDnsManager *                self,
                     "Could not unlink %s: %s",
                     RESOLV_CONF_TMP,
                     nm_strerror_native(errsv));
-        _LOGT("update-resolv-conf: write internal file %s succeeded "
-              "but cannot delete temporary file %s: %s",
-              MY_RESOLV_CONF,
-              RESOLV_CONF_TMP,
-              nm_strerror_native(errsv));
+        _TRACE("write internal file %s succeeded "
+               "but cannot delete temporary file %s: %s",
+               MY_RESOLV_CONF,
+               RESOLV_CONF_TMP,
+               nm_strerror_native(errsv));
         return SR_ERROR;
     }
 
@@ -1071,11 +1288,11 @@ update_resolv_conf(NMDnsManager *                self,
                     RESOLV_CONF_TMP,
                     MY_RESOLV_CONF,
                     nm_strerror_native(errsv));
-        _LOGT("update-resolv-conf: write internal file %s succeeded "
-              "but failed to symlink %s: %s",
-              MY_RESOLV_CONF,
-              RESOLV_CONF_TMP,
-              nm_strerror_native(errsv));
+        _TRACE("write internal file %s succeeded "
+               "but failed to symlink %s: %s",
+               MY_RESOLV_CONF,
+               RESOLV_CONF_TMP,
+               nm_strerror_native(errsv));
         return SR_ERROR;
     }
 
@@ -1088,21 +1305,161 @@ update_resolv_conf(NMDnsManager *                self,
                     RESOLV_CONF_TMP,
                     _PATH_RESCONF,
                     nm_strerror_native(errsv));
-        _LOGT("update-resolv-conf: write internal file %s succeeded "
-              "but failed to rename temporary symlink %s to %s: %s",
-              MY_RESOLV_CONF,
-              RESOLV_CONF_TMP,
-              _PATH_RESCONF,
-              nm_strerror_native(errsv));
+        _TRACE("write internal file %s succeeded "
+               "but failed to rename temporary symlink %s to %s: %s",
+               MY_RESOLV_CONF,
+               RESOLV_CONF_TMP,
+               _PATH_RESCONF,
+               nm_strerror_native(errsv));
         return SR_ERROR;
     }
 
-    _LOGT("update-resolv-conf: write internal file %s succeeded and update symlink %s",
-          MY_RESOLV_CONF,
-          _PATH_RESCONF);
+    _TRACE("write internal file %s succeeded and update symlink %s", MY_RESOLV_CONF, _PATH_RESCONF);
     return write_file_result;
 }
 
+#undef _TRACE
+
+static SpawnResult
+update_resolv_conf(NMDnsManager *                self,
+                   RcWriteData *                 rc_write,
+                   const char *const *           searches,
+                   const char *const *           nameservers,
+                   const char *const *           options,
+                   NMDnsManagerResolvConfManager rc_manager,
+                   gboolean                      report_result)
+{
+    NMDnsManagerPrivate *     priv    = NM_DNS_MANAGER_GET_PRIVATE(self);
+    static const char *const paths[] = {_PATH_RESCONF, MY_RESOLV_CONF, NULL};
+    gs_free char *           content = NULL;
+
+    content = create_resolv_conf(searches, nameservers, options);
+
+    /* Rewriting the files costs an fsync() each. Skip that, if the content
+     * is what we wrote last time and nobody touched the files since. */
+    if (!nm_dns_rc_writer_is_busy(priv->rc_writer)
+        && _rc_written_is_unchanged(&priv->rc_written,
+                                    rc_manager,
+                                    content,
+                                    _rc_written_fingerprint(paths))) {
+        _LOGT("update-resolv-conf: content unchanged, skip writing (rc-manager=%s)",
+              _rc_manager_to_string(rc_manager));
+        return SR_SUCCESS;
+    }
+    _rc_written_clear(&priv->rc_written);
+
+    rc_write->content       = g_steal_pointer(&content);
+    rc_write->rc_manager    = rc_manager;
+    rc_write->report_result = report_result;
+    return SR_PENDING;
+}
+
+static void
+_rc_write_data_free(RcWriteData *rc_write)
+{
+    if (!rc_write)
+        return;
+    g_free(rc_write->content);
+    g_free(rc_write->content_no_stub);
+    g_clear_error(&rc_write->error_no_stub);
+    nm_clear_pointer(&rc_write->trace, g_ptr_array_unref);
+    nm_g_slice_free(rc_write);
+}
+
+static void
+_rc_write_thread_fn(gpointer user_data, GError **error)
+{
+    static const char *const paths[]         = {_PATH_RESCONF, MY_RESOLV_CONF, NULL};
+    static const char *const paths_no_stub[] = {NO_STUB_RESOLV_CONF, NULL};
+    RcWriteData *            rc_write        = user_data;
+
+    if (rc_write->content_no_stub) {
+        if (g_file_set_contents(NO_STUB_RESOLV_CONF,
+                                rc_write->content_no_stub,
+                                -1,
+                                &rc_write->error_no_stub))
+            rc_write->fingerprint_no_stub = _rc_written_fingerprint(paths_no_stub);
+    }
+
+    if (rc_write->content) {
+        rc_write->trace  = g_ptr_array_new_with_free_func(g_free);
+        rc_write->result = _update_resolv_conf_write(rc_write->content,
+                                                     rc_write->rc_manager,
+                                                     rc_write->trace,
+                                                     error);
+        if (rc_write->result == SR_SUCCESS)
+            rc_write->fingerprint = _rc_written_fingerprint(paths);
+    }
+}
+
+static void
+_rc_write_done(gpointer user_data, GError *error, gpointer self_ptr)
+{
+    NMDnsManager *       self     = self_ptr;
+    NMDnsManagerPrivate *priv     = NM_DNS_MANAGER_GET_PRIVATE(self);
+    RcWriteData *        rc_write = user_data;
+    guint                i;
+
+    if (rc_write->content_no_stub) {
+        if (rc_write->error_no_stub) {
+            _LOGD("update-resolv-no-stub: failure to write file: %s",
+                  rc_write->error_no_stub->message);
+        } else {
+            _rc_written_set(&priv->rc_written_no_stub,
+                            0,
+                            rc_write->content_no_stub,
+                            rc_write->fingerprint_no_stub);
+            _LOGT("update-resolv-no-stub: '%s' successfully written", NO_STUB_RESOLV_CONF);
+        }
+    }
+
+    if (!rc_write->content)
+        return;
+
+    for (i = 0; i < rc_write->trace->len; i++)
+        _LOGT("update-resolv-conf: %s", (const char *) rc_write->trace->pdata[i]);
+
+    if (rc_write->result == SR_SUCCESS) {
+        _rc_written_set(&priv->rc_written,
+                        rc_write->rc_manager,
+                        rc_write->content,
+                        rc_write->fingerprint);
+        if (rc_write->report_result)
+            g_signal_emit(self, signals[CONFIG_CHANGED], 0);
+        return;
+    }
+
+    if (rc_write->report_result)
+        _LOGW("could not commit DNS changes: %s", error ? error->message : "unknown error");
+    else {
+        _LOGD("update-resolv-conf: failure to write %s: %s",
+              MY_RESOLV_CONF,
+              error ? error->message : "unknown error");
+    }
+}
+
+static void
+_rc_write_queue(NMDnsManager *self, RcWriteData *rc_write)
+{
+    NMDnsManagerPrivate *priv = NM_DNS_MANAGER_GET_PRIVATE(self);
+
+    if (!rc_write->content && !rc_write->content_no_stub) {
+        _rc_write_data_free(rc_write);
+        return;
+    }
+
+    nm_dns_rc_writer_set_delay(
+        priv->rc_writer,
+        nm_config_data_get_value_int64(nm_config_get_data(priv->config),
+                                       NM_CONFIG_KEYFILE_GROUP_MAIN,
+                                       NM_CONFIG_KEYFILE_KEY_MAIN_RC_WRITE_DELAY,
+                                       10,
+                                       0,
+                                       RC_WRITE_DELAY_MAX_MSEC,
+                                       0));
+    nm_dns_rc_writer_queue(priv->rc_writer, rc_write);
+}
+
 static void
 compute_hash(NMDnsManager *self, const NMGlobalDnsConfig *global, guint8 buffer[HASH_LEN])
 {
@@ -1330,67 +1687,176 @@ get_ip_rdns_domains(NMIPConfig *ip_config)
     return _nm_utils_strv_cleanup(strv, FALSE, FALSE, TRUE);
 }
 
+/* The tracked routing domains are kept in a trie over the DNS labels, starting
+ * with the right-most label. That way, all parent domains of a domain are found
+ * in one walk along its labels, instead of one hash lookup per suffix. The
+ * root node is the wildcard domain "".
+ *
+ * Labels point into the domain strings passed to _domain_track_add(), which must
+ * outlive the trie. */
+typedef struct _DomainTrackNode {
+    const char *label;
+    gsize       label_len;
+    GHashTable *children;
+    int         priority;
+    bool        has_priority : 1;
+} DomainTrackNode;
+
+static guint
+_domain_track_node_hash(gconstpointer ptr)
+{
+    const DomainTrackNode *node = ptr;
+
+    return nm_hash_mem(1379447821u, node->label, node->label_len);
+}
+
+static gboolean
+_domain_track_node_equal(gconstpointer a, gconstpointer b)
+{
+    const DomainTrackNode *node_a = a;
+    const DomainTrackNode *node_b = b;
+
+    return node_a->label_len == node_b->label_len
+           && memcmp(node_a->label, node_b->label, node_a->label_len) == 0;
+}
+
+static void
+_domain_track_free(DomainTrackNode *node)
+{
+    nm_clear_pointer(&node->children, g_hash_table_unref);
+    nm_g_slice_free(node);
+}
+
+NM_AUTO_DEFINE_FCN0(DomainTrackNode *, _nm_auto_free_domain_track, _domain_track_free);
+#define nm_auto_free_domain_track nm_auto(_nm_auto_free_domain_track)
+
+static DomainTrackNode *
+_domain_track_child(DomainTrackNode *node, const char *label, gsize label_len, gboolean create)
+{
+    DomainTrackNode  needle;
+    DomainTrackNode *child;
+
+    needle = (DomainTrackNode){
+        .label     = label,
+        .label_len = label_len,
+    };
+
+    if (node->children) {
+        child = g_hash_table_lookup(node->children, &needle);
+        if (child || !create)
+            return child;
+    } else {
+        if (!create)
+            return NULL;
+        node->children = g_hash_table_new_full(_domain_track_node_hash,
+                                               _domain_track_node_equal,
+                                               (GDestroyNotify) _domain_track_free,
+                                               NULL);
+    }
+
+    child  = g_slice_new(DomainTrackNode);
+    *child = needle;
+    g_hash_table_add(node->children, child);
+    return child;
+}
+
+/* Finds the node for @domain. If @out_parent is given, also checks whether a parent
+ * domain with a more negative priority than @priority shadows @domain. In that case,
+ * NULL is returned. */
+static DomainTrackNode *
+_domain_track_walk(DomainTrackNode *root,
+                   const char *     domain,
+                   gboolean         create,
+                   int              priority,
+                   const char **    out_parent,
+                   int *            out_parent_priority)
+{
+    DomainTrackNode *node = root;
+    const char *     start;
+    const char *     end;
+
+    end   = &domain[strlen(domain)];
+    start = end;
+
+    while (TRUE) {
+        if (out_parent && node->has_priority && start != domain) {
+            nm_assert(node->priority <= priority);
+            if (node->priority < 0 && node->priority < priority) {
+                *out_parent          = node == root ? "" : start;
+                *out_parent_priority = node->priority;
+                return NULL;
+            }
+        }
+
+        if (start == domain)
+            return node;
+
+        if (node != root)
+            end = start - 1;
+        start = end;
+        while (start > domain && start[-1] != '.')
+            start--;
+
+        node = _domain_track_child(node, start, end - start, create);
+        if (!node)
+            return NULL;
+    }
+}
+
 static gboolean
-_domain_track_get_priority(GHashTable *ht, const char *domain, int *out_priority)
+_domain_track_get_priority(DomainTrackNode *root, const char *domain, int *out_priority)
 {
-    gpointer ptr;
+    DomainTrackNode *node = NULL;
 
-    if (!ht || !g_hash_table_lookup_extended(ht, domain, NULL, &ptr)) {
+    if (root)
+        node = _domain_track_walk(root, domain, FALSE, 0, NULL, NULL);
+
+    if (!node || !node->has_priority) {
         *out_priority = 0;
         return FALSE;
     }
-    *out_priority = GPOINTER_TO_INT(ptr);
+    *out_priority = node->priority;
     return TRUE;
 }
 
 /* Check if the domain is shadowed by a parent domain with more negative priority */
 static gboolean
-_domain_track_is_shadowed(GHashTable * ht,
-                          const char * domain,
-                          int          priority,
-                          const char **out_parent,
-                          int *        out_parent_priority)
+_domain_track_is_shadowed(DomainTrackNode *root,
+                          const char *     domain,
+                          int              priority,
+                          const char **    out_parent,
+                          int *            out_parent_priority)
 {
-    char *parent;
-    int   parent_priority;
+    *out_parent = NULL;
 
-    if (!ht)
+    if (!root)
         return FALSE;
 
-    nm_assert(!g_hash_table_contains(ht, domain));
+    return !_domain_track_walk(root, domain, FALSE, priority, out_parent, out_parent_priority)
+           && *out_parent;
+}
 
-    if (_domain_track_get_priority(ht, "", &parent_priority)) {
-        nm_assert(parent_priority <= priority);
-        if (parent_priority < 0 && parent_priority < priority) {
-            *out_parent          = "";
-            *out_parent_priority = parent_priority;
-            return TRUE;
-        }
-    }
+static void
+_domain_track_add(DomainTrackNode **p_root, const char *domain, int priority)
+{
+    DomainTrackNode *node;
 
-    parent = strchr(domain, '.');
-    while (parent && parent[1]) {
-        parent++;
-        if (_domain_track_get_priority(ht, parent, &parent_priority)) {
-            nm_assert(parent_priority <= priority);
-            if (parent_priority < 0 && parent_priority < priority) {
-                *out_parent          = parent;
-                *out_parent_priority = parent_priority;
-                return TRUE;
-            }
-        }
-        parent = strchr(parent, '.');
+    if (!*p_root) {
+        *p_root  = g_slice_new(DomainTrackNode);
+        **p_root = (DomainTrackNode){};
     }
 
-    return FALSE;
+    node               = _domain_track_walk(*p_root, domain, TRUE, 0, NULL, NULL);
+    node->priority     = priority;
+    node->has_priority = TRUE;
 }
 
 static void
 _mgr_configs_data_construct(NMDnsManager *self)
 {
     NMDnsConfigIPData *ip_data;
-    gs_unref_hashtable GHashTable *ht               = NULL;
-    gs_unref_hashtable GHashTable *wildcard_entries = NULL;
+    nm_auto_free_domain_track DomainTrackNode *track = NULL;
+    gs_unref_hashtable GHashTable *wildcard_entries  = NULL;
     CList *                        head;
     int                            prev_priority = G_MININT;
 
@@ -1520,7 +1986,7 @@ _mgr_configs_data_construct(NMDnsManager *self)
                 break;
 
             /* Remove domains with lower priority */
-            if (_domain_track_get_priority(ht, domain_clean, &old_priority)) {
+            if (_domain_track_get_priority(track, domain_clean, &old_priority)) {
                 nm_assert(old_priority <= priority);
                 if (old_priority < priority) {
                     _LOGT("plugin: drop domain %s%s%s (i=%d, p=%d) because it already exists "
@@ -1535,7 +2001,7 @@ _mgr_configs_data_construct(NMDnsManager *self)
                           old_priority);
                     continue;
                 }
-            } else if (_domain_track_is_shadowed(ht,
+            } else if (_domain_track_is_shadowed(track,
                                                  domain_clean,
                                                  priority,
                                                  &parent,
@@ -1559,9 +2025,7 @@ _mgr_configs_data_construct(NMDnsManager *self)
                 ip_data->data->ifindex,
                 priority);
 
-            if (!ht)
-                ht = g_hash_table_new(nm_str_hash, g_str_equal);
-            g_hash_table_insert(ht, (gpointer) domain_clean, GINT_TO_POINTER(priority));
+            _domain_track_add(&track, domain_clean, priority);
 
             if (check_default_route)
                 has_default_route_auto = TRUE;
@@ -1638,6 +2102,7 @@ update_dns(NMDnsManager *self, gboolean no_caching, GError **error)
     SpawnResult          result              = SR_SUCCESS;
     NMConfigData *       data;
     NMGlobalDnsConfig *  global_config;
+    RcWriteData *        rc_write;
     gs_free_error GError *local_error   = NULL;
     GError **const        p_local_error = error ? &local_error : NULL;
 
@@ -1721,7 +2186,9 @@ plugin_skip:;
      * guarantee they stay alive. */
     _mgr_configs_data_clear(self);
 
+    rc_write = g_slice_new0(RcWriteData);
     update_resolv_conf_no_stub(self,
+                               rc_write,
                                NM_CAST_STRV_CC(searches),
                                NM_CAST_STRV_CC(nameservers),
                                NM_CAST_STRV_CC(options));
@@ -1765,11 +2232,12 @@ plugin_skip:;
         case NM_DNS_MANAGER_RESOLV_CONF_MAN_SYMLINK:
         case NM_DNS_MANAGER_RESOLV_CONF_MAN_FILE:
             result              = update_resolv_conf(self,
+                                        rc_write,
                                         NM_CAST_STRV_CC(searches),
                                         NM_CAST_STRV_CC(nameservers),
                                         NM_CAST_STRV_CC(options),
-                                        p_local_error,
-                                        priv->rc_manager);
+                                        priv->rc_manager,
+                                        TRUE);
             resolv_conf_updated = TRUE;
             /* If we have ended with no nameservers avoid updating again resolv.conf
              * on stop, as some external changes may be applied to it in the meanwhile */
@@ -1795,11 +2263,12 @@ plugin_skip:;
             _LOGD("update-dns: program not available, writing to resolv.conf");
             g_clear_error(&local_error);
             result              = update_resolv_conf(self,
+                                        rc_write,
                                         NM_CAST_STRV_CC(searches),
                                         NM_CAST_STRV_CC(nameservers),
                                         NM_CAST_STRV_CC(options),
-                                        p_local_error,
-                                        NM_DNS_MANAGER_RESOLV_CONF_MAN_SYMLINK);
+                                        NM_DNS_MANAGER_RESOLV_CONF_MAN_SYMLINK,
+                                        TRUE);
             resolv_conf_updated = TRUE;
         }
     }
@@ -1808,21 +2277,25 @@ plugin_skip:;
      * ignoring any errors */
     if (!resolv_conf_updated) {
         update_resolv_conf(self,
+                           rc_write,
                            NM_CAST_STRV_CC(searches),
                            NM_CAST_STRV_CC(nameservers),
                            NM_CAST_STRV_CC(options),
-                           NULL,
-                           NM_DNS_MANAGER_RESOLV_CONF_MAN_UNMANAGED);
+                           NM_DNS_MANAGER_RESOLV_CONF_MAN_UNMANAGED,
+                           FALSE);
     }
 
-    /* signal that resolv.conf was changed */
+    _rc_write_queue(self, rc_write);
+
+    /* signal that resolv.conf was changed. For SR_PENDING, that happens
+     * once the helper or the writer finished. */
     if (do_update && result == SR_SUCCESS)
         g_signal_emit(self, signals[CONFIG_CHANGED], 0);
 
     nm_clear_pointer(&priv->config_variant, g_variant_unref);
     _notify(self, PROP_CONFIGURATION);
 
-    if (result != SR_SUCCESS) {
+    if (!NM_IN_SET(result, SR_SUCCESS, SR_PENDING)) {
         if (error)
             g_propagate_error(error, g_steal_pointer(&local_error));
         return FALSE;
@@ -2044,6 +2517,9 @@ nm_dns_manager_stop(NMDnsManager *self)
         priv->dns_touched = FALSE;
     }
 
+    _rc_spawn_flush_sync(self);
+    nm_dns_rc_writer_flush_sync(priv->rc_writer);
+
     priv->is_stopped = TRUE;
 }
 
@@ -2550,6 +3026,11 @@ nm_dns_manager_init(NMDnsManager *self)
 
     priv->config = g_object_ref(nm_config_get());
 
+    priv->rc_writer = nm_dns_rc_writer_new(_rc_write_thread_fn,
+                                           _rc_write_done,
+                                           (GDestroyNotify) _rc_write_data_free,
+                                           self);
+
     G_STATIC_ASSERT_EXPR(G_STRUCT_OFFSET(NMDnsConfigData, ifindex) == 0);
     priv->configs_dict = g_hash_table_new_full(nm_pint_hash,
                                                nm_pint_equals,
@@ -2595,6 +3076,8 @@ dispose(GObject *object)
 
     nm_clear_g_source(&priv->plugin_ratelimit.timer);
 
+    nm_clear_pointer(&priv->rc_writer, nm_dns_rc_writer_free);
+
     g_clear_object(&priv->config);
 
     G_OBJECT_CLASS(nm_dns_manager_parent_class)->dispose(object);
@@ -2611,6 +3094,10 @@ finalize(GObject *object)
     g_free(priv->hostname);
     g_free(priv->mode);
 
+    _rc_written_clear(&priv->rc_written);
+    _rc_written_clear(&priv->rc_written_no_stub);
+    _rc_written_clear(&priv->rc_written_spawn);
+
     G_OBJECT_CLASS(nm_dns_manager_parent_class)->finalize(object);
 }
 
@@ -0,0 +1,271 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+/*
+ * Copyright (C) 2021 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include "nm-dns-rc-writer.h"
+
+/*****************************************************************************/
+
+/* Writes resolv.conf files on a worker thread, so that a slow file system
+ * does not stall the main loop.
+ *
+ * Only one write is in flight at a time. A newer request replaces the one
+ * that waits for it, so a burst of updates results in at most one more
+ * write of the newest data. With a delay, the first request opens a window
+ * and only the newest data at its end gets written. */
+
+typedef struct {
+    NMDnsRcWriter *writer;
+    gpointer       data;
+    GError *       error;
+    guint64        seq;
+
+    /* set on the worker, if a newer job was written already. */
+    bool skipped;
+
+    /* set on the main thread, if nm_dns_rc_writer_flush_sync() wrote a
+     * newer job while this one was in flight. Not a bitfield next to
+     * @skipped, because the two threads write them concurrently. */
+    bool stale;
+} Job;
+
+struct _NMDnsRcWriter {
+    NMDnsRcWriterWriteFunc write_func;
+    NMDnsRcWriterDoneFunc  done_func;
+    GDestroyNotify         data_free;
+    gpointer               user_data;
+
+    GCancellable *cancellable;
+    GSource *     delay_source;
+
+    Job *job;
+    Job *next;
+
+    /* Serializes the writes of the worker with nm_dns_rc_writer_flush_sync().
+     * @written_seq is the sequence number of the newest job written so far,
+     * an older job is skipped. */
+    GMutex  lock;
+    guint64 written_seq;
+
+    guint64 last_seq;
+    int     ref_count;
+    guint   delay_msec;
+};
+
+/*****************************************************************************/
+
+static void
+_job_free(NMDnsRcWriter *self, Job *job)
+{
+    if (!job)
+        return;
+    if (self->data_free)
+        self->data_free(job->data);
+    g_clear_error(&job->error);
+    nm_g_slice_free(job);
+}
+
+static void
+_writer_unref(NMDnsRcWriter *self)
+{
+    nm_assert(self->ref_count > 0);
+
+    if (--self->ref_count > 0)
+        return;
+
+    nm_assert(!self->job);
+    nm_assert(!self->next);
+    nm_assert(!self->delay_source);
+
+    g_mutex_clear(&self->lock);
+    g_object_unref(self->cancellable);
+    nm_g_slice_free(self);
+}
+
+static gboolean
+_job_write(NMDnsRcWriter *self, Job *job)
+{
+    gboolean written = FALSE;
+
+    g_mutex_lock(&self->lock);
+    if (job->seq > self->written_seq) {
+        self->written_seq = job->seq;
+        self->write_func(job->data, &job->error);
+        written = TRUE;
+    }
+    g_mutex_unlock(&self->lock);
+    return written;
+}
+
+static void
+_job_thread_fn(GTask *task, gpointer source_object, gpointer task_data, GCancellable *cancellable)
+{
+    Job *job = task_data;
+
+    /* the main thread does not touch @job while it is in flight, except
+     * for setting @stale. */
+    job->skipped = !_job_write(job->writer, job);
+    g_task_return_boolean(task, TRUE);
+}
+
+static void _job_start(NMDnsRcWriter *self, Job *job);
+
+static void
+_job_done_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+    NMDnsRcWriter *self = user_data;
+    Job *          job  = g_steal_pointer(&self->job);
+
+    nm_assert(job);
+
+    if (!g_cancellable_is_cancelled(self->cancellable)) {
+        if (!job->skipped && !job->stale)
+            self->done_func(job->data, job->error, self->user_data);
+
+        /* the delay timeout starts the next job, if the window is open. */
+        if (self->next && !self->delay_source)
+            _job_start(self, g_steal_pointer(&self->next));
+    }
+
+    _job_free(self, job);
+    _writer_unref(self);
+}
+
+static void
+_job_start(NMDnsRcWriter *self, Job *job)
+{
+    GTask *task;
+
+    nm_assert(!self->job);
+
+    self->job = job;
+    self->ref_count++;
+
+    task = g_task_new(NULL, NULL, _job_done_cb, self);
+    g_task_set_task_data(task, job, NULL);
+    g_task_run_in_thread(task, _job_thread_fn);
+    g_object_unref(task);
+}
+
+static gboolean
+_delay_cb(gpointer user_data)
+{
+    NMDnsRcWriter *self = user_data;
+
+    nm_clear_g_source_inst(&self->delay_source);
+
+    if (self->next && !self->job)
+        _job_start(self, g_steal_pointer(&self->next));
+    return G_SOURCE_CONTINUE;
+}
+
+/*****************************************************************************/
+
+void
+nm_dns_rc_writer_set_delay(NMDnsRcWriter *self, guint delay_msec)
+{
+    g_return_if_fail(self);
+
+    self->delay_msec = delay_msec;
+}
+
+void
+nm_dns_rc_writer_queue(NMDnsRcWriter *self, gpointer data)
+{
+    Job *job;
+
+    g_return_if_fail(self);
+
+    job  = g_slice_new(Job);
+    *job = (Job){
+        .writer = self,
+        .data   = data,
+        .seq    = ++self->last_seq,
+    };
+
+    _job_free(self, self->next);
+    self->next = job;
+
+    if (self->delay_source)
+        return;
+
+    if (self->delay_msec > 0) {
+        self->delay_source = nm_g_timeout_add_source(self->delay_msec, _delay_cb, self);
+        return;
+    }
+
+    if (!self->job)
+        _job_start(self, g_steal_pointer(&self->next));
+}
+
+gboolean
+nm_dns_rc_writer_is_busy(NMDnsRcWriter *self)
+{
+    g_return_val_if_fail(self, FALSE);
+
+    return self->job || self->next;
+}
+
+void
+nm_dns_rc_writer_flush_sync(NMDnsRcWriter *self)
+{
+    Job *job;
+
+    g_return_if_fail(self);
+
+    nm_clear_g_source_inst(&self->delay_source);
+
+    job = g_steal_pointer(&self->next);
+    if (!job)
+        return;
+
+    /* Write the queued data right away. This waits for a write that is
+     * currently in flight, whose result is then superseded. */
+    if (self->job)
+        self->job->stale = TRUE;
+
+    if (_job_write(self, job))
+        self->done_func(job->data, job->error, self->user_data);
+    _job_free(self, job);
+}
+
+NMDnsRcWriter *
+nm_dns_rc_writer_new(NMDnsRcWriterWriteFunc write_func,
+                     NMDnsRcWriterDoneFunc  done_func,
+                     GDestroyNotify         data_free,
+                     gpointer               user_data)
+{
+    NMDnsRcWriter *self;
+
+    g_return_val_if_fail(write_func, NULL);
+    g_return_val_if_fail(done_func, NULL);
+
+    self  = g_slice_new(NMDnsRcWriter);
+    *self = (NMDnsRcWriter){
+        .write_func  = write_func,
+        .done_func   = done_func,
+        .data_free   = data_free,
+        .user_data   = user_data,
+        .cancellable = g_cancellable_new(),
+        .ref_count   = 1,
+    };
+    g_mutex_init(&self->lock);
+    return self;
+}
+
+void
+nm_dns_rc_writer_free(NMDnsRcWriter *self)
+{
+    if (!self)
+        return;
+
+    /* A write in flight keeps the writer alive until it completes, but
+     * it no longer reports back. */
+    g_cancellable_cancel(self->cancellable);
+    nm_clear_g_source_inst(&self->delay_source);
+    _job_free(self, g_steal_pointer(&self->next));
+    _writer_unref(self);
+}
@@ -0,0 +1,36 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+/*
+ * Copyright (C) 2021 Red Hat, Inc.
+ */
+
+#ifndef __NETWORKMANAGER_DNS_RC_WRITER_H__
+#define __NETWORKMANAGER_DNS_RC_WRITER_H__
+
+/*****************************************************************************/
+
+typedef struct _NMDnsRcWriter NMDnsRcWriter;
+
+/* Called on a worker thread (or, from nm_dns_rc_writer_flush_sync(), on the
+ * calling thread). It must not log nor touch state of the main thread. */
+typedef void (*NMDnsRcWriterWriteFunc)(gpointer data, GError **error);
+
+/* Called on the main thread after @data was written. It is not called for
+ * data that was superseded by a newer one before it was written. */
+typedef void (*NMDnsRcWriterDoneFunc)(gpointer data, GError *error, gpointer user_data);
+
+NMDnsRcWriter *nm_dns_rc_writer_new(NMDnsRcWriterWriteFunc write_func,
+                                    NMDnsRcWriterDoneFunc  done_func,
+                                    GDestroyNotify         data_free,
+                                    gpointer               user_data);
+
+void nm_dns_rc_writer_set_delay(NMDnsRcWriter *self, guint delay_msec);
+
+void nm_dns_rc_writer_queue(NMDnsRcWriter *self, gpointer data);
+
+gboolean nm_dns_rc_writer_is_busy(NMDnsRcWriter *self);
+
+void nm_dns_rc_writer_flush_sync(NMDnsRcWriter *self);
+
+void nm_dns_rc_writer_free(NMDnsRcWriter *self);
+
+#endif /* __NETWORKMANAGER_DNS_RC_WRITER_H__ */
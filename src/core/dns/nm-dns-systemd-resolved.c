@@ -34,37 +34,69 @@
 #define SYSTEMD_RESOLVED_MANAGER_IFACE "org.freedesktop.resolve1.Manager"
 #define SYSTEMD_RESOLVED_DBUS_PATH     "/org/freedesktop/resolve1"
 
-/* define a variable, so that we can compare the operation with pointer equality. */
-static const char *const DBUS_OP_SET_LINK_DEFAULT_ROUTE = "SetLinkDefaultRoute";
-
 /*****************************************************************************/
 
+typedef enum {
+    LINK_OP_DOMAINS,
+    LINK_OP_DEFAULT_ROUTE,
+    LINK_OP_MULTICAST_DNS,
+    LINK_OP_LLMNR,
+    LINK_OP_DNS,
+    _LINK_OP_NUM,
+} LinkOp;
+
+static const char *const _link_op_names[_LINK_OP_NUM] = {
+    [LINK_OP_DOMAINS]       = "SetLinkDomains",
+    [LINK_OP_DEFAULT_ROUTE] = "SetLinkDefaultRoute",
+    [LINK_OP_MULTICAST_DNS] = "SetLinkMulticastDNS",
+    [LINK_OP_LLMNR]         = "SetLinkLLMNR",
+    [LINK_OP_DNS]           = "SetLinkDNS",
+};
+
 typedef struct {
     int   ifindex;
     CList configs_lst_head;
 } InterfaceConfig;
 
+/* The state of one link in systemd-resolved. @args are the arguments for
+ * the D-Bus calls that we want, @args_sent what we last sent. Only the
+ * calls where the two differ need to be sent again. */
+typedef struct {
+    int       ifindex;
+    CList     dirty_lst;
+    GVariant *args[_LINK_OP_NUM];
+    GVariant *args_sent[_LINK_OP_NUM];
+
+    /* the number of calls for this link that are in flight. */
+    guint n_pending;
+
+    /* whether the link has a non-empty configuration in resolved. */
+    bool has_config : 1;
+
+    /* the link is no longer part of the DNS configuration. Once the
+     * reset calls completed successfully, the link state gets dropped. */
+    bool to_remove : 1;
+} LinkState;
+
 typedef struct {
-    CList                 request_queue_lst;
-    const char *          operation;
-    GVariant *            argument;
     NMDnsSystemdResolved *self;
+    GVariant *            argument;
     int                   ifindex;
-} RequestItem;
+    LinkOp                op;
+} RequestData;
 
 /*****************************************************************************/
 
 typedef struct {
     GDBusConnection *dbus_connection;
-    GHashTable *     dirty_interfaces;
+    GHashTable *     links;
     GCancellable *   cancellable;
-    CList            request_queue_lst_head;
+    CList            links_dirty_lst_head;
     guint            name_owner_changed_id;
     bool             send_updates_warn_ratelimited : 1;
     bool             try_start_blocked : 1;
     bool             dbus_has_owner : 1;
     bool             dbus_initied : 1;
-    bool             request_queue_to_send : 1;
     NMTernary        has_link_default_route : 3;
 } NMDnsSystemdResolvedPrivate;
 
@@ -91,30 +123,73 @@ G_DEFINE_TYPE(NMDnsSystemdResolved, nm_dns_systemd_resolved, NM_TYPE_DNS_PLUGIN)
 /*****************************************************************************/
 
 static void
-_request_item_free(RequestItem *request_item)
+_link_state_free(LinkState *ls)
 {
-    c_list_unlink_stale(&request_item->request_queue_lst);
-    g_variant_unref(request_item->argument);
-    nm_g_slice_free(request_item);
+    guint i;
+
+    c_list_unlink_stale(&ls->dirty_lst);
+    for (i = 0; i < _LINK_OP_NUM; i++) {
+        nm_clear_pointer(&ls->args[i], g_variant_unref);
+        nm_clear_pointer(&ls->args_sent[i], g_variant_unref);
+    }
+    nm_g_slice_free(ls);
+}
+
+static LinkState *
+_link_state_get(NMDnsSystemdResolved *self, int ifindex, gboolean create)
+{
+    NMDnsSystemdResolvedPrivate *priv = NM_DNS_SYSTEMD_RESOLVED_GET_PRIVATE(self);
+    LinkState *                  ls;
+
+    ls = g_hash_table_lookup(priv->links, &ifindex);
+    if (!ls && create) {
+        ls  = g_slice_new(LinkState);
+        *ls = (LinkState){
+            .ifindex   = ifindex,
+            .dirty_lst = C_LIST_INIT(ls->dirty_lst),
+        };
+        g_hash_table_add(priv->links, ls);
+    }
+    return ls;
 }
 
 static void
-_request_item_append(NMDnsSystemdResolved *self,
-                     const char *          operation,
-                     int                   ifindex,
-                     GVariant *            argument)
+_link_state_maybe_drop(NMDnsSystemdResolved *self, LinkState *ls)
+{
+    /* A link that is to be removed is dropped only after its reset calls
+     * succeeded. If one fails, call_done() still finds the link and marks it
+     * dirty again, so that the reset is retried. */
+    if (ls->to_remove && ls->n_pending == 0 && c_list_is_empty(&ls->dirty_lst))
+        g_hash_table_remove(NM_DNS_SYSTEMD_RESOLVED_GET_PRIVATE(self)->links, ls);
+}
+
+static gboolean
+_link_state_is_dirty(const LinkState *ls)
+{
+    guint i;
+
+    for (i = 0; i < _LINK_OP_NUM; i++) {
+        if (!ls->args_sent[i] || !g_variant_equal(ls->args[i], ls->args_sent[i]))
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static void
+_link_state_set_args(NMDnsSystemdResolved *self, LinkState *ls, GVariant **args)
 {
     NMDnsSystemdResolvedPrivate *priv = NM_DNS_SYSTEMD_RESOLVED_GET_PRIVATE(self);
-    RequestItem *                request_item;
-
-    request_item  = g_slice_new(RequestItem);
-    *request_item = (RequestItem){
-        .operation = operation,
-        .argument  = g_variant_ref_sink(argument),
-        .self      = self,
-        .ifindex   = ifindex,
-    };
-    c_list_link_tail(&priv->request_queue_lst_head, &request_item->request_queue_lst);
+    guint                        i;
+
+    for (i = 0; i < _LINK_OP_NUM; i++) {
+        nm_clear_pointer(&ls->args[i], g_variant_unref);
+        ls->args[i] = g_variant_ref_sink(args[i]);
+    }
+
+    if (!_link_state_is_dirty(ls))
+        c_list_unlink(&ls->dirty_lst);
+    else if (c_list_is_empty(&ls->dirty_lst))
+        c_list_link_tail(&priv->links_dirty_lst_head, &ls->dirty_lst);
 }
 
 /*****************************************************************************/
@@ -131,38 +206,57 @@ call_done(GObject *source, GAsyncResult *r, gpointer user_data)
 {
     gs_unref_variant GVariant *v       = NULL;
     gs_free_error GError *       error = NULL;
+    RequestData *                request_data;
     NMDnsSystemdResolved *       self;
     NMDnsSystemdResolvedPrivate *priv;
-    RequestItem *                request_item;
+    LinkState *                  ls;
     NMLogLevel                   log_level;
 
     v = g_dbus_connection_call_finish(G_DBUS_CONNECTION(source), r, &error);
+
+    request_data = user_data;
+
     if (nm_utils_error_is_cancelled(error))
-        return;
+        goto out;
+
+    self = request_data->self;
+    priv = NM_DNS_SYSTEMD_RESOLVED_GET_PRIVATE(self);
 
-    request_item = user_data;
-    self         = request_item->self;
-    priv         = NM_DNS_SYSTEMD_RESOLVED_GET_PRIVATE(self);
+    /* Links with calls in flight are never dropped, and a cancelled call
+     * (above) resets the counters. So the link is still there. */
+    ls = _link_state_get(self, request_data->ifindex, FALSE);
+    nm_assert(ls);
+    nm_assert(ls->n_pending > 0);
+    ls->n_pending--;
 
     if (v) {
-        if (request_item->operation == DBUS_OP_SET_LINK_DEFAULT_ROUTE
+        if (request_data->op == LINK_OP_DEFAULT_ROUTE
             && priv->has_link_default_route == NM_TERNARY_DEFAULT) {
             priv->has_link_default_route = NM_TERNARY_TRUE;
             _LOGD("systemd-resolved support for SetLinkDefaultRoute(): API supported");
         }
         priv->send_updates_warn_ratelimited = FALSE;
-        return;
+        _link_state_maybe_drop(self, ls);
+        goto out;
     }
 
-    if (request_item->operation == DBUS_OP_SET_LINK_DEFAULT_ROUTE
+    if (request_data->op == LINK_OP_DEFAULT_ROUTE
         && nm_g_error_matches(error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD)) {
         if (priv->has_link_default_route == NM_TERNARY_DEFAULT) {
             priv->has_link_default_route = NM_TERNARY_FALSE;
             _LOGD("systemd-resolved support for SetLinkDefaultRoute(): API not supported");
         }
-        return;
+        _link_state_maybe_drop(self, ls);
+        goto out;
     }
 
+    /* The call failed. Forget that we sent it and mark the link dirty, so
+     * that the next update retries it. */
+    if (ls->args_sent[request_data->op] == request_data->argument)
+        nm_clear_pointer(&ls->args_sent[request_data->op], g_variant_unref);
+    if (c_list_is_empty(&ls->dirty_lst))
+        c_list_link_tail(&priv->links_dirty_lst_head, &ls->dirty_lst);
+
     log_level = LOGL_DEBUG;
     if (!priv->send_updates_warn_ratelimited) {
         priv->send_updates_warn_ratelimited = TRUE;
@@ -170,9 +264,13 @@ call_done(GObject *source, GAsyncResult *r, gpointer user_data)
     }
     _NMLOG(log_level,
            "send-updates %s@%d failed: %s",
-           request_item->operation,
-           request_item->ifindex,
+           _link_op_names[request_data->op],
+           request_data->ifindex,
            error->message);
+
+out:
+    g_variant_unref(request_data->argument);
+    nm_g_slice_free(request_data);
 }
 
 static gboolean
@@ -224,19 +322,8 @@ update_add_ip_config(NMDnsSystemdResolved *self,
     return has_config;
 }
 
-static void
-free_pending_updates(NMDnsSystemdResolved *self)
-{
-    NMDnsSystemdResolvedPrivate *priv = NM_DNS_SYSTEMD_RESOLVED_GET_PRIVATE(self);
-    RequestItem *                request_item;
-
-    while ((request_item =
-                c_list_first_entry(&priv->request_queue_lst_head, RequestItem, request_queue_lst)))
-        _request_item_free(request_item);
-}
-
 static gboolean
-prepare_one_interface(NMDnsSystemdResolved *self, InterfaceConfig *ic)
+prepare_one_interface(NMDnsSystemdResolved *self, InterfaceConfig *ic, GVariant **args)
 {
     GVariantBuilder          dns;
     GVariantBuilder          domains;
@@ -308,20 +395,11 @@ prepare_one_interface(NMDnsSystemdResolved *self, InterfaceConfig *ic)
     if (!nm_str_is_empty(mdns_arg) || !nm_str_is_empty(llmnr_arg))
         has_config = TRUE;
 
-    _request_item_append(self, "SetLinkDomains", ic->ifindex, g_variant_builder_end(&domains));
-    _request_item_append(self,
-                         DBUS_OP_SET_LINK_DEFAULT_ROUTE,
-                         ic->ifindex,
-                         g_variant_new("(ib)", ic->ifindex, has_default_route));
-    _request_item_append(self,
-                         "SetLinkMulticastDNS",
-                         ic->ifindex,
-                         g_variant_new("(is)", ic->ifindex, mdns_arg ?: ""));
-    _request_item_append(self,
-                         "SetLinkLLMNR",
-                         ic->ifindex,
-                         g_variant_new("(is)", ic->ifindex, llmnr_arg ?: ""));
-    _request_item_append(self, "SetLinkDNS", ic->ifindex, g_variant_builder_end(&dns));
+    args[LINK_OP_DOMAINS]       = g_variant_builder_end(&domains);
+    args[LINK_OP_DEFAULT_ROUTE] = g_variant_new("(ib)", ic->ifindex, has_default_route);
+    args[LINK_OP_MULTICAST_DNS] = g_variant_new("(is)", ic->ifindex, mdns_arg ?: "");
+    args[LINK_OP_LLMNR]         = g_variant_new("(is)", ic->ifindex, llmnr_arg ?: "");
+    args[LINK_OP_DNS]           = g_variant_builder_end(&dns);
 
     return has_config;
 }
@@ -330,9 +408,13 @@ static void
 send_updates(NMDnsSystemdResolved *self)
 {
     NMDnsSystemdResolvedPrivate *priv = NM_DNS_SYSTEMD_RESOLVED_GET_PRIVATE(self);
-    RequestItem *                request_item;
+    LinkState *                  ls;
+    LinkState *                  ls_safe;
+    guint                        n_requests = 0;
+    guint                        n_links    = 0;
+    guint                        i;
 
-    if (!priv->request_queue_to_send) {
+    if (c_list_is_empty(&priv->links_dirty_lst_head)) {
         /* nothing to do. */
         return;
     }
@@ -362,51 +444,69 @@ send_updates(NMDnsSystemdResolved *self)
         return;
     }
 
-    nm_clear_g_cancellable(&priv->cancellable);
-
-    if (c_list_is_empty(&priv->request_queue_lst_head)) {
-        _LOGT("send-updates: no requests to send");
-        priv->request_queue_to_send = FALSE;
-        return;
-    }
-
-    _LOGT("send-updates: start %lu requests", c_list_length(&priv->request_queue_lst_head));
-
-    priv->cancellable = g_cancellable_new();
-
-    priv->request_queue_to_send = FALSE;
+    /* Requests that are still in flight are not cancelled. Every link only
+     * gets the calls for what changed since the last update, and D-Bus
+     * preserves the order of our calls. */
+    if (!priv->cancellable)
+        priv->cancellable = g_cancellable_new();
+
+    c_list_for_each_entry_safe (ls, ls_safe, &priv->links_dirty_lst_head, dirty_lst) {
+        c_list_unlink(&ls->dirty_lst);
+        n_links++;
+
+        for (i = 0; i < _LINK_OP_NUM; i++) {
+            RequestData *request_data;
+
+            if (ls->args_sent[i] && g_variant_equal(ls->args[i], ls->args_sent[i]))
+                continue;
+
+            nm_clear_pointer(&ls->args_sent[i], g_variant_unref);
+            ls->args_sent[i] = g_variant_ref(ls->args[i]);
+
+            if (i == LINK_OP_DEFAULT_ROUTE && priv->has_link_default_route == NM_TERNARY_FALSE) {
+                /* The "SetLinkDefaultRoute" API is only supported since v240.
+                 * We detected that it is not supported, and skip the call. There
+                 * is no special workaround, because in this case we rely on systemd-resolved
+                 * to do the right thing automatically. */
+                continue;
+            }
+
+            request_data  = g_slice_new(RequestData);
+            *request_data = (RequestData){
+                .self     = self,
+                .argument = g_variant_ref(ls->args[i]),
+                .ifindex  = ls->ifindex,
+                .op       = i,
+            };
 
-    c_list_for_each_entry (request_item, &priv->request_queue_lst_head, request_queue_lst) {
-        if (request_item->operation == DBUS_OP_SET_LINK_DEFAULT_ROUTE
-            && priv->has_link_default_route == NM_TERNARY_FALSE) {
-            /* The "SetLinkDefaultRoute" API is only supported since v240.
-             * We detected that it is not supported, and skip the call. There
-             * is no special workaround, because in this case we rely on systemd-resolved
-             * to do the right thing automatically. */
-            continue;
+            /* Above we explicitly call "StartServiceByName" trying to avoid D-Bus activating systmd-resolved
+             * multiple times. There is still a race, were we might hit this line although actually
+             * the service just quit this very moment. In that case, we would try to D-Bus activate the
+             * service multiple times during each call (something we wanted to avoid).
+             *
+             * But this is hard to avoid, because we'd have to check the error failure to detect the reason
+             * and retry. The race is not critical, because at worst it results in logging a warning
+             * about failure to start systemd.resolved. */
+            g_dbus_connection_call(priv->dbus_connection,
+                                   SYSTEMD_RESOLVED_DBUS_SERVICE,
+                                   SYSTEMD_RESOLVED_DBUS_PATH,
+                                   SYSTEMD_RESOLVED_MANAGER_IFACE,
+                                   _link_op_names[i],
+                                   ls->args[i],
+                                   NULL,
+                                   G_DBUS_CALL_FLAGS_NONE,
+                                   -1,
+                                   priv->cancellable,
+                                   call_done,
+                                   request_data);
+            ls->n_pending++;
+            n_requests++;
         }
 
-        /* Above we explicitly call "StartServiceByName" trying to avoid D-Bus activating systmd-resolved
-         * multiple times. There is still a race, were we might hit this line although actually
-         * the service just quit this very moment. In that case, we would try to D-Bus activate the
-         * service multiple times during each call (something we wanted to avoid).
-         *
-         * But this is hard to avoid, because we'd have to check the error failure to detect the reason
-         * and retry. The race is not critical, because at worst it results in logging a warning
-         * about failure to start systemd.resolved. */
-        g_dbus_connection_call(priv->dbus_connection,
-                               SYSTEMD_RESOLVED_DBUS_SERVICE,
-                               SYSTEMD_RESOLVED_DBUS_PATH,
-                               SYSTEMD_RESOLVED_MANAGER_IFACE,
-                               request_item->operation,
-                               request_item->argument,
-                               NULL,
-                               G_DBUS_CALL_FLAGS_NONE,
-                               -1,
-                               priv->cancellable,
-                               call_done,
-                               request_item);
+        _link_state_maybe_drop(self, ls);
     }
+
+    _LOGT("send-updates: sent %u requests for %u links", n_requests, n_links);
 }
 
 static gboolean
@@ -422,8 +522,8 @@ update(NMDnsPlugin *            plugin,
     gs_free gpointer * interfaces_keys        = NULL;
     guint              interfaces_len;
     int                ifindex;
-    gpointer           pointer;
     NMDnsConfigIPData *ip_data;
+    LinkState *        ls;
     GHashTableIter     iter;
     guint              i;
 
@@ -447,39 +547,56 @@ update(NMDnsPlugin *            plugin,
         c_list_link_tail(&ic->configs_lst_head, &nm_c_list_elem_new_stale(ip_data)->lst);
     }
 
-    free_pending_updates(self);
-
     interfaces_keys =
         nm_utils_hash_keys_to_array(interfaces, nm_cmp_int2ptr_p_with_data, NULL, &interfaces_len);
     for (i = 0; i < interfaces_len; i++) {
         InterfaceConfig *ic = g_hash_table_lookup(interfaces, GINT_TO_POINTER(interfaces_keys[i]));
+        GVariant *       args[_LINK_OP_NUM];
 
-        if (prepare_one_interface(self, ic))
-            g_hash_table_add(priv->dirty_interfaces, GINT_TO_POINTER(ic->ifindex));
-        else
-            g_hash_table_remove(priv->dirty_interfaces, GINT_TO_POINTER(ic->ifindex));
+        ls             = _link_state_get(self, ic->ifindex, TRUE);
+        ls->has_config = prepare_one_interface(self, ic, args);
+        ls->to_remove  = FALSE;
+        _link_state_set_args(self, ls, args);
     }
 
     /* If we previously configured an ifindex with non-empty values in
      * resolved, and the current update doesn't contain that interface,
-     * reset the resolved configuration for that ifindex. */
-    g_hash_table_iter_init(&iter, priv->dirty_interfaces);
-    while (g_hash_table_iter_next(&iter, (gpointer *) &pointer, NULL)) {
-        ifindex = GPOINTER_TO_INT(pointer);
-        if (!g_hash_table_contains(interfaces, GINT_TO_POINTER(ifindex))) {
-            InterfaceConfig ic;
-
-            _LOGT("clear previously configured ifindex %d", ifindex);
-            ic = (InterfaceConfig){
-                .ifindex          = ifindex,
-                .configs_lst_head = C_LIST_INIT(ic.configs_lst_head),
-            };
-            prepare_one_interface(self, &ic);
+     * reset the resolved configuration for that ifindex. Links that never
+     * had a configuration are just forgotten. */
+    g_hash_table_iter_init(&iter, priv->links);
+    while (g_hash_table_iter_next(&iter, (gpointer *) &ls, NULL)) {
+        InterfaceConfig ic;
+        GVariant *      args[_LINK_OP_NUM];
+
+        if (g_hash_table_contains(interfaces, GINT_TO_POINTER(ls->ifindex)))
+            continue;
+
+        if (ls->to_remove) {
+            /* the reset did not complete yet, for example because resolved
+             * has no name owner. Keep the link until it did. */
+            continue;
+        }
+
+        if (!ls->has_config && ls->n_pending == 0) {
+            g_hash_table_iter_remove(&iter);
+            continue;
+        }
+
+        _LOGT("clear previously configured ifindex %d", ls->ifindex);
+        ic = (InterfaceConfig){
+            .ifindex          = ls->ifindex,
+            .configs_lst_head = C_LIST_INIT(ic.configs_lst_head),
+        };
+        prepare_one_interface(self, &ic, args);
+        ls->has_config = FALSE;
+        ls->to_remove  = TRUE;
+        _link_state_set_args(self, ls, args);
+        if (c_list_is_empty(&ls->dirty_lst) && ls->n_pending == 0) {
+            /* resolved already has the empty configuration. */
             g_hash_table_iter_remove(&iter);
         }
     }
 
-    priv->request_queue_to_send = TRUE;
     send_updates(self);
     return TRUE;
 }
@@ -490,6 +607,9 @@ static void
 name_owner_changed(NMDnsSystemdResolved *self, const char *owner)
 {
     NMDnsSystemdResolvedPrivate *priv = NM_DNS_SYSTEMD_RESOLVED_GET_PRIVATE(self);
+    GHashTableIter               iter;
+    LinkState *                  ls;
+    guint                        i;
 
     owner = nm_str_not_empty(owner);
 
@@ -498,10 +618,26 @@ name_owner_changed(NMDnsSystemdResolved *self, const char *owner)
     else
         _LOGT("D-Bus name for systemd-resolved has owner %s", owner);
 
+    /* requests to a previous owner are obsolete. Their callbacks see the
+     * cancellation and don't touch the links. */
+    nm_clear_g_cancellable(&priv->cancellable);
+    g_hash_table_iter_init(&iter, priv->links);
+    while (g_hash_table_iter_next(&iter, (gpointer *) &ls, NULL))
+        ls->n_pending = 0;
+
     priv->dbus_has_owner = !!owner;
     if (owner) {
-        priv->try_start_blocked     = FALSE;
-        priv->request_queue_to_send = TRUE;
+        priv->try_start_blocked = FALSE;
+
+        /* a new instance of resolved knows nothing about our links. Resend
+         * everything. */
+        g_hash_table_iter_init(&iter, priv->links);
+        while (g_hash_table_iter_next(&iter, (gpointer *) &ls, NULL)) {
+            for (i = 0; i < _LINK_OP_NUM; i++)
+                nm_clear_pointer(&ls->args_sent[i], g_variant_unref);
+            if (c_list_is_empty(&ls->dirty_lst))
+                c_list_link_tail(&priv->links_dirty_lst_head, &ls->dirty_lst);
+        }
     } else
         priv->has_link_default_route = NM_TERNARY_DEFAULT;
 
@@ -569,6 +705,22 @@ nm_dns_systemd_resolved_is_running(NMDnsSystemdResolved *self)
     return priv->dbus_initied && (priv->dbus_has_owner || !priv->try_start_blocked);
 }
 
+gboolean
+_nmtst_dns_systemd_resolved_get_link(NMDnsSystemdResolved *self,
+                                     int                   ifindex,
+                                     gboolean *            out_pending,
+                                     gboolean *            out_to_remove)
+{
+    LinkState *ls;
+
+    g_return_val_if_fail(NM_IS_DNS_SYSTEMD_RESOLVED(self), FALSE);
+
+    ls = _link_state_get(self, ifindex, FALSE);
+    NM_SET_OUT(out_pending, ls && !c_list_is_empty(&ls->dirty_lst));
+    NM_SET_OUT(out_to_remove, ls && ls->to_remove);
+    return !!ls;
+}
+
 /*****************************************************************************/
 
 static void
@@ -578,8 +730,11 @@ nm_dns_systemd_resolved_init(NMDnsSystemdResolved *self)
 
     priv->has_link_default_route = NM_TERNARY_DEFAULT;
 
-    c_list_init(&priv->request_queue_lst_head);
-    priv->dirty_interfaces = g_hash_table_new(nm_direct_hash, NULL);
+    c_list_init(&priv->links_dirty_lst_head);
+    priv->links = g_hash_table_new_full(nm_pint_hash,
+                                        nm_pint_equals,
+                                        (GDestroyNotify) _link_state_free,
+                                        NULL);
 
     priv->dbus_connection = nm_g_object_ref(NM_MAIN_DBUS_CONNECTION_GET);
     if (!priv->dbus_connection) {
@@ -614,14 +769,12 @@ dispose(GObject *object)
     NMDnsSystemdResolved *       self = NM_DNS_SYSTEMD_RESOLVED(object);
     NMDnsSystemdResolvedPrivate *priv = NM_DNS_SYSTEMD_RESOLVED_GET_PRIVATE(self);
 
-    free_pending_updates(self);
-
     nm_clear_g_dbus_connection_signal(priv->dbus_connection, &priv->name_owner_changed_id);
 
     nm_clear_g_cancellable(&priv->cancellable);
 
     g_clear_object(&priv->dbus_connection);
-    nm_clear_pointer(&priv->dirty_interfaces, g_hash_table_unref);
+    nm_clear_pointer(&priv->links, g_hash_table_unref);
 
     G_OBJECT_CLASS(nm_dns_systemd_resolved_parent_class)->dispose(object);
 }
@@ -30,4 +30,9 @@ NMDnsPlugin *nm_dns_systemd_resolved_new(void);
 
 gboolean nm_dns_systemd_resolved_is_running(NMDnsSystemdResolved *self);
 
+gboolean _nmtst_dns_systemd_resolved_get_link(NMDnsSystemdResolved *self,
+                                              int                   ifindex,
+                                              gboolean *            out_pending,
+                                              gboolean *            out_to_remove);
+
 #endif /* __NETWORKMANAGER_DNS_SYSTEMD_RESOLVED_H__ */
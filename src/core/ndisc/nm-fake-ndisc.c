@@ -222,6 +222,19 @@ send_rs(NMNDisc *ndisc, GError **error)
     return TRUE;
 }
 
+static gboolean receive_ra(gpointer user_data);
+
+static guint
+_schedule_ra(NMFakeNDisc *self, guint when)
+{
+    /* second timeouts get rounded to full seconds. RAs that are supposed to
+     * follow immediately are scheduled on idle, so that tests can replay
+     * bursts of RAs without waiting a second for each. */
+    if (when == 0)
+        return g_idle_add(receive_ra, self);
+    return g_timeout_add_seconds(when, receive_ra, self);
+}
+
 static gboolean
 receive_ra(gpointer user_data)
 {
@@ -312,7 +325,7 @@ receive_ra(gpointer user_data)
     /* Schedule next RA */
     if (priv->ras) {
         ra                  = priv->ras->data;
-        priv->receive_ra_id = g_timeout_add_seconds(ra->when, receive_ra, self);
+        priv->receive_ra_id = _schedule_ra(self, ra->when);
     }
 
     return G_SOURCE_REMOVE;
@@ -329,7 +342,7 @@ start(NMNDisc *ndisc)
     ra = priv->ras->data;
 
     g_assert(!priv->receive_ra_id);
-    priv->receive_ra_id = g_timeout_add_seconds(ra->when, receive_ra, ndisc);
+    priv->receive_ra_id = _schedule_ra(NM_FAKE_NDISC(ndisc), ra->when);
 }
 
 static void
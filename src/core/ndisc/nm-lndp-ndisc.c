@@ -24,9 +24,28 @@
 
 /*****************************************************************************/
 
+/* All NMLndpNDisc instances in a network namespace share one raw ICMPv6
+ * socket (one libndp instance). The kernel only passes router solicitations
+ * and advertisements to the socket, and received messages are dispatched to
+ * the instance for the ifindex that libndp got from IPV6_PKTINFO. */
 typedef struct {
+    CList       shared_lst;
+    NMPNetns *  netns;
     struct ndp *ndp;
     GSource *   event_source;
+    GHashTable *ndisc_by_ifindex;
+    int         ref_count;
+} NMLndpShared;
+
+typedef struct {
+    NMLndpShared *shared;
+
+    /* The instance that was started on the same ifindex before this one.
+     * Only the newest instance for an ifindex receives messages. When it
+     * stops, the older one takes over again. */
+    NMNDisc *shadowed;
+
+    bool started : 1;
 } NMLndpNDiscPrivate;
 
 /*****************************************************************************/
@@ -49,6 +68,10 @@ G_DEFINE_TYPE(NMLndpNDisc, nm_lndp_ndisc, NM_TYPE_NDISC)
 
 /*****************************************************************************/
 
+static CList _shared_lst_head = C_LIST_INIT(_shared_lst_head);
+
+/*****************************************************************************/
+
 static gboolean
 send_rs(NMNDisc *ndisc, GError **error)
 {
@@ -66,7 +89,7 @@ send_rs(NMNDisc *ndisc, GError **error)
     }
     ndp_msg_ifindex_set(msg, nm_ndisc_get_ifindex(ndisc));
 
-    errsv = ndp_msg_send(priv->ndp, msg);
+    errsv = ndp_msg_send(priv->shared->ndp, msg);
     ndp_msg_destroy(msg);
     if (errsv) {
         errsv = nm_errno_native(errsv);
@@ -544,7 +567,7 @@ dns_servers_done:
     }
 dns_domains_done:
 
-    errsv = ndp_msg_send(priv->ndp, msg);
+    errsv = ndp_msg_send(priv->shared->ndp, msg);
 
     ndp_msg_destroy(msg);
     if (errsv) {
@@ -570,92 +593,228 @@ receive_rs(struct ndp *ndp, struct ndp_msg *msg, gpointer user_data)
     return 0;
 }
 
+static int
+_shared_receive(struct ndp *ndp, struct ndp_msg *msg, gpointer user_data)
+{
+    NMLndpShared *           shared = user_data;
+    gs_unref_object NMNDisc *ndisc  = NULL;
+
+    ndisc = nm_g_object_ref(
+        g_hash_table_lookup(shared->ndisc_by_ifindex, GINT_TO_POINTER(ndp_msg_ifindex(msg))));
+    if (!ndisc)
+        return 0;
+
+    switch (ndp_msg_type(msg)) {
+    case NDP_MSG_RA:
+        if (nm_ndisc_get_node_type(ndisc) == NM_NDISC_NODE_TYPE_HOST)
+            return receive_ra(ndp, msg, ndisc);
+        break;
+    case NDP_MSG_RS:
+        if (nm_ndisc_get_node_type(ndisc) == NM_NDISC_NODE_TYPE_ROUTER)
+            return receive_rs(ndp, msg, ndisc);
+        break;
+    default:
+        break;
+    }
+    return 0;
+}
+
+static NMLndpShared *
+_shared_ref(NMLndpShared *shared)
+{
+    nm_assert(shared);
+    nm_assert(shared->ref_count > 0);
+
+    shared->ref_count++;
+    return shared;
+}
+
+static void
+_shared_unref(NMLndpShared *shared)
+{
+    nm_assert(shared);
+    nm_assert(shared->ref_count > 0);
+
+    if (--shared->ref_count > 0)
+        return;
+
+    nm_assert(g_hash_table_size(shared->ndisc_by_ifindex) == 0);
+
+    _LOG(LOGL_DEBUG, _NMLOG_DOMAIN, NULL, "close shared libndp socket");
+
+    c_list_unlink_stale(&shared->shared_lst);
+    nm_clear_g_source_inst(&shared->event_source);
+    ndp_msgrcv_handler_unregister(shared->ndp, _shared_receive, NDP_MSG_ALL, 0, shared);
+    ndp_close(shared->ndp);
+    g_hash_table_unref(shared->ndisc_by_ifindex);
+    g_clear_object(&shared->netns);
+    nm_g_slice_free(shared);
+}
+
+NM_AUTO_DEFINE_FCN0(NMLndpShared *, _nm_auto_unref_shared, _shared_unref);
+#define nm_auto_unref_shared nm_auto(_nm_auto_unref_shared)
+
 static gboolean
-event_ready(int fd, GIOCondition condition, gpointer user_data)
+_shared_event_ready(int fd, GIOCondition condition, gpointer user_data)
 {
-    gs_unref_object NMNDisc *ndisc    = g_object_ref(NM_NDISC(user_data));
-    nm_auto_pop_netns NMPNetns *netns = NULL;
-    NMLndpNDiscPrivate *        priv  = NM_LNDP_NDISC_GET_PRIVATE(ndisc);
+    nm_auto_unref_shared NMLndpShared *shared = _shared_ref(user_data);
+    nm_auto_pop_netns NMPNetns *netns         = NULL;
 
-    _LOGD("processing libndp events");
+    _LOG(LOGL_DEBUG, _NMLOG_DOMAIN, NULL, "processing libndp events");
 
-    if (!nm_ndisc_netns_push(ndisc, &netns)) {
-        /* something is very wrong. Stop handling events. */
-        nm_clear_g_source_inst(&priv->event_source);
-        return G_SOURCE_REMOVE;
+    if (shared->netns) {
+        if (!nmp_netns_push(shared->netns)) {
+            /* something is very wrong. Stop handling events. */
+            nm_clear_g_source_inst(&shared->event_source);
+            return G_SOURCE_REMOVE;
+        }
+        netns = shared->netns;
     }
 
-    ndp_callall_eventfd_handler(priv->ndp);
+    /* The handler list of the libndp instance only contains _shared_receive(),
+     * so it does not get modified while libndp iterates over it. */
+    ndp_callall_eventfd_handler(shared->ndp);
     return G_SOURCE_CONTINUE;
 }
 
-static void
-start(NMNDisc *ndisc)
+/* Must be called with @netns pushed as current network namespace. */
+static NMLndpShared *
+_shared_acquire(NMPNetns *netns, GError **error)
 {
-    NMLndpNDiscPrivate *priv = NM_LNDP_NDISC_GET_PRIVATE(ndisc);
+    NMLndpShared *      shared;
+    struct ndp *        ndp;
+    struct icmp6_filter filter;
+    int                 errsv;
     int                 fd;
 
-    g_return_if_fail(!priv->event_source);
+    c_list_for_each_entry (shared, &_shared_lst_head, shared_lst) {
+        if (shared->netns == netns)
+            return _shared_ref(shared);
+    }
 
-    fd = ndp_get_eventfd(priv->ndp);
+    errsv = ndp_open(&ndp);
+    if (errsv != 0) {
+        errsv = nm_errno_native(errsv);
+        g_set_error(error,
+                    NM_UTILS_ERROR,
+                    NM_UTILS_ERROR_UNKNOWN,
+                    "failure creating libndp socket: %s (%d)",
+                    nm_strerror_native(errsv),
+                    errsv);
+        return NULL;
+    }
 
-    priv->event_source =
-        nm_g_unix_fd_source_new(fd, G_IO_IN, G_PRIORITY_DEFAULT, event_ready, ndisc, NULL);
-    g_source_attach(priv->event_source, NULL);
+    fd = ndp_get_eventfd(ndp);
+
+    /* We only ever handle RA and RS messages. Let the kernel drop all other
+     * ICMPv6 types, so that we are not woken up for them. */
+    ICMP6_FILTER_SETBLOCKALL(&filter);
+    ICMP6_FILTER_SETPASS(ND_ROUTER_SOLICIT, &filter);
+    ICMP6_FILTER_SETPASS(ND_ROUTER_ADVERT, &filter);
+    if (setsockopt(fd, IPPROTO_ICMPV6, ICMP6_FILTER, &filter, sizeof(filter)) != 0) {
+        errsv = errno;
+        _LOG(LOGL_DEBUG,
+             _NMLOG_DOMAIN,
+             NULL,
+             "failure setting ICMPv6 filter on libndp socket: %s",
+             nm_strerror_native(errsv));
+    }
 
-    /* Flush any pending messages to avoid using obsolete information */
-    event_ready(fd, 0, ndisc);
+    shared  = g_slice_new(NMLndpShared);
+    *shared = (NMLndpShared){
+        .netns            = nm_g_object_ref(netns),
+        .ndp              = ndp,
+        .ndisc_by_ifindex = g_hash_table_new(nm_direct_hash, NULL),
+        .ref_count        = 1,
+    };
+    c_list_link_tail(&_shared_lst_head, &shared->shared_lst);
+
+    ndp_msgrcv_handler_register(shared->ndp, _shared_receive, NDP_MSG_ALL, 0, shared);
+
+    shared->event_source = nm_g_unix_fd_source_new(fd,
+                                                   G_IO_IN,
+                                                   G_PRIORITY_DEFAULT,
+                                                   _shared_event_ready,
+                                                   shared,
+                                                   NULL);
+    g_source_attach(shared->event_source, NULL);
+
+    _LOG(LOGL_DEBUG, _NMLOG_DOMAIN, NULL, "open shared libndp socket");
+    return shared;
+}
 
-    switch (nm_ndisc_get_node_type(ndisc)) {
-    case NM_NDISC_NODE_TYPE_HOST:
-        ndp_msgrcv_handler_register(priv->ndp,
-                                    receive_ra,
-                                    NDP_MSG_RA,
-                                    nm_ndisc_get_ifindex(ndisc),
-                                    ndisc);
-        break;
-    case NM_NDISC_NODE_TYPE_ROUTER:
-        ndp_msgrcv_handler_register(priv->ndp,
-                                    receive_rs,
-                                    NDP_MSG_RS,
-                                    nm_ndisc_get_ifindex(ndisc),
-                                    ndisc);
-        break;
-    default:
-        g_assert_not_reached();
+/*****************************************************************************/
+
+static void
+start(NMNDisc *ndisc)
+{
+    NMLndpNDiscPrivate *priv    = NM_LNDP_NDISC_GET_PRIVATE(ndisc);
+    int                 ifindex = nm_ndisc_get_ifindex(ndisc);
+
+    g_return_if_fail(priv->shared);
+    g_return_if_fail(!priv->started);
+
+    nm_assert(NM_IN_SET(nm_ndisc_get_node_type(ndisc),
+                        NM_NDISC_NODE_TYPE_HOST,
+                        NM_NDISC_NODE_TYPE_ROUTER));
+
+    /* Flush any pending messages to avoid using obsolete information. Messages
+     * for other interfaces are still delivered to their instances, but those
+     * that were queued for this ifindex before we started don't reach us. */
+    _shared_event_ready(ndp_get_eventfd(priv->shared->ndp), 0, priv->shared);
+    if (!priv->shared) {
+        /* A handler for another interface stopped us. */
+        return;
     }
+
+    priv->shadowed =
+        g_hash_table_lookup(priv->shared->ndisc_by_ifindex, GINT_TO_POINTER(ifindex));
+    if (priv->shadowed)
+        _LOGD("shadow instance %p as receiver for ifindex %d", priv->shadowed, ifindex);
+
+    g_hash_table_insert(priv->shared->ndisc_by_ifindex, GINT_TO_POINTER(ifindex), ndisc);
+    priv->started = TRUE;
 }
 
 static void
 _cleanup(NMNDisc *ndisc)
 {
     NMLndpNDiscPrivate *priv = NM_LNDP_NDISC_GET_PRIVATE(ndisc);
+    gpointer            ifindex_p;
+    NMNDisc *           top;
+
+    if (!priv->shared)
+        return;
+
+    if (priv->started) {
+        priv->started = FALSE;
+        ifindex_p     = GINT_TO_POINTER(nm_ndisc_get_ifindex(ndisc));
+        top           = g_hash_table_lookup(priv->shared->ndisc_by_ifindex, ifindex_p);
+
+        nm_assert(top);
+
+        if (top == ndisc) {
+            if (priv->shadowed) {
+                _LOGD("instance %p receives again for ifindex %d",
+                      priv->shadowed,
+                      GPOINTER_TO_INT(ifindex_p));
+                g_hash_table_insert(priv->shared->ndisc_by_ifindex, ifindex_p, priv->shadowed);
+            } else
+                g_hash_table_remove(priv->shared->ndisc_by_ifindex, ifindex_p);
+        } else {
+            NMLndpNDiscPrivate *p = NM_LNDP_NDISC_GET_PRIVATE(top);
 
-    nm_clear_g_source_inst(&priv->event_source);
-
-    if (priv->ndp) {
-        switch (nm_ndisc_get_node_type(ndisc)) {
-        case NM_NDISC_NODE_TYPE_HOST:
-            ndp_msgrcv_handler_unregister(priv->ndp,
-                                          receive_ra,
-                                          NDP_MSG_RA,
-                                          nm_ndisc_get_ifindex(ndisc),
-                                          ndisc);
-            break;
-        case NM_NDISC_NODE_TYPE_ROUTER:
-            ndp_msgrcv_handler_unregister(priv->ndp,
-                                          receive_rs,
-                                          NDP_MSG_RS,
-                                          nm_ndisc_get_ifindex(ndisc),
-                                          ndisc);
-            break;
-        default:
-            nm_assert_not_reached();
-            break;
+            /* We are shadowed by a newer instance. Unlink us from the chain. */
+            while (p->shadowed != ndisc) {
+                nm_assert(p->shadowed);
+                p = NM_LNDP_NDISC_GET_PRIVATE(p->shadowed);
+            }
+            p->shadowed = priv->shadowed;
         }
-        ndp_close(priv->ndp);
-        priv->ndp = NULL;
+        priv->shadowed = NULL;
     }
+
+    nm_clear_pointer(&priv->shared, _shared_unref);
 }
 
 static void
@@ -750,7 +909,6 @@ nm_lndp_ndisc_new(NMPlatform *                  platform,
     nm_auto_pop_netns NMPNetns *netns = NULL;
     NMNDisc *                   ndisc;
     NMLndpNDiscPrivate *        priv;
-    int                         errsv;
 
     g_return_val_if_fail(NM_IS_PLATFORM(platform), NULL);
     g_return_val_if_fail(!error || !*error, NULL);
@@ -786,16 +944,8 @@ nm_lndp_ndisc_new(NMPlatform *                  platform,
 
     priv = NM_LNDP_NDISC_GET_PRIVATE(ndisc);
 
-    errsv = ndp_open(&priv->ndp);
-
-    if (errsv != 0) {
-        errsv = nm_errno_native(errsv);
-        g_set_error(error,
-                    NM_UTILS_ERROR,
-                    NM_UTILS_ERROR_UNKNOWN,
-                    "failure creating libndp socket: %s (%d)",
-                    nm_strerror_native(errsv),
-                    errsv);
+    priv->shared = _shared_acquire(netns, error);
+    if (!priv->shared) {
         g_object_unref(ndisc);
         return NULL;
     }
@@ -49,6 +49,13 @@ struct _NMNDiscPrivate {
 
     GSource *timeout_expire_source;
 
+    /* A lower bound for the earliest expiry of all tracked items. Until then,
+     * nothing can expire and check_timestamps() does not need to walk the lists. */
+    gint64 expiry_next_msec;
+
+    /* The expiry for which timeout_expire_source is scheduled. */
+    gint64 timeout_expire_msec;
+
     NMUtilsIPv6IfaceId iid;
 
     /* immutable values: */
@@ -269,6 +276,15 @@ _get_exp(char *buf, gsize buf_size, gint64 now_msec, gint64 expiry_time)
 #define get_exp(buf, now_msec, item) \
     _get_exp((buf), G_N_ELEMENTS(buf), (now_msec), (item)->expiry_msec)
 
+static void
+_expiry_track(NMNDisc *ndisc, gint64 expiry_msec)
+{
+    NMNDiscPrivate *priv = NM_NDISC_GET_PRIVATE(ndisc);
+
+    if (priv->expiry_next_msec > expiry_msec)
+        priv->expiry_next_msec = expiry_msec;
+}
+
 /*****************************************************************************/
 
 NMPNetns *
@@ -399,6 +415,8 @@ nm_ndisc_add_gateway(NMNDisc *ndisc, const NMNDiscGateway *new_item, gint64 now_
     guint                i;
     guint                insert_idx = G_MAXUINT;
 
+    _expiry_track(ndisc, new_item->expiry_msec);
+
     for (i = 0; i < rdata->gateways->len;) {
         NMNDiscGateway *item = &g_array_index(rdata->gateways, NMNDiscGateway, i);
 
@@ -516,6 +534,10 @@ nm_ndisc_add_address(NMNDisc *             ndisc,
     nm_assert(new_item->expiry_preferred_msec <= new_item->expiry_msec);
     nm_assert((!!from_ra) == (now_msec > 0));
 
+    /* when updating an existing address from an RA, the resulting expiry is
+     * never earlier than new_item->expiry_msec. */
+    _expiry_track(ndisc, new_item->expiry_msec);
+
     for (i = 0; i < rdata->addresses->len; i++) {
         NMNDiscAddress *item = &g_array_index(rdata->addresses, NMNDiscAddress, i);
 
@@ -648,6 +670,8 @@ nm_ndisc_add_route(NMNDisc *ndisc, const NMNDiscRoute *new_item, gint64 now_msec
     priv  = NM_NDISC_GET_PRIVATE(ndisc);
     rdata = &priv->rdata;
 
+    _expiry_track(ndisc, new_item->expiry_msec);
+
     for (i = 0; i < rdata->routes->len;) {
         NMNDiscRoute *item = &g_array_index(rdata->routes, NMNDiscRoute, i);
 
@@ -704,6 +728,8 @@ nm_ndisc_add_dns_server(NMNDisc *ndisc, const NMNDiscDNSServer *new_item, gint64
     priv  = NM_NDISC_GET_PRIVATE(ndisc);
     rdata = &priv->rdata;
 
+    _expiry_track(ndisc, new_item->expiry_msec);
+
     for (i = 0; i < rdata->dns_servers->len; i++) {
         NMNDiscDNSServer *item = &g_array_index(rdata->dns_servers, NMNDiscDNSServer, i);
 
@@ -743,6 +769,8 @@ nm_ndisc_add_dns_domain(NMNDisc *ndisc, const NMNDiscDNSDomain *new_item, gint64
     priv  = NM_NDISC_GET_PRIVATE(ndisc);
     rdata = &priv->rdata;
 
+    _expiry_track(ndisc, new_item->expiry_msec);
+
     for (i = 0; i < rdata->dns_domains->len; i++) {
         item = &g_array_index(rdata->dns_domains, NMNDiscDNSDomain, i);
 
@@ -1153,6 +1181,8 @@ nm_ndisc_stop(NMNDisc *ndisc)
     nm_clear_g_source(&priv->send_ra_id);
     nm_clear_g_free(&priv->last_error);
     nm_clear_g_source_inst(&priv->timeout_expire_source);
+    priv->timeout_expire_msec = NM_NDISC_EXPIRY_INFINITY;
+    priv->expiry_next_msec    = NM_NDISC_EXPIRY_INFINITY;
 
     priv->solicit_retransmit_time_msec = 0;
     nm_clear_g_source_inst(&priv->solicit_timer_source);
@@ -1371,11 +1401,11 @@ clean_addresses(NMNDisc *ndisc, gint64 now_msec, NMNDiscConfigMap *changed, gint
     }
 
     if (i != j) {
-        *changed = NM_NDISC_CONFIG_ADDRESSES;
+        *changed |= NM_NDISC_CONFIG_ADDRESSES;
         g_array_set_size(rdata->addresses, j);
     }
 
-    if (_array_set_size_max(rdata->gateways, priv->max_addresses))
+    if (_array_set_size_max(rdata->addresses, priv->max_addresses))
         *changed |= NM_NDISC_CONFIG_ADDRESSES;
 }
 
@@ -1405,7 +1435,7 @@ clean_routes(NMNDisc *ndisc, gint64 now_msec, NMNDiscConfigMap *changed, gint64
         g_array_set_size(rdata->routes, j);
     }
 
-    if (_array_set_size_max(rdata->gateways, _SIZE_MAX_ROUTES))
+    if (_array_set_size_max(rdata->routes, _SIZE_MAX_ROUTES))
         *changed |= NM_NDISC_CONFIG_ROUTES;
 }
 
@@ -1435,7 +1465,7 @@ clean_dns_servers(NMNDisc *ndisc, gint64 now_msec, NMNDiscConfigMap *changed, gi
         g_array_set_size(rdata->dns_servers, j);
     }
 
-    if (_array_set_size_max(rdata->gateways, _SIZE_MAX_DNS_SERVERS))
+    if (_array_set_size_max(rdata->dns_servers, _SIZE_MAX_DNS_SERVERS))
         *changed |= NM_NDISC_CONFIG_DNS_SERVERS;
 }
 
@@ -1465,36 +1495,50 @@ clean_dns_domains(NMNDisc *ndisc, gint64 now_msec, NMNDiscConfigMap *changed, gi
         j++;
     }
 
-    if (i != 0) {
+    if (i != j) {
         *changed |= NM_NDISC_CONFIG_DNS_DOMAINS;
         g_array_set_size(rdata->dns_domains, j);
     }
 
-    if (_array_set_size_max(rdata->gateways, _SIZE_MAX_DNS_DOMAINS))
+    if (_array_set_size_max(rdata->dns_domains, _SIZE_MAX_DNS_DOMAINS))
         *changed |= NM_NDISC_CONFIG_DNS_DOMAINS;
 }
 
 static void
 check_timestamps(NMNDisc *ndisc, gint64 now_msec, NMNDiscConfigMap changed)
 {
-    NMNDiscPrivate *priv      = NM_NDISC_GET_PRIVATE(ndisc);
-    gint64          next_msec = G_MAXINT64;
-
-    _LOGT("router-data: check for changed router advertisement data");
-
-    clean_gateways(ndisc, now_msec, &changed, &next_msec);
-    clean_addresses(ndisc, now_msec, &changed, &next_msec);
-    clean_routes(ndisc, now_msec, &changed, &next_msec);
-    clean_dns_servers(ndisc, now_msec, &changed, &next_msec);
-    clean_dns_domains(ndisc, now_msec, &changed, &next_msec);
+    NMNDiscPrivate *priv = NM_NDISC_GET_PRIVATE(ndisc);
+    gint64          next_msec;
+
+    if (now_msec >= priv->expiry_next_msec) {
+        _LOGT("router-data: check for changed router advertisement data");
+
+        next_msec = G_MAXINT64;
+        clean_gateways(ndisc, now_msec, &changed, &next_msec);
+        clean_addresses(ndisc, now_msec, &changed, &next_msec);
+        clean_routes(ndisc, now_msec, &changed, &next_msec);
+        clean_dns_servers(ndisc, now_msec, &changed, &next_msec);
+        clean_dns_domains(ndisc, now_msec, &changed, &next_msec);
+        priv->expiry_next_msec = next_msec;
+    } else {
+        /* Nothing expired yet. Items refreshed by the RA may now expire later
+         * than expiry_next_msec, but we only find out when the timer hits and
+         * we walk the lists. That spares the walk for every RA. */
+        next_msec = priv->expiry_next_msec;
+    }
 
     nm_assert(next_msec > now_msec);
 
-    nm_clear_g_source_inst(&priv->timeout_expire_source);
+    nm_assert((!!priv->timeout_expire_source)
+              == (priv->timeout_expire_msec != NM_NDISC_EXPIRY_INFINITY));
 
-    if (next_msec == NM_NDISC_EXPIRY_INFINITY)
+    if (next_msec == priv->timeout_expire_msec) {
+        /* the timer is already scheduled for the right time. */
+    } else if (next_msec == NM_NDISC_EXPIRY_INFINITY) {
+        nm_clear_g_source_inst(&priv->timeout_expire_source);
+        priv->timeout_expire_msec = NM_NDISC_EXPIRY_INFINITY;
         _LOGD("router-data: next lifetime expiration will happen: never");
-    else {
+    } else {
         const gint64 timeout_msec = NM_MIN(next_msec - now_msec, ((gint64) G_MAXINT32));
         const guint  TIMEOUT_APPROX_THRESHOLD_SEC = 10000;
 
@@ -1502,6 +1546,8 @@ check_timestamps(NMNDisc *ndisc, gint64 now_msec, NMNDiscConfigMap changed)
               (timeout_msec / 1000) >= TIMEOUT_APPROX_THRESHOLD_SEC ? " about" : "",
               ((double) timeout_msec) / 1000);
 
+        nm_clear_g_source_inst(&priv->timeout_expire_source);
+        priv->timeout_expire_msec   = next_msec;
         priv->timeout_expire_source = nm_g_timeout_add_source_approx(timeout_msec,
                                                                      TIMEOUT_APPROX_THRESHOLD_SEC,
                                                                      timeout_expire_cb,
@@ -1542,7 +1588,17 @@ check_timestamps(NMNDisc *ndisc, gint64 now_msec, NMNDiscConfigMap changed)
 static gboolean
 timeout_expire_cb(gpointer user_data)
 {
-    check_timestamps(user_data, nm_utils_get_monotonic_timestamp_msec(), NM_NDISC_CONFIG_NONE);
+    NMNDisc *       ndisc    = user_data;
+    NMNDiscPrivate *priv     = NM_NDISC_GET_PRIVATE(ndisc);
+    const gint64    now_msec = nm_utils_get_monotonic_timestamp_msec();
+
+    nm_clear_g_source_inst(&priv->timeout_expire_source);
+    priv->timeout_expire_msec = NM_NDISC_EXPIRY_INFINITY;
+
+    /* the timeout is approximate and might fire early. Force a walk over the lists. */
+    priv->expiry_next_msec = NM_MIN(priv->expiry_next_msec, now_msec);
+
+    check_timestamps(ndisc, now_msec, NM_NDISC_CONFIG_NONE);
     return G_SOURCE_CONTINUE;
 }
 
@@ -1671,6 +1727,9 @@ nm_ndisc_init(NMNDisc *ndisc)
     rdata->dns_domains = g_array_new(FALSE, FALSE, sizeof(NMNDiscDNSDomain));
     g_array_set_clear_func(rdata->dns_domains, dns_domain_free);
     priv->rdata.public.hop_limit = 64;
+
+    priv->expiry_next_msec    = NM_NDISC_EXPIRY_INFINITY;
+    priv->timeout_expire_msec = NM_NDISC_EXPIRY_INFINITY;
 }
 
 static void
@@ -632,6 +632,94 @@ test_dns_solicit_loop(void)
 
 /*****************************************************************************/
 
+static void
+_test_ra_replay_changed(NMNDisc *          ndisc,
+                        const NMNDiscData *rdata,
+                        guint              changed_int,
+                        TestData *         data)
+{
+    NMNDiscConfigMap changed = changed_int;
+
+    g_assert_cmpint(data->counter, ==, 0);
+    g_assert_cmpint(changed,
+                    ==,
+                    NM_NDISC_CONFIG_GATEWAYS | NM_NDISC_CONFIG_ADDRESSES | NM_NDISC_CONFIG_ROUTES
+                        | NM_NDISC_CONFIG_DNS_SERVERS | NM_NDISC_CONFIG_DNS_DOMAINS
+                        | NM_NDISC_CONFIG_HOP_LIMIT | NM_NDISC_CONFIG_MTU);
+    g_assert_cmpint(rdata->gateways_n, ==, 1);
+    g_assert_cmpint(rdata->addresses_n, ==, 1);
+    g_assert_cmpint(rdata->routes_n, ==, 33);
+    g_assert_cmpint(rdata->dns_servers_n, ==, 1);
+    g_assert_cmpint(rdata->dns_domains_n, ==, 1);
+    data->counter++;
+}
+
+static void
+test_ra_replay(void)
+{
+    nm_auto_unref_gmainloop GMainLoop *loop = g_main_loop_new(NULL, FALSE);
+    gs_unref_object NMFakeNDisc *ndisc      = ndisc_new();
+    const gint64                 now_msec   = nm_utils_get_monotonic_timestamp_msec();
+    TestData                     data       = {
+        .loop             = loop,
+        .timestamp_msec_1 = now_msec,
+    };
+    guint n_ra;
+    guint i;
+
+    /* A router that sends the very same RA with many route information options
+     * in quick succession. Only the first RA carries news, the following ones
+     * must neither change the data nor cause a config-received signal. */
+
+    for (n_ra = 0; n_ra < 100; n_ra++) {
+        guint id;
+
+        id = nm_fake_ndisc_add_ra(ndisc, n_ra == 0 ? 1 : 0, NM_NDISC_DHCP_LEVEL_NONE, 4, 1500);
+        g_assert(id);
+        nm_fake_ndisc_add_gateway(ndisc,
+                                  id,
+                                  "fe80::1",
+                                  now_msec + 10000,
+                                  NM_ICMPV6_ROUTER_PREF_MEDIUM);
+        nm_fake_ndisc_add_prefix(ndisc,
+                                 id,
+                                 "2001:db8:a:a::",
+                                 64,
+                                 "fe80::1",
+                                 now_msec + 10000,
+                                 now_msec + 10000,
+                                 NM_ICMPV6_ROUTER_PREF_MEDIUM);
+        for (i = 0; i < 32; i++) {
+            char network[NM_UTILS_INET_ADDRSTRLEN];
+
+            nm_sprintf_buf(network, "2001:db8:%x::", 0x100 + i);
+            nm_fake_ndisc_add_prefix(ndisc,
+                                     id,
+                                     network,
+                                     48,
+                                     "fe80::1",
+                                     now_msec + 10000 + i,
+                                     0,
+                                     NM_ICMPV6_ROUTER_PREF_MEDIUM);
+        }
+        nm_fake_ndisc_add_dns_server(ndisc, id, "2001:db8:c:c::1", now_msec + 10000);
+        nm_fake_ndisc_add_dns_domain(ndisc, id, "foobar.com", now_msec + 10000);
+    }
+
+    g_signal_connect(ndisc,
+                     NM_NDISC_CONFIG_RECEIVED,
+                     G_CALLBACK(_test_ra_replay_changed),
+                     &data);
+
+    nm_ndisc_start(NM_NDISC(ndisc));
+    if (nmtst_main_loop_run(data.loop, 4000))
+        g_error("we expect to run the loop until timeout. What is wrong?");
+    g_assert(nm_fake_ndisc_done(ndisc));
+    g_assert_cmpint(data.counter, ==, 1);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -652,6 +740,7 @@ main(int argc, char **argv)
     g_test_add_func("/ndisc/preference-order", test_preference_order);
     g_test_add_func("/ndisc/preference-changed", test_preference_changed);
     g_test_add_func("/ndisc/dns-solicit-loop", test_dns_solicit_loop);
+    g_test_add_func("/ndisc/ra-replay", test_ra_replay);
 
     return g_test_run();
 }
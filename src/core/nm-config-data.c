@@ -72,6 +72,7 @@ typedef struct {
 
     struct {
         gboolean enabled;
+        gboolean passive;
         char *   uri;
         char *   response;
         guint    interval;
@@ -280,6 +281,14 @@ nm_config_data_get_connectivity_interval(const NMConfigData *self)
     return NM_CONFIG_DATA_GET_PRIVATE(self)->connectivity.interval;
 }
 
+gboolean
+nm_config_data_get_connectivity_passive(const NMConfigData *self)
+{
+    g_return_val_if_fail(self, FALSE);
+
+    return NM_CONFIG_DATA_GET_PRIVATE(self)->connectivity.passive;
+}
+
 const char *
 nm_config_data_get_connectivity_response(const NMConfigData *self)
 {
@@ -1662,6 +1671,8 @@ nm_config_data_diff(NMConfigData *old_data, NMConfigData *new_data)
             != nm_config_data_get_connectivity_enabled(new_data)
         || nm_config_data_get_connectivity_interval(old_data)
                != nm_config_data_get_connectivity_interval(new_data)
+        || nm_config_data_get_connectivity_passive(old_data)
+               != nm_config_data_get_connectivity_passive(new_data)
         || g_strcmp0(nm_config_data_get_connectivity_uri(old_data),
                      nm_config_data_get_connectivity_uri(new_data))
         || g_strcmp0(nm_config_data_get_connectivity_response(old_data),
@@ -1848,6 +1859,11 @@ constructed(GObject *object)
                                       NM_CONFIG_KEYFILE_GROUP_CONNECTIVITY,
                                       NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_ENABLED,
                                       TRUE);
+    priv->connectivity.passive =
+        nm_config_keyfile_get_boolean(priv->keyfile,
+                                      NM_CONFIG_KEYFILE_GROUP_CONNECTIVITY,
+                                      NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_PASSIVE,
+                                      FALSE);
     priv->connectivity.uri =
         nm_strstrip(g_key_file_get_string(priv->keyfile,
                                           NM_CONFIG_KEYFILE_GROUP_CONNECTIVITY,
@@ -13,6 +13,7 @@
     #include <curl/curl.h>
 #endif
 #include <linux/rtnetlink.h>
+#include <linux/neighbour.h>
 #include <glib-unix.h>
 
 #include "c-list/src/c-list.h"
@@ -73,15 +74,13 @@ struct _NMConnectivityCheckHandle {
         ConConfig *con_config;
 
         GCancellable *     resolve_cancellable;
-        CURLM *            curl_mhandle;
+        struct _ConPool *  pool;
         CURL *             curl_ehandle;
-        struct curl_slist *request_headers;
         struct curl_slist *hosts;
 
         gsize response_good_cnt;
 
-        guint curl_timer;
-        int   ch_ifindex;
+        int ch_ifindex;
     } concheck;
 #endif
 
@@ -108,10 +107,14 @@ typedef struct {
     CList      completed_handles_lst_head;
     NMConfig * config;
     ConConfig *con_config;
-    guint      interval;
+#if WITH_CONCHECK
+    GHashTable *pools;
+#endif
+    guint interval;
 
     bool enabled : 1;
     bool uri_valid : 1;
+    bool passive : 1;
 } NMConnectivityPrivate;
 
 struct _NMConnectivity {
@@ -197,6 +200,216 @@ _con_config_get_response(const ConConfig *con_config)
 
 /*****************************************************************************/
 
+#if WITH_CONCHECK
+
+/* How long an unused pool (and the connections that cURL keeps open in it)
+ * stays around after the last check on that interface completed. */
+#define CON_POOL_IDLE_TIMEOUT_SEC 120
+
+/* Don't reuse a kept-alive connection that is older than this. A captive
+ * portal that shows up later must not be hidden by an old connection. */
+#define CON_POOL_MAXAGE_CONN_SEC 60
+
+/* systemd-resolved's ResolveHostname() does not tell us the TTL of the
+ * records. Use a short, fixed lifetime for the cached result instead. */
+#define CON_POOL_RESOLVE_TTL_MSEC ((gint64) 60000)
+
+/* A pool is the per-interface state that outlives a single connectivity
+ * check. cURL keeps its connection and DNS cache per multi handle, so by
+ * binding one multi handle to an (ifindex, addr-family) pair, consecutive
+ * checks can reuse the connection and resolve results, without ever
+ * leaking them to another interface. */
+typedef struct _ConPool {
+    int ifindex;
+    int addr_family;
+
+    NMConnectivity *self;
+
+    CURLM *curl_mhandle;
+
+    GSource *expire_source;
+
+    CList sock_lst_head;
+
+    ConConfig *resolve_con_config;
+    char **    resolve_entries;
+    gint64     resolve_expiry_msec;
+
+    guint ref_count;
+    guint curl_timer;
+
+    /* the last check on this pool did not succeed. Don't trust what we
+     * cached, but start afresh. */
+    bool need_fresh : 1;
+} ConPool;
+
+typedef struct _ConCurlSockData ConCurlSockData;
+
+static int
+multi_socket_cb(CURL *e_handle, curl_socket_t fd, int what, void *userdata, void *socketp);
+static int  multi_timer_cb(CURLM *multi, long timeout_msec, void *userdata);
+static void _con_curl_sock_data_free(ConCurlSockData *fdp);
+
+static guint
+_con_pool_hash(gconstpointer ptr)
+{
+    const ConPool *pool = ptr;
+    NMHashState    h;
+
+    nm_hash_init(&h, 1811417519u);
+    nm_hash_update_vals(&h, pool->ifindex, pool->addr_family);
+    return nm_hash_complete(&h);
+}
+
+static gboolean
+_con_pool_equal(gconstpointer a, gconstpointer b)
+{
+    const ConPool *pool_a = a;
+    const ConPool *pool_b = b;
+
+    return pool_a->ifindex == pool_b->ifindex && pool_a->addr_family == pool_b->addr_family;
+}
+
+static void
+_con_pool_resolve_clear(ConPool *pool)
+{
+    nm_clear_pointer(&pool->resolve_con_config, _con_config_unref);
+    nm_clear_pointer(&pool->resolve_entries, g_strfreev);
+    pool->resolve_expiry_msec = 0;
+}
+
+static void
+_con_pool_free(gpointer data)
+{
+    ConPool *        pool = data;
+    ConCurlSockData *fdp;
+
+    nm_assert(pool->ref_count == 0);
+
+    nm_clear_g_source_inst(&pool->expire_source);
+
+    curl_multi_cleanup(pool->curl_mhandle);
+    nm_clear_g_source(&pool->curl_timer);
+
+    /* curl_multi_cleanup() is not guaranteed to notify us about all the
+     * sockets that it closes. Drop what is left. */
+    while ((fdp = c_list_first_entry(&pool->sock_lst_head, ConCurlSockData, sock_lst)))
+        _con_curl_sock_data_free(fdp);
+
+    _con_pool_resolve_clear(pool);
+    nm_g_slice_free(pool);
+}
+
+static gboolean
+_con_pool_expire_cb(gpointer user_data)
+{
+    ConPool *pool = user_data;
+
+    nm_assert(pool->ref_count == 0);
+
+    nm_clear_g_source_inst(&pool->expire_source);
+    g_hash_table_remove(NM_CONNECTIVITY_GET_PRIVATE(pool->self)->pools, pool);
+    return G_SOURCE_REMOVE;
+}
+
+static ConPool *
+_con_pool_acquire(NMConnectivity *self, int ifindex, int addr_family)
+{
+    NMConnectivityPrivate *priv = NM_CONNECTIVITY_GET_PRIVATE(self);
+    ConPool *              pool;
+    ConPool                needle = {
+        .ifindex     = ifindex,
+        .addr_family = addr_family,
+    };
+
+    pool = g_hash_table_lookup(priv->pools, &needle);
+    if (!pool) {
+        CURLM *mhandle;
+
+        mhandle = curl_multi_init();
+        if (!mhandle)
+            return NULL;
+
+        pool  = g_slice_new(ConPool);
+        *pool = (ConPool){
+            .ifindex      = ifindex,
+            .addr_family  = addr_family,
+            .self         = self,
+            .curl_mhandle = mhandle,
+        };
+        c_list_init(&pool->sock_lst_head);
+
+        curl_multi_setopt(mhandle, CURLMOPT_SOCKETFUNCTION, multi_socket_cb);
+        curl_multi_setopt(mhandle, CURLMOPT_SOCKETDATA, pool);
+        curl_multi_setopt(mhandle, CURLMOPT_TIMERFUNCTION, multi_timer_cb);
+        curl_multi_setopt(mhandle, CURLMOPT_TIMERDATA, pool);
+        curl_multi_setopt(mhandle, CURLMOPT_MAXCONNECTS, 2L);
+
+        g_hash_table_add(priv->pools, pool);
+    }
+
+    nm_clear_g_source_inst(&pool->expire_source);
+    pool->ref_count++;
+    return pool;
+}
+
+static void
+_con_pool_release(ConPool *pool, NMConnectivityState state)
+{
+    nm_assert(pool);
+    nm_assert(pool->ref_count > 0);
+
+    if (!NM_IN_SET(state, NM_CONNECTIVITY_FULL, NM_CONNECTIVITY_CANCELLED)) {
+        /* the check failed (or we are shutting down). Next time, resolve the name
+         * again and don't reuse a connection. */
+        pool->need_fresh = TRUE;
+        _con_pool_resolve_clear(pool);
+    }
+
+    if (--pool->ref_count > 0)
+        return;
+
+    nm_assert(!pool->expire_source);
+    pool->expire_source = nm_g_timeout_source_new_seconds(CON_POOL_IDLE_TIMEOUT_SEC,
+                                                          G_PRIORITY_DEFAULT,
+                                                          _con_pool_expire_cb,
+                                                          pool,
+                                                          NULL);
+    g_source_attach(pool->expire_source, NULL);
+}
+
+static const char *const *
+_con_pool_resolve_get(ConPool *pool, ConConfig *con_config)
+{
+    if (!pool->resolve_entries)
+        return NULL;
+
+    if (pool->resolve_con_config != con_config
+        || pool->resolve_expiry_msec <= nm_utils_get_monotonic_timestamp_msec()) {
+        _con_pool_resolve_clear(pool);
+        return NULL;
+    }
+
+    return (const char *const *) pool->resolve_entries;
+}
+
+static void
+_con_pool_resolve_set(ConPool *pool, ConConfig *con_config, GPtrArray *entries)
+{
+    _con_pool_resolve_clear(pool);
+
+    if (!entries || entries->len == 0)
+        return;
+
+    pool->resolve_entries     = nm_utils_strv_dup(entries->pdata, entries->len, TRUE);
+    pool->resolve_con_config  = _con_config_ref(con_config);
+    pool->resolve_expiry_msec = nm_utils_get_monotonic_timestamp_msec() + CON_POOL_RESOLVE_TTL_MSEC;
+}
+
+#endif
+
+/*****************************************************************************/
+
 static void
 cb_data_complete(NMConnectivityCheckHandle *cb_data,
                  NMConnectivityState        state,
@@ -232,17 +445,17 @@ cb_data_complete(NMConnectivityCheckHandle *cb_data,
         curl_easy_setopt(cb_data->concheck.curl_ehandle, CURLOPT_HEADERFUNCTION, NULL);
         curl_easy_setopt(cb_data->concheck.curl_ehandle, CURLOPT_HEADERDATA, NULL);
         curl_easy_setopt(cb_data->concheck.curl_ehandle, CURLOPT_PRIVATE, NULL);
-        curl_easy_setopt(cb_data->concheck.curl_ehandle, CURLOPT_HTTPHEADER, NULL);
 
-        curl_multi_remove_handle(cb_data->concheck.curl_mhandle, cb_data->concheck.curl_ehandle);
+        /* The multi handle is shared by all checks on this interface and keeps
+         * the connection around for the next check. Only drop our easy handle. */
+        curl_multi_remove_handle(cb_data->concheck.pool->curl_mhandle,
+                                 cb_data->concheck.curl_ehandle);
         curl_easy_cleanup(cb_data->concheck.curl_ehandle);
-        curl_multi_cleanup(cb_data->concheck.curl_mhandle);
-
-        curl_slist_free_all(cb_data->concheck.request_headers);
         curl_slist_free_all(cb_data->concheck.hosts);
     }
-    nm_clear_g_source(&cb_data->concheck.curl_timer);
     nm_clear_g_cancellable(&cb_data->concheck.resolve_cancellable);
+    if (cb_data->concheck.pool)
+        _con_pool_release(g_steal_pointer(&cb_data->concheck.pool), state);
 #endif
 
     nm_clear_g_source(&cb_data->timeout_id);
@@ -404,26 +617,27 @@ _con_curl_check_connectivity(CURLM *mhandle, int sockfd, int ev_bitmask)
 static gboolean
 _con_curl_timeout_cb(gpointer user_data)
 {
-    NMConnectivityCheckHandle *cb_data = user_data;
+    ConPool *pool = user_data;
 
-    _con_curl_check_connectivity(cb_data->concheck.curl_mhandle, CURL_SOCKET_TIMEOUT, 0);
-    _complete_queued(cb_data->self);
+    _con_curl_check_connectivity(pool->curl_mhandle, CURL_SOCKET_TIMEOUT, 0);
+    _complete_queued(pool->self);
     return G_SOURCE_CONTINUE;
 }
 
 static int
 multi_timer_cb(CURLM *multi, long timeout_msec, void *userdata)
 {
-    NMConnectivityCheckHandle *cb_data = userdata;
+    ConPool *pool = userdata;
 
-    nm_clear_g_source(&cb_data->concheck.curl_timer);
+    nm_clear_g_source(&pool->curl_timer);
     if (timeout_msec != -1)
-        cb_data->concheck.curl_timer = g_timeout_add(timeout_msec, _con_curl_timeout_cb, cb_data);
+        pool->curl_timer = g_timeout_add(timeout_msec, _con_curl_timeout_cb, pool);
     return 0;
 }
 
-typedef struct {
-    NMConnectivityCheckHandle *cb_data;
+struct _ConCurlSockData {
+    CList    sock_lst;
+    ConPool *pool;
 
     GSource *source;
 
@@ -433,17 +647,26 @@ typedef struct {
      * _con_curl_socketevent_cb() uses this to detect whether it can
      * safely access @fdp after _con_curl_check_connectivity(). */
     gboolean *destroy_notify;
+};
 
-} ConCurlSockData;
+static void
+_con_curl_sock_data_free(ConCurlSockData *fdp)
+{
+    if (fdp->destroy_notify)
+        *fdp->destroy_notify = TRUE;
+    nm_clear_g_source_inst(&fdp->source);
+    c_list_unlink_stale(&fdp->sock_lst);
+    nm_g_slice_free(fdp);
+}
 
 static gboolean
 _con_curl_socketevent_cb(int fd, GIOCondition condition, gpointer user_data)
 {
-    ConCurlSockData *          fdp           = user_data;
-    NMConnectivityCheckHandle *cb_data       = fdp->cb_data;
-    int                        action        = 0;
-    gboolean                   fdp_destroyed = FALSE;
-    gboolean                   success;
+    ConCurlSockData *fdp           = user_data;
+    ConPool *        pool          = fdp->pool;
+    int              action        = 0;
+    gboolean         fdp_destroyed = FALSE;
+    gboolean         success;
 
     if (condition & G_IO_IN)
         action |= CURL_CSELECT_IN;
@@ -455,7 +678,7 @@ _con_curl_socketevent_cb(int fd, GIOCondition condition, gpointer user_data)
     nm_assert(!fdp->destroy_notify);
     fdp->destroy_notify = &fdp_destroyed;
 
-    success = _con_curl_check_connectivity(cb_data->concheck.curl_mhandle, fd, action);
+    success = _con_curl_check_connectivity(pool->curl_mhandle, fd, action);
 
     if (fdp_destroyed) {
         /* hups. fdp got invalidated during _con_curl_check_connectivity(). That's fine,
@@ -467,7 +690,7 @@ _con_curl_socketevent_cb(int fd, GIOCondition condition, gpointer user_data)
             nm_clear_g_source_inst(&fdp->source);
     }
 
-    _complete_queued(cb_data->self);
+    _complete_queued(pool->self);
 
     return G_SOURCE_CONTINUE;
 }
@@ -475,18 +698,15 @@ _con_curl_socketevent_cb(int fd, GIOCondition condition, gpointer user_data)
 static int
 multi_socket_cb(CURL *e_handle, curl_socket_t fd, int what, void *userdata, void *socketp)
 {
-    NMConnectivityCheckHandle *cb_data = userdata;
-    ConCurlSockData *          fdp     = socketp;
+    ConPool *        pool = userdata;
+    ConCurlSockData *fdp  = socketp;
 
     (void) _NM_ENSURE_TYPE(int, fd);
 
     if (what == CURL_POLL_REMOVE) {
         if (fdp) {
-            if (fdp->destroy_notify)
-                *fdp->destroy_notify = TRUE;
-            nm_clear_g_source_inst(&fdp->source);
-            curl_multi_assign(cb_data->concheck.curl_mhandle, fd, NULL);
-            g_slice_free(ConCurlSockData, fdp);
+            curl_multi_assign(pool->curl_mhandle, fd, NULL);
+            _con_curl_sock_data_free(fdp);
         }
     } else {
         GIOCondition condition;
@@ -494,9 +714,10 @@ multi_socket_cb(CURL *e_handle, curl_socket_t fd, int what, void *userdata, void
         if (!fdp) {
             fdp  = g_slice_new(ConCurlSockData);
             *fdp = (ConCurlSockData){
-                .cb_data = cb_data,
+                .pool = pool,
             };
-            curl_multi_assign(cb_data->concheck.curl_mhandle, fd, fdp);
+            c_list_link_tail(&pool->sock_lst_head, &fdp->sock_lst);
+            curl_multi_assign(pool->curl_mhandle, fd, fdp);
         } else
             nm_clear_g_source_inst(&fdp->source);
 
@@ -647,34 +868,35 @@ _idle_cb(gpointer user_data)
 
 #if WITH_CONCHECK
 static void
-do_curl_request(NMConnectivityCheckHandle *cb_data)
+do_curl_request(NMConnectivityCheckHandle *cb_data, const char *const *resolve_entries)
 {
-    CURLM *mhandle;
-    CURL * ehandle;
-    long   resolve;
+    ConPool *pool = cb_data->concheck.pool;
+    CURL *   ehandle;
+    long     resolve;
+    gs_free char *resolve_remove = NULL;
 
-    mhandle = curl_multi_init();
-    if (!mhandle) {
-        cb_data_complete(cb_data, NM_CONNECTIVITY_ERROR, "curl error");
-        return;
-    }
+    nm_assert(pool);
 
     ehandle = curl_easy_init();
     if (!ehandle) {
-        curl_multi_cleanup(mhandle);
         cb_data_complete(cb_data, NM_CONNECTIVITY_ERROR, "curl error");
         return;
     }
 
-    cb_data->concheck.curl_mhandle    = mhandle;
-    cb_data->concheck.curl_ehandle    = ehandle;
-    cb_data->concheck.request_headers = curl_slist_append(NULL, "Connection: close");
-    cb_data->timeout_id               = g_timeout_add_seconds(20, _timeout_cb, cb_data);
+    cb_data->concheck.curl_ehandle = ehandle;
+    cb_data->timeout_id            = g_timeout_add_seconds(20, _timeout_cb, cb_data);
 
-    curl_multi_setopt(mhandle, CURLMOPT_SOCKETFUNCTION, multi_socket_cb);
-    curl_multi_setopt(mhandle, CURLMOPT_SOCKETDATA, cb_data);
-    curl_multi_setopt(mhandle, CURLMOPT_TIMERFUNCTION, multi_timer_cb);
-    curl_multi_setopt(mhandle, CURLMOPT_TIMERDATA, cb_data);
+    /* The DNS cache of cURL belongs to the (per-interface) multi handle and
+     * outlives this request. Always drop what a previous request put there,
+     * before adding the addresses that we resolved this time. */
+    resolve_remove = g_strdup_printf("-%s:%s",
+                                     cb_data->concheck.con_config->host,
+                                     cb_data->concheck.con_config->port ?: "80");
+    cb_data->concheck.hosts = curl_slist_append(NULL, resolve_remove);
+    for (; resolve_entries && resolve_entries[0]; resolve_entries++) {
+        cb_data->concheck.hosts = curl_slist_append(cb_data->concheck.hosts, resolve_entries[0]);
+        _LOG2T("adding '%s' to curl resolve list", resolve_entries[0]);
+    }
 
     switch (cb_data->addr_family) {
     case AF_INET:
@@ -697,12 +919,22 @@ do_curl_request(NMConnectivityCheckHandle *cb_data)
     curl_easy_setopt(ehandle, CURLOPT_HEADERFUNCTION, easy_header_cb);
     curl_easy_setopt(ehandle, CURLOPT_HEADERDATA, cb_data);
     curl_easy_setopt(ehandle, CURLOPT_PRIVATE, cb_data);
-    curl_easy_setopt(ehandle, CURLOPT_HTTPHEADER, cb_data->concheck.request_headers);
     curl_easy_setopt(ehandle, CURLOPT_INTERFACE, cb_data->ifspec);
     curl_easy_setopt(ehandle, CURLOPT_RESOLVE, cb_data->concheck.hosts);
     curl_easy_setopt(ehandle, CURLOPT_IPRESOLVE, resolve);
+#if LIBCURL_VERSION_NUM >= 0x074100
+    curl_easy_setopt(ehandle, CURLOPT_MAXAGE_CONN, (long) CON_POOL_MAXAGE_CONN_SEC);
+#endif
 
-    curl_multi_add_handle(mhandle, ehandle);
+    if (pool->need_fresh) {
+        /* the previous check on this interface failed. Don't trust the
+         * connection or the name resolution that it left behind. */
+        pool->need_fresh = FALSE;
+        curl_easy_setopt(ehandle, CURLOPT_FRESH_CONNECT, 1L);
+        curl_easy_setopt(ehandle, CURLOPT_DNS_CACHE_TIMEOUT, 0L);
+    }
+
+    curl_multi_add_handle(pool->curl_mhandle, ehandle);
 }
 
 static void
@@ -711,11 +943,12 @@ resolve_cb(GObject *object, GAsyncResult *res, gpointer user_data)
     NMConnectivityCheckHandle *cb_data;
     gs_unref_variant GVariant *result    = NULL;
     gs_unref_variant GVariant *addresses = NULL;
-    gsize                      no_addresses;
-    int                        ifindex;
-    int                        addr_family;
-    gsize                      len = 0;
-    gsize                      i;
+    gs_unref_ptrarray GPtrArray *entries = NULL;
+    gsize                        no_addresses;
+    int                          ifindex;
+    int                          addr_family;
+    gsize                        len = 0;
+    gsize                        i;
     gs_free_error GError *error = NULL;
 
     result = g_dbus_connection_call_finish(G_DBUS_CONNECTION(object), res, &error);
@@ -729,17 +962,18 @@ resolve_cb(GObject *object, GAsyncResult *res, gpointer user_data)
     if (!result) {
         /* Never mind. Just let do curl do its own resolving. */
         _LOG2D("can't resolve a name via systemd-resolved: %s", error->message);
-        do_curl_request(cb_data);
+        do_curl_request(cb_data, NULL);
         return;
     }
 
     addresses    = g_variant_get_child_value(result, 0);
     no_addresses = g_variant_n_children(addresses);
 
+    entries = g_ptr_array_new_with_free_func(g_free);
+
     for (i = 0; i < no_addresses; i++) {
         gs_unref_variant GVariant *address = NULL;
         char                       str_addr[NM_UTILS_INET_ADDRSTRLEN];
-        gs_free char *             host_entry = NULL;
         const guchar *             address_buf;
 
         g_variant_get_child(addresses, i, "(ii@ay)", &ifindex, &addr_family, &address);
@@ -752,15 +986,16 @@ resolve_cb(GObject *object, GAsyncResult *res, gpointer user_data)
             || (addr_family == AF_INET6 && len != sizeof(struct in6_addr)))
             continue;
 
-        host_entry              = g_strdup_printf("%s:%s:%s",
-                                     cb_data->concheck.con_config->host,
-                                     cb_data->concheck.con_config->port ?: "80",
-                                     nm_utils_inet_ntop(addr_family, address_buf, str_addr));
-        cb_data->concheck.hosts = curl_slist_append(cb_data->concheck.hosts, host_entry);
-        _LOG2T("adding '%s' to curl resolve list", host_entry);
+        g_ptr_array_add(entries,
+                        g_strdup_printf("%s:%s:%s",
+                                        cb_data->concheck.con_config->host,
+                                        cb_data->concheck.con_config->port ?: "80",
+                                        nm_utils_inet_ntop(addr_family, address_buf, str_addr)));
     }
 
-    do_curl_request(cb_data);
+    _con_pool_resolve_set(cb_data->concheck.pool, cb_data->concheck.con_config, entries);
+
+    do_curl_request(cb_data, (const char *const *) cb_data->concheck.pool->resolve_entries);
 }
 #endif
 
@@ -871,6 +1106,7 @@ nm_connectivity_check_start(NMConnectivity *            self,
         gboolean            has_systemd_resolved;
         NMConnectivityState state;
         const char *        reason;
+        const char *const * resolve_entries;
 
         cb_data->concheck.ch_ifindex = ifindex;
 
@@ -886,6 +1122,25 @@ nm_connectivity_check_start(NMConnectivity *            self,
             }
         }
 
+        cb_data->concheck.pool = _con_pool_acquire(self, ifindex, addr_family);
+        if (!cb_data->concheck.pool) {
+            _LOG2D("start fake request (fail due to curl error)");
+            cb_data->completed_state  = NM_CONNECTIVITY_ERROR;
+            cb_data->completed_reason = "curl error";
+            cb_data->timeout_id       = g_idle_add(_idle_cb, cb_data);
+            return cb_data;
+        }
+
+        resolve_entries =
+            _con_pool_resolve_get(cb_data->concheck.pool, cb_data->concheck.con_config);
+        if (resolve_entries) {
+            _LOG2D("start request to '%s' (using cached addresses for '%s')",
+                   cb_data->concheck.con_config->uri,
+                   cb_data->concheck.con_config->host);
+            do_curl_request(cb_data, resolve_entries);
+            return cb_data;
+        }
+
         /* note that we pick up support for systemd-resolved right away when we need it.
          * We don't need to remember the setting, because we can (cheaply) check anew
          * on each request.
@@ -945,7 +1200,7 @@ nm_connectivity_check_start(NMConnectivity *            self,
         } else {
             _LOG2D("start request to '%s' (systemd-resolved not available)",
                    cb_data->concheck.con_config->uri);
-            do_curl_request(cb_data);
+            do_curl_request(cb_data, NULL);
         }
 
         return cb_data;
@@ -998,6 +1253,144 @@ nm_connectivity_get_interval(NMConnectivity *self)
     return nm_connectivity_check_enabled(self) ? NM_CONNECTIVITY_GET_PRIVATE(self)->interval : 0;
 }
 
+gboolean
+nm_connectivity_get_passive(NMConnectivity *self)
+{
+    return nm_connectivity_check_enabled(self) && NM_CONNECTIVITY_GET_PRIVATE(self)->passive;
+}
+
+/* Without confirmation that the gateway is reachable, don't skip more than
+ * that many periodic checks in a row. */
+#define PASSIVE_MAX_SKIP 3
+
+/* In any case, check at least that often. */
+#define PASSIVE_MAX_AGE_MSEC ((gint64) 3600 * 1000)
+
+/**
+ * nm_connectivity_passive_fingerprint:
+ * @platform: the platform instance
+ * @ifindex: the IP interface of the device
+ * @addr_family: the address family
+ * @out_gateway_confirmed: (out) (allow-none): whether the kernel recently
+ *   confirmed the gateway of the best default route as reachable.
+ *
+ * Hashes the platform state that the result of a connectivity check depends
+ * on. That is the carrier, the addresses and the default routes (gateway,
+ * metric, table) of @ifindex, and whether the neighbour entry of the gateway
+ * failed. The neighbour is only known if somebody subscribed to the
+ * neighbours of @ifindex. Its regular transitions (reachable, stale, probe)
+ * don't change the fingerprint.
+ *
+ * Returns: the fingerprint, or 0 if there is no carrier or no default route.
+ */
+guint64
+nm_connectivity_passive_fingerprint(NMPlatform *platform,
+                                    int         ifindex,
+                                    int         addr_family,
+                                    gboolean *  out_gateway_confirmed)
+{
+    const int                    IS_IPv4     = NM_IS_IPv4(addr_family);
+    const NMPlatformIPRoute *    best_route  = NULL;
+    const NMPlatformNeighbor *   neigh       = NULL;
+    gboolean                     has_default = FALSE;
+    gconstpointer                gateway;
+    const NMDedupMultiHeadEntry *head_entry;
+    NMDedupMultiIter             iter;
+    const NMPObject *            obj;
+    NMHashState                  h;
+
+    NM_SET_OUT(out_gateway_confirmed, FALSE);
+
+    if (ifindex <= 0 || !nm_platform_link_is_connected(platform, ifindex))
+        return 0;
+
+    nm_hash_init(&h, 1367284011u);
+    nm_hash_update_val(&h, ifindex);
+
+    head_entry = nm_platform_lookup_object(platform, NMP_OBJECT_TYPE_IP_ADDRESS(IS_IPv4), ifindex);
+    nmp_cache_iter_for_each (&iter, head_entry, &obj) {
+        const NMPlatformIPAddress *address = NMP_OBJECT_CAST_IP_ADDRESS(obj);
+
+        nm_hash_update(&h, address->address_ptr, nm_utils_addr_family_to_size(addr_family));
+        nm_hash_update_val(&h, address->plen);
+    }
+
+    head_entry = nm_platform_lookup_object(platform, NMP_OBJECT_TYPE_IP_ROUTE(IS_IPv4), ifindex);
+    nmp_cache_iter_for_each (&iter, head_entry, &obj) {
+        const NMPlatformIPRoute *route = NMP_OBJECT_CAST_IP_ROUTE(obj);
+
+        if (!NM_PLATFORM_IP_ROUTE_IS_DEFAULT(route))
+            continue;
+
+        has_default = TRUE;
+        nm_hash_update(&h,
+                       nm_platform_ip_route_get_gateway(addr_family, route),
+                       nm_utils_addr_family_to_size(addr_family));
+        nm_hash_update_vals(&h, route->metric, nm_platform_ip_route_get_effective_table(route));
+
+        if (!best_route || route->metric < best_route->metric)
+            best_route = route;
+    }
+
+    /* without default route, we cannot reach the server anyway. That is not a state
+     * where we want to guess. */
+    if (!has_default)
+        return 0;
+
+    gateway = nm_platform_ip_route_get_gateway(addr_family, best_route);
+    if (!nm_ip_addr_is_null(addr_family, gateway))
+        neigh = nm_platform_neighbor_get(platform, ifindex, addr_family, gateway);
+
+    /* a missing entry hashes like a healthy one, so that the fingerprint
+     * does not change when the neighbours only start being cached. */
+    nm_hash_update_bool(&h, neigh && NM_FLAGS_HAS(neigh->state, NUD_FAILED));
+
+    /* the kernel only sets NUD_REACHABLE after it saw that the gateway
+     * answers, for example from TCP acknowledgements. */
+    NM_SET_OUT(out_gateway_confirmed, neigh && NM_FLAGS_HAS(neigh->state, NUD_REACHABLE));
+
+    return nm_hash_complete_u64(&h) ?: 1u;
+}
+
+/**
+ * nm_connectivity_passive_check:
+ * @passive: the passive state of the device
+ * @fingerprint: the current fingerprint
+ * @gateway_confirmed: whether the gateway is confirmed reachable
+ * @now_msec: the current timestamp
+ *
+ * Decides whether a periodic check can be skipped. A skip is always allowed
+ * while the kernel confirms the gateway as reachable. Without that, at most
+ * %PASSIVE_MAX_SKIP checks in a row are skipped. After
+ * %PASSIVE_MAX_AGE_MSEC, the check is sent in any case.
+ *
+ * Returns: the decision.
+ */
+NMConnectivityPassiveResult
+nm_connectivity_passive_check(NMConnectivityPassive *passive,
+                              guint64                fingerprint,
+                              gboolean               gateway_confirmed,
+                              gint64                 now_msec)
+{
+    if (passive->fingerprint == 0)
+        return NM_CONNECTIVITY_PASSIVE_CHECK;
+
+    if (fingerprint != passive->fingerprint)
+        return NM_CONNECTIVITY_PASSIVE_CHECK_CHANGED;
+
+    if (now_msec - passive->ts_msec >= PASSIVE_MAX_AGE_MSEC)
+        return NM_CONNECTIVITY_PASSIVE_CHECK;
+
+    if (gateway_confirmed)
+        return NM_CONNECTIVITY_PASSIVE_SKIP_CONFIRMED;
+
+    if (passive->n_skipped >= PASSIVE_MAX_SKIP)
+        return NM_CONNECTIVITY_PASSIVE_CHECK;
+
+    passive->n_skipped++;
+    return NM_CONNECTIVITY_PASSIVE_SKIP;
+}
+
 static gboolean
 host_and_port_from_uri(const char *uri, char **host, char **port)
 {
@@ -1052,6 +1445,7 @@ update_config(NMConnectivity *self, NMConfigData *config_data)
     NMConnectivityPrivate *priv = NM_CONNECTIVITY_GET_PRIVATE(self);
     guint                  interval;
     gboolean               enabled;
+    gboolean               passive;
     gboolean               changed      = FALSE;
     const char *           cur_uri      = priv->con_config ? priv->con_config->uri : NULL;
     const char *           cur_response = priv->con_config ? priv->con_config->response : NULL;
@@ -1137,6 +1531,12 @@ update_config(NMConnectivity *self, NMConfigData *config_data)
         changed       = TRUE;
     }
 
+    passive = nm_config_data_get_connectivity_passive(config_data);
+    if (priv->passive != passive) {
+        priv->passive = passive;
+        changed       = TRUE;
+    }
+
     if (changed)
         g_signal_emit(self, signals[CONFIG_CHANGED], 0);
 }
@@ -1164,6 +1564,10 @@ nm_connectivity_init(NMConnectivity *self)
     c_list_init(&priv->handles_lst_head);
     c_list_init(&priv->completed_handles_lst_head);
 
+#if WITH_CONCHECK
+    priv->pools = g_hash_table_new_full(_con_pool_hash, _con_pool_equal, _con_pool_free, NULL);
+#endif
+
     priv->config = g_object_ref(nm_config_get());
     g_signal_connect(G_OBJECT(priv->config),
                      NM_CONFIG_SIGNAL_CONFIG_CHANGED,
@@ -1199,6 +1603,7 @@ dispose(GObject *object)
     nm_clear_pointer(&priv->con_config, _con_config_unref);
 
 #if WITH_CONCHECK
+    nm_clear_pointer(&priv->pools, g_hash_table_unref);
     curl_global_cleanup();
 #endif
 
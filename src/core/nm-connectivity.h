@@ -53,6 +53,39 @@ gboolean nm_connectivity_check_enabled(NMConnectivity *self);
 
 guint nm_connectivity_get_interval(NMConnectivity *self);
 
+gboolean nm_connectivity_get_passive(NMConnectivity *self);
+
+/* With passive checking, the state of one address family of a device. */
+typedef struct {
+    /* a fingerprint of the platform state when the last check returned full
+     * connectivity, or 0. */
+    guint64 fingerprint;
+
+    /* when @fingerprint was recorded. */
+    gint64 ts_msec;
+
+    /* the number of periodic checks skipped since then, while the kernel
+     * did not confirm the gateway as reachable. */
+    guint n_skipped;
+} NMConnectivityPassive;
+
+typedef enum {
+    NM_CONNECTIVITY_PASSIVE_CHECK,
+    NM_CONNECTIVITY_PASSIVE_CHECK_CHANGED,
+    NM_CONNECTIVITY_PASSIVE_SKIP,
+    NM_CONNECTIVITY_PASSIVE_SKIP_CONFIRMED,
+} NMConnectivityPassiveResult;
+
+guint64 nm_connectivity_passive_fingerprint(NMPlatform *platform,
+                                            int         ifindex,
+                                            int         addr_family,
+                                            gboolean *  out_gateway_confirmed);
+
+NMConnectivityPassiveResult nm_connectivity_passive_check(NMConnectivityPassive *passive,
+                                                          guint64                fingerprint,
+                                                          gboolean               gateway_confirmed,
+                                                          gint64                 now_msec);
+
 typedef struct _NMConnectivityCheckHandle NMConnectivityCheckHandle;
 
 typedef void (*NMConnectivityCheckCallback)(NMConnectivity *           self,
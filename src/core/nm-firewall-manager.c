@@ -17,6 +17,11 @@
 #define FIREWALL_DBUS_PATH           "/org/fedoraproject/FirewallD1"
 #define FIREWALL_DBUS_INTERFACE_ZONE "org.fedoraproject.FirewallD1.zone"
 
+/* Requests are not sent right away, but collected for a short time. That way,
+ * when many devices activate at once, we can drop the requests that are
+ * superseded by a later one for the same interface, and send the rest back-to-back. */
+#define FLUSH_TIMEOUT_MSEC 20
+
 /*****************************************************************************/
 
 enum { STATE_CHANGED, LAST_SIGNAL };
@@ -28,6 +33,8 @@ typedef struct {
 
     GCancellable *get_name_owner_cancellable;
 
+    GSource *flush_source;
+
     CList pending_calls;
 
     guint name_owner_changed_id;
@@ -85,6 +92,7 @@ struct _NMFirewallManagerCallId {
     OpsType ops_type;
 
     bool is_idle : 1;
+    bool superseded : 1;
 };
 
 /*****************************************************************************/
@@ -230,10 +238,16 @@ _handle_idle_cb(gpointer user_data)
 
     self = call_id->self;
 
-    _LOGD(call_id, "complete: fake success");
-
     call_id->idle.id = 0;
 
+    /* A superseded request did not fail. The later request for the interface
+     * determines the outcome, and the caller of that one learns about it. We
+     * don't complete it as cancelled, because callers rightly take that to mean
+     * that they cancelled the request themselves. */
+    _LOGD(call_id,
+          "complete: fake success%s",
+          call_id->superseded ? " (superseded by a later request)" : "");
+
     _cb_info_complete(call_id, NULL);
     return G_SOURCE_REMOVE;
 }
@@ -354,6 +368,101 @@ _handle_dbus_start(NMFirewallManager *self, NMFirewallManagerCallId *call_id)
                            call_id);
 }
 
+static gboolean
+_is_queued(NMFirewallManagerCallId *call_id)
+{
+    /* the request was created while firewalld is running (or while we are still
+     * initializing), but no D-Bus call was made yet. */
+    return !call_id->is_idle && call_id->dbus.arg;
+}
+
+static void
+_flush(NMFirewallManager *self)
+{
+    /* completing a request without callback drops its reference on @self. */
+    _nm_unused gs_unref_object NMFirewallManager *self_keep_alive = g_object_ref(self);
+    NMFirewallManagerPrivate *                    priv = NM_FIREWALL_MANAGER_GET_PRIVATE(self);
+    gs_unref_hashtable GHashTable *latest              = NULL;
+    NMFirewallManagerCallId *                     call_id_safe;
+    NMFirewallManagerCallId *                     call_id;
+
+    nm_clear_g_source_inst(&priv->flush_source);
+
+    if (!priv->dbus_inited) {
+        /* we don't know yet whether firewalld is running. name_owner_changed()
+         * flushes the queue once we know. */
+        return;
+    }
+
+    /* Find the last queued request for each interface. Only that one
+     * determines the zone that the interface ends up in. */
+    latest = g_hash_table_new(nm_str_hash, g_str_equal);
+    c_list_for_each_entry (call_id, &priv->pending_calls, lst) {
+        if (_is_queued(call_id))
+            g_hash_table_insert(latest, call_id->iface, call_id);
+    }
+
+    /* Note that we don't invoke any callbacks for the user from here. Requests that we
+     * don't send are converted to idle requests which fake success, like when
+     * firewalld is not running. That way, the user cannot modify the list of pending
+     * calls while we iterate it. */
+    c_list_for_each_entry_safe (call_id, call_id_safe, &priv->pending_calls, lst) {
+        NMFirewallManagerCallId *call_id_latest;
+
+        if (!_is_queued(call_id))
+            continue;
+
+        if (!priv->running) {
+            nm_clear_pointer(&call_id->dbus.arg, g_variant_unref);
+            call_id->is_idle = TRUE;
+            _LOGD(call_id, "firewalld stopped: fake success on idle");
+            _handle_idle_start(self, call_id);
+            continue;
+        }
+
+        call_id_latest = g_hash_table_lookup(latest, call_id->iface);
+        if (call_id_latest != call_id) {
+            /* The later request overrules this one. If that one is an "add", it
+             * cannot rely on us removing the interface from its current zone
+             * first, so let it change the zone instead. "changeZone" also adds
+             * the interface, if it is not yet part of a zone. */
+            if (call_id_latest->ops_type == OPS_TYPE_ADD)
+                call_id_latest->ops_type = OPS_TYPE_CHANGE;
+            nm_clear_pointer(&call_id->dbus.arg, g_variant_unref);
+            call_id->is_idle    = TRUE;
+            call_id->superseded = TRUE;
+            _LOGD(call_id, "superseded by a later request: fake success on idle");
+            _handle_idle_start(self, call_id);
+            continue;
+        }
+
+        _handle_dbus_start(self, call_id);
+    }
+}
+
+static gboolean
+_flush_cb(gpointer user_data)
+{
+    _flush(user_data);
+    return G_SOURCE_CONTINUE;
+}
+
+static void
+_flush_schedule(NMFirewallManager *self)
+{
+    NMFirewallManagerPrivate *priv = NM_FIREWALL_MANAGER_GET_PRIVATE(self);
+
+    if (priv->flush_source)
+        return;
+
+    priv->flush_source = nm_g_timeout_source_new(FLUSH_TIMEOUT_MSEC,
+                                                 G_PRIORITY_DEFAULT,
+                                                 _flush_cb,
+                                                 self,
+                                                 NULL);
+    g_source_attach(priv->flush_source, NULL);
+}
+
 static NMFirewallManagerCallId *
 _start_request(NMFirewallManager *                self,
                OpsType                            ops_type,
@@ -382,7 +491,7 @@ _start_request(NMFirewallManager *                self,
 
     if (!call_id->is_idle) {
         if (priv->running)
-            _handle_dbus_start(self, call_id);
+            _flush_schedule(self);
         if (!call_id->callback) {
             /* if the user did not provide a callback, the call_id is useless.
              * Especially, the user cannot use the call-id to cancel the request,
@@ -479,36 +588,16 @@ name_owner_changed(NMFirewallManager *self, const char *owner)
 
     now_running = _get_running(priv);
 
-    if (just_initied) {
-        NMFirewallManagerCallId *call_id_safe;
-        NMFirewallManagerCallId *call_id;
-
-        /* We kick of the requests that we have pending. Note that this is
-         * entirely asynchronous and also we don't invoke any callbacks for
-         * the user.
+    if (just_initied || (!priv->running && priv->flush_source)) {
+        /* We kick of the requests that we have queued (or, if firewalld is
+         * not running, fake success for them). Note that this is entirely
+         * asynchronous and also we don't invoke any callbacks for the user.
          * Even _handle_idle_start() just schedules an idle handler. That is,
          * because we don't want to callback to the user before emitting the
          * DISCONNECTED signal below. Also, emitting callbacks means the user
          * can call back to modify the list of pending-calls and we'd have
          * to handle reentrancy. */
-        c_list_for_each_entry_safe (call_id, call_id_safe, &priv->pending_calls, lst) {
-            nm_assert(!call_id->is_idle);
-            nm_assert(call_id->dbus.arg);
-
-            if (priv->running) {
-                _LOGD(call_id, "initalizing: make D-Bus call");
-                _handle_dbus_start(self, call_id);
-            } else {
-                /* we don't want to invoke callbacks to the user right away. That is because
-                 * the user might schedule/cancel more calls, which messes up the order.
-                 *
-                 * Instead, convert the pending calls to idle requests... */
-                nm_clear_pointer(&call_id->dbus.arg, g_variant_unref);
-                call_id->is_idle = TRUE;
-                _LOGD(call_id, "initializing: fake success on idle");
-                _handle_idle_start(self, call_id);
-            }
-        }
+        _flush(self);
     }
 
     if (was_running != now_running)
@@ -554,6 +643,36 @@ get_name_owner_cb(const char *name_owner, GError *error, gpointer user_data)
 
 /*****************************************************************************/
 
+/**
+ * _nmtst_firewall_manager_new:
+ * @dbus_connection: a peer-to-peer connection to a mock firewalld
+ *
+ * Returns: (transfer full): a new manager that sends its requests to
+ *   @dbus_connection. As there is no bus daemon to ask for the name owner,
+ *   firewalld is considered running right away.
+ */
+NMFirewallManager *
+_nmtst_firewall_manager_new(GDBusConnection *dbus_connection)
+{
+    NMFirewallManager *       self;
+    NMFirewallManagerPrivate *priv;
+
+    g_return_val_if_fail(G_IS_DBUS_CONNECTION(dbus_connection), NULL);
+
+    self = g_object_new(NM_TYPE_FIREWALL_MANAGER, NULL);
+    priv = NM_FIREWALL_MANAGER_GET_PRIVATE(self);
+
+    nm_clear_g_dbus_connection_signal(priv->dbus_connection, &priv->name_owner_changed_id);
+    nm_clear_g_cancellable(&priv->get_name_owner_cancellable);
+    g_clear_object(&priv->dbus_connection);
+
+    priv->dbus_connection = g_object_ref(dbus_connection);
+    name_owner_changed(self, FIREWALL_DBUS_SERVICE);
+    return self;
+}
+
+/*****************************************************************************/
+
 static void
 nm_firewall_manager_init(NMFirewallManager *self)
 {
@@ -598,6 +717,8 @@ dispose(GObject *object)
 
     nm_clear_g_cancellable(&priv->get_name_owner_cancellable);
 
+    nm_clear_g_source_inst(&priv->flush_source);
+
     G_OBJECT_CLASS(nm_firewall_manager_parent_class)->dispose(object);
 
     g_clear_object(&priv->dbus_connection);
@@ -51,4 +51,6 @@ nm_firewall_manager_remove_from_zone(NMFirewallManager *                mgr,
 
 void nm_firewall_manager_cancel_call(NMFirewallManagerCallId *call_id);
 
+NMFirewallManager *_nmtst_firewall_manager_new(GDBusConnection *dbus_connection);
+
 #endif /* __NETWORKMANAGER_FIREWALL_MANAGER_H__ */
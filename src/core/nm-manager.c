@@ -3589,7 +3589,8 @@ platform_query_devices(NMManager *self)
     gs_unref_ptrarray GPtrArray *links = NULL;
     int                          i;
     gboolean                     guess_assume;
-    gs_free char *               order = NULL;
+    gs_free int *                ifindexes = NULL;
+    gs_free char *               order     = NULL;
 
     guess_assume = nm_config_get_first_start(nm_config_get());
     order        = nm_config_data_get_value(NM_CONFIG_GET_DATA,
@@ -3599,6 +3600,16 @@ platform_query_devices(NMManager *self)
     links        = nm_platform_link_get_all(priv->platform, !nm_streq0(order, "index"));
     if (!links)
         return;
+
+    /* Realizing a device reads its driver info and permanent MAC address
+     * via ethtool. With thousands of links (e.g. SR-IOV VFs or veths), doing
+     * that one by one dominates startup. Let the platform fetch them in
+     * parallel upfront. */
+    ifindexes = g_new(int, links->len);
+    for (i = 0; i < links->len; i++)
+        ifindexes[i] = NMP_OBJECT_CAST_LINK(links->pdata[i])->ifindex;
+    nm_platform_link_prefetch(priv->platform, ifindexes, links->len);
+
     for (i = 0; i < links->len; i++) {
         const NMPlatformLink *         link = NMP_OBJECT_CAST_LINK(links->pdata[i]);
         const NMConfigDeviceStateData *dev_state;
@@ -3610,6 +3621,8 @@ platform_query_devices(NMManager *self)
                             guess_assume && (!dev_state || !dev_state->connection_uuid),
                             dev_state);
     }
+
+    nm_platform_link_prefetch(priv->platform, NULL, 0);
 }
 
 static void
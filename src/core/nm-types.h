@@ -185,6 +185,9 @@ typedef enum {
 
     NMP_OBJECT_TYPE_TFILTER,
 
+    NMP_OBJECT_TYPE_NEIGHBOR,
+    NMP_OBJECT_TYPE_FDB,
+
     NMP_OBJECT_TYPE_LNK_BRIDGE,
     NMP_OBJECT_TYPE_LNK_GRE,
     NMP_OBJECT_TYPE_LNK_GRETAP,
@@ -13,6 +13,7 @@
 #include <fcntl.h>
 #include <libudev.h>
 #include <net/ethernet.h>
+#include <linux/ethtool.h>
 #include <linux/fib_rules.h>
 #include <linux/ip.h>
 #include <linux/if.h>
@@ -22,6 +23,7 @@
 #include <linux/if_tunnel.h>
 #include <linux/if_vlan.h>
 #include <linux/ip6_tunnel.h>
+#include <linux/neighbour.h>
 #include <linux/tc_act/tc_mirred.h>
 #include <netinet/icmp6.h>
 #include <netinet/in.h>
@@ -229,6 +231,78 @@ G_STATIC_ASSERT(RTA_MAX == (__RTA_MAX - 1));
 
 /*****************************************************************************/
 
+/* Redefine the team generic netlink API from <linux/if_team.h>, which is not
+ * available everywhere. */
+
+#define TEAM_GENL_NAME    "team"
+#define TEAM_GENL_VERSION 1
+
+#define TEAM_CMD_OPTIONS_SET 1
+
+#define TEAM_ATTR_TEAM_IFINDEX 1
+#define TEAM_ATTR_LIST_OPTION  2
+
+#define TEAM_ATTR_ITEM_OPTION 1
+
+#define TEAM_ATTR_OPTION_NAME         1
+#define TEAM_ATTR_OPTION_TYPE         3
+#define TEAM_ATTR_OPTION_DATA         4
+#define TEAM_ATTR_OPTION_PORT_IFINDEX 6
+
+/*****************************************************************************/
+
+/* Redefine the parts of the ethtool generic netlink API from <linux/ethtool_netlink.h>
+ * that we use. It is only available since kernel 5.6. */
+
+#define ETHTOOL_GENL_NAME    "ethtool"
+#define ETHTOOL_GENL_VERSION 1
+
+#define ETHTOOL_MSG_LINKMODES_GET 4
+#define ETHTOOL_MSG_RINGS_GET     15
+#define ETHTOOL_MSG_COALESCE_GET  19
+
+#define ETHTOOL_FLAG_COMPACT_BITSETS (1 << 0)
+
+#define ETHTOOL_A_HEADER_DEV_INDEX 1
+#define ETHTOOL_A_HEADER_FLAGS     3
+
+#define ETHTOOL_A_LINKMODES_HEADER  1
+#define ETHTOOL_A_LINKMODES_AUTONEG 2
+#define ETHTOOL_A_LINKMODES_SPEED   5
+#define ETHTOOL_A_LINKMODES_DUPLEX  6
+
+#define ETHTOOL_A_RINGS_HEADER   1
+#define ETHTOOL_A_RINGS_RX       6
+#define ETHTOOL_A_RINGS_RX_MINI  7
+#define ETHTOOL_A_RINGS_RX_JUMBO 8
+#define ETHTOOL_A_RINGS_TX       9
+
+#define ETHTOOL_A_COALESCE_HEADER               1
+#define ETHTOOL_A_COALESCE_RX_USECS             2
+#define ETHTOOL_A_COALESCE_RX_MAX_FRAMES        3
+#define ETHTOOL_A_COALESCE_RX_USECS_IRQ         4
+#define ETHTOOL_A_COALESCE_RX_MAX_FRAMES_IRQ    5
+#define ETHTOOL_A_COALESCE_TX_USECS             6
+#define ETHTOOL_A_COALESCE_TX_MAX_FRAMES        7
+#define ETHTOOL_A_COALESCE_TX_USECS_IRQ         8
+#define ETHTOOL_A_COALESCE_TX_MAX_FRAMES_IRQ    9
+#define ETHTOOL_A_COALESCE_STATS_BLOCK_USECS    10
+#define ETHTOOL_A_COALESCE_USE_ADAPTIVE_RX      11
+#define ETHTOOL_A_COALESCE_USE_ADAPTIVE_TX      12
+#define ETHTOOL_A_COALESCE_PKT_RATE_LOW         13
+#define ETHTOOL_A_COALESCE_RX_USECS_LOW         14
+#define ETHTOOL_A_COALESCE_RX_MAX_FRAMES_LOW    15
+#define ETHTOOL_A_COALESCE_TX_USECS_LOW         16
+#define ETHTOOL_A_COALESCE_TX_MAX_FRAMES_LOW    17
+#define ETHTOOL_A_COALESCE_PKT_RATE_HIGH        18
+#define ETHTOOL_A_COALESCE_RX_USECS_HIGH        19
+#define ETHTOOL_A_COALESCE_RX_MAX_FRAMES_HIGH   20
+#define ETHTOOL_A_COALESCE_TX_USECS_HIGH        21
+#define ETHTOOL_A_COALESCE_TX_MAX_FRAMES_HIGH   22
+#define ETHTOOL_A_COALESCE_RATE_SAMPLE_INTERVAL 23
+
+/*****************************************************************************/
+
 /* Redefine VF enums and structures that are not available on older kernels. */
 
 #define IFLA_VF_UNSPEC       0
@@ -313,6 +387,8 @@ typedef enum {
     REFRESH_ALL_TYPE_ROUTING_RULES_IP6 = 6,
     REFRESH_ALL_TYPE_QDISCS            = 7,
     REFRESH_ALL_TYPE_TFILTERS          = 8,
+    REFRESH_ALL_TYPE_NEIGHBORS         = 9,
+    REFRESH_ALL_TYPE_FDB               = 10,
 
     _REFRESH_ALL_TYPE_NUM,
 } RefreshAllType;
@@ -337,14 +413,16 @@ typedef enum {
                                                         << F(5, REFRESH_ALL_TYPE_ROUTING_RULES_IP4),
     DELAYED_ACTION_TYPE_REFRESH_ALL_ROUTING_RULES_IP6 = 1
                                                         << F(6, REFRESH_ALL_TYPE_ROUTING_RULES_IP6),
-    DELAYED_ACTION_TYPE_REFRESH_ALL_QDISCS   = 1 << F(7, REFRESH_ALL_TYPE_QDISCS),
-    DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS = 1 << F(8, REFRESH_ALL_TYPE_TFILTERS),
+    DELAYED_ACTION_TYPE_REFRESH_ALL_QDISCS    = 1 << F(7, REFRESH_ALL_TYPE_QDISCS),
+    DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS  = 1 << F(8, REFRESH_ALL_TYPE_TFILTERS),
+    DELAYED_ACTION_TYPE_REFRESH_ALL_NEIGHBORS = 1 << F(9, REFRESH_ALL_TYPE_NEIGHBORS),
+    DELAYED_ACTION_TYPE_REFRESH_ALL_FDB       = 1 << F(10, REFRESH_ALL_TYPE_FDB),
 #undef F
 
-    DELAYED_ACTION_TYPE_REFRESH_LINK         = 1 << 9,
-    DELAYED_ACTION_TYPE_MASTER_CONNECTED     = 1 << 10,
-    DELAYED_ACTION_TYPE_READ_NETLINK         = 1 << 11,
-    DELAYED_ACTION_TYPE_WAIT_FOR_NL_RESPONSE = 1 << 12,
+    DELAYED_ACTION_TYPE_REFRESH_LINK         = 1 << 11,
+    DELAYED_ACTION_TYPE_MASTER_CONNECTED     = 1 << 12,
+    DELAYED_ACTION_TYPE_READ_NETLINK         = 1 << 13,
+    DELAYED_ACTION_TYPE_WAIT_FOR_NL_RESPONSE = 1 << 14,
 
     __DELAYED_ACTION_TYPE_MAX,
 
@@ -357,7 +435,8 @@ typedef enum {
         | DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ADDRESSES | DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ROUTES
         | DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES
         | DELAYED_ACTION_TYPE_REFRESH_ALL_ROUTING_RULES_ALL | DELAYED_ACTION_TYPE_REFRESH_ALL_QDISCS
-        | DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS,
+        | DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS | DELAYED_ACTION_TYPE_REFRESH_ALL_NEIGHBORS
+        | DELAYED_ACTION_TYPE_REFRESH_ALL_FDB,
 
     DELAYED_ACTION_TYPE_MAX = __DELAYED_ACTION_TYPE_MAX - 1,
 } DelayedActionType;
@@ -414,6 +493,13 @@ typedef struct {
     } response;
 } DelayedActionWaitForNlResponseData;
 
+typedef enum {
+    ETHTOOL_CACHE_TYPE_LINKMODES,
+    ETHTOOL_CACHE_TYPE_RINGS,
+    ETHTOOL_CACHE_TYPE_COALESCE,
+    _ETHTOOL_CACHE_TYPE_NUM,
+} EthtoolCacheType;
+
 /*****************************************************************************/
 
 typedef struct {
@@ -434,6 +520,20 @@ typedef struct {
     GHashTable *sysctl_get_prev_values;
     CList       sysctl_list;
 
+    /* LinkPrefetchData, indexed by ifindex. See nm_platform_link_prefetch(). */
+    GHashTable *link_prefetch_idx;
+
+    /* EthtoolCacheData, indexed by ifindex. */
+    GHashTable *ethtool_cache;
+    int         ethtool_family_id;
+    gint64      ethtool_dump_msec[_ETHTOOL_CACHE_TYPE_NUM];
+    gint64      ethtool_miss_msec[_ETHTOOL_CACHE_TYPE_NUM];
+
+    /* The ifindexes for which neighbors (index 0) and FDB entries (index 1)
+     * are cached, with a reference count. See nm_platform_neighbor_subscribe(). */
+    GHashTable *neigh_subscriptions[2];
+    bool        neigh_group_joined : 1;
+
     NMUdevClient *udev_client;
 
     struct {
@@ -549,6 +649,7 @@ static void cache_on_change(NMPlatform *     platform,
 static void cache_prune_all(NMPlatform *platform);
 static gboolean        event_handler_read_netlink(NMPlatform *platform, gboolean wait_for_acks);
 static struct nl_sock *_genl_sock(NMLinuxPlatform *platform);
+static void            ethtool_invalidate(NMPlatform *platform, int ifindex);
 
 /*****************************************************************************/
 
@@ -2875,6 +2976,105 @@ link_wireguard_change(NMPlatform *                              platform,
 
 /*****************************************************************************/
 
+static int
+link_team_set_options(NMPlatform *                self,
+                      int                         ifindex,
+                      const NMPlatformTeamOption *options,
+                      guint                       n_options)
+{
+    NMLinuxPlatformPrivate *     priv = NM_LINUX_PLATFORM_GET_PRIVATE(self);
+    nm_auto_nlmsg struct nl_msg *msg  = NULL;
+    struct nlattr *              nest_list;
+    struct nlattr *              nest_item;
+    int                          team_family_id;
+    guint                        i;
+    int                          r;
+
+    team_family_id = genl_ctrl_resolve(priv->genl, TEAM_GENL_NAME);
+    if (team_family_id < 0)
+        return -NME_PL_NO_FIRMWARE;
+
+    /* All options go into one TEAM_CMD_OPTIONS_SET request. The kernel
+     * validates the entire list before it applies any option. */
+    msg = nlmsg_alloc();
+    if (!genlmsg_put(msg,
+                     NL_AUTO_PORT,
+                     NL_AUTO_SEQ,
+                     team_family_id,
+                     0,
+                     NLM_F_REQUEST,
+                     TEAM_CMD_OPTIONS_SET,
+                     TEAM_GENL_VERSION))
+        g_return_val_if_reached(-NME_BUG);
+
+    NLA_PUT_U32(msg, TEAM_ATTR_TEAM_IFINDEX, (guint32) ifindex);
+
+    nest_list = nla_nest_start(msg, TEAM_ATTR_LIST_OPTION);
+    if (!nest_list)
+        goto nla_put_failure;
+
+    for (i = 0; i < n_options; i++) {
+        const NMPlatformTeamOption *opt = &options[i];
+
+        nest_item = nla_nest_start(msg, TEAM_ATTR_ITEM_OPTION);
+        if (!nest_item)
+            goto nla_put_failure;
+
+        NLA_PUT_STRING(msg, TEAM_ATTR_OPTION_NAME, opt->name);
+        if (opt->port_ifindex > 0)
+            NLA_PUT_U32(msg, TEAM_ATTR_OPTION_PORT_IFINDEX, (guint32) opt->port_ifindex);
+
+        switch (opt->type) {
+        case NM_PLATFORM_TEAM_OPTION_TYPE_U32:
+            NLA_PUT_U8(msg, TEAM_ATTR_OPTION_TYPE, NLA_U32);
+            NLA_PUT_U32(msg, TEAM_ATTR_OPTION_DATA, opt->v_u32);
+            break;
+        case NM_PLATFORM_TEAM_OPTION_TYPE_S32:
+            NLA_PUT_U8(msg, TEAM_ATTR_OPTION_TYPE, NLA_S32);
+            NLA_PUT_S32(msg, TEAM_ATTR_OPTION_DATA, opt->v_s32);
+            break;
+        case NM_PLATFORM_TEAM_OPTION_TYPE_STRING:
+            NLA_PUT_U8(msg, TEAM_ATTR_OPTION_TYPE, NLA_STRING);
+            NLA_PUT_STRING(msg, TEAM_ATTR_OPTION_DATA, opt->v_string);
+            break;
+        case NM_PLATFORM_TEAM_OPTION_TYPE_BOOL:
+            /* for boolean options, the presence of the data attribute means TRUE. */
+            NLA_PUT_U8(msg, TEAM_ATTR_OPTION_TYPE, NLA_FLAG);
+            if (opt->v_bool)
+                NLA_PUT_FLAG(msg, TEAM_ATTR_OPTION_DATA);
+            break;
+        default:
+            g_return_val_if_reached(-NME_BUG);
+        }
+
+        nla_nest_end(msg, nest_item);
+    }
+
+    nla_nest_end(msg, nest_list);
+
+    r = nl_send_auto(priv->genl, msg);
+    if (r < 0) {
+        _LOGW("team: set-options, send netlink message failed: %s", nm_strerror(r));
+        return r;
+    }
+
+    do {
+        r = nl_recvmsgs(priv->genl, NULL);
+    } while (r == -EAGAIN);
+    if (r < 0) {
+        _LOGD("team: set-options, message was rejected: %s", nm_strerror(r));
+        return r;
+    }
+
+    _LOGT("team: set-options, %u options sent and confirmed", n_options);
+    return 0;
+
+nla_put_failure:
+    g_return_val_if_reached(-NME_BUG);
+}
+
+/*****************************************************************************/
+
 static void
 _nmp_link_address_set(NMPLinkAddress *dst, const struct nlattr *nla)
 {
@@ -3994,6 +4194,140 @@ _new_from_nl_tfilter(struct nlmsghdr *nlh, gboolean id_only)
     return obj;
 }
 
+/*****************************************************************************/
+
+/* Bridges learn addresses from the traffic they see, so the number of
+ * entries is bounded by the other side. Cap what we cache per interface. */
+#define NEIGH_CACHE_MAX_PER_IFINDEX 4096u
+
+static GHashTable **
+_neigh_subscriptions(NMPlatform *platform, NMPObjectType obj_type)
+{
+    NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE(platform);
+
+    nm_assert(NM_IN_SET(obj_type, NMP_OBJECT_TYPE_NEIGHBOR, NMP_OBJECT_TYPE_FDB));
+
+    return &priv->neigh_subscriptions[obj_type == NMP_OBJECT_TYPE_FDB];
+}
+
+static gboolean
+_neigh_is_subscribed(NMPlatform *platform, NMPObjectType obj_type, int ifindex, int master)
+{
+    GHashTable *subscriptions = *_neigh_subscriptions(platform, obj_type);
+
+    if (!subscriptions)
+        return FALSE;
+
+    if (g_hash_table_contains(subscriptions, GINT_TO_POINTER(ifindex)))
+        return TRUE;
+
+    /* FDB entries of a port are also cached when subscribing to the bridge. */
+    return master > 0 && g_hash_table_contains(subscriptions, GINT_TO_POINTER(master));
+}
+
+static gboolean
+_neigh_cache_is_full(const NMPCache *cache, const NMPObject *obj)
+{
+    const NMDedupMultiHeadEntry *head_entry;
+    NMPLookup                    lookup;
+
+    head_entry =
+        nmp_cache_lookup(cache,
+                         nmp_lookup_init_object(&lookup,
+                                                NMP_OBJECT_GET_TYPE(obj),
+                                                NMP_OBJECT_CAST_NEIGHBOR(obj)->ifindex));
+    return head_entry && head_entry->len >= NEIGH_CACHE_MAX_PER_IFINDEX;
+}
+
+static DelayedActionType
+_neigh_refresh_all_flags(NMPlatform *platform)
+{
+    NMLinuxPlatformPrivate *priv  = NM_LINUX_PLATFORM_GET_PRIVATE(platform);
+    DelayedActionType       flags = DELAYED_ACTION_TYPE_NONE;
+
+    if (priv->neigh_subscriptions[0])
+        flags |= DELAYED_ACTION_TYPE_REFRESH_ALL_NEIGHBORS;
+    if (priv->neigh_subscriptions[1])
+        flags |= DELAYED_ACTION_TYPE_REFRESH_ALL_FDB;
+    return flags;
+}
+
+static NMPObject *
+_new_from_nl_neigh(NMPlatform *platform, struct nlmsghdr *nlh, gboolean id_only)
+{
+    static const struct nla_policy policy[] = {
+        [NDA_DST]    = {.minlen = sizeof(in_addr_t)},
+        [NDA_VLAN]   = {.type = NLA_U16},
+        [NDA_MASTER] = {.type = NLA_U32},
+    };
+    struct nlattr *      tb[G_N_ELEMENTS(policy)];
+    const struct ndmsg * ndm;
+    NMPObjectType        obj_type;
+    int                  master;
+    int                  addr_family = AF_UNSPEC;
+    nm_auto_nmpobj NMPObject *obj    = NULL;
+
+    if (!platform)
+        return NULL;
+
+    if (nlmsg_parse_arr(nlh, sizeof(*ndm), tb, policy) < 0)
+        return NULL;
+
+    ndm = nlmsg_data(nlh);
+
+    switch (ndm->ndm_family) {
+    case AF_INET:
+    case AF_INET6:
+        /* proxy entries are configuration, not neighbors. */
+        if (NM_FLAGS_HAS(ndm->ndm_flags, NTF_PROXY))
+            return NULL;
+        obj_type    = NMP_OBJECT_TYPE_NEIGHBOR;
+        addr_family = ndm->ndm_family;
+        if (!tb[NDA_DST] || nla_len(tb[NDA_DST]) != nm_utils_addr_family_to_size(addr_family))
+            return NULL;
+        break;
+    case AF_BRIDGE:
+        obj_type = NMP_OBJECT_TYPE_FDB;
+        if (!tb[NDA_LLADDR])
+            return NULL;
+        if (tb[NDA_DST]) {
+            /* the remote of a tunnel device. */
+            addr_family = nm_utils_addr_family_from_size(nla_len(tb[NDA_DST]));
+            if (addr_family == AF_UNSPEC)
+                return NULL;
+        }
+        break;
+    default:
+        return NULL;
+    }
+
+    if (ndm->ndm_ifindex <= 0)
+        return NULL;
+
+    master = tb[NDA_MASTER] ? (int) nla_get_u32(tb[NDA_MASTER]) : 0;
+
+    if (!_neigh_is_subscribed(platform, obj_type, ndm->ndm_ifindex, master))
+        return NULL;
+
+    obj = nmp_object_new(obj_type, NULL);
+
+    obj->neighbor.ifindex     = ndm->ndm_ifindex;
+    obj->neighbor.addr_family = addr_family;
+    if (addr_family != AF_UNSPEC)
+        memcpy(&obj->neighbor.address, nla_data(tb[NDA_DST]), nla_len(tb[NDA_DST]));
+    _nmp_link_address_set(&obj->neighbor.lladdr, tb[NDA_LLADDR]);
+    if (tb[NDA_VLAN])
+        obj->neighbor.vlan_id = nla_get_u16(tb[NDA_VLAN]);
+    obj->neighbor.flags = ndm->ndm_flags;
+
+    if (!id_only) {
+        obj->neighbor.master = master;
+        obj->neighbor.state  = ndm->ndm_state;
+    }
+
+    return g_steal_pointer(&obj);
+}
+
 /**
  * nmp_object_new_from_nl:
  * @platform: (allow-none): for creating certain objects, the constructor wants to check
@@ -4045,6 +4379,10 @@ nmp_object_new_from_nl(NMPlatform *    platform,
     case RTM_DELTFILTER:
     case RTM_GETTFILTER:
         return _new_from_nl_tfilter(msghdr, id_only);
+    case RTM_NEWNEIGH:
+    case RTM_DELNEIGH:
+    case RTM_GETNEIGH:
+        return _new_from_nl_neigh(platform, msghdr, id_only);
     default:
         return NULL;
     }
@@ -5626,6 +5964,8 @@ refresh_all_type_get_info(RefreshAllType refresh_all_type)
         R(REFRESH_ALL_TYPE_ROUTING_RULES_IP6, NMP_OBJECT_TYPE_ROUTING_RULE, AF_INET6),
         R(REFRESH_ALL_TYPE_QDISCS, NMP_OBJECT_TYPE_QDISC, AF_UNSPEC),
         R(REFRESH_ALL_TYPE_TFILTERS, NMP_OBJECT_TYPE_TFILTER, AF_UNSPEC),
+        R(REFRESH_ALL_TYPE_NEIGHBORS, NMP_OBJECT_TYPE_NEIGHBOR, AF_UNSPEC),
+        R(REFRESH_ALL_TYPE_FDB, NMP_OBJECT_TYPE_FDB, AF_UNSPEC),
 #undef R
     };
 
@@ -5654,6 +5994,8 @@ static NM_UTILS_LOOKUP_DEFINE(
                          REFRESH_ALL_TYPE_ROUTING_RULES_IP6),
     NM_UTILS_LOOKUP_ITEM(DELAYED_ACTION_TYPE_REFRESH_ALL_QDISCS, REFRESH_ALL_TYPE_QDISCS),
     NM_UTILS_LOOKUP_ITEM(DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS, REFRESH_ALL_TYPE_TFILTERS),
+    NM_UTILS_LOOKUP_ITEM(DELAYED_ACTION_TYPE_REFRESH_ALL_NEIGHBORS, REFRESH_ALL_TYPE_NEIGHBORS),
+    NM_UTILS_LOOKUP_ITEM(DELAYED_ACTION_TYPE_REFRESH_ALL_FDB, REFRESH_ALL_TYPE_FDB),
     NM_UTILS_LOOKUP_ITEM_IGNORE_OTHER(), );
 
 static DelayedActionType
@@ -5688,6 +6030,10 @@ refresh_all_type_from_needle_object(const NMPObject *obj_needle)
         return REFRESH_ALL_TYPE_QDISCS;
     case NMP_OBJECT_TYPE_TFILTER:
         return REFRESH_ALL_TYPE_TFILTERS;
+    case NMP_OBJECT_TYPE_NEIGHBOR:
+        return REFRESH_ALL_TYPE_NEIGHBORS;
+    case NMP_OBJECT_TYPE_FDB:
+        return REFRESH_ALL_TYPE_FDB;
     case NMP_OBJECT_TYPE_ROUTING_RULE:
         switch (NMP_OBJECT_CAST_ROUTING_RULE(obj_needle)->addr_family) {
         case AF_INET:
@@ -5750,6 +6096,8 @@ static NM_UTILS_LOOKUP_STR_DEFINE(
                              "refresh-all-routing-rules-ip6"),
     NM_UTILS_LOOKUP_STR_ITEM(DELAYED_ACTION_TYPE_REFRESH_ALL_QDISCS, "refresh-all-qdiscs"),
     NM_UTILS_LOOKUP_STR_ITEM(DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS, "refresh-all-tfilters"),
+    NM_UTILS_LOOKUP_STR_ITEM(DELAYED_ACTION_TYPE_REFRESH_ALL_NEIGHBORS, "refresh-all-neighbors"),
+    NM_UTILS_LOOKUP_STR_ITEM(DELAYED_ACTION_TYPE_REFRESH_ALL_FDB, "refresh-all-fdb"),
     NM_UTILS_LOOKUP_STR_ITEM(DELAYED_ACTION_TYPE_REFRESH_LINK, "refresh-link"),
     NM_UTILS_LOOKUP_STR_ITEM(DELAYED_ACTION_TYPE_MASTER_CONNECTED, "master-connected"),
     NM_UTILS_LOOKUP_STR_ITEM(DELAYED_ACTION_TYPE_READ_NETLINK, "read-netlink"),
@@ -6290,7 +6638,8 @@ cache_on_change(NMPlatform *     platform,
                                             | DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES
                                             | DELAYED_ACTION_TYPE_REFRESH_ALL_ROUTING_RULES_ALL
                                             | DELAYED_ACTION_TYPE_REFRESH_ALL_QDISCS
-                                            | DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS,
+                                            | DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS
+                                            | _neigh_refresh_all_flags(platform),
                                         NULL);
             }
         }
@@ -6344,6 +6693,11 @@ cache_on_change(NMPlatform *     platform,
                                         NULL);
             }
         }
+        {
+            /* the ethtool settings can change together with the link (for example,
+             * the speed on carrier change). Don't trust what we cached anymore. */
+            ethtool_invalidate(platform, obj_old ? obj_old->link.ifindex : obj_new->link.ifindex);
+        }
         if (NM_IN_SET(cache_op, NMP_CACHE_OPS_ADDED, NMP_CACHE_OPS_UPDATED)
             && (obj_new && obj_new->_link.netlink.is_in_netlink)
             && (!obj_old || !obj_old->_link.netlink.is_in_netlink)) {
@@ -6655,6 +7009,16 @@ _nl_msg_new_dump(NMPObjectType obj_type, int preferred_addr_family)
         if (nlmsg_append_struct(nlmsg, &tcmsg) < 0)
             g_return_val_if_reached(NULL);
     } break;
+    case NMP_OBJECT_TYPE_NEIGHBOR:
+    case NMP_OBJECT_TYPE_FDB:
+    {
+        const struct ndmsg ndmsg = {
+            .ndm_family = preferred_addr_family,
+        };
+
+        if (nlmsg_append_struct(nlmsg, &ndmsg) < 0)
+            g_return_val_if_reached(NULL);
+    } break;
     case NMP_OBJECT_TYPE_LINK:
     case NMP_OBJECT_TYPE_IP4_ADDRESS:
     case NMP_OBJECT_TYPE_IP6_ADDRESS:
@@ -6891,7 +7255,8 @@ event_valid_msg(NMPlatform *platform, struct nl_msg *msg, gboolean handle_events
                   RTM_DELROUTE,
                   RTM_DELRULE,
                   RTM_DELQDISC,
-                  RTM_DELTFILTER)) {
+                  RTM_DELTFILTER,
+                  RTM_DELNEIGH)) {
         /* The event notifies about a deleted object. We don't need to initialize all
          * fields of the object. */
         is_del = TRUE;
@@ -6911,7 +7276,8 @@ event_valid_msg(NMPlatform *platform, struct nl_msg *msg, gboolean handle_events
                      RTM_NEWROUTE,
                      RTM_NEWRULE,
                      RTM_NEWQDISC,
-                     RTM_NEWTFILTER)) {
+                     RTM_NEWTFILTER,
+                     RTM_NEWNEIGH)) {
         is_dump =
             delayed_action_refresh_all_in_progress(platform,
                                                    delayed_action_refresh_from_needle_object(obj));
@@ -6930,6 +7296,16 @@ event_valid_msg(NMPlatform *platform, struct nl_msg *msg, gboolean handle_events
         nm_auto_nmpobj const NMPObject *obj_new = NULL;
 
         switch (msghdr->nlmsg_type) {
+        case RTM_NEWNEIGH:
+            if (!nmp_cache_lookup_obj(cache, obj) && _neigh_cache_is_full(cache, obj)) {
+                _LOGT("event-notification: %s: ignore, cache limit of %u entries for ifindex %d "
+                      "reached",
+                      NMP_OBJECT_GET_CLASS(obj)->obj_type_name,
+                      (guint) NEIGH_CACHE_MAX_PER_IFINDEX,
+                      obj->neighbor.ifindex);
+                break;
+            }
+            /* fall-through */
         case RTM_GETLINK:
         case RTM_NEWADDR:
         case RTM_NEWLINK:
@@ -7040,6 +7416,7 @@ event_valid_msg(NMPlatform *platform, struct nl_msg *msg, gboolean handle_events
         case RTM_DELROUTE:
         case RTM_DELRULE:
         case RTM_DELTFILTER:
+        case RTM_DELNEIGH:
             cache_op = nmp_cache_remove_netlink(cache, obj, &obj_old, &obj_new);
             if (cache_op != NMP_CACHE_OPS_UNCHANGED) {
                 cache_on_change(platform, cache_op, obj_old, obj_new);
@@ -7608,10 +7985,114 @@ nla_put_failure:
     g_return_val_if_reached(FALSE);
 }
 
+/*****************************************************************************/
+
+/* Don't bother with worker threads for a handful of links. */
+#define LINK_PREFETCH_MIN_LINKS 32
+#define LINK_PREFETCH_N_THREADS 8
+
+typedef struct {
+    int                       ifindex;
+    guint8                    perm_addr_len;
+    bool                      has_driver_info : 1;
+    bool                      has_perm_addr : 1;
+    guint8                    perm_addr[_NM_UTILS_HWADDR_LEN_MAX];
+    NMPUtilsEthtoolDriverInfo driver_info;
+} LinkPrefetchData;
+
+static void
+_link_prefetch_thread_fn(gpointer data, gpointer user_data)
+{
+    nm_auto_pop_netns NMPNetns *netns    = NULL;
+    LinkPrefetchData *          prefetch = data;
+    size_t                      len      = 0;
+
+    /* NMPNetns is thread-safe. The ethtool helpers only issue ioctls on
+     * their own socket. */
+    if (!nm_platform_netns_push(user_data, &netns))
+        return;
+
+    prefetch->has_driver_info =
+        nmp_utils_ethtool_get_driver_info(prefetch->ifindex, &prefetch->driver_info);
+    prefetch->has_perm_addr =
+        nmp_utils_ethtool_get_permanent_address(prefetch->ifindex, prefetch->perm_addr, &len);
+    prefetch->perm_addr_len = len;
+}
+
+static void
+link_prefetch(NMPlatform *platform, const int *ifindexes, guint n_ifindexes)
+{
+    NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE(platform);
+    LinkPrefetchData *      prefetch;
+    GThreadPool *           pool;
+    gs_free_error GError *  error = NULL;
+    gint64                  start_msec;
+    guint                   i;
+
+    nm_clear_pointer(&priv->link_prefetch_idx, g_hash_table_destroy);
+
+    if (n_ifindexes < LINK_PREFETCH_MIN_LINKS)
+        return;
+
+    start_msec = nm_utils_get_monotonic_timestamp_msec();
+
+    pool = g_thread_pool_new(_link_prefetch_thread_fn,
+                             platform,
+                             LINK_PREFETCH_N_THREADS,
+                             FALSE,
+                             &error);
+    if (!pool) {
+        _LOGD("link: prefetch: cannot create thread pool: %s", error->message);
+        return;
+    }
+
+    priv->link_prefetch_idx = g_hash_table_new_full(nm_pint_hash, nm_pint_equals, g_free, NULL);
+
+    for (i = 0; i < n_ifindexes; i++) {
+        if (ifindexes[i] <= 0 || g_hash_table_contains(priv->link_prefetch_idx, &ifindexes[i]))
+            continue;
+
+        prefetch  = g_new(LinkPrefetchData, 1);
+        *prefetch = (LinkPrefetchData){
+            .ifindex = ifindexes[i],
+        };
+        g_hash_table_add(priv->link_prefetch_idx, prefetch);
+        g_thread_pool_push(pool, prefetch, NULL);
+    }
+
+    /* wait for all workers to finish. The main thread is blocked anyway while
+     * realizing the devices, this just overlaps the kernel round trips. */
+    g_thread_pool_free(pool, FALSE, TRUE);
+
+    _LOGD("link: prefetch: read ethtool info of %u links in %" G_GINT64_FORMAT " msec",
+          g_hash_table_size(priv->link_prefetch_idx),
+          nm_utils_get_monotonic_timestamp_msec() - start_msec);
+}
+
+static const LinkPrefetchData *
+_link_prefetch_lookup(NMPlatform *platform, int ifindex)
+{
+    NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE(platform);
+
+    if (!priv->link_prefetch_idx)
+        return NULL;
+    return g_hash_table_lookup(priv->link_prefetch_idx, &ifindex);
+}
+
 static gboolean
 link_get_permanent_address(NMPlatform *platform, int ifindex, guint8 *buf, size_t *length)
 {
     nm_auto_pop_netns NMPNetns *netns = NULL;
+    const LinkPrefetchData *    prefetch;
+
+    prefetch = _link_prefetch_lookup(platform, ifindex);
+    if (prefetch) {
+        if (!prefetch->has_perm_addr)
+            return FALSE;
+        memcpy(buf, prefetch->perm_addr, prefetch->perm_addr_len);
+        *length = prefetch->perm_addr_len;
+        return TRUE;
+    }
 
     if (!nm_platform_netns_push(platform, &netns))
         return FALSE;
@@ -7772,137 +8253,478 @@ out_idle:
     }
 }
 
-static gboolean
-link_set_sriov_vfs(NMPlatform *platform, int ifindex, const NMPlatformVF *const *vfs)
+static struct nl_msg *
+_nl_msg_new_link_set_vf(int ifindex, const NMPlatformVF *vf)
 {
     nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
     struct nlattr *              list, *info, *vlan_list;
-    guint                        i;
+    struct _ifla_vf_vlan_info    ivvi = {0};
 
-    nlmsg = _nl_msg_new_link(RTM_NEWLINK, 0, ifindex, NULL);
+    /* Kernel only supports one VLAN per VF now. If this
+     * changes in the future, we need to figure out how to
+     * clear existing VLANs and set new ones in one message
+     * with the new API.*/
+    nm_assert(vf->num_vlans <= 1);
+
+    nlmsg = _nl_msg_new_link(RTM_SETLINK, 0, ifindex, NULL);
     if (!nlmsg)
-        g_return_val_if_reached(-NME_BUG);
+        g_return_val_if_reached(NULL);
 
     if (!(list = nla_nest_start(nlmsg, IFLA_VFINFO_LIST)))
         goto nla_put_failure;
 
-    for (i = 0; vfs[i]; i++) {
-        const NMPlatformVF *vf = vfs[i];
-
-        if (!(info = nla_nest_start(nlmsg, IFLA_VF_INFO)))
-            goto nla_put_failure;
+    if (!(info = nla_nest_start(nlmsg, IFLA_VF_INFO)))
+        goto nla_put_failure;
 
-        if (vf->spoofchk >= 0) {
-            struct _ifla_vf_setting ivs = {0};
+    if (vf->spoofchk >= 0) {
+        struct _ifla_vf_setting ivs = {0};
 
-            ivs.vf      = vf->index;
-            ivs.setting = vf->spoofchk;
-            NLA_PUT(nlmsg, IFLA_VF_SPOOFCHK, sizeof(ivs), &ivs);
-        }
+        ivs.vf      = vf->index;
+        ivs.setting = vf->spoofchk;
+        NLA_PUT(nlmsg, IFLA_VF_SPOOFCHK, sizeof(ivs), &ivs);
+    }
 
-        if (vf->trust >= 0) {
-            struct _ifla_vf_setting ivs = {0};
+    if (vf->trust >= 0) {
+        struct _ifla_vf_setting ivs = {0};
 
-            ivs.vf      = vf->index;
-            ivs.setting = vf->trust;
-            NLA_PUT(nlmsg, IFLA_VF_TRUST, sizeof(ivs), &ivs);
-        }
+        ivs.vf      = vf->index;
+        ivs.setting = vf->trust;
+        NLA_PUT(nlmsg, IFLA_VF_TRUST, sizeof(ivs), &ivs);
+    }
 
-        if (vf->mac.len) {
-            struct ifla_vf_mac ivm = {0};
+    if (vf->mac.len) {
+        struct ifla_vf_mac ivm = {0};
 
-            ivm.vf = vf->index;
-            memcpy(ivm.mac, vf->mac.data, vf->mac.len);
-            NLA_PUT(nlmsg, IFLA_VF_MAC, sizeof(ivm), &ivm);
-        }
+        ivm.vf = vf->index;
+        memcpy(ivm.mac, vf->mac.data, vf->mac.len);
+        NLA_PUT(nlmsg, IFLA_VF_MAC, sizeof(ivm), &ivm);
+    }
 
-        if (vf->min_tx_rate || vf->max_tx_rate) {
-            struct _ifla_vf_rate ivr = {0};
+    if (vf->min_tx_rate || vf->max_tx_rate) {
+        struct _ifla_vf_rate ivr = {0};
 
-            ivr.vf          = vf->index;
-            ivr.min_tx_rate = vf->min_tx_rate;
-            ivr.max_tx_rate = vf->max_tx_rate;
-            NLA_PUT(nlmsg, IFLA_VF_RATE, sizeof(ivr), &ivr);
-        }
+        ivr.vf          = vf->index;
+        ivr.min_tx_rate = vf->min_tx_rate;
+        ivr.max_tx_rate = vf->max_tx_rate;
+        NLA_PUT(nlmsg, IFLA_VF_RATE, sizeof(ivr), &ivr);
+    }
 
-        /* Kernel only supports one VLAN per VF now. If this
-         * changes in the future, we need to figure out how to
-         * clear existing VLANs and set new ones in one message
-         * with the new API.*/
-        if (vf->num_vlans > 1) {
-            _LOGW("multiple VLANs per VF are not supported at the moment");
-            return FALSE;
-        } else {
-            struct _ifla_vf_vlan_info ivvi = {0};
+    if (!(vlan_list = nla_nest_start(nlmsg, IFLA_VF_VLAN_LIST)))
+        goto nla_put_failure;
 
-            if (!(vlan_list = nla_nest_start(nlmsg, IFLA_VF_VLAN_LIST)))
-                goto nla_put_failure;
+    ivvi.vf = vf->index;
+    if (vf->num_vlans == 1) {
+        ivvi.vlan       = vf->vlans[0].id;
+        ivvi.qos        = vf->vlans[0].qos;
+        ivvi.vlan_proto = htons(vf->vlans[0].proto_ad ? ETH_P_8021AD : ETH_P_8021Q);
+    } else {
+        /* Clear existing VLAN */
+        ivvi.vlan       = 0;
+        ivvi.qos        = 0;
+        ivvi.vlan_proto = htons(ETH_P_8021Q);
+    }
 
-            ivvi.vf = vf->index;
-            if (vf->num_vlans == 1) {
-                ivvi.vlan       = vf->vlans[0].id;
-                ivvi.qos        = vf->vlans[0].qos;
-                ivvi.vlan_proto = htons(vf->vlans[0].proto_ad ? ETH_P_8021AD : ETH_P_8021Q);
-            } else {
-                /* Clear existing VLAN */
-                ivvi.vlan       = 0;
-                ivvi.qos        = 0;
-                ivvi.vlan_proto = htons(ETH_P_8021Q);
-            }
+    NLA_PUT(nlmsg, IFLA_VF_VLAN_INFO, sizeof(ivvi), &ivvi);
+    nla_nest_end(nlmsg, vlan_list);
 
-            NLA_PUT(nlmsg, IFLA_VF_VLAN_INFO, sizeof(ivvi), &ivvi);
-            nla_nest_end(nlmsg, vlan_list);
-        }
-        nla_nest_end(nlmsg, info);
-    }
+    nla_nest_end(nlmsg, info);
     nla_nest_end(nlmsg, list);
 
-    return (do_change_link(platform, CHANGE_LINK_TYPE_UNSPEC, ifindex, nlmsg, NULL) >= 0);
+    return g_steal_pointer(&nlmsg);
 nla_put_failure:
-    g_return_val_if_reached(FALSE);
+    g_return_val_if_reached(NULL);
 }
 
-static gboolean
-link_set_bridge_vlans(NMPlatform *                       platform,
-                      int                                ifindex,
-                      gboolean                           on_master,
-                      const NMPlatformBridgeVlan *const *vlans)
-{
-    nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
-    struct nlattr *              list;
-    struct bridge_vlan_info      vinfo = {};
-    guint                        i;
+typedef struct {
+    struct nl_msg *msg;
+    guint32        vf_index;
 
-    nlmsg =
-        _nl_msg_new_link_full(vlans ? RTM_SETLINK : RTM_DELLINK, 0, ifindex, NULL, AF_BRIDGE, 0, 0);
-    if (!nlmsg)
-        g_return_val_if_reached(-NME_BUG);
+    /* 1 while pending, 0 on success or a negative NME error. */
+    int result;
+} SriovVFsAsyncItem;
 
-    if (!(list = nla_nest_start(nlmsg, IFLA_AF_SPEC)))
-        goto nla_put_failure;
+typedef struct {
+    NMPlatform *            platform;
+    int                     ifindex;
+    guint                   n_items;
+    SriovVFsAsyncItem *     items;
+    NMPlatformAsyncCallback callback;
+    gpointer                callback_data;
+} SriovVFsAsyncInfo;
 
-    NLA_PUT_U16(nlmsg, IFLA_BRIDGE_FLAGS, on_master ? BRIDGE_FLAGS_MASTER : BRIDGE_FLAGS_SELF);
+static void
+sriov_vfs_async_info_free(SriovVFsAsyncInfo *info)
+{
+    guint i;
 
-    if (vlans) {
-        /* Add VLANs */
-        for (i = 0; vlans[i]; i++) {
-            const NMPlatformBridgeVlan *vlan     = vlans[i];
-            gboolean                    is_range = vlan->vid_start != vlan->vid_end;
+    for (i = 0; i < info->n_items; i++)
+        nlmsg_free(info->items[i].msg);
+    g_free(info->items);
+    g_object_unref(info->platform);
+    g_slice_free(SriovVFsAsyncInfo, info);
+}
 
-            vinfo.vid   = vlan->vid_start;
-            vinfo.flags = is_range ? BRIDGE_VLAN_INFO_RANGE_BEGIN : 0;
+static void
+sriov_vfs_async_cb(GObject *object, GAsyncResult *res, gpointer user_data)
+{
+    GTask *            task = G_TASK(res);
+    SriovVFsAsyncInfo *info = g_task_get_task_data(task);
+    NMPlatform *       platform;
+    gs_free_error GError *error          = NULL;
+    nm_auto_free_gstring GString *failed = NULL;
+    guint                         i;
 
-            if (vlan->untagged)
-                vinfo.flags |= BRIDGE_VLAN_INFO_UNTAGGED;
-            if (vlan->pvid)
-                vinfo.flags |= BRIDGE_VLAN_INFO_PVID;
+    platform = info->platform;
 
-            NLA_PUT(nlmsg, IFLA_BRIDGE_VLAN_INFO, sizeof(vinfo), &vinfo);
+    if (g_task_propagate_boolean(task, &error)) {
+        for (i = 0; i < info->n_items; i++) {
+            const SriovVFsAsyncItem *item = &info->items[i];
 
-            if (is_range) {
-                vinfo.vid   = vlan->vid_end;
-                vinfo.flags = BRIDGE_VLAN_INFO_RANGE_END;
-                NLA_PUT(nlmsg, IFLA_BRIDGE_VLAN_INFO, sizeof(vinfo), &vinfo);
+            if (item->result == 0)
+                continue;
+            if (!failed)
+                failed = g_string_new(NULL);
+            else
+                g_string_append(failed, ", ");
+            g_string_append_printf(failed, "%u (%s)", item->vf_index, nm_strerror(item->result));
+        }
+
+        if (failed) {
+            g_set_error(&error,
+                        NM_UTILS_ERROR,
+                        NM_UTILS_ERROR_UNKNOWN,
+                        "failed to configure VFs %s",
+                        failed->str);
+        } else
+            _LOGD("link: %d: successfully configured %u VFs", info->ifindex, info->n_items);
+    }
+
+    if (info->callback)
+        info->callback(error, info->callback_data);
+}
+
+/* The VF requests are sent from a worker thread, which also logs.
+ * Hence, we require locking from nm-logging. */
+#undef NM_THREAD_SAFE_ON_MAIN_THREAD
+#define NM_THREAD_SAFE_ON_MAIN_THREAD 0
+
+static int
+_sriov_vfs_async_err_cb(struct sockaddr_nl *nla, struct nlmsgerr *nlerr, void *arg)
+{
+    int *p_result = arg;
+
+    *p_result = -nm_errno_from_native(nlerr->error);
+    return NL_SKIP;
+}
+
+static void
+sriov_vfs_async_thread_fn(GTask *       task,
+                          gpointer      source_object,
+                          gpointer      task_data,
+                          GCancellable *cancellable)
+{
+    nm_auto_pop_netns NMPNetns *netns       = NULL;
+    SriovVFsAsyncInfo *         info        = task_data;
+    NMPlatform *                platform    = info->platform;
+    struct nl_sock *            sk          = NULL;
+    int                         nle_failure = 0;
+    int                         nle;
+    guint                       i;
+
+    if (g_task_return_error_if_cancelled(task))
+        return;
+
+    if (!nm_platform_netns_push(info->platform, &netns)) {
+        g_task_return_new_error(task,
+                                NM_UTILS_ERROR,
+                                NM_UTILS_ERROR_UNKNOWN,
+                                "sriov: failed changing namespace");
+        return;
+    }
+
+    sk  = nl_socket_alloc();
+    nle = nl_connect(sk, NETLINK_ROUTE);
+    if (nle < 0) {
+        nl_socket_free(sk);
+        g_task_return_new_error(task,
+                                NM_UTILS_ERROR,
+                                NM_UTILS_ERROR_UNKNOWN,
+                                "sriov: failed creating netlink socket: %s",
+                                nm_strerror(nle));
+        return;
+    }
+
+    /* Kernel handles each request to completion under RTNL before it
+     * acknowledges it, so sending the next one early gains nothing. Send one
+     * VF at a time and wait for its acknowledgement. That takes one round
+     * trip per VF instead of a single RTM_NEWLINK for all of them, but a
+     * failure for one VF doesn't stop the others, and tells which VF failed. */
+    for (i = 0; i < info->n_items; i++) {
+        SriovVFsAsyncItem *item   = &info->items[i];
+        int                result = 0;
+        const struct nl_cb cb     = {
+            .err_cb  = _sriov_vfs_async_err_cb,
+            .err_arg = &result,
+        };
+
+        if (g_cancellable_is_cancelled(cancellable))
+            break;
+
+        nle = nl_send_auto(sk, item->msg);
+        if (nle >= 0)
+            nle = nl_wait_for_ack(sk, &cb);
+        if (nle < 0) {
+            /* the socket failed, and we lost track of the replies. */
+            nle_failure = nle;
+            break;
+        }
+
+        item->result = result;
+        _LOGD("link: %d: VF %u %s%s%s (%u/%u)",
+              info->ifindex,
+              item->vf_index,
+              result == 0 ? "configured" : "failed",
+              NM_PRINT_FMT_QUOTED(result != 0, ": ", nm_strerror(result), "", ""),
+              i + 1,
+              info->n_items);
+    }
+
+    nl_socket_free(sk);
+
+    if (g_task_return_error_if_cancelled(task))
+        return;
+
+    for (i = 0; i < info->n_items; i++) {
+        if (info->items[i].result == 1)
+            info->items[i].result = nle_failure ?: -NME_UNSPEC;
+    }
+    g_task_return_boolean(task, TRUE);
+}
+
+#undef NM_THREAD_SAFE_ON_MAIN_THREAD
+#define NM_THREAD_SAFE_ON_MAIN_THREAD 1
+
+static void
+link_set_sriov_vfs_async(NMPlatform *              platform,
+                         int                       ifindex,
+                         const NMPlatformVF *const *vfs,
+                         NMPlatformAsyncCallback   callback,
+                         gpointer                  data,
+                         GCancellable *            cancellable)
+{
+    SriovVFsAsyncInfo *info;
+    GTask *            task;
+    GError *           error = NULL;
+    gpointer           packed;
+    guint              n;
+    guint              i;
+
+    g_return_if_fail(callback || !data);
+    g_return_if_fail(cancellable);
+
+    n = NM_PTRARRAY_LEN(vfs);
+    if (n == 0)
+        goto out_idle;
+
+    for (i = 0; i < n; i++) {
+        if (vfs[i]->num_vlans > 1) {
+            g_set_error_literal(&error,
+                                NM_UTILS_ERROR,
+                                NM_UTILS_ERROR_UNKNOWN,
+                                "multiple VLANs per VF are not supported at the moment");
+            goto out_idle;
+        }
+    }
+
+    info  = g_slice_new(SriovVFsAsyncInfo);
+    *info = (SriovVFsAsyncInfo){
+        .platform      = g_object_ref(platform),
+        .ifindex       = ifindex,
+        .n_items       = n,
+        .items         = g_new0(SriovVFsAsyncItem, n),
+        .callback      = callback,
+        .callback_data = data,
+    };
+    for (i = 0; i < n; i++) {
+        info->items[i].msg      = _nl_msg_new_link_set_vf(ifindex, vfs[i]);
+        info->items[i].vf_index = vfs[i]->index;
+        info->items[i].result   = 1;
+        if (!info->items[i].msg) {
+            sriov_vfs_async_info_free(info);
+            g_set_error_literal(&error,
+                                NM_UTILS_ERROR,
+                                NM_UTILS_ERROR_UNKNOWN,
+                                "failed to build netlink message");
+            goto out_idle;
+        }
+    }
+
+    task = g_task_new(platform, cancellable, sriov_vfs_async_cb, NULL);
+    g_task_set_task_data(task, info, (GDestroyNotify) sriov_vfs_async_info_free);
+    g_task_set_return_on_cancel(task, FALSE);
+    g_task_run_in_thread(task, sriov_vfs_async_thread_fn);
+    g_object_unref(task);
+    return;
+
+out_idle:
+    if (callback) {
+        packed = nm_utils_user_data_pack(g_object_ref(platform), error, callback, data);
+        nm_utils_invoke_on_idle(cancellable, sriov_idle_cb, packed);
+    } else
+        g_clear_error(&error);
+}
+
+typedef struct {
+    int     ifindex;
+    GArray *vlans;
+} BridgeVlansDumpData;
+
+static int
+_bridge_vlans_dump_cb(struct nl_msg *msg, void *arg)
+{
+    static const struct nla_policy policy[] = {
+        [IFLA_AF_SPEC] = {.type = NLA_NESTED},
+    };
+    BridgeVlansDumpData *   data = arg;
+    struct nlmsghdr *       nlh  = nlmsg_hdr(msg);
+    struct nlattr *         tb[G_N_ELEMENTS(policy)];
+    const struct ifinfomsg *ifi;
+    struct nlattr *         attr;
+    int                     remaining;
+    guint16                 range_start = 0;
+
+    if (nlh->nlmsg_type != RTM_NEWLINK || !nlmsg_valid_hdr(nlh, sizeof(*ifi)))
+        return NL_SKIP;
+
+    ifi = nlmsg_data(nlh);
+    if (ifi->ifi_index != data->ifindex)
+        return NL_SKIP;
+
+    if (nlmsg_parse_arr(nlh, sizeof(*ifi), tb, policy) < 0 || !tb[IFLA_AF_SPEC])
+        return NL_SKIP;
+
+    nla_for_each_nested (attr, tb[IFLA_AF_SPEC], remaining) {
+        const struct bridge_vlan_info *vinfo;
+        NMPlatformBridgeVlan           vlan;
+
+        if (nla_type(attr) != IFLA_BRIDGE_VLAN_INFO || nla_len(attr) < sizeof(*vinfo))
+            continue;
+
+        vinfo = nla_data(attr);
+        if (vinfo->flags & BRIDGE_VLAN_INFO_RANGE_BEGIN) {
+            range_start = vinfo->vid;
+            continue;
+        }
+
+        if (!(vinfo->flags & BRIDGE_VLAN_INFO_RANGE_END) || !range_start)
+            range_start = vinfo->vid;
+
+        vlan = (NMPlatformBridgeVlan){
+            .vid_start = range_start,
+            .vid_end   = vinfo->vid,
+            .untagged  = NM_FLAGS_HAS(vinfo->flags, BRIDGE_VLAN_INFO_UNTAGGED),
+            .pvid      = NM_FLAGS_HAS(vinfo->flags, BRIDGE_VLAN_INFO_PVID),
+        };
+        g_array_append_val(data->vlans, vlan);
+        range_start = 0;
+    }
+
+    return NL_OK;
+}
+
+static gboolean
+link_get_bridge_vlans(NMPlatform *           platform,
+                      int                    ifindex,
+                      NMPlatformBridgeVlan **out_vlans,
+                      guint *                out_len)
+{
+    nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+    gs_unref_array GArray *vlans       = NULL;
+    struct nl_sock *       sk;
+    BridgeVlansDumpData    data;
+    int                    nle;
+
+    nlmsg = _nl_msg_new_link_full(RTM_GETLINK, NLM_F_DUMP, 0, NULL, AF_BRIDGE, 0, 0);
+    if (!nlmsg)
+        g_return_val_if_reached(FALSE);
+
+    NLA_PUT_U32(nlmsg, IFLA_EXT_MASK, RTEXT_FILTER_BRVLAN_COMPRESSED);
+
+    /* Kernel can only dump the VLANs of all bridge ports at once. Do that on
+     * a separate socket, so that the replies don't mix with the events for
+     * the platform cache. */
+    sk  = nl_socket_alloc();
+    nle = nl_connect(sk, NETLINK_ROUTE);
+    if (nle >= 0)
+        nle = nl_send_auto(sk, nlmsg);
+    if (nle >= 0) {
+        vlans = g_array_new(FALSE, FALSE, sizeof(NMPlatformBridgeVlan));
+        data  = (BridgeVlansDumpData){
+            .ifindex = ifindex,
+            .vlans   = vlans,
+        };
+        nle = nl_recvmsgs(sk,
+                          &((const struct nl_cb){
+                              .valid_cb  = _bridge_vlans_dump_cb,
+                              .valid_arg = &data,
+                          }));
+    }
+    nl_socket_free(sk);
+
+    if (nle < 0) {
+        _LOGD("link: %d: failed to dump bridge VLANs: %s", ifindex, nm_strerror(nle));
+        return FALSE;
+    }
+
+    *out_len   = vlans->len;
+    *out_vlans = (NMPlatformBridgeVlan *) g_array_free(g_steal_pointer(&vlans), *out_len == 0);
+    return TRUE;
+nla_put_failure:
+    g_return_val_if_reached(FALSE);
+}
+
+static gboolean
+_link_set_bridge_vlans_msg(NMPlatform *                platform,
+                           int                         ifindex,
+                           gboolean                    on_master,
+                           const NMPlatformBridgeVlan *vlans,
+                           guint                       n_vlans)
+{
+    nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+    struct nlattr *              list;
+    struct bridge_vlan_info      vinfo = {};
+    guint                        i;
+
+    nlmsg =
+        _nl_msg_new_link_full(vlans ? RTM_SETLINK : RTM_DELLINK, 0, ifindex, NULL, AF_BRIDGE, 0, 0);
+    if (!nlmsg)
+        g_return_val_if_reached(-NME_BUG);
+
+    if (!(list = nla_nest_start(nlmsg, IFLA_AF_SPEC)))
+        goto nla_put_failure;
+
+    NLA_PUT_U16(nlmsg, IFLA_BRIDGE_FLAGS, on_master ? BRIDGE_FLAGS_MASTER : BRIDGE_FLAGS_SELF);
+
+    if (vlans) {
+        /* Add VLANs */
+        for (i = 0; i < n_vlans; i++) {
+            const NMPlatformBridgeVlan *vlan     = &vlans[i];
+            gboolean                    is_range = vlan->vid_start != vlan->vid_end;
+
+            vinfo.vid   = vlan->vid_start;
+            vinfo.flags = is_range ? BRIDGE_VLAN_INFO_RANGE_BEGIN : 0;
+
+            if (vlan->untagged)
+                vinfo.flags |= BRIDGE_VLAN_INFO_UNTAGGED;
+            if (vlan->pvid)
+                vinfo.flags |= BRIDGE_VLAN_INFO_PVID;
+
+            NLA_PUT(nlmsg, IFLA_BRIDGE_VLAN_INFO, sizeof(vinfo), &vinfo);
+
+            if (is_range) {
+                vinfo.vid   = vlan->vid_end;
+                vinfo.flags = BRIDGE_VLAN_INFO_RANGE_END;
+                NLA_PUT(nlmsg, IFLA_BRIDGE_VLAN_INFO, sizeof(vinfo), &vinfo);
             }
         }
     } else {
@@ -7923,6 +8745,49 @@ nla_put_failure:
     g_return_val_if_reached(FALSE);
 }
 
+/* Each range takes two attributes of 8 bytes. Stay well below the page
+ * sized netlink message. */
+#define BRIDGE_VLANS_PER_MSG 200
+
+static gboolean
+link_set_bridge_vlans(NMPlatform *                       platform,
+                      int                                ifindex,
+                      gboolean                           on_master,
+                      const NMPlatformBridgeVlan *const *vlans)
+{
+    gs_free NMPlatformBridgeVlan *current = NULL;
+    gs_free NMPlatformBridgeVlan *ranges  = NULL;
+    guint                         n_current;
+    guint                         n_ranges;
+    guint                         i;
+
+    if (!vlans)
+        return _link_set_bridge_vlans_msg(platform, ifindex, on_master, NULL, 0);
+
+    /* Only send the VLANs that kernel doesn't have yet, merged into as few
+     * ranges as possible. If we can't fetch the current state, send all. */
+    if (!nm_platform_link_get_bridge_vlans(platform, ifindex, &current, &n_current))
+        n_current = 0;
+
+    ranges = nm_platform_bridge_vlans_compress(vlans, current, n_current, &n_ranges);
+
+    _LOGD("link: %d: %u bridge VLAN ranges to configure in %u messages",
+          ifindex,
+          n_ranges,
+          (n_ranges + BRIDGE_VLANS_PER_MSG - 1) / BRIDGE_VLANS_PER_MSG);
+
+    for (i = 0; i < n_ranges; i += BRIDGE_VLANS_PER_MSG) {
+        if (!_link_set_bridge_vlans_msg(platform,
+                                        ifindex,
+                                        on_master,
+                                        &ranges[i],
+                                        NM_MIN(n_ranges - i, (guint) BRIDGE_VLANS_PER_MSG)))
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
 static char *
 link_get_physical_port_id(NMPlatform *platform, int ifindex)
 {
@@ -8489,12 +9354,20 @@ link_get_driver_info(NMPlatform *platform,
 {
     nm_auto_pop_netns NMPNetns *netns = NULL;
     NMPUtilsEthtoolDriverInfo   driver_info;
+    const LinkPrefetchData *    prefetch;
 
-    if (!nm_platform_netns_push(platform, &netns))
-        return FALSE;
+    prefetch = _link_prefetch_lookup(platform, ifindex);
+    if (prefetch) {
+        if (!prefetch->has_driver_info)
+            return FALSE;
+        driver_info = prefetch->driver_info;
+    } else {
+        if (!nm_platform_netns_push(platform, &netns))
+            return FALSE;
 
-    if (!nmp_utils_ethtool_get_driver_info(ifindex, &driver_info))
-        return FALSE;
+        if (!nmp_utils_ethtool_get_driver_info(ifindex, &driver_info))
+            return FALSE;
+    }
     NM_SET_OUT(out_driver_name, g_strdup(driver_info.driver));
     NM_SET_OUT(out_driver_version, g_strdup(driver_info.version));
     NM_SET_OUT(out_fw_version, g_strdup(driver_info.fw_version));
@@ -8503,6 +9376,417 @@ link_get_driver_info(NMPlatform *platform,
 
 /*****************************************************************************/
 
+/* For how long we trust the ethtool settings that we read. Changes done via
+ * NMPlatform and link changes drop them right away, but somebody else calling
+ * ethtool does not give us a notification on the rtnetlink socket. */
+#define ETHTOOL_CACHE_TIMEOUT_MSEC 3000
+
+typedef struct {
+    int                      ifindex;
+    gint64                   timestamp_msec[_ETHTOOL_CACHE_TYPE_NUM];
+    bool                     success[_ETHTOOL_CACHE_TYPE_NUM];
+    bool                     autoneg;
+    guint32                  speed;
+    NMPlatformLinkDuplexType duplex;
+    NMEthtoolRingState       ring;
+    NMEthtoolCoalesceState   coalesce;
+} EthtoolCacheData;
+
+typedef struct {
+    NMPlatform *     platform;
+    EthtoolCacheType type;
+    gint64           now_msec;
+    guint            n_links;
+} EthtoolDumpData;
+
+static NM_UTILS_LOOKUP_STR_DEFINE(
+    _ethtool_cache_type_to_string,
+    EthtoolCacheType,
+    NM_UTILS_LOOKUP_DEFAULT_NM_ASSERT("unknown"),
+    NM_UTILS_LOOKUP_STR_ITEM(ETHTOOL_CACHE_TYPE_LINKMODES, "linkmodes"),
+    NM_UTILS_LOOKUP_STR_ITEM(ETHTOOL_CACHE_TYPE_RINGS, "rings"),
+    NM_UTILS_LOOKUP_STR_ITEM(ETHTOOL_CACHE_TYPE_COALESCE, "coalesce"),
+    NM_UTILS_LOOKUP_ITEM_IGNORE(_ETHTOOL_CACHE_TYPE_NUM), );
+
+static EthtoolCacheData *
+_ethtool_cache_get(NMPlatform *platform, int ifindex, gboolean create)
+{
+    NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE(platform);
+    EthtoolCacheData *      data;
+
+    if (priv->ethtool_cache) {
+        data = g_hash_table_lookup(priv->ethtool_cache, &ifindex);
+        if (data || !create)
+            return data;
+    } else {
+        if (!create)
+            return NULL;
+        priv->ethtool_cache = g_hash_table_new_full(nm_pint_hash, nm_pint_equals, g_free, NULL);
+    }
+
+    data  = g_new(EthtoolCacheData, 1);
+    *data = (EthtoolCacheData){
+        .ifindex = ifindex,
+    };
+    g_hash_table_add(priv->ethtool_cache, data);
+    return data;
+}
+
+static EthtoolCacheData *
+_ethtool_dump_data_get(EthtoolDumpData *dump_data, struct nlattr *header)
+{
+    static const struct nla_policy policy[] = {
+        [ETHTOOL_A_HEADER_DEV_INDEX] = {.type = NLA_U32},
+    };
+    struct nlattr *   tb[G_N_ELEMENTS(policy)];
+    EthtoolCacheData *data;
+    int               ifindex;
+
+    if (!header || nla_parse_nested_arr(tb, header, policy) < 0
+        || !tb[ETHTOOL_A_HEADER_DEV_INDEX])
+        return NULL;
+
+    ifindex = (int) nla_get_u32(tb[ETHTOOL_A_HEADER_DEV_INDEX]);
+    if (ifindex <= 0)
+        return NULL;
+
+    data                                  = _ethtool_cache_get(dump_data->platform, ifindex, TRUE);
+    data->timestamp_msec[dump_data->type] = dump_data->now_msec;
+    data->success[dump_data->type]        = TRUE;
+    dump_data->n_links++;
+    return data;
+}
+
+static int
+_ethtool_linkmodes_dump_cb(struct nl_msg *msg, void *arg)
+{
+    static const struct nla_policy policy[] = {
+        [ETHTOOL_A_LINKMODES_HEADER]  = {.type = NLA_NESTED},
+        [ETHTOOL_A_LINKMODES_AUTONEG] = {.type = NLA_U8},
+        [ETHTOOL_A_LINKMODES_SPEED]   = {.type = NLA_U32},
+        [ETHTOOL_A_LINKMODES_DUPLEX]  = {.type = NLA_U8},
+    };
+    struct nlattr *   tb[G_N_ELEMENTS(policy)];
+    EthtoolCacheData *data;
+    guint32           speed;
+
+    if (genlmsg_parse_arr(nlmsg_hdr(msg), 0, tb, policy) < 0)
+        return NL_SKIP;
+
+    data = _ethtool_dump_data_get(arg, tb[ETHTOOL_A_LINKMODES_HEADER]);
+    if (!data)
+        return NL_SKIP;
+
+    data->autoneg =
+        (nla_get_u8_cond(tb, ETHTOOL_A_LINKMODES_AUTONEG, AUTONEG_DISABLE) == AUTONEG_ENABLE);
+
+    speed = nla_get_u32_cond(tb, ETHTOOL_A_LINKMODES_SPEED, 0);
+    if (speed == G_MAXUINT16 || speed == G_MAXUINT32)
+        speed = 0;
+    data->speed = speed;
+
+    switch (nla_get_u8_cond(tb, ETHTOOL_A_LINKMODES_DUPLEX, DUPLEX_UNKNOWN)) {
+    case DUPLEX_HALF:
+        data->duplex = NM_PLATFORM_LINK_DUPLEX_HALF;
+        break;
+    case DUPLEX_FULL:
+        data->duplex = NM_PLATFORM_LINK_DUPLEX_FULL;
+        break;
+    default:
+        data->duplex = NM_PLATFORM_LINK_DUPLEX_UNKNOWN;
+        break;
+    }
+
+    return NL_OK;
+}
+
+static int
+_ethtool_rings_dump_cb(struct nl_msg *msg, void *arg)
+{
+    static const struct nla_policy policy[] = {
+        [ETHTOOL_A_RINGS_HEADER]   = {.type = NLA_NESTED},
+        [ETHTOOL_A_RINGS_RX]       = {.type = NLA_U32},
+        [ETHTOOL_A_RINGS_RX_MINI]  = {.type = NLA_U32},
+        [ETHTOOL_A_RINGS_RX_JUMBO] = {.type = NLA_U32},
+        [ETHTOOL_A_RINGS_TX]       = {.type = NLA_U32},
+    };
+    struct nlattr *   tb[G_N_ELEMENTS(policy)];
+    EthtoolCacheData *data;
+
+    if (genlmsg_parse_arr(nlmsg_hdr(msg), 0, tb, policy) < 0)
+        return NL_SKIP;
+
+    data = _ethtool_dump_data_get(arg, tb[ETHTOOL_A_RINGS_HEADER]);
+    if (!data)
+        return NL_SKIP;
+
+    data->ring = (NMEthtoolRingState){
+        .rx_pending       = nla_get_u32_cond(tb, ETHTOOL_A_RINGS_RX, 0),
+        .rx_mini_pending  = nla_get_u32_cond(tb, ETHTOOL_A_RINGS_RX_MINI, 0),
+        .rx_jumbo_pending = nla_get_u32_cond(tb, ETHTOOL_A_RINGS_RX_JUMBO, 0),
+        .tx_pending       = nla_get_u32_cond(tb, ETHTOOL_A_RINGS_TX, 0),
+    };
+
+    return NL_OK;
+}
+
+static int
+_ethtool_coalesce_dump_cb(struct nl_msg *msg, void *arg)
+{
+#define _COALESCE_ATTR(id, attr) \
+    [_NM_ETHTOOL_ID_COALESCE_AS_IDX(NM_ETHTOOL_ID_COALESCE_##id)] = (attr)
+    static const guint8 attrs[_NM_ETHTOOL_ID_COALESCE_NUM] = {
+        _COALESCE_ATTR(ADAPTIVE_RX, ETHTOOL_A_COALESCE_USE_ADAPTIVE_RX),
+        _COALESCE_ATTR(ADAPTIVE_TX, ETHTOOL_A_COALESCE_USE_ADAPTIVE_TX),
+        _COALESCE_ATTR(PKT_RATE_HIGH, ETHTOOL_A_COALESCE_PKT_RATE_HIGH),
+        _COALESCE_ATTR(PKT_RATE_LOW, ETHTOOL_A_COALESCE_PKT_RATE_LOW),
+        _COALESCE_ATTR(RX_FRAMES, ETHTOOL_A_COALESCE_RX_MAX_FRAMES),
+        _COALESCE_ATTR(RX_FRAMES_HIGH, ETHTOOL_A_COALESCE_RX_MAX_FRAMES_HIGH),
+        _COALESCE_ATTR(RX_FRAMES_IRQ, ETHTOOL_A_COALESCE_RX_MAX_FRAMES_IRQ),
+        _COALESCE_ATTR(RX_FRAMES_LOW, ETHTOOL_A_COALESCE_RX_MAX_FRAMES_LOW),
+        _COALESCE_ATTR(RX_USECS, ETHTOOL_A_COALESCE_RX_USECS),
+        _COALESCE_ATTR(RX_USECS_HIGH, ETHTOOL_A_COALESCE_RX_USECS_HIGH),
+        _COALESCE_ATTR(RX_USECS_IRQ, ETHTOOL_A_COALESCE_RX_USECS_IRQ),
+        _COALESCE_ATTR(RX_USECS_LOW, ETHTOOL_A_COALESCE_RX_USECS_LOW),
+        _COALESCE_ATTR(SAMPLE_INTERVAL, ETHTOOL_A_COALESCE_RATE_SAMPLE_INTERVAL),
+        _COALESCE_ATTR(STATS_BLOCK_USECS, ETHTOOL_A_COALESCE_STATS_BLOCK_USECS),
+        _COALESCE_ATTR(TX_FRAMES, ETHTOOL_A_COALESCE_TX_MAX_FRAMES),
+        _COALESCE_ATTR(TX_FRAMES_HIGH, ETHTOOL_A_COALESCE_TX_MAX_FRAMES_HIGH),
+        _COALESCE_ATTR(TX_FRAMES_IRQ, ETHTOOL_A_COALESCE_TX_MAX_FRAMES_IRQ),
+        _COALESCE_ATTR(TX_FRAMES_LOW, ETHTOOL_A_COALESCE_TX_MAX_FRAMES_LOW),
+        _COALESCE_ATTR(TX_USECS, ETHTOOL_A_COALESCE_TX_USECS),
+        _COALESCE_ATTR(TX_USECS_HIGH, ETHTOOL_A_COALESCE_TX_USECS_HIGH),
+        _COALESCE_ATTR(TX_USECS_IRQ, ETHTOOL_A_COALESCE_TX_USECS_IRQ),
+        _COALESCE_ATTR(TX_USECS_LOW, ETHTOOL_A_COALESCE_TX_USECS_LOW),
+    };
+#undef _COALESCE_ATTR
+    struct nlattr *   tb[ETHTOOL_A_COALESCE_RATE_SAMPLE_INTERVAL + 1];
+    EthtoolCacheData *data;
+    guint             i;
+
+    /* the attributes have different sizes, we check them below. */
+    if (genlmsg_parse_arr(nlmsg_hdr(msg), 0, tb, NULL) < 0)
+        return NL_SKIP;
+
+    data = _ethtool_dump_data_get(arg, tb[ETHTOOL_A_COALESCE_HEADER]);
+    if (!data)
+        return NL_SKIP;
+
+    for (i = 0; i < G_N_ELEMENTS(attrs); i++) {
+        const struct nlattr *attr = tb[attrs[i]];
+
+        if (!attr)
+            data->coalesce.s[i] = 0;
+        else if (NM_IN_SET(attrs[i],
+                           ETHTOOL_A_COALESCE_USE_ADAPTIVE_RX,
+                           ETHTOOL_A_COALESCE_USE_ADAPTIVE_TX))
+            data->coalesce.s[i] = nla_len(attr) >= sizeof(guint8) ? nla_get_u8(attr) : 0;
+        else
+            data->coalesce.s[i] = nla_len(attr) >= sizeof(guint32) ? nla_get_u32(attr) : 0;
+    }
+
+    return NL_OK;
+}
+
+static gboolean
+_ethtool_dump(NMPlatform *platform, EthtoolCacheType type, gint64 now_msec)
+{
+    NMLinuxPlatformPrivate *     priv = NM_LINUX_PLATFORM_GET_PRIVATE(platform);
+    nm_auto_nlmsg struct nl_msg *msg  = NULL;
+    struct nlattr *              nest;
+    NMPLookup                    lookup;
+    NMDedupMultiIter             iter;
+    const NMPlatformLink *       plink;
+    nl_recvmsg_msg_cb_t          dump_cb;
+    guint8                       cmd;
+    int                          r;
+    EthtoolDumpData              dump_data = {
+        .platform = platform,
+        .type     = type,
+        .now_msec = now_msec,
+    };
+
+    if (priv->ethtool_family_id == 0) {
+        priv->ethtool_family_id = genl_ctrl_resolve(priv->genl, ETHTOOL_GENL_NAME);
+        if (priv->ethtool_family_id < 0)
+            _LOGD("ethtool: generic netlink family not available, using ioctl");
+    }
+    if (priv->ethtool_family_id < 0)
+        return FALSE;
+
+    switch (type) {
+    case ETHTOOL_CACHE_TYPE_LINKMODES:
+        cmd     = ETHTOOL_MSG_LINKMODES_GET;
+        dump_cb = _ethtool_linkmodes_dump_cb;
+        break;
+    case ETHTOOL_CACHE_TYPE_RINGS:
+        cmd     = ETHTOOL_MSG_RINGS_GET;
+        dump_cb = _ethtool_rings_dump_cb;
+        break;
+    case ETHTOOL_CACHE_TYPE_COALESCE:
+        cmd     = ETHTOOL_MSG_COALESCE_GET;
+        dump_cb = _ethtool_coalesce_dump_cb;
+        break;
+    default:
+        nm_assert_not_reached();
+        return FALSE;
+    }
+
+    msg = nlmsg_alloc();
+
+    if (!genlmsg_put(msg,
+                     NL_AUTO_PORT,
+                     NL_AUTO_SEQ,
+                     priv->ethtool_family_id,
+                     0,
+                     NLM_F_DUMP,
+                     cmd,
+                     ETHTOOL_GENL_VERSION))
+        return FALSE;
+
+    /* all messages have the header at the same attribute type. */
+    nest = nla_nest_start(msg, ETHTOOL_A_LINKMODES_HEADER);
+    if (!nest)
+        goto nla_put_failure;
+    NLA_PUT_U32(msg, ETHTOOL_A_HEADER_FLAGS, ETHTOOL_FLAG_COMPACT_BITSETS);
+    nla_nest_end(msg, nest);
+
+    if (nl_send_auto(priv->genl, msg) < 0)
+        return FALSE;
+
+    r = nl_recvmsgs(priv->genl,
+                    &((const struct nl_cb){
+                        .valid_cb  = dump_cb,
+                        .valid_arg = &dump_data,
+                    }));
+    if (r < 0) {
+        _LOGD("ethtool: dumping %s failed: %s",
+              _ethtool_cache_type_to_string(type),
+              nm_strerror(r));
+        return FALSE;
+    }
+
+    /* kernel omits the links that don't support the operation from the dump.
+     * Remember them as failed, so that we don't ask again with ioctl. */
+    nmp_lookup_init_obj_type(&lookup, NMP_OBJECT_TYPE_LINK);
+    nmp_cache_iter_for_each_link (&iter,
+                                  nmp_cache_lookup(nm_platform_get_cache(platform), &lookup),
+                                  &plink) {
+        EthtoolCacheData *data;
+
+        data = _ethtool_cache_get(platform, plink->ifindex, TRUE);
+        if (data->timestamp_msec[type] != now_msec) {
+            data->timestamp_msec[type] = now_msec;
+            data->success[type]        = FALSE;
+        }
+    }
+
+    _LOGT("ethtool: dumped %s of %u links", _ethtool_cache_type_to_string(type), dump_data.n_links);
+    return TRUE;
+
+nla_put_failure:
+    g_return_val_if_reached(FALSE);
+}
+
+static const EthtoolCacheData *
+_ethtool_cache_lookup(NMPlatform *platform, int ifindex, EthtoolCacheType type)
+{
+    NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE(platform);
+    const EthtoolCacheData *data;
+    gint64                  now_msec;
+    gint64                  miss_msec;
+
+    now_msec = nm_utils_get_monotonic_timestamp_msec();
+
+    data = _ethtool_cache_get(platform, ifindex, FALSE);
+    if (data && data->timestamp_msec[type] != 0
+        && now_msec - data->timestamp_msec[type] < ETHTOOL_CACHE_TIMEOUT_MSEC)
+        return data;
+
+    /* A single miss is served by an ioctl for that one link, as before. Only
+     * when a second miss follows shortly (like, when activating many devices
+     * at once), fetch the settings of all links with one netlink dump. */
+    miss_msec                     = priv->ethtool_miss_msec[type];
+    priv->ethtool_miss_msec[type] = now_msec;
+
+    if (miss_msec == 0 || now_msec - miss_msec >= ETHTOOL_CACHE_TIMEOUT_MSEC)
+        return NULL;
+    if (priv->ethtool_dump_msec[type] != 0
+        && now_msec - priv->ethtool_dump_msec[type] < ETHTOOL_CACHE_TIMEOUT_MSEC)
+        return NULL;
+
+    priv->ethtool_dump_msec[type] = now_msec;
+    if (!_ethtool_dump(platform, type, now_msec))
+        return NULL;
+
+    data = _ethtool_cache_get(platform, ifindex, FALSE);
+    if (data && data->timestamp_msec[type] == now_msec)
+        return data;
+    return NULL;
+}
+
+static void
+ethtool_invalidate(NMPlatform *platform, int ifindex)
+{
+    NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE(platform);
+
+    if (priv->ethtool_cache)
+        g_hash_table_remove(priv->ethtool_cache, &ifindex);
+}
+
+static gboolean
+ethtool_get_link_settings(NMPlatform *              platform,
+                          int                       ifindex,
+                          gboolean *                out_autoneg,
+                          guint32 *                 out_speed,
+                          NMPlatformLinkDuplexType *out_duplex)
+{
+    const EthtoolCacheData *data;
+
+    data = _ethtool_cache_lookup(platform, ifindex, ETHTOOL_CACHE_TYPE_LINKMODES);
+    if (!data)
+        return nmp_utils_ethtool_get_link_settings(ifindex, out_autoneg, out_speed, out_duplex);
+
+    if (!data->success[ETHTOOL_CACHE_TYPE_LINKMODES])
+        return FALSE;
+    NM_SET_OUT(out_autoneg, data->autoneg);
+    NM_SET_OUT(out_speed, data->speed);
+    NM_SET_OUT(out_duplex, data->duplex);
+    return TRUE;
+}
+
+static gboolean
+ethtool_get_link_coalesce(NMPlatform *platform, int ifindex, NMEthtoolCoalesceState *coalesce)
+{
+    const EthtoolCacheData *data;
+
+    data = _ethtool_cache_lookup(platform, ifindex, ETHTOOL_CACHE_TYPE_COALESCE);
+    if (!data)
+        return nmp_utils_ethtool_get_coalesce(ifindex, coalesce);
+
+    if (!data->success[ETHTOOL_CACHE_TYPE_COALESCE])
+        return FALSE;
+    *coalesce = data->coalesce;
+    return TRUE;
+}
+
+static gboolean
+ethtool_get_link_ring(NMPlatform *platform, int ifindex, NMEthtoolRingState *ring)
+{
+    const EthtoolCacheData *data;
+
+    data = _ethtool_cache_lookup(platform, ifindex, ETHTOOL_CACHE_TYPE_RINGS);
+    if (!data)
+        return nmp_utils_ethtool_get_ring(ifindex, ring);
+
+    if (!data->success[ETHTOOL_CACHE_TYPE_RINGS])
+        return FALSE;
+    *ring = data->ring;
+    return TRUE;
+}
+
+/*****************************************************************************/
+
 static gboolean
 ip4_address_add(NMPlatform *platform,
                 int         ifindex,
@@ -8896,6 +10180,110 @@ tfilter_add(NMPlatform *platform, NMPNlmFlags flags, const NMPlatformTfilter *tf
 
 /*****************************************************************************/
 
+static void
+_neigh_sync_membership(NMPlatform *platform)
+{
+    NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE(platform);
+    gboolean                want;
+    int                     nle;
+
+    /* only listen to neighbor events while somebody is interested. On a busy
+     * network they are frequent, and we would have to parse each of them. */
+    want = priv->neigh_subscriptions[0] || priv->neigh_subscriptions[1];
+    if (want == priv->neigh_group_joined)
+        return;
+
+    if (want)
+        nle = nl_socket_add_memberships(priv->nlh, RTNLGRP_NEIGH, 0);
+    else
+        nle = nl_socket_drop_membership(priv->nlh, RTNLGRP_NEIGH);
+    if (nle < 0) {
+        _LOGW("neighbor: failure to %s netlink group: %s",
+              want ? "join" : "leave",
+              nm_strerror(nle));
+        return;
+    }
+
+    priv->neigh_group_joined = want;
+}
+
+static void
+_neigh_prune(NMPlatform *platform, NMPObjectType obj_type)
+{
+    NMPCache *                   cache = nm_platform_get_cache(platform);
+    gs_unref_ptrarray GPtrArray *objs  = NULL;
+    NMPLookup                    lookup;
+    guint                        i;
+
+    objs = nm_platform_lookup_clone(platform,
+                                    nmp_lookup_init_obj_type(&lookup, obj_type),
+                                    NULL,
+                                    NULL);
+    if (!objs)
+        return;
+
+    for (i = 0; i < objs->len; i++) {
+        const NMPObject *         obj      = objs->pdata[i];
+        const NMPlatformNeighbor *neighbor = NMP_OBJECT_CAST_NEIGHBOR(obj);
+        NMPCacheOpsType           cache_op;
+
+        if (_neigh_is_subscribed(platform, obj_type, neighbor->ifindex, neighbor->master))
+            continue;
+
+        cache_op = nmp_cache_remove(cache, obj, TRUE, FALSE, NULL);
+        if (cache_op != NMP_CACHE_OPS_UNCHANGED) {
+            cache_on_change(platform, cache_op, obj, NULL);
+            nm_platform_cache_update_emit_signal(platform, cache_op, obj, NULL);
+        }
+    }
+}
+
+static void
+neighbor_subscribe(NMPlatform *platform, NMPObjectType obj_type, int ifindex, gboolean subscribe)
+{
+    GHashTable **p_subscriptions = _neigh_subscriptions(platform, obj_type);
+    gpointer     key             = GINT_TO_POINTER(ifindex);
+    int          count;
+
+    count = *p_subscriptions ? GPOINTER_TO_INT(g_hash_table_lookup(*p_subscriptions, key)) : 0;
+
+    if (subscribe) {
+        if (!*p_subscriptions)
+            *p_subscriptions = g_hash_table_new(nm_direct_hash, NULL);
+        g_hash_table_insert(*p_subscriptions, key, GINT_TO_POINTER(count + 1));
+        if (count > 0)
+            return;
+
+        _neigh_sync_membership(platform);
+
+        /* there is no dump for a single interface, fetch them all. Entries of
+         * interfaces that nobody subscribed to get dropped while parsing. */
+        do_request_all_no_delayed_actions(platform,
+                                          obj_type == NMP_OBJECT_TYPE_FDB
+                                              ? DELAYED_ACTION_TYPE_REFRESH_ALL_FDB
+                                              : DELAYED_ACTION_TYPE_REFRESH_ALL_NEIGHBORS);
+        delayed_action_handle_all(platform, FALSE);
+        return;
+    }
+
+    if (count <= 0)
+        g_return_if_reached();
+
+    if (count > 1) {
+        g_hash_table_insert(*p_subscriptions, key, GINT_TO_POINTER(count - 1));
+        return;
+    }
+
+    g_hash_table_remove(*p_subscriptions, key);
+    if (g_hash_table_size(*p_subscriptions) == 0)
+        nm_clear_pointer(p_subscriptions, g_hash_table_unref);
+
+    _neigh_sync_membership(platform);
+    _neigh_prune(platform, obj_type);
+}
+
+/*****************************************************************************/
+
 static gboolean
 event_handler(int fd, GIOCondition io_condition, gpointer user_data)
 {
@@ -9171,7 +10559,8 @@ event_handler_read_netlink(NMPlatform *platform, gboolean wait_for_acks)
                                                 | DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES
                                                 | DELAYED_ACTION_TYPE_REFRESH_ALL_ROUTING_RULES_ALL
                                                 | DELAYED_ACTION_TYPE_REFRESH_ALL_QDISCS
-                                                | DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS,
+                                                | DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS
+                                                | _neigh_refresh_all_flags(platform),
                                             NULL);
                     break;
                 default:
@@ -9593,6 +10982,11 @@ finalize(GObject *object)
         g_hash_table_destroy(priv->sysctl_get_prev_values);
     }
 
+    nm_clear_pointer(&priv->link_prefetch_idx, g_hash_table_destroy);
+    nm_clear_pointer(&priv->ethtool_cache, g_hash_table_destroy);
+    nm_clear_pointer(&priv->neigh_subscriptions[0], g_hash_table_unref);
+    nm_clear_pointer(&priv->neigh_subscriptions[1], g_hash_table_unref);
+
     priv->udev_client = nm_udev_client_destroy(priv->udev_client);
 
     G_OBJECT_CLASS(nm_linux_platform_parent_class)->finalize(object);
@@ -9632,13 +11026,20 @@ nm_linux_platform_class_init(NMLinuxPlatformClass *klass)
     platform_class->link_set_mtu                = link_set_mtu;
     platform_class->link_set_name               = link_set_name;
     platform_class->link_set_sriov_params_async = link_set_sriov_params_async;
-    platform_class->link_set_sriov_vfs          = link_set_sriov_vfs;
+    platform_class->link_set_sriov_vfs_async    = link_set_sriov_vfs_async;
     platform_class->link_set_bridge_vlans       = link_set_bridge_vlans;
+    platform_class->link_get_bridge_vlans       = link_get_bridge_vlans;
 
     platform_class->link_get_physical_port_id = link_get_physical_port_id;
     platform_class->link_get_dev_id           = link_get_dev_id;
     platform_class->link_get_wake_on_lan      = link_get_wake_on_lan;
     platform_class->link_get_driver_info      = link_get_driver_info;
+    platform_class->link_prefetch             = link_prefetch;
+
+    platform_class->ethtool_get_link_settings = ethtool_get_link_settings;
+    platform_class->ethtool_get_link_coalesce = ethtool_get_link_coalesce;
+    platform_class->ethtool_get_link_ring     = ethtool_get_link_ring;
+    platform_class->ethtool_invalidate        = ethtool_invalidate;
 
     platform_class->link_supports_carrier_detect = link_supports_carrier_detect;
     platform_class->link_supports_vlans          = link_supports_vlans;
@@ -9651,6 +11052,7 @@ nm_linux_platform_class_init(NMLinuxPlatformClass *klass)
 
     platform_class->link_vlan_change      = link_vlan_change;
     platform_class->link_wireguard_change = link_wireguard_change;
+    platform_class->link_team_set_options = link_team_set_options;
 
     platform_class->infiniband_partition_add    = infiniband_partition_add;
     platform_class->infiniband_partition_delete = infiniband_partition_delete;
@@ -9692,5 +11094,7 @@ nm_linux_platform_class_init(NMLinuxPlatformClass *klass)
     platform_class->qdisc_add   = qdisc_add;
     platform_class->tfilter_add = tfilter_add;
 
+    platform_class->neighbor_subscribe = neighbor_subscribe;
+
     platform_class->process_events = process_events;
 }
@@ -18,6 +18,7 @@
 #include <linux/if.h>
 #include <linux/if_tun.h>
 #include <linux/if_tunnel.h>
+#include <linux/neighbour.h>
 #include <linux/rtnetlink.h>
 #include <linux/tc_act/tc_mirred.h>
 #include <libudev.h>
@@ -1874,13 +1875,33 @@ nm_platform_link_set_sriov_params_async(NMPlatform *            self,
                                        cancellable);
 }
 
-gboolean
-nm_platform_link_set_sriov_vfs(NMPlatform *self, int ifindex, const NMPlatformVF *const *vfs)
+/**
+ * nm_platform_link_set_sriov_vfs_async:
+ * @self: platform instance
+ * @ifindex: the index of the interface to change
+ * @vfs: the NULL terminated list of VFs to configure
+ * @callback: called when the operation finishes
+ * @callback_data: data passed to @callback
+ * @cancellable: cancellable to abort the operation
+ *
+ * Configures the VFs asynchronously without blocking the main
+ * thread. All VFs are configured, even if some of them fail. In
+ * that case, the error passed to @callback names the failed VFs.
+ * The callback function is always invoked, and asynchronously.
+ */
+void
+nm_platform_link_set_sriov_vfs_async(NMPlatform *              self,
+                                     int                       ifindex,
+                                     const NMPlatformVF *const *vfs,
+                                     NMPlatformAsyncCallback   callback,
+                                     gpointer                  callback_data,
+                                     GCancellable *            cancellable)
 {
     guint i;
-    _CHECK_SELF(self, klass, FALSE);
+    _CHECK_SELF_VOID(self, klass);
 
-    g_return_val_if_fail(ifindex > 0, FALSE);
+    g_return_if_fail(ifindex > 0);
+    g_return_if_fail(vfs);
 
     _LOG3D("link: setting VFs");
     for (i = 0; vfs[i]; i++) {
@@ -1889,7 +1910,7 @@ nm_platform_link_set_sriov_vfs(NMPlatform *self, int ifindex, const NMPlatformVF
         _LOG3D("link:   VF %s", nm_platform_vf_to_string(vf, NULL, 0));
     }
 
-    return klass->link_set_sriov_vfs(self, ifindex, vfs);
+    klass->link_set_sriov_vfs_async(self, ifindex, vfs, callback, callback_data, cancellable);
 }
 
 gboolean
@@ -1917,6 +1938,34 @@ nm_platform_link_set_bridge_vlans(NMPlatform *                       self,
     return klass->link_set_bridge_vlans(self, ifindex, on_master, vlans);
 }
 
+/**
+ * nm_platform_link_get_bridge_vlans:
+ * @self: platform instance
+ * @ifindex: the index of the bridge or bridge port
+ * @out_vlans: (out) (transfer full): the VLANs currently configured
+ *   in kernel, as ranges of VLANs with the same flags.
+ * @out_len: (out): the number of elements in @out_vlans
+ *
+ * Returns: %TRUE if the VLANs could be fetched from kernel.
+ */
+gboolean
+nm_platform_link_get_bridge_vlans(NMPlatform *           self,
+                                  int                    ifindex,
+                                  NMPlatformBridgeVlan **out_vlans,
+                                  guint *                out_len)
+{
+    _CHECK_SELF_NETNS(self, klass, netns, FALSE);
+
+    g_return_val_if_fail(ifindex > 0, FALSE);
+    g_return_val_if_fail(out_vlans && !*out_vlans, FALSE);
+    g_return_val_if_fail(out_len, FALSE);
+
+    if (!klass->link_get_bridge_vlans)
+        return FALSE;
+
+    return klass->link_get_bridge_vlans(self, ifindex, out_vlans, out_len);
+}
+
 /**
  * nm_platform_link_set_up:
  * @self: platform instance
@@ -2149,6 +2198,32 @@ nm_platform_link_get_driver_info(NMPlatform *self,
                                        out_fw_version);
 }
 
+/**
+ * nm_platform_link_prefetch:
+ * @self: platform instance
+ * @ifindexes: the interfaces to prefetch
+ * @n_ifindexes: the number of @ifindexes
+ *
+ * Reads the ethtool driver information and the permanent hardware address
+ * of many links at once, so that the following calls to
+ * nm_platform_link_get_driver_info() and nm_platform_link_get_permanent_address()
+ * for them don't need to do a round trip to the kernel each. This is
+ * useful when realizing all devices during startup.
+ *
+ * The prefetched data is only valid for a short time. Call again with
+ * zero @n_ifindexes to drop it.
+ */
+void
+nm_platform_link_prefetch(NMPlatform *self, const int *ifindexes, guint n_ifindexes)
+{
+    _CHECK_SELF_VOID(self, klass);
+
+    g_return_if_fail(ifindexes || n_ifindexes == 0);
+
+    if (klass->link_prefetch)
+        klass->link_prefetch(self, ifindexes, n_ifindexes);
+}
+
 /**
  * nm_platform_link_enslave:
  * @self: platform instance
@@ -2465,6 +2540,67 @@ nm_platform_link_wireguard_change(NMPlatform *                              self
                                         change_flags);
 }
 
+/**
+ * nm_platform_link_team_set_options:
+ * @self: platform instance
+ * @ifindex: the ifindex of the team device
+ * @options: the options to set
+ * @n_options: the number of @options
+ *
+ * Configures the team driver directly, without going through teamd.
+ * All @options are sent with one request and either all of them or
+ * none are applied.
+ *
+ * Returns: 0 on success or a negative error code.
+ */
+int
+nm_platform_link_team_set_options(NMPlatform *                self,
+                                  int                         ifindex,
+                                  const NMPlatformTeamOption *options,
+                                  guint                       n_options)
+{
+    _CHECK_SELF(self, klass, -NME_BUG);
+
+    g_return_val_if_fail(ifindex > 0, -NME_BUG);
+    g_return_val_if_fail(options || n_options == 0, -NME_BUG);
+
+    if (!klass->link_team_set_options)
+        return -NME_PL_OPNOTSUPP;
+
+    if (_LOGD_ENABLED()) {
+        char  buf[512];
+        char *b   = buf;
+        gsize len = sizeof(buf);
+        guint i;
+
+        buf[0] = '\0';
+        for (i = 0; i < n_options; i++) {
+            const NMPlatformTeamOption *opt = &options[i];
+
+            nm_utils_strbuf_append(&b, &len, " %s", opt->name);
+            if (opt->port_ifindex > 0)
+                nm_utils_strbuf_append(&b, &len, "[%d]", opt->port_ifindex);
+            switch (opt->type) {
+            case NM_PLATFORM_TEAM_OPTION_TYPE_U32:
+                nm_utils_strbuf_append(&b, &len, "=%u", opt->v_u32);
+                break;
+            case NM_PLATFORM_TEAM_OPTION_TYPE_S32:
+                nm_utils_strbuf_append(&b, &len, "=%d", opt->v_s32);
+                break;
+            case NM_PLATFORM_TEAM_OPTION_TYPE_STRING:
+                nm_utils_strbuf_append(&b, &len, "=%s", opt->v_string);
+                break;
+            case NM_PLATFORM_TEAM_OPTION_TYPE_BOOL:
+                nm_utils_strbuf_append_str(&b, &len, opt->v_bool ? "=true" : "=false");
+                break;
+            }
+        }
+        _LOG3D("link: team set options:%s", buf);
+    }
+
+    return klass->link_team_set_options(self, ifindex, options, n_options);
+}
+
 /*****************************************************************************/
 
 /**
@@ -3281,6 +3417,15 @@ _to_string_ifa_flags(guint32 ifa_flags, char *buf, gsize size)
 
 /*****************************************************************************/
 
+static void
+_ethtool_invalidate(NMPlatform *self, NMPlatformClass *klass, int ifindex)
+{
+    /* the platform might cache what it read before. Whether we succeeded or not,
+     * the settings might have changed. */
+    if (klass->ethtool_invalidate)
+        klass->ethtool_invalidate(self, ifindex);
+}
+
 gboolean
 nm_platform_ethtool_set_wake_on_lan(NMPlatform *             self,
                                     int                      ifindex,
@@ -3301,11 +3446,14 @@ nm_platform_ethtool_set_link_settings(NMPlatform *             self,
                                       guint32                  speed,
                                       NMPlatformLinkDuplexType duplex)
 {
+    gboolean success;
     _CHECK_SELF_NETNS(self, klass, netns, FALSE);
 
     g_return_val_if_fail(ifindex > 0, FALSE);
 
-    return nmp_utils_ethtool_set_link_settings(ifindex, autoneg, speed, duplex);
+    success = nmp_utils_ethtool_set_link_settings(ifindex, autoneg, speed, duplex);
+    _ethtool_invalidate(self, klass, ifindex);
+    return success;
 }
 
 gboolean
@@ -3319,6 +3467,8 @@ nm_platform_ethtool_get_link_settings(NMPlatform *              self,
 
     g_return_val_if_fail(ifindex > 0, FALSE);
 
+    if (klass->ethtool_get_link_settings)
+        return klass->ethtool_get_link_settings(self, ifindex, out_autoneg, out_speed, out_duplex);
     return nmp_utils_ethtool_get_link_settings(ifindex, out_autoneg, out_speed, out_duplex);
 }
 
@@ -3359,6 +3509,8 @@ nm_platform_ethtool_get_link_coalesce(NMPlatform *            self,
     g_return_val_if_fail(ifindex > 0, FALSE);
     g_return_val_if_fail(coalesce, FALSE);
 
+    if (klass->ethtool_get_link_coalesce)
+        return klass->ethtool_get_link_coalesce(self, ifindex, coalesce);
     return nmp_utils_ethtool_get_coalesce(ifindex, coalesce);
 }
 
@@ -3367,11 +3519,14 @@ nm_platform_ethtool_set_coalesce(NMPlatform *                  self,
                                  int                           ifindex,
                                  const NMEthtoolCoalesceState *coalesce)
 {
+    gboolean success;
     _CHECK_SELF_NETNS(self, klass, netns, FALSE);
 
     g_return_val_if_fail(ifindex > 0, FALSE);
 
-    return nmp_utils_ethtool_set_coalesce(ifindex, coalesce);
+    success = nmp_utils_ethtool_set_coalesce(ifindex, coalesce);
+    _ethtool_invalidate(self, klass, ifindex);
+    return success;
 }
 
 gboolean
@@ -3382,17 +3537,22 @@ nm_platform_ethtool_get_link_ring(NMPlatform *self, int ifindex, NMEthtoolRingSt
     g_return_val_if_fail(ifindex > 0, FALSE);
     g_return_val_if_fail(ring, FALSE);
 
+    if (klass->ethtool_get_link_ring)
+        return klass->ethtool_get_link_ring(self, ifindex, ring);
     return nmp_utils_ethtool_get_ring(ifindex, ring);
 }
 
 gboolean
 nm_platform_ethtool_set_ring(NMPlatform *self, int ifindex, const NMEthtoolRingState *ring)
 {
+    gboolean success;
     _CHECK_SELF_NETNS(self, klass, netns, FALSE);
 
     g_return_val_if_fail(ifindex > 0, FALSE);
 
-    return nmp_utils_ethtool_set_ring(ifindex, ring);
+    success = nmp_utils_ethtool_set_ring(ifindex, ring);
+    _ethtool_invalidate(self, klass, ifindex);
+    return success;
 }
 
 /*****************************************************************************/
@@ -5372,6 +5532,73 @@ nm_platform_tfilter_sync(NMPlatform *self, int ifindex, GPtrArray *known_tfilter
 
 /*****************************************************************************/
 
+/**
+ * nm_platform_neighbor_subscribe:
+ * @self: the #NMPlatform instance
+ * @obj_type: either %NMP_OBJECT_TYPE_NEIGHBOR or %NMP_OBJECT_TYPE_FDB
+ * @ifindex: the interface of interest
+ *
+ * Neighbors and bridge FDB entries are only cached for interfaces that
+ * somebody subscribed to. Once subscribed, the entries of @ifindex are
+ * kept in the cache and the corresponding signal is emitted whenever
+ * they change. For %NMP_OBJECT_TYPE_FDB, @ifindex may also be a bridge,
+ * in which case the entries of all its ports are cached.
+ *
+ * Subscriptions are reference counted. Each call must be balanced by
+ * nm_platform_neighbor_unsubscribe().
+ */
+void
+nm_platform_neighbor_subscribe(NMPlatform *self, NMPObjectType obj_type, int ifindex)
+{
+    _CHECK_SELF_VOID(self, klass);
+
+    g_return_if_fail(NM_IN_SET(obj_type, NMP_OBJECT_TYPE_NEIGHBOR, NMP_OBJECT_TYPE_FDB));
+    g_return_if_fail(ifindex > 0);
+
+    if (!klass->neighbor_subscribe)
+        return;
+
+    _LOG3D("%s: subscribe", nmp_class_from_type(obj_type)->obj_type_name);
+    klass->neighbor_subscribe(self, obj_type, ifindex, TRUE);
+}
+
+void
+nm_platform_neighbor_unsubscribe(NMPlatform *self, NMPObjectType obj_type, int ifindex)
+{
+    _CHECK_SELF_VOID(self, klass);
+
+    g_return_if_fail(NM_IN_SET(obj_type, NMP_OBJECT_TYPE_NEIGHBOR, NMP_OBJECT_TYPE_FDB));
+    g_return_if_fail(ifindex > 0);
+
+    if (!klass->neighbor_subscribe)
+        return;
+
+    _LOG3D("%s: unsubscribe", nmp_class_from_type(obj_type)->obj_type_name);
+    klass->neighbor_subscribe(self, obj_type, ifindex, FALSE);
+}
+
+const NMPlatformNeighbor *
+nm_platform_neighbor_get(NMPlatform *  self,
+                         int           ifindex,
+                         int           addr_family,
+                         gconstpointer address /* in_addr_t or struct in6_addr */)
+{
+    NMPObject        obj_id;
+    const NMPObject *obj;
+
+    _CHECK_SELF(self, klass, NULL);
+
+    nm_assert(NM_IN_SET(addr_family, AF_INET, AF_INET6));
+    nm_assert(address);
+
+    nmp_object_stackinit_id_neighbor(&obj_id, ifindex, addr_family, address);
+    obj = nmp_cache_lookup_obj(nm_platform_get_cache(self), &obj_id);
+    nm_assert(!obj || nmp_object_is_visible(obj));
+    return NMP_OBJECT_CAST_NEIGHBOR(obj);
+}
+
+/*****************************************************************************/
+
 const char *
 nm_platform_vlan_qos_mapping_to_string(const char *            name,
                                        const NMVlanQosMapping *map,
@@ -7170,6 +7397,79 @@ nm_platform_tfilter_cmp(const NMPlatformTfilter *a, const NMPlatformTfilter *b)
     return 0;
 }
 
+static NM_UTILS_FLAGS2STR_DEFINE(_neigh_state_to_string,
+                                 guint16,
+                                 NM_UTILS_FLAGS2STR(NUD_NONE, "none"),
+                                 NM_UTILS_FLAGS2STR(NUD_INCOMPLETE, "incomplete"),
+                                 NM_UTILS_FLAGS2STR(NUD_REACHABLE, "reachable"),
+                                 NM_UTILS_FLAGS2STR(NUD_STALE, "stale"),
+                                 NM_UTILS_FLAGS2STR(NUD_DELAY, "delay"),
+                                 NM_UTILS_FLAGS2STR(NUD_PROBE, "probe"),
+                                 NM_UTILS_FLAGS2STR(NUD_FAILED, "failed"),
+                                 NM_UTILS_FLAGS2STR(NUD_NOARP, "noarp"),
+                                 NM_UTILS_FLAGS2STR(NUD_PERMANENT, "permanent"), );
+
+const char *
+nm_platform_neighbor_to_string(const NMPlatformNeighbor *neighbor, char *buf, gsize len)
+{
+    char str_dev[TO_STRING_DEV_BUF_SIZE];
+    char str_addr[NM_UTILS_INET_ADDRSTRLEN];
+    char str_lladdr[NM_UTILS_HWADDR_LEN_MAX * 3];
+    char str_master[30];
+    char str_vlan[30];
+    char str_state[100];
+
+    if (!nm_utils_to_string_buffer_init_null(neighbor, &buf, &len))
+        return buf;
+
+    g_snprintf(
+        buf,
+        len,
+        "%s%s%s%s%s%s state %s flags 0x%x",
+        neighbor->addr_family != AF_UNSPEC
+            ? nm_utils_inet_ntop(neighbor->addr_family, &neighbor->address, str_addr)
+            : "*",
+        neighbor->lladdr.len > 0 ? " lladdr " : "",
+        _nmp_link_address_to_string(&neighbor->lladdr, str_lladdr),
+        _to_string_dev(NULL, neighbor->ifindex, str_dev, sizeof(str_dev)),
+        neighbor->master > 0 ? nm_sprintf_buf(str_master, " master %d", neighbor->master) : "",
+        neighbor->vlan_id > 0 ? nm_sprintf_buf(str_vlan, " vlan %u", neighbor->vlan_id) : "",
+        _neigh_state_to_string(neighbor->state, str_state, sizeof(str_state)),
+        neighbor->flags);
+
+    return buf;
+}
+
+void
+nm_platform_neighbor_hash_update(const NMPlatformNeighbor *obj, NMHashState *h)
+{
+    nm_hash_update_vals(h,
+                        obj->ifindex,
+                        obj->address,
+                        obj->master,
+                        obj->state,
+                        obj->vlan_id,
+                        obj->addr_family,
+                        obj->flags);
+    nm_hash_update_mem(h, obj->lladdr.data, NM_MIN(obj->lladdr.len, sizeof(obj->lladdr.data)));
+}
+
+int
+nm_platform_neighbor_cmp(const NMPlatformNeighbor *a, const NMPlatformNeighbor *b)
+{
+    NM_CMP_SELF(a, b);
+    NM_CMP_FIELD(a, b, ifindex);
+    NM_CMP_FIELD(a, b, addr_family);
+    NM_CMP_FIELD_MEMCMP(a, b, address);
+    NM_CMP_FIELD(a, b, lladdr.len);
+    NM_CMP_FIELD_MEMCMP_LEN(a, b, lladdr.data, NM_MIN(a->lladdr.len, sizeof(a->lladdr.data)));
+    NM_CMP_FIELD(a, b, master);
+    NM_CMP_FIELD(a, b, state);
+    NM_CMP_FIELD(a, b, vlan_id);
+    NM_CMP_FIELD(a, b, flags);
+    return 0;
+}
+
 const char *
 nm_platform_vf_to_string(const NMPlatformVF *vf, char *buf, gsize len)
 {
@@ -7249,6 +7549,111 @@ nm_platform_bridge_vlan_to_string(const NMPlatformBridgeVlan *vlan, char *buf, g
     return buf;
 }
 
+#define _BRIDGE_VLAN_MAP_PRESENT  ((guint8) 0x01)
+#define _BRIDGE_VLAN_MAP_UNTAGGED ((guint8) 0x02)
+#define _BRIDGE_VLAN_MAP_PVID     ((guint8) 0x04)
+
+static void
+_bridge_vlan_map_set(guint8 *map, const NMPlatformBridgeVlan *vlan)
+{
+    guint8 flags = _BRIDGE_VLAN_MAP_PRESENT;
+    guint  vid;
+
+    if (vlan->untagged)
+        flags |= _BRIDGE_VLAN_MAP_UNTAGGED;
+    if (vlan->pvid) {
+        /* There is only one PVID per port. Like kernel, the last one wins. */
+        for (vid = NM_BRIDGE_VLAN_VID_MIN; vid <= NM_BRIDGE_VLAN_VID_MAX; vid++)
+            map[vid] &= ~_BRIDGE_VLAN_MAP_PVID;
+        flags |= _BRIDGE_VLAN_MAP_PVID;
+    }
+
+    for (vid = NM_MAX(vlan->vid_start, NM_BRIDGE_VLAN_VID_MIN);
+         vid <= NM_MIN(vlan->vid_end, NM_BRIDGE_VLAN_VID_MAX);
+         vid++)
+        map[vid] = flags;
+}
+
+static guint
+_bridge_vlan_map_to_ranges(const guint8 *want, const guint8 *have, NMPlatformBridgeVlan *ranges)
+{
+    guint n            = 0;
+    guint last_vid_end = 0;
+    guint vid;
+
+    for (vid = NM_BRIDGE_VLAN_VID_MIN; vid <= NM_BRIDGE_VLAN_VID_MAX; vid++) {
+        if (!want[vid] || want[vid] == have[vid])
+            continue;
+
+        if (n > 0 && vid == last_vid_end + 1 && want[last_vid_end] == want[vid]
+            && !(want[vid] & _BRIDGE_VLAN_MAP_PVID)) {
+            if (ranges)
+                ranges[n - 1].vid_end = vid;
+            last_vid_end = vid;
+            continue;
+        }
+
+        if (ranges) {
+            ranges[n] = (NMPlatformBridgeVlan){
+                .vid_start = vid,
+                .vid_end   = vid,
+                .untagged  = NM_FLAGS_HAS(want[vid], _BRIDGE_VLAN_MAP_UNTAGGED),
+                .pvid      = NM_FLAGS_HAS(want[vid], _BRIDGE_VLAN_MAP_PVID),
+            };
+        }
+        last_vid_end = vid;
+        n++;
+    }
+
+    return n;
+}
+
+/**
+ * nm_platform_bridge_vlans_compress:
+ * @vlans: (allow-none): the NULL terminated list of VLANs to configure.
+ *   Later entries override the flags of earlier, overlapping ones.
+ * @current: (allow-none): the VLANs currently configured in kernel
+ * @n_current: the number of elements in @current
+ * @out_len: (out): the number of returned elements
+ *
+ * Computes the minimal list of VLAN ranges that need to be sent to kernel
+ * to add @vlans on top of @current. VLANs that kernel already has with the
+ * same flags are skipped, and adjacent VLANs with the same flags are merged
+ * into one range. A PVID is always returned as a single VLAN.
+ *
+ * Returns: (transfer full): the ranges or %NULL if there is nothing
+ *   to configure.
+ */
+NMPlatformBridgeVlan *
+nm_platform_bridge_vlans_compress(const NMPlatformBridgeVlan *const *vlans,
+                                  const NMPlatformBridgeVlan *       current,
+                                  guint                              n_current,
+                                  guint *                            out_len)
+{
+    guint8                want[NM_BRIDGE_VLAN_VID_MAX + 1] = {0};
+    guint8                have[NM_BRIDGE_VLAN_VID_MAX + 1] = {0};
+    NMPlatformBridgeVlan *ranges;
+    guint                 n;
+    guint                 i;
+
+    nm_assert(out_len);
+    nm_assert(current || n_current == 0);
+
+    for (i = 0; i < n_current; i++)
+        _bridge_vlan_map_set(have, &current[i]);
+    for (i = 0; vlans && vlans[i]; i++)
+        _bridge_vlan_map_set(want, vlans[i]);
+
+    n        = _bridge_vlan_map_to_ranges(want, have, NULL);
+    *out_len = n;
+    if (n == 0)
+        return NULL;
+
+    ranges = g_new(NMPlatformBridgeVlan, n);
+    _bridge_vlan_map_to_ranges(want, have, ranges);
+    return ranges;
+}
+
 void
 nm_platform_link_hash_update(const NMPlatformLink *obj, NMHashState *h)
 {
@@ -8671,6 +9076,20 @@ log_tfilter(NMPlatform *               self,
            nm_platform_tfilter_to_string(tfilter, NULL, 0));
 }
 
+static void
+log_neighbor(NMPlatform *               self,
+             NMPObjectType              obj_type,
+             int                        ifindex,
+             NMPlatformNeighbor *       neighbor,
+             NMPlatformSignalChangeType change_type,
+             gpointer                   user_data)
+{
+    _LOG3D("signal: %s %7s: %s",
+           obj_type == NMP_OBJECT_TYPE_FDB ? "fdb" : "neighbor",
+           nm_platform_signal_change_type_to_string(change_type),
+           nm_platform_neighbor_to_string(neighbor, NULL, 0));
+}
+
 /*****************************************************************************/
 
 void
@@ -8963,4 +9382,6 @@ nm_platform_class_init(NMPlatformClass *platform_class)
            log_routing_rule);
     SIGNAL(NM_PLATFORM_SIGNAL_ID_QDISC, NM_PLATFORM_SIGNAL_QDISC_CHANGED, log_qdisc);
     SIGNAL(NM_PLATFORM_SIGNAL_ID_TFILTER, NM_PLATFORM_SIGNAL_TFILTER_CHANGED, log_tfilter);
+    SIGNAL(NM_PLATFORM_SIGNAL_ID_NEIGHBOR, NM_PLATFORM_SIGNAL_NEIGHBOR_CHANGED, log_neighbor);
+    SIGNAL(NM_PLATFORM_SIGNAL_ID_FDB, NM_PLATFORM_SIGNAL_FDB_CHANGED, log_neighbor);
 }
@@ -273,6 +273,8 @@ typedef enum { /*< skip >*/
                NM_PLATFORM_SIGNAL_ID_ROUTING_RULE,
                NM_PLATFORM_SIGNAL_ID_QDISC,
                NM_PLATFORM_SIGNAL_ID_TFILTER,
+               NM_PLATFORM_SIGNAL_ID_NEIGHBOR,
+               NM_PLATFORM_SIGNAL_ID_FDB,
                _NM_PLATFORM_SIGNAL_ID_LAST,
 } NMPlatformSignalIdType;
 
@@ -763,6 +765,34 @@ typedef struct {
     NMPlatformAction action;
 } NMPlatformTfilter;
 
+/* Both neighbors (NMP_OBJECT_TYPE_NEIGHBOR, with family AF_INET/AF_INET6) and
+ * bridge forwarding database entries (NMP_OBJECT_TYPE_FDB, RTM_NEWNEIGH with
+ * family AF_BRIDGE) are represented by this struct. */
+typedef struct {
+    __NMPlatformObjWithIfindex_COMMON;
+
+    /* NDA_DST. For FDB entries this is only set for tunnel devices
+     * (the remote VTEP), in which case @addr_family tells its family. */
+    NMIPAddr address;
+
+    /* NDA_LLADDR */
+    NMPLinkAddress lladdr;
+
+    /* NDA_MASTER, the ifindex of the bridge for FDB entries. */
+    int master;
+
+    /* NUD_* flags. */
+    guint16 state;
+
+    /* NDA_VLAN, only for FDB entries. */
+    guint16 vlan_id;
+
+    guint8 addr_family;
+
+    /* NTF_* flags. */
+    guint8 flags;
+} NMPlatformNeighbor;
+
 #undef __NMPlatformObjWithIfindex_COMMON
 
 typedef struct {
@@ -1003,6 +1033,29 @@ typedef enum {
 
 } NMPlatformWireGuardChangePeerFlags;
 
+typedef enum {
+    NM_PLATFORM_TEAM_OPTION_TYPE_U32,
+    NM_PLATFORM_TEAM_OPTION_TYPE_S32,
+    NM_PLATFORM_TEAM_OPTION_TYPE_STRING,
+    NM_PLATFORM_TEAM_OPTION_TYPE_BOOL,
+} NMPlatformTeamOptionType;
+
+typedef struct {
+    const char *name;
+
+    /* the ifindex of the port for per-port options, or zero for options
+     * of the team device itself. */
+    int port_ifindex;
+
+    NMPlatformTeamOptionType type;
+    union {
+        guint32     v_u32;
+        gint32      v_s32;
+        const char *v_string;
+        bool        v_bool;
+    };
+} NMPlatformTeamOption;
+
 typedef void (*NMPlatformAsyncCallback)(GError *error, gpointer user_data);
 
 /*****************************************************************************/
@@ -1122,11 +1175,20 @@ typedef struct {
                                         NMPlatformAsyncCallback callback,
                                         gpointer                callback_data,
                                         GCancellable *          cancellable);
-    gboolean (*link_set_sriov_vfs)(NMPlatform *self, int ifindex, const NMPlatformVF *const *vfs);
+    void (*link_set_sriov_vfs_async)(NMPlatform *              self,
+                                     int                       ifindex,
+                                     const NMPlatformVF *const *vfs,
+                                     NMPlatformAsyncCallback   callback,
+                                     gpointer                  callback_data,
+                                     GCancellable *            cancellable);
     gboolean (*link_set_bridge_vlans)(NMPlatform *                       self,
                                       int                                ifindex,
                                       gboolean                           on_master,
                                       const NMPlatformBridgeVlan *const *vlans);
+    gboolean (*link_get_bridge_vlans)(NMPlatform *           self,
+                                      int                    ifindex,
+                                      NMPlatformBridgeVlan **out_vlans,
+                                      guint *                out_len);
 
     char *(*link_get_physical_port_id)(NMPlatform *self, int ifindex);
     guint (*link_get_dev_id)(NMPlatform *self, int ifindex);
@@ -1136,6 +1198,18 @@ typedef struct {
                                      char **     out_driver_name,
                                      char **     out_driver_version,
                                      char **     out_fw_version);
+    void (*link_prefetch)(NMPlatform *self, const int *ifindexes, guint n_ifindexes);
+
+    gboolean (*ethtool_get_link_settings)(NMPlatform *              self,
+                                          int                       ifindex,
+                                          gboolean *                out_autoneg,
+                                          guint32 *                 out_speed,
+                                          NMPlatformLinkDuplexType *out_duplex);
+    gboolean (*ethtool_get_link_coalesce)(NMPlatform *            self,
+                                          int                     ifindex,
+                                          NMEthtoolCoalesceState *coalesce);
+    gboolean (*ethtool_get_link_ring)(NMPlatform *self, int ifindex, NMEthtoolRingState *ring);
+    void (*ethtool_invalidate)(NMPlatform *self, int ifindex);
 
     gboolean (*link_supports_carrier_detect)(NMPlatform *self, int ifindex);
     gboolean (*link_supports_vlans)(NMPlatform *self, int ifindex);
@@ -1154,6 +1228,11 @@ typedef struct {
                                  guint                                     peers_len,
                                  NMPlatformWireGuardChangeFlags            change_flags);
 
+    int (*link_team_set_options)(NMPlatform *                self,
+                                 int                         ifindex,
+                                 const NMPlatformTeamOption *options,
+                                 guint                       n_options);
+
     gboolean (*link_vlan_change)(NMPlatform *            self,
                                  int                     ifindex,
                                  NMVlanFlags             flags_mask,
@@ -1255,6 +1334,11 @@ typedef struct {
     int (*qdisc_add)(NMPlatform *self, NMPNlmFlags flags, const NMPlatformQdisc *qdisc);
 
     int (*tfilter_add)(NMPlatform *self, NMPNlmFlags flags, const NMPlatformTfilter *tfilter);
+
+    void (*neighbor_subscribe)(NMPlatform *  self,
+                               NMPObjectType obj_type,
+                               int           ifindex,
+                               gboolean      subscribe);
 } NMPlatformClass;
 
 /* NMPlatform signals
@@ -1276,6 +1360,8 @@ typedef struct {
 #define NM_PLATFORM_SIGNAL_ROUTING_RULE_CHANGED "routing-rule-changed"
 #define NM_PLATFORM_SIGNAL_QDISC_CHANGED        "qdisc-changed"
 #define NM_PLATFORM_SIGNAL_TFILTER_CHANGED      "tfilter-changed"
+#define NM_PLATFORM_SIGNAL_NEIGHBOR_CHANGED     "neighbor-changed"
+#define NM_PLATFORM_SIGNAL_FDB_CHANGED          "fdb-changed"
 
 const char *nm_platform_signal_change_type_to_string(NMPlatformSignalChangeType change_type);
 
@@ -1857,13 +1943,20 @@ void nm_platform_link_set_sriov_params_async(NMPlatform *            self,
                                              NMPlatformAsyncCallback callback,
                                              gpointer                callback_data,
                                              GCancellable *          cancellable);
-
-gboolean
-nm_platform_link_set_sriov_vfs(NMPlatform *self, int ifindex, const NMPlatformVF *const *vfs);
+void nm_platform_link_set_sriov_vfs_async(NMPlatform *              self,
+                                          int                       ifindex,
+                                          const NMPlatformVF *const *vfs,
+                                          NMPlatformAsyncCallback   callback,
+                                          gpointer                  callback_data,
+                                          GCancellable *            cancellable);
 gboolean nm_platform_link_set_bridge_vlans(NMPlatform *                       self,
                                            int                                ifindex,
                                            gboolean                           on_master,
                                            const NMPlatformBridgeVlan *const *vlans);
+gboolean nm_platform_link_get_bridge_vlans(NMPlatform *           self,
+                                           int                    ifindex,
+                                           NMPlatformBridgeVlan **out_vlans,
+                                           guint *                out_len);
 
 char *   nm_platform_link_get_physical_port_id(NMPlatform *self, int ifindex);
 guint    nm_platform_link_get_dev_id(NMPlatform *self, int ifindex);
@@ -1873,6 +1966,7 @@ gboolean nm_platform_link_get_driver_info(NMPlatform *self,
                                           char **     out_driver_name,
                                           char **     out_driver_version,
                                           char **     out_fw_version);
+void     nm_platform_link_prefetch(NMPlatform *self, const int *ifindexes, guint n_ifindexes);
 
 gboolean nm_platform_link_supports_carrier_detect(NMPlatform *self, int ifindex);
 gboolean nm_platform_link_supports_vlans(NMPlatform *self, int ifindex);
@@ -2020,6 +2114,11 @@ int nm_platform_link_wireguard_change(NMPlatform *
                                       guint                                     peers_len,
                                       NMPlatformWireGuardChangeFlags            change_flags);
 
+int nm_platform_link_team_set_options(NMPlatform *                self,
+                                      int                         ifindex,
+                                      const NMPlatformTeamOption *options,
+                                      guint                       n_options);
+
 const NMPlatformIP6Address *
 nm_platform_ip6_address_get(NMPlatform *self, int ifindex, const struct in6_addr *address);
 
@@ -2182,6 +2281,14 @@ gboolean nm_platform_qdisc_sync(NMPlatform *self, int ifindex, GPtrArray *known_
 int nm_platform_tfilter_add(NMPlatform *self, NMPNlmFlags flags, const NMPlatformTfilter *tfilter);
 gboolean nm_platform_tfilter_sync(NMPlatform *self, int ifindex, GPtrArray *known_tfilters);
 
+void nm_platform_neighbor_subscribe(NMPlatform *self, NMPObjectType obj_type, int ifindex);
+void nm_platform_neighbor_unsubscribe(NMPlatform *self, NMPObjectType obj_type, int ifindex);
+
+const NMPlatformNeighbor *nm_platform_neighbor_get(NMPlatform *  self,
+                                                   int           ifindex,
+                                                   int           addr_family,
+                                                   gconstpointer address);
+
 const char *nm_platform_link_to_string(const NMPlatformLink *link, char *buf, gsize len);
 const char *nm_platform_lnk_bridge_to_string(const NMPlatformLnkBridge *lnk, char *buf, gsize len);
 const char *nm_platform_lnk_gre_to_string(const NMPlatformLnkGre *lnk, char *buf, gsize len);
@@ -2209,10 +2316,17 @@ const char *
 nm_platform_routing_rule_to_string(const NMPlatformRoutingRule *routing_rule, char *buf, gsize len);
 const char *nm_platform_qdisc_to_string(const NMPlatformQdisc *qdisc, char *buf, gsize len);
 const char *nm_platform_tfilter_to_string(const NMPlatformTfilter *tfilter, char *buf, gsize len);
+const char *
+nm_platform_neighbor_to_string(const NMPlatformNeighbor *neighbor, char *buf, gsize len);
 const char *nm_platform_vf_to_string(const NMPlatformVF *vf, char *buf, gsize len);
 const char *
 nm_platform_bridge_vlan_to_string(const NMPlatformBridgeVlan *vlan, char *buf, gsize len);
 
+NMPlatformBridgeVlan *nm_platform_bridge_vlans_compress(const NMPlatformBridgeVlan *const *vlans,
+                                                        const NMPlatformBridgeVlan *current,
+                                                        guint                       n_current,
+                                                        guint *                     out_len);
+
 const char *nm_platform_vlan_qos_mapping_to_string(const char *            name,
                                                    const NMVlanQosMapping *map,
                                                    gsize                   n_map,
@@ -2283,6 +2397,7 @@ int nm_platform_qdisc_cmp_full(const NMPlatformQdisc *a,
                                const NMPlatformQdisc *b,
                                gboolean               compare_handle);
 int nm_platform_tfilter_cmp(const NMPlatformTfilter *a, const NMPlatformTfilter *b);
+int nm_platform_neighbor_cmp(const NMPlatformNeighbor *a, const NMPlatformNeighbor *b);
 
 void nm_platform_link_hash_update(const NMPlatformLink *obj, NMHashState *h);
 void nm_platform_ip4_address_hash_update(const NMPlatformIP4Address *obj, NMHashState *h);
@@ -2312,6 +2427,7 @@ void nm_platform_lnk_wireguard_hash_update(const NMPlatformLnkWireGuard *obj, NM
 
 void nm_platform_qdisc_hash_update(const NMPlatformQdisc *obj, NMHashState *h);
 void nm_platform_tfilter_hash_update(const NMPlatformTfilter *obj, NMHashState *h);
+void nm_platform_neighbor_hash_update(const NMPlatformNeighbor *obj, NMHashState *h);
 
 #define NM_PLATFORM_LINK_FLAGS2STR_MAX_LEN ((gsize) 162)
 
@@ -10,6 +10,7 @@
 #include <unistd.h>
 #include <linux/rtnetlink.h>
 #include <linux/if.h>
+#include <linux/neighbour.h>
 #include <libudev.h>
 
 #include "nm-utils.h"
@@ -262,6 +263,10 @@ nm_sock_addr_union_to_string(const NMSockAddrUnion *sa, char *buf, gsize len)
 /*****************************************************************************/
 
 static const NMDedupMultiIdxTypeClass _dedup_multi_idx_type_class;
+static const NMDedupMultiIdxTypeClass _dedup_multi_idx_type_class_fast;
+
+#define _IS_IDX_TYPE_CLASS(klass) \
+    NM_IN_SET((klass), &_dedup_multi_idx_type_class, &_dedup_multi_idx_type_class_fast)
 
 static void
 _idx_obj_id_hash_update(const NMDedupMultiIdxType *idx_type,
@@ -270,7 +275,7 @@ _idx_obj_id_hash_update(const NMDedupMultiIdxType *idx_type,
 {
     const NMPObject *o = (NMPObject *) obj;
 
-    nm_assert(idx_type && idx_type->klass == &_dedup_multi_idx_type_class);
+    nm_assert(idx_type && _IS_IDX_TYPE_CLASS(idx_type->klass));
     nm_assert(NMP_OBJECT_GET_TYPE(o) != NMP_OBJECT_TYPE_UNKNOWN);
 
     nmp_object_id_hash_update(o, h);
@@ -284,7 +289,7 @@ _idx_obj_id_equal(const NMDedupMultiIdxType *idx_type,
     const NMPObject *o_a = (NMPObject *) obj_a;
     const NMPObject *o_b = (NMPObject *) obj_b;
 
-    nm_assert(idx_type && idx_type->klass == &_dedup_multi_idx_type_class);
+    nm_assert(idx_type && _IS_IDX_TYPE_CLASS(idx_type->klass));
     nm_assert(NMP_OBJECT_GET_TYPE(o_a) != NMP_OBJECT_TYPE_UNKNOWN);
     nm_assert(NMP_OBJECT_GET_TYPE(o_b) != NMP_OBJECT_TYPE_UNKNOWN);
 
@@ -303,7 +308,7 @@ _idx_obj_part(const DedupMultiIdxType *idx_type,
      * side-by-side and do it all in _idx_obj_part(). */
 
     nm_assert(idx_type);
-    nm_assert(idx_type->parent.klass == &_dedup_multi_idx_type_class);
+    nm_assert(_IS_IDX_TYPE_CLASS(idx_type->parent.klass));
     nm_assert(obj_a);
     nm_assert(NMP_OBJECT_GET_TYPE(obj_a) != NMP_OBJECT_TYPE_UNKNOWN);
     nm_assert(!obj_b || (NMP_OBJECT_GET_TYPE(obj_b) != NMP_OBJECT_TYPE_UNKNOWN));
@@ -366,7 +371,9 @@ _idx_obj_part(const DedupMultiIdxType *idx_type,
                        NMP_OBJECT_TYPE_IP4_ROUTE,
                        NMP_OBJECT_TYPE_IP6_ROUTE,
                        NMP_OBJECT_TYPE_QDISC,
-                       NMP_OBJECT_TYPE_TFILTER)
+                       NMP_OBJECT_TYPE_TFILTER,
+                       NMP_OBJECT_TYPE_NEIGHBOR,
+                       NMP_OBJECT_TYPE_FDB)
             || !nmp_object_is_visible(obj_a)) {
             if (h)
                 nm_hash_update_val(h, obj_a);
@@ -469,6 +476,47 @@ _idx_obj_partition_equal(const NMDedupMultiIdxType *idx_type,
                          NULL);
 }
 
+/* Hash the head entries of idx-types that are partitioned by ifindex, object
+ * type or address family. These keys cannot be chosen from outside, so the
+ * cheaper NMHashFastState is good enough. */
+static guint
+_idx_obj_partition_hash_fast(const NMDedupMultiIdxType *idx_type, const NMDedupMultiObj *obj)
+{
+    const DedupMultiIdxType *t = (const DedupMultiIdxType *) idx_type;
+    const NMPObject *        o = (const NMPObject *) obj;
+    NMHashFastState          h;
+
+    nm_hash_fast_init(&h, 1914869417u);
+    nm_hash_fast_update_val(&h, idx_type);
+
+    if (!_idx_obj_part(t, o, NULL, NULL)) {
+        /* like _idx_obj_part(), hash objects that are not partitionable by pointer. */
+        nm_hash_fast_update_val(&h, o);
+        return nm_hash_fast_complete(&h);
+    }
+
+    switch (t->cache_id_type) {
+    case NMP_CACHE_ID_TYPE_OBJECT_TYPE:
+    case NMP_CACHE_ID_TYPE_DEFAULT_ROUTES:
+        nm_hash_fast_update_val(&h, NMP_OBJECT_GET_TYPE(o));
+        break;
+    case NMP_CACHE_ID_TYPE_OBJECT_BY_IFINDEX:
+        /* also mix in the object type, so that for example the addresses and the
+         * routes of one interface don't collide. It is one round either way. */
+        nm_hash_fast_update_val(&h,
+                                (((guint64) NMP_OBJECT_GET_TYPE(o)) << 32)
+                                    | ((guint32) o->obj_with_ifindex.ifindex));
+        break;
+    case NMP_CACHE_ID_TYPE_OBJECT_BY_ADDR_FAMILY:
+        nm_hash_fast_update_val(&h, o->routing_rule.addr_family);
+        break;
+    default:
+        nm_assert_not_reached();
+        break;
+    }
+    return nm_hash_fast_complete(&h);
+}
+
 static const NMDedupMultiIdxTypeClass _dedup_multi_idx_type_class = {
     .idx_obj_id_hash_update        = _idx_obj_id_hash_update,
     .idx_obj_id_equal              = _idx_obj_id_equal,
@@ -477,10 +525,26 @@ static const NMDedupMultiIdxTypeClass _dedup_multi_idx_type_class = {
     .idx_obj_partition_equal       = _idx_obj_partition_equal,
 };
 
+static const NMDedupMultiIdxTypeClass _dedup_multi_idx_type_class_fast = {
+    .idx_obj_id_hash_update        = _idx_obj_id_hash_update,
+    .idx_obj_id_equal              = _idx_obj_id_equal,
+    .idx_obj_partitionable         = _idx_obj_partitionable,
+    .idx_obj_partition_hash_update = _idx_obj_partition_hash_update,
+    .idx_obj_partition_equal       = _idx_obj_partition_equal,
+    .idx_obj_partition_hash        = _idx_obj_partition_hash_fast,
+};
+
 static void
 _dedup_multi_idx_type_init(DedupMultiIdxType *idx_type, NMPCacheIdType cache_id_type)
 {
-    nm_dedup_multi_idx_type_init((NMDedupMultiIdxType *) idx_type, &_dedup_multi_idx_type_class);
+    nm_dedup_multi_idx_type_init((NMDedupMultiIdxType *) idx_type,
+                                 NM_IN_SET(cache_id_type,
+                                           NMP_CACHE_ID_TYPE_OBJECT_TYPE,
+                                           NMP_CACHE_ID_TYPE_DEFAULT_ROUTES,
+                                           NMP_CACHE_ID_TYPE_OBJECT_BY_IFINDEX,
+                                           NMP_CACHE_ID_TYPE_OBJECT_BY_ADDR_FAMILY)
+                                     ? &_dedup_multi_idx_type_class_fast
+                                     : &_dedup_multi_idx_type_class);
     idx_type->cache_id_type = cache_id_type;
 }
 
@@ -875,6 +939,22 @@ nmp_object_stackinit_id_ip6_address(NMPObject *obj, int ifindex, const struct in
     return obj;
 }
 
+const NMPObject *
+nmp_object_stackinit_id_neighbor(NMPObject *   obj,
+                                 int           ifindex,
+                                 int           addr_family,
+                                 gconstpointer address)
+{
+    nm_assert(NM_IN_SET(addr_family, AF_INET, AF_INET6));
+
+    _nmp_object_stackinit_from_type(obj, NMP_OBJECT_TYPE_NEIGHBOR);
+    obj->neighbor.ifindex     = ifindex;
+    obj->neighbor.addr_family = addr_family;
+    if (address)
+        nm_ip_addr_set(addr_family, &obj->neighbor.address, address);
+    return obj;
+}
+
 /*****************************************************************************/
 
 const char *
@@ -1514,6 +1594,24 @@ _vt_cmd_plobj_id_cmp(tfilter, NMPlatformTfilter, {
     NM_CMP_FIELD(obj1, obj2, handle);
 });
 
+_vt_cmd_plobj_id_cmp(neighbor, NMPlatformNeighbor, {
+    NM_CMP_FIELD(obj1, obj2, ifindex);
+    NM_CMP_FIELD(obj1, obj2, addr_family);
+    NM_CMP_FIELD_MEMCMP(obj1, obj2, address);
+});
+
+_vt_cmd_plobj_id_cmp(fdb, NMPlatformNeighbor, {
+    NM_CMP_FIELD(obj1, obj2, ifindex);
+    NM_CMP_FIELD(obj1, obj2, vlan_id);
+    NM_CMP_FIELD(obj1, obj2, lladdr.len);
+    NM_CMP_FIELD_MEMCMP_LEN(obj1, obj2, lladdr.data, obj1->lladdr.len);
+    /* kernel keeps entries in the bridge's FDB and the port's own FDB (NTF_SELF) apart. */
+    NM_CMP_DIRECT(NM_FLAGS_HAS(obj1->flags, NTF_SELF), NM_FLAGS_HAS(obj2->flags, NTF_SELF));
+    /* tunnel devices can have several entries with the same lladdr, one per remote. */
+    NM_CMP_FIELD(obj1, obj2, addr_family);
+    NM_CMP_FIELD_MEMCMP(obj1, obj2, address);
+});
+
 static int
 _vt_cmd_plobj_id_cmp_ip4_route(const NMPlatformObject *obj1, const NMPlatformObject *obj2)
 {
@@ -1623,6 +1721,20 @@ _vt_cmd_plobj_id_hash_update(tfilter, NMPlatformTfilter, {
     nm_hash_update_vals(h, obj->ifindex, obj->handle);
 });
 
+_vt_cmd_plobj_id_hash_update(neighbor, NMPlatformNeighbor, {
+    nm_hash_update_vals(h, obj->ifindex, obj->addr_family, obj->address);
+});
+
+_vt_cmd_plobj_id_hash_update(fdb, NMPlatformNeighbor, {
+    nm_hash_update_vals(h,
+                        obj->ifindex,
+                        obj->vlan_id,
+                        obj->addr_family,
+                        obj->address,
+                        (bool) NM_FLAGS_HAS(obj->flags, NTF_SELF));
+    nm_hash_update_mem(h, obj->lladdr.data, obj->lladdr.len);
+});
+
 static void
 _vt_cmd_plobj_hash_update_ip4_route(const NMPlatformObject *obj, NMHashState *h)
 {
@@ -1732,6 +1844,12 @@ _vt_cmd_obj_is_alive_tfilter(const NMPObject *obj)
     return NMP_OBJECT_CAST_TFILTER(obj)->ifindex > 0;
 }
 
+static gboolean
+_vt_cmd_obj_is_alive_neighbor(const NMPObject *obj)
+{
+    return NMP_OBJECT_CAST_NEIGHBOR(obj)->ifindex > 0;
+}
+
 gboolean
 nmp_object_is_visible(const NMPObject *obj)
 {
@@ -2074,6 +2192,8 @@ nmp_lookup_init_obj_type(NMPLookup *lookup, NMPObjectType obj_type)
     case NMP_OBJECT_TYPE_ROUTING_RULE:
     case NMP_OBJECT_TYPE_QDISC:
     case NMP_OBJECT_TYPE_TFILTER:
+    case NMP_OBJECT_TYPE_NEIGHBOR:
+    case NMP_OBJECT_TYPE_FDB:
         _nmp_object_stackinit_from_type(&lookup->selector_obj, obj_type);
         lookup->cache_id_type = NMP_CACHE_ID_TYPE_OBJECT_TYPE;
         return _L(lookup);
@@ -2111,7 +2231,9 @@ nmp_lookup_init_object(NMPLookup *lookup, NMPObjectType obj_type, int ifindex)
                         NMP_OBJECT_TYPE_IP4_ROUTE,
                         NMP_OBJECT_TYPE_IP6_ROUTE,
                         NMP_OBJECT_TYPE_QDISC,
-                        NMP_OBJECT_TYPE_TFILTER));
+                        NMP_OBJECT_TYPE_TFILTER,
+                        NMP_OBJECT_TYPE_NEIGHBOR,
+                        NMP_OBJECT_TYPE_FDB));
 
     if (ifindex <= 0) {
         return nmp_lookup_init_obj_type(lookup, obj_type);
@@ -3042,6 +3164,18 @@ nmp_cache_new(NMDedupMultiIndex *multi_idx, gboolean use_udev)
     return cache;
 }
 
+NMPCache *
+_nmtst_nmp_cache_new_siphash(NMDedupMultiIndex *multi_idx, gboolean use_udev)
+{
+    NMPCache *cache = nmp_cache_new(multi_idx, use_udev);
+    guint     i;
+
+    /* for benchmarking: hash all head entries with NMHashState. */
+    for (i = NMP_CACHE_ID_TYPE_NONE + 1; i <= NMP_CACHE_ID_TYPE_MAX; i++)
+        _idx_type_get(cache, i)->klass = &_dedup_multi_idx_type_class;
+    return cache;
+}
+
 void
 nmp_cache_free(NMPCache *cache)
 {
@@ -3239,6 +3373,45 @@ const NMPClass _nmp_classes[NMP_OBJECT_TYPE_MAX] = {
             .cmd_plobj_hash_update    = (CmdPlobjHashUpdateFunc) nm_platform_tfilter_hash_update,
             .cmd_plobj_cmp            = (CmdPlobjCmpFunc) nm_platform_tfilter_cmp,
         },
+    [NMP_OBJECT_TYPE_NEIGHBOR - 1] =
+        {
+            .parent                   = DEDUP_MULTI_OBJ_CLASS_INIT(),
+            .obj_type                 = NMP_OBJECT_TYPE_NEIGHBOR,
+            .sizeof_data              = sizeof(NMPObjectNeighbor),
+            .sizeof_public            = sizeof(NMPlatformNeighbor),
+            .obj_type_name            = "neighbor",
+            .rtm_gettype              = RTM_GETNEIGH,
+            .signal_type_id           = NM_PLATFORM_SIGNAL_ID_NEIGHBOR,
+            .signal_type              = NM_PLATFORM_SIGNAL_NEIGHBOR_CHANGED,
+            .supported_cache_ids      = _supported_cache_ids_object,
+            .cmd_obj_is_alive         = _vt_cmd_obj_is_alive_neighbor,
+            .cmd_plobj_id_cmp         = _vt_cmd_plobj_id_cmp_neighbor,
+            .cmd_plobj_id_hash_update = _vt_cmd_plobj_id_hash_update_neighbor,
+            .cmd_plobj_to_string_id   = (CmdPlobjToStringIdFunc) nm_platform_neighbor_to_string,
+            .cmd_plobj_to_string      = (CmdPlobjToStringFunc) nm_platform_neighbor_to_string,
+            .cmd_plobj_hash_update    = (CmdPlobjHashUpdateFunc) nm_platform_neighbor_hash_update,
+            .cmd_plobj_cmp            = (CmdPlobjCmpFunc) nm_platform_neighbor_cmp,
+        },
+    [NMP_OBJECT_TYPE_FDB - 1] =
+        {
+            .parent                   = DEDUP_MULTI_OBJ_CLASS_INIT(),
+            .obj_type                 = NMP_OBJECT_TYPE_FDB,
+            .sizeof_data              = sizeof(NMPObjectNeighbor),
+            .sizeof_public            = sizeof(NMPlatformNeighbor),
+            .obj_type_name            = "fdb",
+            .addr_family              = AF_BRIDGE,
+            .rtm_gettype              = RTM_GETNEIGH,
+            .signal_type_id           = NM_PLATFORM_SIGNAL_ID_FDB,
+            .signal_type              = NM_PLATFORM_SIGNAL_FDB_CHANGED,
+            .supported_cache_ids      = _supported_cache_ids_object,
+            .cmd_obj_is_alive         = _vt_cmd_obj_is_alive_neighbor,
+            .cmd_plobj_id_cmp         = _vt_cmd_plobj_id_cmp_fdb,
+            .cmd_plobj_id_hash_update = _vt_cmd_plobj_id_hash_update_fdb,
+            .cmd_plobj_to_string_id   = (CmdPlobjToStringIdFunc) nm_platform_neighbor_to_string,
+            .cmd_plobj_to_string      = (CmdPlobjToStringFunc) nm_platform_neighbor_to_string,
+            .cmd_plobj_hash_update    = (CmdPlobjHashUpdateFunc) nm_platform_neighbor_hash_update,
+            .cmd_plobj_cmp            = (CmdPlobjCmpFunc) nm_platform_neighbor_cmp,
+        },
     [NMP_OBJECT_TYPE_LNK_BRIDGE - 1] =
         {
             .parent                = DEDUP_MULTI_OBJ_CLASS_INIT(),
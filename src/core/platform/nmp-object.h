@@ -332,6 +332,10 @@ typedef struct {
     NMPlatformTfilter _public;
 } NMPObjectTfilter;
 
+typedef struct {
+    NMPlatformNeighbor _public;
+} NMPObjectNeighbor;
+
 struct _NMPObject {
     union {
         NMDedupMultiObj parent;
@@ -405,6 +409,9 @@ struct _NMPObject {
         NMPObjectQdisc    _qdisc;
         NMPlatformTfilter tfilter;
         NMPObjectTfilter  _tfilter;
+
+        NMPlatformNeighbor neighbor;
+        NMPObjectNeighbor  _neighbor;
     };
 };
 
@@ -488,6 +495,9 @@ _NMP_OBJECT_TYPE_IS_OBJ_WITH_IFINDEX(NMPObjectType obj_type)
 
     case NMP_OBJECT_TYPE_TFILTER:
 
+    case NMP_OBJECT_TYPE_NEIGHBOR:
+    case NMP_OBJECT_TYPE_FDB:
+
     case NMP_OBJECT_TYPE_LNK_BRIDGE:
     case NMP_OBJECT_TYPE_LNK_GRE:
     case NMP_OBJECT_TYPE_LNK_GRETAP:
@@ -562,6 +572,8 @@ _NMP_OBJECT_TYPE_IS_OBJ_WITH_IFINDEX(NMPObjectType obj_type)
     _NMP_OBJECT_CAST(obj, routing_rule, NMP_OBJECT_TYPE_ROUTING_RULE)
 #define NMP_OBJECT_CAST_QDISC(obj)   _NMP_OBJECT_CAST(obj, qdisc, NMP_OBJECT_TYPE_QDISC)
 #define NMP_OBJECT_CAST_TFILTER(obj) _NMP_OBJECT_CAST(obj, tfilter, NMP_OBJECT_TYPE_TFILTER)
+#define NMP_OBJECT_CAST_NEIGHBOR(obj) \
+    _NMP_OBJECT_CAST(obj, neighbor, NMP_OBJECT_TYPE_NEIGHBOR, NMP_OBJECT_TYPE_FDB)
 #define NMP_OBJECT_CAST_LNK_WIREGUARD(obj) \
     _NMP_OBJECT_CAST(obj, lnk_wireguard, NMP_OBJECT_TYPE_LNK_WIREGUARD)
 #define NMP_OBJECT_CAST_LNK_BRIDGE(obj) \
@@ -661,6 +673,10 @@ const NMPObject *nmp_object_stackinit_id_ip4_address(NMPObject *obj,
                                                      guint32    peer_address);
 const NMPObject *
 nmp_object_stackinit_id_ip6_address(NMPObject *obj, int ifindex, const struct in6_addr *address);
+const NMPObject *nmp_object_stackinit_id_neighbor(NMPObject *   obj,
+                                                 int           ifindex,
+                                                 int           addr_family,
+                                                 gconstpointer address);
 
 const char *nmp_object_to_string(const NMPObject *     obj,
                                  NMPObjectToStringMode to_string_mode,
@@ -874,6 +890,7 @@ nmp_cache_reresolve_main_entry(NMPCache *               cache,
 void nmp_cache_dirty_set_all_main(NMPCache *cache, const NMPLookup *lookup);
 
 NMPCache *nmp_cache_new(NMDedupMultiIndex *multi_idx, gboolean use_udev);
+NMPCache *_nmtst_nmp_cache_new_siphash(NMDedupMultiIndex *multi_idx, gboolean use_udev);
 void      nmp_cache_free(NMPCache *cache);
 
 static inline void
@@ -755,7 +755,7 @@ nmtstp_wait_for_signal(NMPlatform *platform, gint64 timeout_msec)
 {
     WaitForSignalData data = {0};
     gulong            id_link, id_ip4_address, id_ip6_address, id_ip4_route, id_ip6_route;
-    gulong            id_qdisc, id_tfilter;
+    gulong            id_qdisc, id_tfilter, id_neighbor, id_fdb;
 
     _init_platform(&platform, FALSE);
 
@@ -789,6 +789,14 @@ nmtstp_wait_for_signal(NMPlatform *platform, gint64 timeout_msec)
                                   NM_PLATFORM_SIGNAL_TFILTER_CHANGED,
                                   G_CALLBACK(_wait_for_signal_cb),
                                   &data);
+    id_neighbor    = g_signal_connect(platform,
+                                   NM_PLATFORM_SIGNAL_NEIGHBOR_CHANGED,
+                                   G_CALLBACK(_wait_for_signal_cb),
+                                   &data);
+    id_fdb         = g_signal_connect(platform,
+                              NM_PLATFORM_SIGNAL_FDB_CHANGED,
+                              G_CALLBACK(_wait_for_signal_cb),
+                              &data);
 
     /* if timeout_msec is negative, it means the wait-time already expired.
      * Maybe, we should do nothing and return right away, without even
@@ -812,6 +820,8 @@ nmtstp_wait_for_signal(NMPlatform *platform, gint64 timeout_msec)
     g_assert(nm_clear_g_signal_handler(platform, &id_ip6_route));
     g_assert(nm_clear_g_signal_handler(platform, &id_tfilter));
     g_assert(nm_clear_g_signal_handler(platform, &id_qdisc));
+    g_assert(nm_clear_g_signal_handler(platform, &id_neighbor));
+    g_assert(nm_clear_g_signal_handler(platform, &id_fdb));
 
     nm_clear_pointer(&data.loop, g_main_loop_unref);
 
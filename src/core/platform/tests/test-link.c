@@ -10,6 +10,7 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <linux/if_tun.h>
+#include <linux/neighbour.h>
 
 #include "nm-glib-aux/nm-io-utils.h"
 #include "nm-base/nm-ethtool-base.h"
@@ -2412,6 +2413,37 @@ test_vlan_set_xgress(void)
 
 /*****************************************************************************/
 
+static void
+_create_many_links_read_driver_info(GArray *ifindexes, gboolean prefetch)
+{
+    gint64 time, start_time = nm_utils_get_monotonic_timestamp_nsec();
+    guint  i;
+
+    if (prefetch)
+        nm_platform_link_prefetch(NM_PLATFORM_GET, (const int *) ifindexes->data, ifindexes->len);
+
+    for (i = 0; i < ifindexes->len; i++) {
+        gs_free char *driver_name = NULL;
+
+        g_assert(nm_platform_link_get_driver_info(NM_PLATFORM_GET,
+                                                  g_array_index(ifindexes, int, i),
+                                                  &driver_name,
+                                                  NULL,
+                                                  NULL));
+        g_assert_cmpstr(driver_name, ==, "dummy");
+    }
+
+    if (prefetch)
+        nm_platform_link_prefetch(NM_PLATFORM_GET, NULL, 0);
+
+    time = nm_utils_get_monotonic_timestamp_nsec() - start_time;
+    _LOGI(">>> read driver info of %u links%s in %ld.%09ld seconds",
+          ifindexes->len,
+          prefetch ? " with prefetch" : "",
+          (long) (time / NM_UTILS_NSEC_PER_SEC),
+          (long) (time % NM_UTILS_NSEC_PER_SEC));
+}
+
 static void
 test_create_many_links_do(guint n_devices)
 {
@@ -2454,6 +2486,9 @@ test_create_many_links_do(guint n_devices)
         g_array_append_val(ifindexes, pllink->ifindex);
     }
 
+    _create_many_links_read_driver_info(ifindexes, FALSE);
+    _create_many_links_read_driver_info(ifindexes, TRUE);
+
     _LOGI(">>> delete devices...");
 
     g_assert_cmpint(ifindexes->len, ==, n_devices);
@@ -2673,6 +2708,194 @@ again:
 
 /*****************************************************************************/
 
+static void
+test_bridge_vlans(void)
+{
+    const char *                  IFACE_BRIDGE0 = "nm-test-bridge0";
+    const char *                  IFACE_DUMMY0  = "nm-test-dummy0";
+    gs_free NMPlatformBridgeVlan *vlans         = NULL;
+    const NMPlatformBridgeVlan    set[]         = {
+        {.vid_start = 10, .vid_end = 15},
+        {.vid_start = 16, .vid_end = 20},
+        {.vid_start = 30, .vid_end = 30, .untagged = TRUE},
+    };
+    const NMPlatformBridgeVlan *set_ptrs[] = {&set[0], &set[1], &set[2], NULL};
+    const NMPlatformLink *      pllink;
+    int                         ifindex_bridge0, ifindex_dummy0;
+    guint                       n_vlans;
+
+    nmtstp_run_command_check("ip link add %s type dummy", IFACE_DUMMY0);
+    ifindex_dummy0 =
+        nmtstp_assert_wait_for_link(NM_PLATFORM_GET, IFACE_DUMMY0, NM_LINK_TYPE_DUMMY, 100)
+            ->ifindex;
+
+    nmtstp_run_command_check("ip link add %s type bridge vlan_filtering 1", IFACE_BRIDGE0);
+    ifindex_bridge0 =
+        nmtstp_assert_wait_for_link(NM_PLATFORM_GET, IFACE_BRIDGE0, NM_LINK_TYPE_BRIDGE, 100)
+            ->ifindex;
+
+    nmtstp_run_command_check("ip link set %s master %s", IFACE_DUMMY0, IFACE_BRIDGE0);
+    NMTST_WAIT_ASSERT(100, {
+        nmtstp_wait_for_signal(NM_PLATFORM_GET, 50);
+
+        pllink = nm_platform_link_get(NM_PLATFORM_GET, ifindex_dummy0);
+        g_assert(pllink);
+        if (pllink->master == ifindex_bridge0)
+            break;
+    });
+
+    g_assert(nm_platform_link_set_bridge_vlans(NM_PLATFORM_GET, ifindex_dummy0, TRUE, set_ptrs));
+    g_assert(nm_platform_link_get_bridge_vlans(NM_PLATFORM_GET, ifindex_dummy0, &vlans, &n_vlans));
+
+    /* The port keeps the default PVID and the adjacent ranges are merged. */
+    g_assert_cmpint(n_vlans, ==, 3);
+    g_assert_cmpint(vlans[0].vid_start, ==, 1);
+    g_assert_cmpint(vlans[0].vid_end, ==, 1);
+    g_assert(vlans[0].pvid);
+    g_assert(vlans[0].untagged);
+    g_assert_cmpint(vlans[1].vid_start, ==, 10);
+    g_assert_cmpint(vlans[1].vid_end, ==, 20);
+    g_assert(!vlans[1].pvid);
+    g_assert(!vlans[1].untagged);
+    g_assert_cmpint(vlans[2].vid_start, ==, 30);
+    g_assert_cmpint(vlans[2].vid_end, ==, 30);
+    g_assert(vlans[2].untagged);
+
+    /* Setting the same VLANs again is a no-op. */
+    g_assert(nm_platform_link_set_bridge_vlans(NM_PLATFORM_GET, ifindex_dummy0, TRUE, set_ptrs));
+
+    nmtstp_link_delete(NULL, -1, ifindex_bridge0, IFACE_BRIDGE0, TRUE);
+    nmtstp_link_delete(NULL, -1, ifindex_dummy0, IFACE_DUMMY0, TRUE);
+}
+
+/*****************************************************************************/
+
+static const NMPlatformNeighbor *
+_fdb_lookup(int ifindex, const char *lladdr)
+{
+    NMPLookup                 lookup;
+    NMDedupMultiIter          iter;
+    const NMPObject *         obj;
+    guint8                    addr[ETH_ALEN];
+
+    g_assert(nm_utils_hwaddr_aton(lladdr, addr, sizeof(addr)));
+
+    nmp_lookup_init_object(&lookup, NMP_OBJECT_TYPE_FDB, ifindex);
+    nm_platform_iter_obj_for_each (&iter, NM_PLATFORM_GET, &lookup, &obj) {
+        const NMPlatformNeighbor *fdb = NMP_OBJECT_CAST_NEIGHBOR(obj);
+
+        if (fdb->lladdr.len == ETH_ALEN && memcmp(fdb->lladdr.data, addr, ETH_ALEN) == 0
+            && !NM_FLAGS_HAS(fdb->flags, NTF_SELF))
+            return fdb;
+    }
+    return NULL;
+}
+
+static void
+test_neighbors(void)
+{
+    const char *              IFACE_BRIDGE0 = "nm-test-bridge0";
+    const char *              IFACE_VETH0   = "nm-test-veth0";
+    const char *              IFACE_VETH1   = "nm-test-veth1";
+    const char *              LLADDR_A      = "02:00:00:00:00:0A";
+    const char *              LLADDR_B      = "02:00:00:00:00:0B";
+    const in_addr_t           addr          = nmtst_inet4_from_string("192.0.2.1");
+    const NMPlatformNeighbor *neigh;
+    const NMPlatformLink *    pllink;
+    NMPLookup                 lookup;
+    int                       ifindex_bridge0, ifindex_veth0, ifindex_veth1;
+
+    ifindex_veth0 = nmtstp_link_veth_add(NM_PLATFORM_GET, -1, IFACE_VETH0, IFACE_VETH1)->ifindex;
+    ifindex_veth1 = nmtstp_link_get_typed(NM_PLATFORM_GET, 0, IFACE_VETH1, NM_LINK_TYPE_VETH)
+                        ->ifindex;
+    nmtstp_link_set_updown(NULL, -1, ifindex_veth0, TRUE);
+
+    /* entries of interfaces nobody subscribed to are not cached. */
+    nmtstp_run_command_check("ip neigh add 192.0.2.1 lladdr %s dev %s nud permanent",
+                             LLADDR_A,
+                             IFACE_VETH0);
+    nmtstp_wait_for_signal(NM_PLATFORM_GET, 50);
+    g_assert(!nm_platform_neighbor_get(NM_PLATFORM_GET, ifindex_veth0, AF_INET, &addr));
+
+    /* subscribing fetches the existing entries right away. */
+    nm_platform_neighbor_subscribe(NM_PLATFORM_GET, NMP_OBJECT_TYPE_NEIGHBOR, ifindex_veth0);
+    neigh = nm_platform_neighbor_get(NM_PLATFORM_GET, ifindex_veth0, AF_INET, &addr);
+    g_assert(neigh);
+    g_assert_cmpint(neigh->state, ==, NUD_PERMANENT);
+    g_assert(nm_utils_hwaddr_matches(neigh->lladdr.data, neigh->lladdr.len, LLADDR_A, -1));
+
+    /* and changes are tracked from the event stream. */
+    nmtstp_run_command_check("ip neigh replace 192.0.2.1 lladdr %s dev %s nud permanent",
+                             LLADDR_B,
+                             IFACE_VETH0);
+    NMTST_WAIT_ASSERT(100, {
+        nmtstp_wait_for_signal(NM_PLATFORM_GET, 50);
+
+        neigh = nm_platform_neighbor_get(NM_PLATFORM_GET, ifindex_veth0, AF_INET, &addr);
+        g_assert(neigh);
+        if (nm_utils_hwaddr_matches(neigh->lladdr.data, neigh->lladdr.len, LLADDR_B, -1))
+            break;
+    });
+
+    nmtstp_run_command_check("ip neigh del 192.0.2.1 dev %s", IFACE_VETH0);
+    NMTST_WAIT_ASSERT(100, {
+        nmtstp_wait_for_signal(NM_PLATFORM_GET, 50);
+
+        if (!nm_platform_neighbor_get(NM_PLATFORM_GET, ifindex_veth0, AF_INET, &addr))
+            break;
+    });
+
+    /* unsubscribing drops the cached entries. */
+    nmtstp_run_command_check("ip neigh add 192.0.2.1 lladdr %s dev %s nud permanent",
+                             LLADDR_A,
+                             IFACE_VETH0);
+    NMTST_WAIT_ASSERT(100, {
+        nmtstp_wait_for_signal(NM_PLATFORM_GET, 50);
+
+        if (nm_platform_neighbor_get(NM_PLATFORM_GET, ifindex_veth0, AF_INET, &addr))
+            break;
+    });
+    nm_platform_neighbor_unsubscribe(NM_PLATFORM_GET, NMP_OBJECT_TYPE_NEIGHBOR, ifindex_veth0);
+    g_assert(!nm_platform_lookup(
+        NM_PLATFORM_GET,
+        nmp_lookup_init_object(&lookup, NMP_OBJECT_TYPE_NEIGHBOR, ifindex_veth0)));
+
+    /* FDB entries of a port are cached when subscribing to its bridge. */
+    nmtstp_run_command_check("ip link add %s type bridge", IFACE_BRIDGE0);
+    ifindex_bridge0 =
+        nmtstp_assert_wait_for_link(NM_PLATFORM_GET, IFACE_BRIDGE0, NM_LINK_TYPE_BRIDGE, 100)
+            ->ifindex;
+
+    nmtstp_run_command_check("ip link set %s master %s", IFACE_VETH0, IFACE_BRIDGE0);
+    NMTST_WAIT_ASSERT(100, {
+        nmtstp_wait_for_signal(NM_PLATFORM_GET, 50);
+
+        pllink = nm_platform_link_get(NM_PLATFORM_GET, ifindex_veth0);
+        g_assert(pllink);
+        if (pllink->master == ifindex_bridge0)
+            break;
+    });
+
+    nm_platform_neighbor_subscribe(NM_PLATFORM_GET, NMP_OBJECT_TYPE_FDB, ifindex_bridge0);
+    nmtstp_run_command_check("bridge fdb add %s dev %s master static", LLADDR_A, IFACE_VETH0);
+    NMTST_WAIT_ASSERT(100, {
+        nmtstp_wait_for_signal(NM_PLATFORM_GET, 50);
+
+        if (_fdb_lookup(ifindex_veth0, LLADDR_A))
+            break;
+    });
+    g_assert_cmpint(_fdb_lookup(ifindex_veth0, LLADDR_A)->master, ==, ifindex_bridge0);
+
+    nm_platform_neighbor_unsubscribe(NM_PLATFORM_GET, NMP_OBJECT_TYPE_FDB, ifindex_bridge0);
+    g_assert(!_fdb_lookup(ifindex_veth0, LLADDR_A));
+
+    nmtstp_link_delete(NULL, -1, ifindex_bridge0, IFACE_BRIDGE0, TRUE);
+    nmtstp_link_delete(NULL, -1, ifindex_veth0, IFACE_VETH0, TRUE);
+    g_assert(!nmtstp_link_get(NM_PLATFORM_GET, ifindex_veth1, IFACE_VETH1));
+}
+
+/*****************************************************************************/
+
 static void
 _test_netns_setup(gpointer fixture, gconstpointer test_data)
 {
@@ -3721,6 +3944,66 @@ test_ethtool_features_get(void)
     }
 }
 
+static void
+test_ethtool_cache(void)
+{
+    const char *IFACE_VETH0 = "nm-test-veth0";
+    const char *IFACE_VETH1 = "nm-test-veth1";
+    int         ifindexes[2];
+    guint       i_run;
+    guint       i;
+
+    ifindexes[0] = nmtstp_link_veth_add(NM_PLATFORM_GET, -1, IFACE_VETH0, IFACE_VETH1)->ifindex;
+    ifindexes[1] =
+        nmtstp_link_get_typed(NM_PLATFORM_GET, -1, IFACE_VETH1, NM_LINK_TYPE_VETH)->ifindex;
+
+    /* The first lookup goes to kernel via ioctl, the following ones are served
+     * from the netlink dump. Either way, we must get what ioctl says. */
+    for (i_run = 0; i_run < 3; i_run++) {
+        for (i = 0; i < G_N_ELEMENTS(ifindexes); i++) {
+            const int                ifindex = ifindexes[i];
+            gboolean                 autoneg1, autoneg2;
+            guint32                  speed1, speed2;
+            NMPlatformLinkDuplexType duplex1, duplex2;
+            NMEthtoolRingState       ring1, ring2;
+            NMEthtoolCoalesceState   coalesce1, coalesce2;
+            gboolean                 success;
+
+            success = nmp_utils_ethtool_get_link_settings(ifindex, &autoneg1, &speed1, &duplex1);
+            g_assert_cmpint(
+                success,
+                ==,
+                nm_platform_ethtool_get_link_settings(NM_PLATFORM_GET,
+                                                      ifindex,
+                                                      &autoneg2,
+                                                      &speed2,
+                                                      &duplex2));
+            if (success) {
+                g_assert_cmpint(autoneg1, ==, autoneg2);
+                g_assert_cmpint(speed1, ==, speed2);
+                g_assert_cmpint(duplex1, ==, duplex2);
+            }
+
+            success = nmp_utils_ethtool_get_ring(ifindex, &ring1);
+            g_assert_cmpint(success,
+                            ==,
+                            nm_platform_ethtool_get_link_ring(NM_PLATFORM_GET, ifindex, &ring2));
+            if (success)
+                g_assert(memcmp(&ring1, &ring2, sizeof(ring1)) == 0);
+
+            success = nmp_utils_ethtool_get_coalesce(ifindex, &coalesce1);
+            g_assert_cmpint(
+                success,
+                ==,
+                nm_platform_ethtool_get_link_coalesce(NM_PLATFORM_GET, ifindex, &coalesce2));
+            if (success)
+                g_assert(memcmp(&coalesce1, &coalesce2, sizeof(coalesce1)) == 0);
+        }
+    }
+
+    nmtstp_link_delete(NM_PLATFORM_GET, -1, ifindexes[0], NULL, TRUE);
+}
+
 /*****************************************************************************/
 
 NMTstpSetupFunc const _nmtstp_setup_platform_func = SETUP;
@@ -3785,6 +4068,8 @@ _nmtstp_setup_tests(void)
         g_test_add_func("/link/nl-bugs/veth", test_nl_bugs_veth);
         g_test_add_func("/link/nl-bugs/spurious-newlink", test_nl_bugs_spuroius_newlink);
         g_test_add_func("/link/nl-bugs/spurious-dellink", test_nl_bugs_spuroius_dellink);
+        g_test_add_func("/link/bridge-vlans", test_bridge_vlans);
+        g_test_add_func("/link/neighbors", test_neighbors);
 
         g_test_add_vtable("/general/netns/general",
                           0,
@@ -3819,5 +4104,6 @@ _nmtstp_setup_tests(void)
         g_test_add_func("/general/sysctl/set-async-fail", test_sysctl_set_async_fail);
 
         g_test_add_func("/link/ethtool/features/get", test_ethtool_features_get);
+        g_test_add_func("/link/ethtool/cache", test_ethtool_cache);
     }
 }
@@ -6,6 +6,7 @@
 #include "nm-default.h"
 
 #include <libudev.h>
+#include <linux/neighbour.h>
 #include <linux/pkt_sched.h>
 
 #include "platform/nmp-object.h"
@@ -559,6 +560,213 @@ test_cache_qdisc(void)
 
 /*****************************************************************************/
 
+static void
+test_cache_neighbor(void)
+{
+    NMPCache *                      cache;
+    nm_auto_unref_dedup_multi_index NMDedupMultiIndex *multi_idx = NULL;
+    NMPLookup                                          lookup;
+    NMPObject                                          obj_id;
+    const NMDedupMultiHeadEntry *                      head_entry;
+    const NMPLinkAddress lladdr_a = {.data = {0x02, 0, 0, 0, 0, 0x0a}, .len = 6};
+    const NMPLinkAddress lladdr_b = {.data = {0x02, 0, 0, 0, 0, 0x0b}, .len = 6};
+    NMPlatformNeighbor   pl_neigh_1a;
+    NMPlatformNeighbor   pl_neigh_1b;
+    NMPlatformNeighbor   pl_neigh_1c;
+    NMPlatformNeighbor   pl_fdb_1a;
+    NMPlatformNeighbor   pl_fdb_1b;
+    NMPlatformNeighbor   pl_fdb_1c;
+    NMPlatformNeighbor   pl_fdb_1d;
+    nm_auto_nmpobj NMPObject *neigh_1a = NULL;
+    nm_auto_nmpobj NMPObject *neigh_1b = NULL;
+    nm_auto_nmpobj NMPObject *neigh_1c = NULL;
+    nm_auto_nmpobj NMPObject *fdb_1a   = NULL;
+    nm_auto_nmpobj NMPObject *fdb_1b   = NULL;
+    nm_auto_nmpobj NMPObject *fdb_1c   = NULL;
+    nm_auto_nmpobj NMPObject *fdb_1d   = NULL;
+
+    pl_neigh_1a = (NMPlatformNeighbor){
+        .ifindex     = 1,
+        .addr_family = AF_INET,
+        .address     = {.addr4 = nmtst_inet4_from_string("192.0.2.1")},
+        .lladdr      = lladdr_a,
+        .state       = NUD_REACHABLE,
+    };
+
+    /* same ID, the neighbor moved to a different MAC address. */
+    pl_neigh_1b        = pl_neigh_1a;
+    pl_neigh_1b.lladdr = lladdr_b;
+    pl_neigh_1b.state  = NUD_STALE;
+
+    pl_neigh_1c = (NMPlatformNeighbor){
+        .ifindex     = 1,
+        .addr_family = AF_INET6,
+        .address     = {.addr6 = *nmtst_inet6_from_string("2001:db8::1")},
+        .lladdr      = lladdr_a,
+        .state       = NUD_REACHABLE,
+    };
+
+    pl_fdb_1a = (NMPlatformNeighbor){
+        .ifindex = 1,
+        .lladdr  = lladdr_a,
+        .master  = 5,
+        .flags   = NTF_MASTER,
+    };
+
+    /* same ID, only the state differs. */
+    pl_fdb_1b       = pl_fdb_1a;
+    pl_fdb_1b.state = NUD_PERMANENT;
+
+    /* the port's own entry is distinct from the one in the bridge. */
+    pl_fdb_1c       = pl_fdb_1a;
+    pl_fdb_1c.flags = NTF_SELF;
+
+    pl_fdb_1d         = pl_fdb_1a;
+    pl_fdb_1d.vlan_id = 10;
+
+    neigh_1a = nmp_object_new(NMP_OBJECT_TYPE_NEIGHBOR, (NMPlatformObject *) &pl_neigh_1a);
+    neigh_1b = nmp_object_new(NMP_OBJECT_TYPE_NEIGHBOR, (NMPlatformObject *) &pl_neigh_1b);
+    neigh_1c = nmp_object_new(NMP_OBJECT_TYPE_NEIGHBOR, (NMPlatformObject *) &pl_neigh_1c);
+    fdb_1a   = nmp_object_new(NMP_OBJECT_TYPE_FDB, (NMPlatformObject *) &pl_fdb_1a);
+    fdb_1b   = nmp_object_new(NMP_OBJECT_TYPE_FDB, (NMPlatformObject *) &pl_fdb_1b);
+    fdb_1c   = nmp_object_new(NMP_OBJECT_TYPE_FDB, (NMPlatformObject *) &pl_fdb_1c);
+    fdb_1d   = nmp_object_new(NMP_OBJECT_TYPE_FDB, (NMPlatformObject *) &pl_fdb_1d);
+
+    g_assert(nmp_object_id_equal(neigh_1a, neigh_1b));
+    g_assert(!nmp_object_equal(neigh_1a, neigh_1b));
+    g_assert(!nmp_object_id_equal(neigh_1a, neigh_1c));
+    g_assert(nmp_object_id_equal(fdb_1a, fdb_1b));
+    g_assert(!nmp_object_id_equal(fdb_1a, fdb_1c));
+    g_assert(!nmp_object_id_equal(fdb_1a, fdb_1d));
+
+    multi_idx = nm_dedup_multi_index_new();
+    cache     = nmp_cache_new(multi_idx, nmtst_get_rand_uint32() % 2);
+
+    g_assert(nmp_cache_update_netlink(cache, neigh_1a, FALSE, NULL, NULL) == NMP_CACHE_OPS_ADDED);
+    g_assert(nmp_cache_lookup_obj(cache, neigh_1b) == neigh_1a);
+
+    g_assert(nmp_cache_update_netlink(cache, neigh_1b, FALSE, NULL, NULL)
+             == NMP_CACHE_OPS_UPDATED);
+    g_assert(nmp_cache_lookup_obj(cache, neigh_1a) == neigh_1b);
+
+    g_assert(nmp_cache_update_netlink(cache, neigh_1c, FALSE, NULL, NULL) == NMP_CACHE_OPS_ADDED);
+
+    nmp_object_stackinit_id_neighbor(&obj_id, 1, AF_INET, &pl_neigh_1a.address);
+    g_assert(nmp_cache_lookup_obj(cache, &obj_id) == neigh_1b);
+    nmp_object_stackinit_id_neighbor(&obj_id, 2, AF_INET, &pl_neigh_1a.address);
+    g_assert(nmp_cache_lookup_obj(cache, &obj_id) == NULL);
+
+    g_assert(nmp_cache_update_netlink(cache, fdb_1a, FALSE, NULL, NULL) == NMP_CACHE_OPS_ADDED);
+    g_assert(nmp_cache_update_netlink(cache, fdb_1b, FALSE, NULL, NULL) == NMP_CACHE_OPS_UPDATED);
+    g_assert(nmp_cache_update_netlink(cache, fdb_1c, FALSE, NULL, NULL) == NMP_CACHE_OPS_ADDED);
+    g_assert(nmp_cache_update_netlink(cache, fdb_1d, FALSE, NULL, NULL) == NMP_CACHE_OPS_ADDED);
+    g_assert(nmp_cache_lookup_obj(cache, fdb_1a) == fdb_1b);
+
+    /* neighbors and FDB entries of the same interface are indexed apart. */
+    head_entry =
+        nmp_cache_lookup(cache, nmp_lookup_init_object(&lookup, NMP_OBJECT_TYPE_NEIGHBOR, 1));
+    g_assert(head_entry->len == 2);
+    head_entry = nmp_cache_lookup(cache, nmp_lookup_init_object(&lookup, NMP_OBJECT_TYPE_FDB, 1));
+    g_assert(head_entry->len == 3);
+
+    g_assert(nmp_cache_remove(cache, fdb_1a, FALSE, FALSE, NULL) == NMP_CACHE_OPS_REMOVED);
+    head_entry = nmp_cache_lookup(cache, nmp_lookup_init_object(&lookup, NMP_OBJECT_TYPE_FDB, 1));
+    g_assert(head_entry->len == 2);
+
+    nmp_cache_free(cache);
+}
+
+/*****************************************************************************/
+
+static NMPCache *
+_cache_bench_new(NMDedupMultiIndex *multi_idx, gboolean siphash, guint n_ifindex, guint n_addr)
+{
+    NMPCache *cache;
+    guint     i;
+    guint     j;
+
+    cache = siphash ? _nmtst_nmp_cache_new_siphash(multi_idx, FALSE)
+                    : nmp_cache_new(multi_idx, FALSE);
+
+    for (i = 1; i <= n_ifindex; i++) {
+        for (j = 0; j < n_addr; j++) {
+            const NMPlatformIP4Address pl_addr = {
+                .ifindex      = i,
+                .address      = htonl(0x0a000000u | (i << 8) | (j + 1)),
+                .peer_address = htonl(0x0a000000u | (i << 8) | (j + 1)),
+                .plen         = 24,
+            };
+            nm_auto_nmpobj NMPObject *obj =
+                nmp_object_new(NMP_OBJECT_TYPE_IP4_ADDRESS, (NMPlatformObject *) &pl_addr);
+
+            g_assert(nmp_cache_update_netlink(cache, obj, FALSE, NULL, NULL)
+                     == NMP_CACHE_OPS_ADDED);
+        }
+    }
+    return cache;
+}
+
+static gint64
+_cache_bench_run(NMPCache *cache, guint n_ifindex, guint n_addr, guint n_rounds)
+{
+    NMPLookup lookup;
+    gint64    t;
+    guint     r;
+    guint     i;
+
+    t = g_get_monotonic_time();
+    for (r = 0; r < n_rounds; r++) {
+        for (i = 1; i <= n_ifindex; i++) {
+            const NMDedupMultiHeadEntry *head_entry;
+
+            head_entry = nmp_cache_lookup(
+                cache,
+                nmp_lookup_init_object(&lookup, NMP_OBJECT_TYPE_IP4_ADDRESS, i));
+            g_assert(head_entry && head_entry->len == n_addr);
+        }
+    }
+    return g_get_monotonic_time() - t;
+}
+
+static void
+test_cache_lookup_bench(void)
+{
+    const guint N_IFINDEX = 4000;
+    const guint N_ADDR    = 4;
+    const guint N_ROUNDS  = 200;
+    nm_auto_unref_dedup_multi_index NMDedupMultiIndex *multi_idx_siphash = NULL;
+    nm_auto_unref_dedup_multi_index NMDedupMultiIndex *multi_idx_fast    = NULL;
+    NMPCache *                                         cache_siphash;
+    NMPCache *                                         cache_fast;
+    gint64                                             t_siphash;
+    gint64                                             t_fast;
+
+    if (nmtst_test_quick()) {
+        g_test_skip("Skip benchmark: don't run long running test (NMTST_DEBUG=slow)");
+        return;
+    }
+
+    multi_idx_siphash = nm_dedup_multi_index_new();
+    multi_idx_fast    = nm_dedup_multi_index_new();
+    cache_siphash     = _cache_bench_new(multi_idx_siphash, TRUE, N_IFINDEX, N_ADDR);
+    cache_fast        = _cache_bench_new(multi_idx_fast, FALSE, N_IFINDEX, N_ADDR);
+
+    t_siphash = _cache_bench_run(cache_siphash, N_IFINDEX, N_ADDR, N_ROUNDS);
+    t_fast    = _cache_bench_run(cache_fast, N_IFINDEX, N_ADDR, N_ROUNDS);
+
+    g_print("nmp-cache: lookup of addresses by ifindex for %u links (%u rounds): "
+            "siphash24 %" G_GINT64_FORMAT " usec, fast %" G_GINT64_FORMAT " usec\n",
+            N_IFINDEX,
+            N_ROUNDS,
+            t_siphash,
+            t_fast);
+
+    nmp_cache_free(cache_siphash);
+    nmp_cache_free(cache_fast);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -603,6 +811,8 @@ main(int argc, char **argv)
     g_test_add_func("/nmp-object/obj-base", test_obj_base);
     g_test_add_func("/nmp-object/cache_link", test_cache_link);
     g_test_add_func("/nmp-object/cache_qdisc", test_cache_qdisc);
+    g_test_add_func("/nmp-object/cache_neighbor", test_cache_neighbor);
+    g_test_add_func("/nmp-object/cache_lookup_bench", test_cache_lookup_bench);
 
     result = g_test_run();
 
@@ -748,6 +748,109 @@ test_platform_ip_address_pretty_sort_cmp(gconstpointer test_data)
 
 /*****************************************************************************/
 
+#define _BV(start, end, _pvid, _untagged)                                             \
+    ((const NMPlatformBridgeVlan){.vid_start = (start),                               \
+                                  .vid_end   = (end),                                 \
+                                  .pvid      = (_pvid),                               \
+                                  .untagged  = (_untagged)})
+
+static void
+_assert_bridge_vlans(const NMPlatformBridgeVlan *vlans,
+                     guint                       n_vlans,
+                     const NMPlatformBridgeVlan *expected,
+                     guint                       n_expected)
+{
+    guint i;
+
+    g_assert_cmpint(n_vlans, ==, n_expected);
+    g_assert(!vlans == !n_vlans);
+    for (i = 0; i < n_vlans; i++) {
+        g_assert_cmpint(vlans[i].vid_start, ==, expected[i].vid_start);
+        g_assert_cmpint(vlans[i].vid_end, ==, expected[i].vid_end);
+        g_assert_cmpint(vlans[i].pvid, ==, expected[i].pvid);
+        g_assert_cmpint(vlans[i].untagged, ==, expected[i].untagged);
+    }
+}
+
+static void
+test_bridge_vlans_compress(void)
+{
+    gs_free NMPlatformBridgeVlan *result = NULL;
+    NMPlatformBridgeVlan          single[NM_BRIDGE_VLAN_VID_MAX];
+    const NMPlatformBridgeVlan *  ptrs[NM_BRIDGE_VLAN_VID_MAX + 1];
+    guint                         n;
+    guint                         i;
+
+    /* Nothing to do. */
+    result = nm_platform_bridge_vlans_compress(NULL, NULL, 0, &n);
+    _assert_bridge_vlans(result, n, NULL, 0);
+
+    /* All single VLANs with the same flags become one range, the PVID stays
+     * alone and adding it late moves it away from the earlier PVID. */
+    for (i = 0; i < NM_BRIDGE_VLAN_VID_MAX; i++) {
+        single[i] = _BV(i + 1, i + 1, i == 0, FALSE);
+        ptrs[i]   = &single[i];
+    }
+    single[99]                   = _BV(100, 100, TRUE, TRUE);
+    ptrs[NM_BRIDGE_VLAN_VID_MAX] = NULL;
+    nm_clear_g_free(&result);
+    result = nm_platform_bridge_vlans_compress(ptrs, NULL, 0, &n);
+    _assert_bridge_vlans(result,
+                         n,
+                         (const NMPlatformBridgeVlan[]){
+                             _BV(1, 99, FALSE, FALSE),
+                             _BV(100, 100, TRUE, TRUE),
+                             _BV(101, NM_BRIDGE_VLAN_VID_MAX, FALSE, FALSE),
+                         },
+                         3);
+
+    /* Overlapping ranges: later flags win. VLANs that kernel already
+     * has with the same flags are skipped. */
+    {
+        const NMPlatformBridgeVlan  want[]      = {
+            _BV(10, 30, FALSE, FALSE),
+            _BV(20, 25, FALSE, TRUE),
+            _BV(40, 41, FALSE, FALSE),
+        };
+        const NMPlatformBridgeVlan *want_ptrs[] = {&want[0], &want[1], &want[2], NULL};
+        const NMPlatformBridgeVlan  current[]   = {
+            _BV(1, 1, TRUE, TRUE),
+            _BV(10, 12, FALSE, FALSE),
+            _BV(21, 21, FALSE, FALSE),
+            _BV(40, 41, FALSE, FALSE),
+        };
+
+        nm_clear_g_free(&result);
+        result = nm_platform_bridge_vlans_compress(want_ptrs,
+                                                   current,
+                                                   G_N_ELEMENTS(current),
+                                                   &n);
+        _assert_bridge_vlans(result,
+                             n,
+                             (const NMPlatformBridgeVlan[]){
+                                 _BV(13, 19, FALSE, FALSE),
+                                 _BV(20, 25, FALSE, TRUE),
+                                 _BV(26, 30, FALSE, FALSE),
+                             },
+                             3);
+
+        /* Once configured, there is nothing left to do. */
+        nm_clear_g_free(&result);
+        result = nm_platform_bridge_vlans_compress(want_ptrs,
+                                                   (const NMPlatformBridgeVlan[]){
+                                                       _BV(10, 19, FALSE, FALSE),
+                                                       _BV(20, 25, FALSE, TRUE),
+                                                       _BV(26, 30, FALSE, FALSE),
+                                                       _BV(40, 41, FALSE, FALSE),
+                                                   },
+                                                   4,
+                                                   &n);
+        _assert_bridge_vlans(result, n, NULL, 0);
+    }
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -758,6 +861,7 @@ main(int argc, char **argv)
     g_test_add_func("/general/init_linux_platform", test_init_linux_platform);
     g_test_add_func("/general/link_get_all", test_link_get_all);
     g_test_add_func("/general/nm_platform_link_flags2str", test_nm_platform_link_flags2str);
+    g_test_add_func("/general/bridge_vlans_compress", test_bridge_vlans_compress);
     g_test_add_data_func("/general/platform_ip_address_pretty_sort_cmp/4",
                          GINT_TO_POINTER(0),
                          test_platform_ip_address_pretty_sort_cmp);
@@ -761,7 +761,7 @@ _bss_info_get_all_cb(GVariant *result, GError *error, gpointer user_data)
 }
 
 static void
-_bss_info_add(NMSupplicantInterface *self, const char *object_path)
+_bss_info_add(NMSupplicantInterface *self, const char *object_path, GVariant *properties)
 {
     NMSupplicantInterfacePrivate *priv       = NM_SUPPLICANT_INTERFACE_GET_PRIVATE(self);
     nm_auto_ref_string NMRefString *bss_path = NULL;
@@ -771,21 +771,46 @@ _bss_info_add(NMSupplicantInterface *self, const char *object_path)
     if (!bss_path)
         return;
 
+    if (properties && g_variant_n_children(properties) == 0) {
+        /* an empty dictionary tells us nothing. Fetch the properties instead. */
+        properties = NULL;
+    }
+
     bss_info = g_hash_table_lookup(priv->bss_idx, &bss_path);
     if (bss_info) {
         bss_info->_bss_dirty = FALSE;
+        if (!properties || !bss_info->_init_cancellable)
+            return;
+
+        /* A GetAll request is still pending, but we now got the properties
+         * along with the BSSAdded signal. No need to wait for it. */
+        nm_clear_g_cancellable(&bss_info->_init_cancellable);
+        nm_c_list_move_tail(&priv->bss_lst_head, &bss_info->_bss_lst);
+        _bss_info_properties_changed(self, bss_info, properties, TRUE);
+        _starting_check_ready(self);
+        _notify_maybe_scanning(self);
         return;
     }
 
     bss_info  = g_slice_new(NMSupplicantBssInfo);
     *bss_info = (NMSupplicantBssInfo){
-        ._self             = self,
-        .bss_path          = g_steal_pointer(&bss_path),
-        ._init_cancellable = g_cancellable_new(),
+        ._self    = self,
+        .bss_path = g_steal_pointer(&bss_path),
     };
-    c_list_link_tail(&priv->bss_initializing_lst_head, &bss_info->_bss_lst);
     g_hash_table_add(priv->bss_idx, bss_info);
 
+    if (properties) {
+        /* wpa_supplicant sends all properties of a new BSS with the BSSAdded
+         * signal. During a scan with many results, that saves one GetAll
+         * round trip per BSS. */
+        c_list_link_tail(&priv->bss_lst_head, &bss_info->_bss_lst);
+        _bss_info_properties_changed(self, bss_info, properties, TRUE);
+        return;
+    }
+
+    bss_info->_init_cancellable = g_cancellable_new();
+    c_list_link_tail(&priv->bss_initializing_lst_head, &bss_info->_bss_lst);
+
     nm_dbus_connection_call_get_all(priv->dbus_connection,
                                     priv->name_owner->str,
                                     bss_info->bss_path->str,
@@ -1908,7 +1933,7 @@ _properties_changed_main(NMSupplicantInterface *self, GVariant *properties)
             bss_info->_bss_dirty = TRUE;
 
         for (iter = v_strv; *iter; iter++)
-            _bss_info_add(self, *iter);
+            _bss_info_add(self, *iter, NULL);
 
         g_free(v_strv);
 
@@ -2514,6 +2539,8 @@ void
 nm_supplicant_interface_request_scan(NMSupplicantInterface *                  self,
                                      GBytes *const *                          ssids,
                                      guint                                    ssids_len,
+                                     const guint32 *                          freqs,
+                                     guint                                    freqs_len,
                                      GCancellable *                           cancellable,
                                      NMSupplicantInterfaceRequestScanCallback callback,
                                      gpointer                                 user_data)
@@ -2529,7 +2556,7 @@ nm_supplicant_interface_request_scan(NMSupplicantInterface *                  se
 
     priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE(self);
 
-    _LOGT("request-scan: request scanning (%u ssids)...", ssids_len);
+    _LOGT("request-scan: request scanning (%u ssids, %u channels)...", ssids_len, freqs_len);
 
     g_variant_builder_init(&builder, G_VARIANT_TYPE_VARDICT);
     g_variant_builder_add(&builder, "{sv}", "Type", g_variant_new_string("active"));
@@ -2544,6 +2571,19 @@ nm_supplicant_interface_request_scan(NMSupplicantInterface *                  se
         }
         g_variant_builder_add(&builder, "{sv}", "SSIDs", g_variant_builder_end(&ssids_builder));
     }
+    if (freqs_len > 0) {
+        GVariantBuilder channels_builder;
+
+        /* restrict the scan to these 20 MHz channels. Without "Channels",
+         * wpa_supplicant scans all supported frequencies. */
+        g_variant_builder_init(&channels_builder, G_VARIANT_TYPE("a(uu)"));
+        for (i = 0; i < freqs_len; i++)
+            g_variant_builder_add(&channels_builder, "(uu)", freqs[i], (guint32) 20);
+        g_variant_builder_add(&builder,
+                              "{sv}",
+                              "Channels",
+                              g_variant_builder_end(&channels_builder));
+    }
 
     data  = g_slice_new(ScanRequestData);
     *data = (ScanRequestData){
@@ -2886,11 +2926,13 @@ _signal_handle(NMSupplicantInterface *self,
             return;
 
         if (nm_streq(signal_name, "BSSAdded")) {
+            gs_unref_variant GVariant *properties = NULL;
+
             if (!g_variant_is_of_type(parameters, G_VARIANT_TYPE("(oa{sv})")))
                 return;
 
-            g_variant_get(parameters, "(&oa{sv})", &path, NULL);
-            _bss_info_add(self, path);
+            g_variant_get(parameters, "(&o@a{sv})", &path, &properties);
+            _bss_info_add(self, path, properties);
             return;
         }
 
@@ -138,6 +138,8 @@ typedef void (*NMSupplicantInterfaceRequestScanCallback)(NMSupplicantInterface *
 void nm_supplicant_interface_request_scan(NMSupplicantInterface *                  self,
                                           GBytes *const *                          ssids,
                                           guint                                    ssids_len,
+                                          const guint32 *                          freqs,
+                                          guint                                    freqs_len,
                                           GCancellable *                           cancellable,
                                           NMSupplicantInterfaceRequestScanCallback callback,
                                           gpointer                                 user_data);
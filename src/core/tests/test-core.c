@@ -7,6 +7,7 @@
 
 #include <net/if.h>
 #include <byteswap.h>
+#include <sys/socket.h>
 
 /* need math.h for isinf() and INFINITY. No need to link with -lm */
 #include <math.h>
@@ -17,7 +18,10 @@
 #include "systemd/nm-sd-utils-core.h"
 
 #include "dns/nm-dns-manager.h"
+#include "dns/nm-dns-rc-writer.h"
+#include "dns/nm-dns-systemd-resolved.h"
 #include "nm-connectivity.h"
+#include "nm-firewall-manager.h"
 
 #include "nm-test-utils-core.h"
 
@@ -2560,6 +2564,510 @@ test_connectivity_state_cmp(void)
 #undef _cmp
 }
 
+static void
+test_connectivity_passive_check(void)
+{
+    const gint64          HOUR_MSEC = 3600 * 1000;
+    NMConnectivityPassive passive   = {};
+    guint                 i;
+
+    /* nothing recorded, or no default route. */
+    g_assert_cmpint(nm_connectivity_passive_check(&passive, 0, FALSE, 1000),
+                    ==,
+                    NM_CONNECTIVITY_PASSIVE_CHECK);
+    g_assert_cmpint(nm_connectivity_passive_check(&passive, 42, TRUE, 1000),
+                    ==,
+                    NM_CONNECTIVITY_PASSIVE_CHECK);
+
+    passive = (NMConnectivityPassive){
+        .fingerprint = 42,
+        .ts_msec     = 1000,
+    };
+
+    g_assert_cmpint(nm_connectivity_passive_check(&passive, 43, TRUE, 2000),
+                    ==,
+                    NM_CONNECTIVITY_PASSIVE_CHECK_CHANGED);
+    g_assert_cmpint(nm_connectivity_passive_check(&passive, 0, FALSE, 2000),
+                    ==,
+                    NM_CONNECTIVITY_PASSIVE_CHECK_CHANGED);
+    g_assert_cmpuint(passive.n_skipped, ==, 0);
+
+    /* without confirmation, only a few checks in a row are skipped. */
+    for (i = 0; i < 3; i++) {
+        g_assert_cmpint(nm_connectivity_passive_check(&passive, 42, FALSE, 2000 + i),
+                        ==,
+                        NM_CONNECTIVITY_PASSIVE_SKIP);
+    }
+    g_assert_cmpuint(passive.n_skipped, ==, 3);
+    g_assert_cmpint(nm_connectivity_passive_check(&passive, 42, FALSE, 3000),
+                    ==,
+                    NM_CONNECTIVITY_PASSIVE_CHECK);
+
+    /* a reachable gateway allows to skip more, and does not count. */
+    for (i = 0; i < 10; i++) {
+        g_assert_cmpint(nm_connectivity_passive_check(&passive, 42, TRUE, 3000 + i),
+                        ==,
+                        NM_CONNECTIVITY_PASSIVE_SKIP_CONFIRMED);
+    }
+    g_assert_cmpuint(passive.n_skipped, ==, 3);
+
+    passive.n_skipped = 0;
+    g_assert_cmpint(nm_connectivity_passive_check(&passive, 42, FALSE, 4000),
+                    ==,
+                    NM_CONNECTIVITY_PASSIVE_SKIP);
+    g_assert_cmpint(nm_connectivity_passive_check(&passive, 42, TRUE, 4000),
+                    ==,
+                    NM_CONNECTIVITY_PASSIVE_SKIP_CONFIRMED);
+
+    /* but the result is only trusted for so long. */
+    g_assert_cmpint(nm_connectivity_passive_check(&passive, 42, TRUE, 1000 + HOUR_MSEC - 1),
+                    ==,
+                    NM_CONNECTIVITY_PASSIVE_SKIP_CONFIRMED);
+    g_assert_cmpint(nm_connectivity_passive_check(&passive, 42, TRUE, 1000 + HOUR_MSEC),
+                    ==,
+                    NM_CONNECTIVITY_PASSIVE_CHECK);
+}
+
+/*****************************************************************************/
+
+static void
+_resolved_update(NMDnsPlugin *plugin, NMIPConfig *ip_config)
+{
+    gs_free_error GError *error    = NULL;
+    NMDnsConfigData       data     = {};
+    NMDnsConfigIPData     ip_data  = {};
+    CList                 lst_head = C_LIST_INIT(lst_head);
+
+    if (ip_config) {
+        data.ifindex      = nm_ip_config_get_ifindex(ip_config);
+        ip_data.data      = &data;
+        ip_data.ip_config = ip_config;
+        c_list_link_tail(&lst_head, &ip_data.ip_config_lst);
+    }
+
+    g_assert(nm_dns_plugin_update(plugin, NULL, &lst_head, NULL, &error));
+    g_assert_no_error(error);
+
+    c_list_unlink_stale(&ip_data.ip_config_lst);
+}
+
+static void
+test_dns_resolved_remove_before_owner(void)
+{
+    gs_unref_object NMDnsPlugin *plugin = nm_dns_systemd_resolved_new();
+    gs_unref_object NMIP4Config *config = nmtst_ip4_config_new(5);
+    NMDnsSystemdResolved *       self   = NM_DNS_SYSTEMD_RESOLVED(plugin);
+    gboolean                     pending;
+    gboolean                     to_remove;
+
+    /* There is no D-Bus connection, so resolved never gets a name owner and
+     * nothing is sent. */
+    nm_ip4_config_mdns_set(config, NM_SETTING_CONNECTION_MDNS_YES);
+
+    _resolved_update(plugin, NM_IP_CONFIG_CAST(config));
+    g_assert(_nmtst_dns_systemd_resolved_get_link(self, 5, &pending, &to_remove));
+    g_assert(pending);
+    g_assert(!to_remove);
+
+    /* The link goes away before anything was sent. It still needs its reset. */
+    _resolved_update(plugin, NULL);
+    g_assert(_nmtst_dns_systemd_resolved_get_link(self, 5, &pending, &to_remove));
+    g_assert(pending);
+    g_assert(to_remove);
+
+    /* Further updates must not drop it before the reset was sent. */
+    _resolved_update(plugin, NULL);
+    _resolved_update(plugin, NULL);
+    g_assert(_nmtst_dns_systemd_resolved_get_link(self, 5, &pending, &to_remove));
+    g_assert(pending);
+    g_assert(to_remove);
+
+    /* When it comes back, it is a regular link again. */
+    _resolved_update(plugin, NM_IP_CONFIG_CAST(config));
+    g_assert(_nmtst_dns_systemd_resolved_get_link(self, 5, &pending, &to_remove));
+    g_assert(pending);
+    g_assert(!to_remove);
+}
+
+/*****************************************************************************/
+
+typedef struct {
+    const char *path;
+    int         n_written;
+    int         n_done;
+    char *      last_done;
+} RcWriterTestData;
+
+typedef struct {
+    RcWriterTestData *t;
+    char *            content;
+} RcWriterTestJob;
+
+static void
+_rc_writer_test_job_free(RcWriterTestJob *job)
+{
+    g_free(job->content);
+    g_free(job);
+}
+
+static void
+_rc_writer_test_write(gpointer user_data, GError **error)
+{
+    RcWriterTestJob *job = user_data;
+
+    /* pretend a slow file system. */
+    g_usleep(20000);
+    g_atomic_int_inc(&job->t->n_written);
+    g_file_set_contents(job->t->path, job->content, -1, error);
+}
+
+static void
+_rc_writer_test_done(gpointer user_data, GError *error, gpointer test_data)
+{
+    RcWriterTestJob * job = user_data;
+    RcWriterTestData *t   = test_data;
+
+    g_assert_no_error(error);
+    t->n_done++;
+    g_free(t->last_done);
+    t->last_done = g_strdup(job->content);
+}
+
+static NMDnsRcWriter *
+_rc_writer_test_burst(RcWriterTestData *t, guint delay_msec, int n, gint64 *out_max_stall_usec)
+{
+    NMDnsRcWriter *writer;
+    gint64         max_stall = 0;
+    gint64         start;
+    gint64         now;
+    int            i;
+
+    writer = nm_dns_rc_writer_new(_rc_writer_test_write,
+                                  _rc_writer_test_done,
+                                  (GDestroyNotify) _rc_writer_test_job_free,
+                                  t);
+    nm_dns_rc_writer_set_delay(writer, delay_msec);
+
+    for (i = 1; i <= n; i++) {
+        RcWriterTestJob *job;
+
+        job  = g_new(RcWriterTestJob, 1);
+        *job = (RcWriterTestJob){
+            .t       = t,
+            .content = g_strdup_printf("nameserver 192.0.2.%d # %d\n", i % 250 + 1, i),
+        };
+
+        start = g_get_monotonic_time();
+        nm_dns_rc_writer_queue(writer, job);
+        now       = g_get_monotonic_time();
+        max_stall = NM_MAX(max_stall, now - start);
+    }
+
+    *out_max_stall_usec = max_stall;
+    return writer;
+}
+
+static void
+test_dns_rc_writer_burst(gconstpointer test_data)
+{
+    const guint           delay_msec = GPOINTER_TO_UINT(test_data);
+    const int             N          = 10000;
+    gs_free char *        path       = NULL;
+    gs_free char *        expected   = NULL;
+    gs_free char *        content    = NULL;
+    gs_free_error GError *error      = NULL;
+    RcWriterTestData      t          = {};
+    NMDnsRcWriter *       writer;
+    gint64                max_stall;
+    gint64                start;
+    int                   fd;
+
+    fd = g_file_open_tmp("nm-test-rc-writer-XXXXXX", &path, &error);
+    g_assert_no_error(error);
+    nm_close(fd);
+    t.path = path;
+
+    /* Writing synchronously would block the main loop for N times 20 msec.
+     * Queuing does no I/O, so the burst takes only a fraction of a single
+     * write and each call returns immediately. */
+    start  = g_get_monotonic_time();
+    writer = _rc_writer_test_burst(&t, delay_msec, N, &max_stall);
+    g_test_message("rc-writer: burst of %d updates took %" G_GINT64_FORMAT
+                   " usec, longest call %" G_GINT64_FORMAT " usec",
+                   N,
+                   g_get_monotonic_time() - start,
+                   max_stall);
+    g_assert_cmpint(g_get_monotonic_time() - start, <, (gint64) N * 20000 / 10);
+
+    while (nm_dns_rc_writer_is_busy(writer))
+        g_main_context_iteration(NULL, TRUE);
+
+    /* Without delay, the first update is written right away and the others
+     * are coalesced into one more write. With a delay, they all end up in a
+     * single write. */
+    g_assert_cmpint(g_atomic_int_get(&t.n_written), ==, delay_msec > 0 ? 1 : 2);
+    g_assert_cmpint(t.n_done, ==, g_atomic_int_get(&t.n_written));
+
+    expected = g_strdup_printf("nameserver 192.0.2.%d # %d\n", N % 250 + 1, N);
+    g_assert_cmpstr(t.last_done, ==, expected);
+    g_assert(g_file_get_contents(path, &content, NULL, &error));
+    g_assert_no_error(error);
+    g_assert_cmpstr(content, ==, expected);
+
+    nm_dns_rc_writer_free(writer);
+    g_free(t.last_done);
+    unlink(path);
+}
+
+static void
+test_dns_rc_writer_flush(void)
+{
+    gs_free char *        path    = NULL;
+    gs_free char *        content = NULL;
+    gs_free_error GError *error   = NULL;
+    RcWriterTestData      t       = {};
+    NMDnsRcWriter *       writer;
+    gint64                max_stall;
+    int                   fd;
+
+    fd = g_file_open_tmp("nm-test-rc-writer-XXXXXX", &path, &error);
+    g_assert_no_error(error);
+    nm_close(fd);
+    t.path = path;
+
+    /* On shutdown, the queued update is written synchronously, even while
+     * an older one is in flight. The older one must not win. */
+    writer = _rc_writer_test_burst(&t, 0, 3, &max_stall);
+    g_assert(nm_dns_rc_writer_is_busy(writer));
+    nm_dns_rc_writer_flush_sync(writer);
+    g_assert_cmpint(t.n_done, ==, 1);
+    g_assert_cmpstr(t.last_done, ==, "nameserver 192.0.2.4 # 3\n");
+
+    while (nm_dns_rc_writer_is_busy(writer))
+        g_main_context_iteration(NULL, TRUE);
+
+    g_assert_cmpint(t.n_done, ==, 1);
+    g_assert(g_file_get_contents(path, &content, NULL, &error));
+    g_assert_no_error(error);
+    g_assert_cmpstr(content, ==, "nameserver 192.0.2.4 # 3\n");
+
+    nm_dns_rc_writer_free(writer);
+    g_free(t.last_done);
+    unlink(path);
+}
+
+/*****************************************************************************/
+
+/* A mock firewalld, reached over a peer-to-peer D-Bus connection. */
+
+typedef struct {
+    GPtrArray *calls;
+} FwMock;
+
+typedef struct {
+    GError *error;
+    bool    done;
+} FwRequest;
+
+static void
+_fw_mock_method_call(GDBusConnection *      connection,
+                     const char *           sender,
+                     const char *           object_path,
+                     const char *           interface_name,
+                     const char *           method_name,
+                     GVariant *             parameters,
+                     GDBusMethodInvocation *invocation,
+                     gpointer               user_data)
+{
+    FwMock *    mock = user_data;
+    const char *zone;
+    const char *iface;
+
+    g_assert_cmpstr(interface_name, ==, "org.fedoraproject.FirewallD1.zone");
+    g_assert(NM_IN_STRSET(method_name, "addInterface", "changeZone", "removeInterface"));
+
+    g_variant_get(parameters, "(&s&s)", &zone, &iface);
+    g_ptr_array_add(mock->calls, g_strdup_printf("%s %s %s", method_name, iface, zone));
+
+    g_dbus_method_invocation_return_value(invocation, g_variant_new("(s)", zone));
+}
+
+static void
+_fw_mock_connection_new_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+    GDBusConnection **p_connection = user_data;
+    gs_free_error GError *error    = NULL;
+
+    *p_connection = g_dbus_connection_new_finish(result, &error);
+    g_assert_no_error(error);
+}
+
+static void
+_fw_mock_connections_new(GDBusConnection **out_firewalld, GDBusConnection **out_nm)
+{
+    gs_free char *guid             = g_dbus_generate_guid();
+    gs_free_error GError *error    = NULL;
+    gs_unref_object GSocket *sock0 = NULL;
+    gs_unref_object GSocket *sock1 = NULL;
+    gs_unref_object GSocketConnection *stream0 = NULL;
+    gs_unref_object GSocketConnection *stream1 = NULL;
+    int                                fds[2];
+
+    g_assert_cmpint(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), ==, 0);
+    sock0 = g_socket_new_from_fd(fds[0], &error);
+    g_assert_no_error(error);
+    sock1 = g_socket_new_from_fd(fds[1], &error);
+    g_assert_no_error(error);
+    stream0 = g_socket_connection_factory_create_connection(sock0);
+    stream1 = g_socket_connection_factory_create_connection(sock1);
+
+    *out_firewalld = NULL;
+    *out_nm        = NULL;
+    g_dbus_connection_new(G_IO_STREAM(stream0),
+                          guid,
+                          G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_SERVER,
+                          NULL,
+                          NULL,
+                          _fw_mock_connection_new_cb,
+                          out_firewalld);
+    g_dbus_connection_new(G_IO_STREAM(stream1),
+                          NULL,
+                          G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT,
+                          NULL,
+                          NULL,
+                          _fw_mock_connection_new_cb,
+                          out_nm);
+    nmtst_main_context_iterate_until_assert(NULL, 5000, *out_firewalld && *out_nm);
+}
+
+static void
+_fw_request_cb(NMFirewallManager *      self,
+               NMFirewallManagerCallId *call_id,
+               GError *                 error,
+               gpointer                 user_data)
+{
+    FwRequest *request = user_data;
+
+    g_assert(!request->done);
+    request->done  = TRUE;
+    request->error = error ? g_error_copy(error) : NULL;
+}
+
+static gboolean
+_fw_requests_done(const FwRequest *requests, guint n)
+{
+    guint i;
+
+    for (i = 0; i < n; i++) {
+        if (!requests[i].done)
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static void
+test_firewall_manager_queue(void)
+{
+    static const char INTROSPECTION[] =
+        "<node>"
+        "  <interface name='org.fedoraproject.FirewallD1.zone'>"
+        "    <method name='addInterface'>"
+        "      <arg type='s' direction='in'/><arg type='s' direction='in'/>"
+        "      <arg type='s' direction='out'/>"
+        "    </method>"
+        "    <method name='changeZone'>"
+        "      <arg type='s' direction='in'/><arg type='s' direction='in'/>"
+        "      <arg type='s' direction='out'/>"
+        "    </method>"
+        "    <method name='removeInterface'>"
+        "      <arg type='s' direction='in'/><arg type='s' direction='in'/>"
+        "      <arg type='s' direction='out'/>"
+        "    </method>"
+        "  </interface>"
+        "</node>";
+    static const GDBusInterfaceVTable vtable = {
+        .method_call = _fw_mock_method_call,
+    };
+    gs_unref_object GDBusConnection *  conn_firewalld = NULL;
+    gs_unref_object GDBusConnection *  conn_nm        = NULL;
+    gs_unref_object NMFirewallManager *mgr            = NULL;
+    gs_unref_ptrarray GPtrArray *calls                = g_ptr_array_new_with_free_func(g_free);
+    gs_free_error GError *   error                    = NULL;
+    FwMock                   mock                     = {.calls = calls};
+    FwRequest                requests[6]              = {};
+    GDBusNodeInfo *          node_info;
+    NMFirewallManagerCallId *call_id;
+    guint                    registration_id;
+    guint                    i;
+
+    _fw_mock_connections_new(&conn_firewalld, &conn_nm);
+
+    node_info = g_dbus_node_info_new_for_xml(INTROSPECTION, &error);
+    g_assert_no_error(error);
+    registration_id = g_dbus_connection_register_object(conn_firewalld,
+                                                        "/org/fedoraproject/FirewallD1",
+                                                        node_info->interfaces[0],
+                                                        &vtable,
+                                                        &mock,
+                                                        NULL,
+                                                        &error);
+    g_assert_no_error(error);
+    g_dbus_node_info_unref(node_info);
+
+    mgr = _nmtst_firewall_manager_new(conn_nm);
+    g_assert(nm_firewall_manager_get_running(mgr));
+
+    nm_firewall_manager_add_or_change_zone(mgr, "eth0", "a", TRUE, _fw_request_cb, &requests[0]);
+    nm_firewall_manager_add_or_change_zone(mgr, "eth0", "b", FALSE, _fw_request_cb, &requests[1]);
+    nm_firewall_manager_remove_from_zone(mgr, "eth1", NULL, _fw_request_cb, &requests[2]);
+    nm_firewall_manager_add_or_change_zone(mgr, "eth1", "c", TRUE, _fw_request_cb, &requests[3]);
+    call_id = nm_firewall_manager_add_or_change_zone(mgr,
+                                                     "eth3",
+                                                     NULL,
+                                                     TRUE,
+                                                     _fw_request_cb,
+                                                     &requests[4]);
+    nm_firewall_manager_add_or_change_zone(mgr, "eth4", "d", TRUE, _fw_request_cb, &requests[5]);
+    nm_firewall_manager_add_or_change_zone(mgr, "eth5", "e", TRUE, NULL, NULL);
+
+    /* cancelling completes right away. The caller cancelled the request itself,
+     * so it gets the cancelled error. */
+    g_assert(call_id);
+    nm_firewall_manager_cancel_call(call_id);
+    g_assert(requests[4].done);
+    g_assert(nm_utils_error_is_cancelled(requests[4].error));
+
+    /* the requests are queued, nothing is sent yet. */
+    g_assert(!requests[0].done);
+    g_assert_cmpint(calls->len, ==, 0);
+
+    nmtst_main_context_iterate_until_assert(NULL,
+                                            5000,
+                                            _fw_requests_done(requests, G_N_ELEMENTS(requests)));
+
+    /* only the last request of each interface was sent, in the order they were
+     * queued. The "add" that overrules a "remove" becomes a "changeZone". */
+    g_assert_cmpint(calls->len, ==, 4);
+    g_assert_cmpstr(calls->pdata[0], ==, "changeZone eth0 b");
+    g_assert_cmpstr(calls->pdata[1], ==, "changeZone eth1 c");
+    g_assert_cmpstr(calls->pdata[2], ==, "addInterface eth4 d");
+    g_assert_cmpstr(calls->pdata[3], ==, "addInterface eth5 e");
+
+    /* the superseded requests did not fail. */
+    for (i = 0; i < G_N_ELEMENTS(requests); i++) {
+        if (i == 4)
+            continue;
+        g_assert_no_error(requests[i].error);
+    }
+
+    for (i = 0; i < G_N_ELEMENTS(requests); i++)
+        g_clear_error(&requests[i].error);
+
+    g_dbus_connection_unregister_object(conn_firewalld, registration_id);
+    g_dbus_connection_close_sync(conn_nm, NULL, NULL);
+    g_dbus_connection_close_sync(conn_firewalld, NULL, NULL);
+}
+
 /*****************************************************************************/
 
 NMTST_DEFINE();
@@ -2623,6 +3131,17 @@ main(int argc, char **argv)
     g_test_add_func("/general/test_utils_file_is_in_path", test_utils_file_is_in_path);
 
     g_test_add_func("/general/test_dns_create_resolv_conf", test_dns_create_resolv_conf);
+    g_test_add_func("/general/test_dns_resolved_remove_before_owner",
+                    test_dns_resolved_remove_before_owner);
+    g_test_add_data_func("/general/test_dns_rc_writer/burst",
+                         GUINT_TO_POINTER(0),
+                         test_dns_rc_writer_burst);
+    g_test_add_data_func("/general/test_dns_rc_writer/burst-delay",
+                         GUINT_TO_POINTER(50),
+                         test_dns_rc_writer_burst);
+    g_test_add_func("/general/test_dns_rc_writer/flush", test_dns_rc_writer_flush);
+
+    g_test_add_func("/general/test_firewall_manager/queue", test_firewall_manager_queue);
 
     g_test_add_data_func("/general/nm_utils_dhcp_client_id_systemd_node_specific/0",
                          GINT_TO_POINTER(0),
@@ -2632,6 +3151,8 @@ main(int argc, char **argv)
                          test_nm_utils_dhcp_client_id_systemd_node_specific);
 
     g_test_add_func("/core/general/test_connectivity_state_cmp", test_connectivity_state_cmp);
+    g_test_add_func("/core/general/test_connectivity_passive_check",
+                    test_connectivity_passive_check);
     g_test_add_func("/core/general/test_kernel_cmdline_match_check",
                     test_kernel_cmdline_match_check);
 
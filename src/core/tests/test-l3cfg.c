@@ -2,9 +2,13 @@
 
 #include "nm-default.h"
 
+#include <linux/neighbour.h>
+
 #include "nm-l3cfg.h"
 #include "nm-l3-ipv4ll.h"
 #include "nm-netns.h"
+#include "nm-connectivity.h"
+#include "NetworkManagerUtils.h"
 #include "platform/nm-platform.h"
 
 #include "platform/tests/test-common.h"
@@ -775,6 +779,186 @@ test_l3_ipv4ll(gconstpointer test_data)
 
 /*****************************************************************************/
 
+static void
+_passive_neighbor_set(const TestFixture1 *f, in_addr_t addr, const char *nud, guint16 state)
+{
+    const NMPlatformNeighbor *neigh;
+    char                      sbuf[NM_UTILS_INET_ADDRSTRLEN];
+
+    nmtstp_run_command_check("ip neigh replace %s dev %s nud %s",
+                             _nm_utils_inet4_ntop(addr, sbuf),
+                             f->ifname0,
+                             nud);
+    NMTST_WAIT_ASSERT(200, {
+        nmtstp_wait_for_signal(f->platform, 50);
+
+        neigh = nm_platform_neighbor_get(f->platform, f->ifindex0, AF_INET, &addr);
+        if (neigh && neigh->state == state)
+            break;
+    });
+}
+
+static void
+test_connectivity_passive_fingerprint(void)
+{
+    nm_auto(_test_fixture_1_teardown) TestFixture1 test_fixture = {};
+    const TestFixture1 *                           f;
+    const in_addr_t                                gateway = nmtst_inet4_from_string("192.0.2.1");
+    const in_addr_t                                address = nmtst_inet4_from_string("192.0.2.2");
+    gboolean                                       confirmed;
+    guint64                                        fingerprint;
+    guint64                                        fp;
+
+    f = _test_fixture_1_setup(&test_fixture, 1);
+
+    NMTST_WAIT_ASSERT(500, {
+        nmtstp_wait_for_signal(f->platform, 50);
+
+        if (nm_platform_link_is_connected(f->platform, f->ifindex0))
+            break;
+    });
+
+    /* without default route, there is nothing to trust. */
+    nmtstp_ip4_address_add(f->platform, -1, f->ifindex0, address, 24, address, 100000, 0, 0, NULL);
+    g_assert_cmpuint(
+        nm_connectivity_passive_fingerprint(f->platform, f->ifindex0, AF_INET, &confirmed),
+        ==,
+        0);
+    g_assert(!confirmed);
+
+    nmtstp_ip4_route_add(f->platform,
+                         f->ifindex0,
+                         NM_IP_CONFIG_SOURCE_USER,
+                         0,
+                         0,
+                         gateway,
+                         0,
+                         100,
+                         0);
+    fingerprint =
+        nm_connectivity_passive_fingerprint(f->platform, f->ifindex0, AF_INET, &confirmed);
+    g_assert_cmpuint(fingerprint, !=, 0);
+    g_assert(!confirmed);
+
+    /* the regular transitions of the gateway don't change the fingerprint,
+     * but only a reachable gateway is confirmed. */
+    nm_platform_neighbor_subscribe(f->platform, NMP_OBJECT_TYPE_NEIGHBOR, f->ifindex0);
+
+    _passive_neighbor_set(f, gateway, "stale", NUD_STALE);
+    fp = nm_connectivity_passive_fingerprint(f->platform, f->ifindex0, AF_INET, &confirmed);
+    g_assert_cmpuint(fp, ==, fingerprint);
+    g_assert(!confirmed);
+
+    _passive_neighbor_set(f, gateway, "reachable", NUD_REACHABLE);
+    fp = nm_connectivity_passive_fingerprint(f->platform, f->ifindex0, AF_INET, &confirmed);
+    g_assert_cmpuint(fp, ==, fingerprint);
+    g_assert(confirmed);
+
+    /* a failed gateway does. */
+    _passive_neighbor_set(f, gateway, "failed", NUD_FAILED);
+    fp = nm_connectivity_passive_fingerprint(f->platform, f->ifindex0, AF_INET, &confirmed);
+    g_assert_cmpuint(fp, !=, fingerprint);
+    g_assert(!confirmed);
+
+    _passive_neighbor_set(f, gateway, "reachable", NUD_REACHABLE);
+    fp = nm_connectivity_passive_fingerprint(f->platform, f->ifindex0, AF_INET, &confirmed);
+    g_assert_cmpuint(fp, ==, fingerprint);
+    g_assert(confirmed);
+
+    /* and so does another default route. */
+    nmtstp_ip4_route_add(f->platform,
+                         f->ifindex0,
+                         NM_IP_CONFIG_SOURCE_USER,
+                         0,
+                         0,
+                         nmtst_inet4_from_string("192.0.2.3"),
+                         0,
+                         200,
+                         0);
+    fp = nm_connectivity_passive_fingerprint(f->platform, f->ifindex0, AF_INET, &confirmed);
+    g_assert_cmpuint(fp, !=, fingerprint);
+    g_assert(confirmed);
+
+    nm_platform_neighbor_unsubscribe(f->platform, NMP_OBJECT_TYPE_NEIGHBOR, f->ifindex0);
+}
+
+/*****************************************************************************/
+
+static gboolean
+_share_rules_nft_has(const char *table, const char *what)
+{
+    return nmtstp_run_command("%s list table ip %s 2>/dev/null | grep -q '%s'",
+                              NFT_PATH,
+                              table,
+                              what)
+           == 0;
+}
+
+static void
+_share_rules_wait(NMUtilsShareRules *rules)
+{
+    nmtst_main_context_iterate_until_assert(NULL,
+                                            5000,
+                                            !_nmtst_utils_share_rules_is_busy(rules));
+}
+
+static void
+test_share_rules_nft(void)
+{
+    nm_auto(_test_fixture_1_teardown) TestFixture1 test_fixture = {};
+    const TestFixture1 *                           f;
+    gs_free char *                                 table = NULL;
+    NMUtilsShareRules *                            rules;
+
+    if (!g_file_test(NFT_PATH, G_FILE_TEST_IS_EXECUTABLE)) {
+        g_test_skip("Skipping test: nft is not installed");
+        return;
+    }
+
+    f     = _test_fixture_1_setup(&test_fixture, 1);
+    table = g_strdup_printf("nm-shared-%d-%s", f->ifindex0, f->ifname0);
+
+    rules = nm_utils_share_rules_new(TRUE);
+    nm_utils_share_rules_add_all_rules(rules,
+                                       f->ifindex0,
+                                       f->ifname0,
+                                       nmtst_inet4_from_string("10.42.0.1"),
+                                       24);
+
+    /* nft runs in the background. */
+    nm_utils_share_rules_apply(rules, TRUE);
+    g_assert(_nmtst_utils_share_rules_is_busy(rules));
+    _share_rules_wait(rules);
+
+    if (!_share_rules_nft_has(table, "table")) {
+        /* the kernel has no nf_tables. We fell back to iptables. */
+        nm_utils_share_rules_apply(rules, FALSE);
+        nm_utils_share_rules_free(rules);
+        g_test_skip("Skipping test: cannot add nftables rules");
+        return;
+    }
+
+    g_assert(_share_rules_nft_has(table, "ip daddr != 10.42.0.0/24 masquerade"));
+    g_assert(_share_rules_nft_has(table, "iifname \"nm-test-veth0\" udp dport { 53, 67 } accept"));
+    g_assert(_share_rules_nft_has(table, "oifname \"nm-test-veth0\" reject"));
+
+    /* the table is removed as a whole. */
+    nm_utils_share_rules_apply(rules, FALSE);
+    _share_rules_wait(rules);
+    g_assert(!_share_rules_nft_has(table, "table"));
+
+    /* unsharing while the table is still being added removes it once nft is done. */
+    nm_utils_share_rules_apply(rules, TRUE);
+    nm_utils_share_rules_apply(rules, FALSE);
+    g_assert(_nmtst_utils_share_rules_is_busy(rules));
+    _share_rules_wait(rules);
+    g_assert(!_share_rules_nft_has(table, "table"));
+
+    nm_utils_share_rules_free(rules);
+}
+
+/*****************************************************************************/
+
 NMTstpSetupFunc const _nmtstp_setup_platform_func = nm_linux_platform_setup;
 
 void
@@ -792,4 +976,7 @@ _nmtstp_setup_tests(void)
     g_test_add_data_func("/l3cfg/4", GINT_TO_POINTER(4), test_l3cfg);
     g_test_add_data_func("/l3-ipv4ll/1", GINT_TO_POINTER(1), test_l3_ipv4ll);
     g_test_add_data_func("/l3-ipv4ll/2", GINT_TO_POINTER(2), test_l3_ipv4ll);
+    g_test_add_func("/l3cfg/connectivity-passive-fingerprint",
+                    test_connectivity_passive_fingerprint);
+    g_test_add_func("/l3cfg/share-rules-nft", test_share_rules_nft);
 }